@@ -0,0 +1,268 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-worker pool of idle keep-alive HTTP connections.
+ */
+#include "conn_pool.h"
+#include "../core/core_assign.h"
+#include "../common/util.h"
+#include "../net/tcp_fsm.h"
+#include "../net/tcp_timer.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_log.h>
+
+conn_pool_t *g_conn_pools[TGEN_MAX_WORKERS];
+
+static bool
+same_target(const conn_pool_key_t *k, const conn_pool_target_t *t)
+{
+    return k->dst_ip == t->dst_ip && k->dst_port == t->dst_port &&
+           k->tls == t->tls && k->cc_algo == t->cc_algo &&
+           k->port_id == t->port_id && k->vlan_id == t->vlan_id;
+}
+
+int conn_pool_configure(uint32_t worker_idx, const conn_pool_target_t *t,
+                        uint32_t min_idle, uint32_t max_idle,
+                        uint32_t idle_ms)
+{
+    int socket = (int)g_core_map.socket_of_lcore[
+                          g_core_map.worker_lcores[worker_idx]];
+    conn_pool_t *pool = g_conn_pools[worker_idx];
+    if (!pool) {
+        pool = rte_zmalloc_socket("conn_pool", sizeof(*pool),
+                                  RTE_CACHE_LINE_SIZE, socket);
+        if (!pool)
+            goto nomem;
+        __atomic_store_n(&g_conn_pools[worker_idx], pool, __ATOMIC_RELEASE);
+    }
+
+    uint32_t i = 0;
+    while (i < pool->n_keys && !same_target(&pool->keys[i], t))
+        i++;
+    conn_pool_key_t *k = &pool->keys[i];
+    if (i == pool->n_keys) {
+        if (i == CONN_POOL_MAX_KEYS) {
+            RTE_LOG(ERR, HTTP, "connection pool: worker %u has %u targets\n",
+                    worker_idx, CONN_POOL_MAX_KEYS);
+            return -ENOSPC;
+        }
+        k->idle = rte_zmalloc_socket("conn_pool_idle",
+                      CONN_POOL_MAX_IDLE * sizeof(k->idle[0]),
+                      RTE_CACHE_LINE_SIZE, socket);
+        if (!k->idle)
+            goto nomem;
+        k->dst_ip   = t->dst_ip;
+        k->dst_port = t->dst_port;
+        k->tls      = t->tls;
+        k->cc_algo  = t->cc_algo;
+        k->port_id  = t->port_id;
+        k->vlan_id  = t->vlan_id;
+        __atomic_store_n(&pool->n_keys, i + 1, __ATOMIC_RELEASE);
+    }
+
+    k->max_idle = TGEN_MIN(TGEN_MAX(max_idle, 1u), CONN_POOL_MAX_IDLE);
+    k->min_idle = TGEN_MIN(min_idle, k->max_idle);
+    k->idle_tsc = (uint64_t)(idle_ms ? idle_ms : CONN_POOL_DEF_IDLE_MS) *
+                  (g_tsc_hz / 1000);
+    return (int)i + 1;
+
+nomem:
+    RTE_LOG(ERR, HTTP, "connection pool: no memory for worker %u\n",
+            worker_idx);
+    return -ENOMEM;
+}
+
+static inline conn_pool_key_t *
+pool_key(uint32_t worker_idx, uint8_t key)
+{
+    return &g_conn_pools[worker_idx]->keys[key - 1];
+}
+
+/* Take TCB index `ci` off the idle list.  Timeouts hit the oldest
+ * entries, which sit at the bottom. */
+static void
+idle_remove(conn_pool_key_t *k, uint32_t ci)
+{
+    for (uint32_t i = 0; i < k->n_idle; i++) {
+        if (k->idle[i] != ci)
+            continue;
+        memmove(&k->idle[i], &k->idle[i + 1],
+                (k->n_idle - i - 1) * sizeof(k->idle[0]));
+        k->n_idle--;
+        return;
+    }
+}
+
+tcb_t *conn_pool_get(uint32_t worker_idx, uint8_t key)
+{
+    conn_pool_key_t *k = pool_key(worker_idx, key);
+    tcb_store_t *store = &g_tcb_stores[worker_idx];
+
+    while (k->n_idle > 0) {
+        tcb_t *tcb = &store->tcbs[k->idle[--k->n_idle]];
+        tcb->idle_deadline_tsc = 0;
+        if (tcb->state != TCP_ESTABLISHED) {
+            /* The server closed it while parked; it is on its way out.
+             * app_state stays 9 so the TLS session is detached at free. */
+            tcb->pool_state = CONN_POOL_NONE;
+            continue;
+        }
+        tcb->pool_state = CONN_POOL_BUSY;
+        k->borrowed++;
+        return tcb;
+    }
+    return NULL;
+}
+
+void conn_pool_opened(uint32_t worker_idx, tcb_t *tcb, uint8_t key,
+                      bool warming)
+{
+    conn_pool_key_t *k = pool_key(worker_idx, key);
+    tcb->pool_key   = key;
+    tcb->pool_state = warming ? CONN_POOL_WARMING : CONN_POOL_BUSY;
+    k->opened++;
+    if (warming)
+        k->warming++;
+}
+
+uint32_t conn_pool_deficit(uint32_t worker_idx, uint8_t key)
+{
+    const conn_pool_key_t *k = pool_key(worker_idx, key);
+    uint32_t have = k->n_idle + k->warming;
+    return k->min_idle > have ? k->min_idle - have : 0;
+}
+
+bool conn_pool_put(uint32_t worker_idx, tcb_t *tcb)
+{
+    if (tcb->pool_key == 0)
+        return false;
+    conn_pool_key_t *k = pool_key(worker_idx, tcb->pool_key);
+    bool warm = tcb->pool_state == CONN_POOL_WARMING;
+    if (warm && k->warming > 0)
+        k->warming--;
+    if (tcb->state != TCP_ESTABLISHED || k->n_idle >= k->max_idle) {
+        if (tcb->state == TCP_ESTABLISHED)
+            k->overflow++;
+        tcb->pool_state = CONN_POOL_NONE;
+        return false;
+    }
+
+    k->idle[k->n_idle++] = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
+    if (k->n_idle > k->idle_peak)
+        k->idle_peak = k->n_idle;
+    if (!warm)
+        k->returned++;
+    tcb->pool_state        = CONN_POOL_IDLE;
+    tcb->app_state         = CONN_POOL_APP_IDLE;
+    tcb->http_req_sent_tsc = 0;     /* no response timeout while parked */
+    tcb->idle_deadline_tsc = rte_rdtsc() + k->idle_tsc;
+    tcp_timer_resched(worker_idx, tcb);
+    return true;
+}
+
+void conn_pool_idle_expired(uint32_t worker_idx, tcb_t *tcb)
+{
+    if (tcb->pool_state != CONN_POOL_IDLE) {
+        tcb->idle_deadline_tsc = 0;
+        return;
+    }
+    conn_pool_key_t *k = pool_key(worker_idx, tcb->pool_key);
+    if (k->n_idle <= k->min_idle) {
+        /* Keep the floor; look again after another idle period */
+        tcb->idle_deadline_tsc = rte_rdtsc() + k->idle_tsc;
+        return;
+    }
+    idle_remove(k, (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs));
+    k->evicted++;
+    tcb->pool_state        = CONN_POOL_NONE;
+    tcb->idle_deadline_tsc = 0;
+    tcp_fsm_close(worker_idx, tcb);
+}
+
+void conn_pool_conn_gone(uint32_t worker_idx, const tcb_t *tcb)
+{
+    if (!g_conn_pools[worker_idx])
+        return;
+    conn_pool_key_t *k = pool_key(worker_idx, tcb->pool_key);
+    if (tcb->pool_state == CONN_POOL_WARMING && k->warming > 0)
+        k->warming--;
+    else if (tcb->pool_state == CONN_POOL_IDLE)
+        idle_remove(k, (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs));
+}
+
+void conn_pool_worker_reset(uint32_t worker_idx)
+{
+    conn_pool_t *pool = g_conn_pools[worker_idx];
+    if (!pool)
+        return;
+    for (uint32_t i = 0; i < pool->n_keys; i++) {
+        pool->keys[i].n_idle  = 0;
+        pool->keys[i].warming = 0;
+    }
+}
+
+uint32_t conn_pool_report(uint32_t n_workers, conn_pool_report_t *out,
+                          uint32_t max)
+{
+    uint32_t n = 0;
+
+    for (uint32_t w = 0; w < n_workers; w++) {
+        const conn_pool_t *pool = __atomic_load_n(&g_conn_pools[w],
+                                                  __ATOMIC_ACQUIRE);
+        if (!pool)
+            continue;
+        uint32_t n_keys = __atomic_load_n(&pool->n_keys, __ATOMIC_ACQUIRE);
+        for (uint32_t i = 0; i < n_keys; i++) {
+            const conn_pool_key_t *k = &pool->keys[i];
+            uint32_t j = 0;
+            while (j < n && (out[j].dst_ip != k->dst_ip ||
+                             out[j].dst_port != k->dst_port ||
+                             out[j].tls != k->tls ||
+                             out[j].cc_algo != k->cc_algo ||
+                             out[j].port_id != k->port_id ||
+                             out[j].vlan_id != k->vlan_id))
+                j++;
+            if (j == n) {
+                if (n == max)
+                    continue;
+                memset(&out[n], 0, sizeof(out[n]));
+                out[n].dst_ip   = k->dst_ip;
+                out[n].dst_port = k->dst_port;
+                out[n].tls      = k->tls;
+                out[n].cc_algo  = k->cc_algo;
+                out[n].port_id  = k->port_id;
+                out[n].vlan_id  = k->vlan_id;
+                n++;
+            }
+            conn_pool_report_t *r = &out[j];
+            r->min_idle   = k->min_idle;
+            r->max_idle   = k->max_idle;
+            r->idle_ms    = (uint32_t)(k->idle_tsc / (g_tsc_hz / 1000));
+            r->idle      += k->n_idle;
+            r->warming   += k->warming;
+            r->idle_peak += k->idle_peak;
+            r->borrowed  += k->borrowed;
+            r->opened    += k->opened;
+            r->returned  += k->returned;
+            r->evicted   += k->evicted;
+            r->overflow  += k->overflow;
+        }
+    }
+    return n;
+}
+
+void conn_pool_destroy(void)
+{
+    for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
+        conn_pool_t *pool = g_conn_pools[w];
+        if (!pool)
+            continue;
+        for (uint32_t i = 0; i < pool->n_keys; i++)
+            rte_free(pool->keys[i].idle);
+        rte_free(pool);
+        g_conn_pools[w] = NULL;
+    }
+}
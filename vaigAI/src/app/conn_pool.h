@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-worker pool of idle keep-alive HTTP connections.
+ *
+ * Without a pool a client connection lives for one flow's txn_per_conn
+ * transactions and is then reset, so every batch pays a handshake (and a
+ * TLS handshake for https).  With `start --pool` a finished connection is
+ * parked instead, and the next transaction of any pooled flow to the
+ * same (dst IP, dst port, TLS, egress port, VLAN, congestion control)
+ * borrows it, the way browsers and proxies keep backend connections.
+ * The connection keeps the headers it was opened with, so flows that
+ * differ in any of those never share it:
+ *
+ *   borrow     the generator takes the most recently parked connection
+ *              (LIFO: warm caches, and the cold tail is what times out);
+ *              only when none is idle does it open a new one
+ *   return     after its transactions a connection is parked idle
+ *              (app_state 9) unless the target already has max idle;
+ *              then it is closed as before
+ *   min idle   the generator opens connections ahead of demand until
+ *              idle + warming reaches min; they park on ESTABLISHED
+ *   timeout    an idle connection closes with FIN after the idle time on
+ *              the timer wheel (tcb->idle_deadline_tsc), unless that
+ *              would leave the target below min idle
+ *
+ * Each worker has up to CONN_POOL_MAX_KEYS targets.  Pools are
+ * allocated by the worker on the first START that configures them and
+ * written only by it; management reads the counters racily.  A START
+ * with no other flow running resets every connection, pools included.
+ */
+#ifndef TGEN_CONN_POOL_H
+#define TGEN_CONN_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+#include "../net/tcp_tcb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONN_POOL_APP_IDLE    9         /* tcb->app_state while parked    */
+#define CONN_POOL_MAX_KEYS    32u       /* targets per worker             */
+#define CONN_POOL_MAX_IDLE    4096u     /* idle connections per target    */
+#define CONN_POOL_DEF_IDLE_MS 60000u    /* idle timeout without :<ms>     */
+
+/* tcb->pool_state (tcb->pool_key = key index + 1) */
+#define CONN_POOL_NONE        0
+#define CONN_POOL_WARMING     1         /* opened to reach min idle       */
+#define CONN_POOL_BUSY        2         /* lent to a transaction          */
+#define CONN_POOL_IDLE        3         /* parked                         */
+
+/** One target on one worker; single writer. */
+typedef struct {
+    uint32_t  dst_ip;           /* network byte order                  */
+    uint16_t  dst_port;
+    bool      tls;
+    uint8_t   cc_algo;
+    uint16_t  port_id;          /* egress port                         */
+    uint16_t  vlan_id;          /* 0 = untagged                        */
+    uint32_t  min_idle;
+    uint32_t  max_idle;
+    uint64_t  idle_tsc;         /* idle timeout in TSC cycles          */
+    uint32_t  n_idle;
+    uint32_t  warming;
+    /* Telemetry since the target was first configured */
+    uint64_t  borrowed;         /* transactions on a parked connection */
+    uint64_t  opened;           /* connections opened for the pool     */
+    uint64_t  returned;         /* parked after their transactions     */
+    uint64_t  evicted;          /* closed by the idle timeout          */
+    uint64_t  overflow;         /* closed: max idle already parked     */
+    uint32_t  idle_peak;
+    uint32_t *idle;             /* CONN_POOL_MAX_IDLE TCB indices      */
+} conn_pool_key_t;
+
+typedef struct {
+    uint32_t        n_keys;
+    conn_pool_key_t keys[CONN_POOL_MAX_KEYS];
+} conn_pool_t;
+
+/** Aggregated view of one target over all workers (management thread). */
+typedef struct {
+    uint32_t dst_ip;
+    uint16_t dst_port;
+    bool     tls;
+    uint8_t  cc_algo;
+    uint16_t port_id;
+    uint16_t vlan_id;
+    uint32_t min_idle;          /* per worker                          */
+    uint32_t max_idle;
+    uint32_t idle_ms;
+    uint32_t idle;
+    uint32_t warming;
+    uint32_t idle_peak;         /* Σ per-worker peaks                  */
+    uint64_t borrowed;
+    uint64_t opened;
+    uint64_t returned;
+    uint64_t evicted;
+    uint64_t overflow;
+} conn_pool_report_t;
+
+/** [worker], NULL until the worker first configures a pool. */
+extern conn_pool_t *g_conn_pools[TGEN_MAX_WORKERS];
+
+/** What makes two flows' connections interchangeable. */
+typedef struct {
+    uint32_t dst_ip;            /* network byte order                  */
+    uint16_t dst_port;
+    bool     tls;
+    uint8_t  cc_algo;
+    uint16_t port_id;
+    uint16_t vlan_id;
+} conn_pool_target_t;
+
+/**
+ * Worker, on START: find or add the target and set its limits (the last
+ * START wins).  Returns the key for tcb->pool_key (≥ 1), -ENOSPC when
+ * the worker has CONN_POOL_MAX_KEYS targets, or -ENOMEM.
+ */
+int  conn_pool_configure(uint32_t worker_idx, const conn_pool_target_t *t,
+                         uint32_t min_idle, uint32_t max_idle,
+                         uint32_t idle_ms);
+
+/** Worker: lend the newest parked connection of `key` (NULL if none). */
+tcb_t *conn_pool_get(uint32_t worker_idx, uint8_t key);
+
+/** Worker: the generator opened `tcb` for `key`, to borrow (busy) or to
+ *  warm the pool. */
+void conn_pool_opened(uint32_t worker_idx, tcb_t *tcb, uint8_t key,
+                      bool warming);
+
+/** Worker: connections to open so that idle + warming reaches min. */
+uint32_t conn_pool_deficit(uint32_t worker_idx, uint8_t key);
+
+/** Worker: park `tcb` after its transactions (or its warm-up).  Returns
+ *  false if it is not poolable or the target is full: the caller closes
+ *  it. */
+bool conn_pool_put(uint32_t worker_idx, tcb_t *tcb);
+
+/** Worker (timer): `tcb`'s idle deadline passed. */
+void conn_pool_idle_expired(uint32_t worker_idx, tcb_t *tcb);
+
+/** Worker: a pool connection is being freed (from tcb_free()). */
+void conn_pool_conn_gone(uint32_t worker_idx, const tcb_t *tcb);
+
+/** Worker: every TCB was dropped (store reset). */
+void conn_pool_worker_reset(uint32_t worker_idx);
+
+/** Management: merge the workers' targets into `out` (at most `max`).
+ *  Returns the number of targets. */
+uint32_t conn_pool_report(uint32_t n_workers, conn_pool_report_t *out,
+                          uint32_t max);
+
+void conn_pool_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_CONN_POOL_H */
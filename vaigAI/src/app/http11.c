@@ -11,6 +11,10 @@
 #include <errno.h>
 #include <inttypes.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 /* ------------------------------------------------------------------ */
 /* Helpers                                                              */
 /* ------------------------------------------------------------------ */
@@ -280,6 +284,319 @@ http11_rx_data(http_conn_t *conn, uint32_t worker_idx, uint32_t conn_idx,
     return 0;
 }
 
+/* ------------------------------------------------------------------ */
+/* RX: streaming response parser                                        */
+/* ------------------------------------------------------------------ */
+/* s->hdr */
+#define SCAN_HDR_CL     1
+#define SCAN_HDR_TE     2
+/* s->flags */
+#define SCAN_HAS_CL     0x01
+#define SCAN_HAS_TE     0x02
+#define SCAN_CHUNKED    0x04    /* the last transfer coding is chunked */
+
+static const char k_cl_name[] = "content-length:";
+static const char k_te_name[] = "transfer-encoding:";
+
+/* First LF in [p, end), or end.  Header lines are a few dozen bytes, so
+ * the compare loop is inlined rather than a memchr() call per line. */
+static inline const uint8_t *
+scan_lf(const uint8_t *p, const uint8_t *end)
+{
+#if defined(__AVX2__)
+    const __m256i lf32 = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                         _mm256_loadu_si256((const __m256i *)p), lf32));
+        if (m)
+            return p + __builtin_ctz(m);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i lf16 = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        uint32_t m = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                         _mm_loadu_si128((const __m128i *)p), lf16));
+        if (m)
+            return p + __builtin_ctz(m);
+    }
+#endif
+    while (p < end && *p != '\n')
+        p++;
+    return p;
+}
+
+static inline int
+hex_val(uint8_t c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (uint8_t)(c | 0x20);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Blank line after the headers: how is the body delimited (RFC 9112
+ * §6.3)?  Returns true when the response has none left. */
+static bool
+scan_hdr_end(http_rsp_scan_t *s, bool head)
+{
+    if (s->status == 101)
+        return true;    /* Switching Protocols: final, and no HTTP after */
+    if (s->status / 100 == 1) {
+        /* Interim (100 Continue, 102, 103…): the real response follows */
+        http11_rsp_scan_init(s);
+        return false;
+    }
+    if (head || s->status == 204 || s->status == 304)
+        return true;
+    s->line_pos = 0;
+    if (s->flags & SCAN_HAS_TE) {
+        /* Transfer-Encoding overrides Content-Length */
+        s->body_left = 0;
+        s->phase = (s->flags & SCAN_CHUNKED) ? HTTP_SCAN_CHUNK
+                                             : HTTP_SCAN_EOF;
+        return false;
+    }
+    if (s->flags & SCAN_HAS_CL) {
+        s->phase = HTTP_SCAN_BODY;
+        return s->body_left == 0;
+    }
+    s->phase = HTTP_SCAN_EOF;
+    return false;
+}
+
+/* End of a chunk-size line: its data, or the trailer after the last. */
+static inline void
+scan_chunk_size_end(http_rsp_scan_t *s)
+{
+    s->phase    = s->body_left ? HTTP_SCAN_DATA : HTTP_SCAN_TRAILER;
+    s->line_pos = 0;
+}
+
+int
+http11_rsp_scan(http_rsp_scan_t *s, const uint8_t *data, uint32_t len,
+                bool head, uint32_t *used)
+{
+    const uint8_t *p = data, *end = data + len;
+    const uint8_t *lf;
+    uint32_t pos;
+    uint8_t  c;
+
+    while (p < end) {
+        switch (s->phase) {
+        case HTTP_SCAN_STATUS:
+            /* "HTTP/1.x NNN", then the reason phrase is skipped */
+            c   = *p++;
+            pos = s->hdr_bytes++;
+            if (pos < 7) {
+                if (c != (uint8_t)"HTTP/1."[pos])
+                    return -1;
+            } else if (pos == 8) {
+                if (c != ' ')
+                    return -1;
+            } else {
+                if (c < '0' || c > '9')
+                    return -1;
+                if (pos > 8)
+                    s->status = (uint16_t)(s->status * 10 + (c - '0'));
+                if (pos == 11)
+                    s->phase = HTTP_SCAN_SKIP;
+            }
+            break;
+
+        case HTTP_SCAN_NAME:
+            /* Only the two framing headers are matched; any other line
+             * drops to the LF scan at its first differing byte. */
+            c = *p++;
+            if (++s->hdr_bytes > HTTP_SCAN_MAX_HDR)
+                return -1;
+            if (s->line_pos == 0) {
+                if (c == '\r')
+                    break;
+                if (c == '\n') {
+                    if (scan_hdr_end(s, head))
+                        goto done;
+                    break;
+                }
+                c      = (uint8_t)tolower(c);
+                s->hdr = c == 'c' ? SCAN_HDR_CL :
+                         c == 't' ? SCAN_HDR_TE : 0;
+            } else {
+                const char *name = s->hdr == SCAN_HDR_CL ? k_cl_name
+                                                         : k_te_name;
+                if (tolower(c) != name[s->line_pos])
+                    s->hdr = 0;
+            }
+            if (s->hdr == 0) {
+                s->phase    = c == '\n' ? HTTP_SCAN_NAME : HTTP_SCAN_SKIP;
+                s->line_pos = 0;
+            } else if ((s->hdr == SCAN_HDR_CL ? k_cl_name
+                                              : k_te_name)[++s->line_pos]
+                       == '\0') {
+                s->phase     = s->hdr == SCAN_HDR_CL ? HTTP_SCAN_CL
+                                                     : HTTP_SCAN_TE;
+                s->line_pos  = 0;
+                if (s->hdr == SCAN_HDR_CL)
+                    s->body_left = 0;
+            }
+            break;
+
+        case HTTP_SCAN_SKIP:
+            lf  = scan_lf(p, end);
+            pos = s->hdr_bytes + (uint32_t)(lf - p) + (lf < end);
+            if (pos > HTTP_SCAN_MAX_HDR)
+                return -1;
+            s->hdr_bytes = (uint16_t)pos;
+            if (lf == end) {
+                p = end;
+                break;
+            }
+            p           = lf + 1;
+            s->phase    = HTTP_SCAN_NAME;
+            s->line_pos = 0;
+            break;
+
+        case HTTP_SCAN_CL:
+            /* line_pos: 0 before the digits, 1 in them, 2 after */
+            c = *p++;
+            if (++s->hdr_bytes > HTTP_SCAN_MAX_HDR)
+                return -1;
+            if (c >= '0' && c <= '9') {
+                if (s->line_pos == 2 ||
+                    s->body_left > (UINT64_MAX - 9) / 10)
+                    return -1;
+                s->body_left = s->body_left * 10 + (uint64_t)(c - '0');
+                s->line_pos  = 1;
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                if (s->line_pos == 1)
+                    s->line_pos = 2;
+            } else if (c == '\n' && s->line_pos != 0) {
+                s->flags   |= SCAN_HAS_CL;
+                s->phase    = HTTP_SCAN_NAME;
+                s->line_pos = 0;
+            } else {
+                return -1;
+            }
+            break;
+
+        case HTTP_SCAN_TE:
+            /* line_pos: bytes of "chunked" matched in the current
+             * coding, 0xFF for any other coding */
+            c = *p++;
+            if (++s->hdr_bytes > HTTP_SCAN_MAX_HDR)
+                return -1;
+            if (c == ',' || c == '\n') {
+                if (s->line_pos == 7)
+                    s->flags |= SCAN_CHUNKED;
+                else if (s->line_pos != 0)
+                    s->flags &= (uint8_t)~SCAN_CHUNKED;
+                s->line_pos = 0;
+                if (c == '\n') {
+                    s->flags |= SCAN_HAS_TE;
+                    s->phase  = HTTP_SCAN_NAME;
+                }
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                /* OWS */
+            } else if (s->line_pos < 7 &&
+                       tolower(c) == "chunked"[s->line_pos]) {
+                s->line_pos++;
+            } else {
+                s->line_pos = 0xFF;
+            }
+            break;
+
+        case HTTP_SCAN_BODY:
+        case HTTP_SCAN_DATA: {
+            uint64_t take = (uint64_t)(end - p);
+            if (take > s->body_left)
+                take = s->body_left;
+            p            += take;
+            s->body_left -= take;
+            if (s->body_left > 0)
+                break;
+            if (s->phase == HTTP_SCAN_BODY)
+                goto done;
+            s->phase    = HTTP_SCAN_DATA_END;
+            s->line_pos = 0;
+            break;
+        }
+
+        case HTTP_SCAN_CHUNK: {
+            /* line_pos: 1 once a digit was seen */
+            c = *p++;
+            int v = hex_val(c);
+            if (v >= 0) {
+                if (s->body_left >> 60)
+                    return -1;
+                s->body_left = s->body_left << 4 | (uint64_t)v;
+                s->line_pos  = 1;
+            } else if (s->line_pos == 0) {
+                return -1;
+            } else if (c == '\n') {
+                scan_chunk_size_end(s);
+            } else if (c == '\r' || c == ';' || c == ' ' || c == '\t') {
+                s->phase = HTTP_SCAN_CHUNK_EXT;
+            } else {
+                return -1;
+            }
+            break;
+        }
+
+        case HTTP_SCAN_CHUNK_EXT:
+            lf = scan_lf(p, end);
+            if (lf == end) {
+                p = end;
+                break;
+            }
+            p = lf + 1;
+            scan_chunk_size_end(s);
+            break;
+
+        case HTTP_SCAN_DATA_END:
+            c = *p++;
+            if (c == '\r' && s->line_pos == 0) {
+                s->line_pos = 1;
+            } else if (c == '\n') {
+                s->phase     = HTTP_SCAN_CHUNK;
+                s->body_left = 0;
+                s->line_pos  = 0;
+            } else {
+                return -1;
+            }
+            break;
+
+        case HTTP_SCAN_TRAILER:
+            /* line_pos: 1 inside a trailer field; a blank line ends */
+            if (s->line_pos == 0) {
+                c = *p++;
+                if (c == '\n')
+                    goto done;
+                if (c != '\r')
+                    s->line_pos = 1;
+                break;
+            }
+            lf = scan_lf(p, end);
+            if (lf == end) {
+                p = end;
+                break;
+            }
+            p           = lf + 1;
+            s->line_pos = 0;
+            break;
+
+        default:    /* HTTP_SCAN_EOF: everything up to the FIN */
+            p = end;
+            break;
+        }
+    }
+    *used = len;
+    return 0;
+
+done:
+    *used = (uint32_t)(p - data);
+    return 1;
+}
+
 /* ------------------------------------------------------------------ */
 /* TX: server response builder                                          */
 /* ------------------------------------------------------------------ */
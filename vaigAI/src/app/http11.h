@@ -88,6 +88,91 @@ typedef struct {
     } state;
 } http_conn_t;
 
+/* ------------------------------------------------------------------ */
+/* Streaming response parser (client)                                   */
+/* ------------------------------------------------------------------ */
+/* Finds where each response ends in the TCP byte stream, one segment at
+ * a time and without copying or allocating: the status code and the
+ * framing headers (Content-Length, Transfer-Encoding) are picked up as
+ * the header bytes go by, lines of no interest are skipped with a vector
+ * scan for LF, and the body is skipped by count — Content-Length, or
+ * chunk by chunk (sizes, extensions, trailers) for chunked responses, to
+ * the byte.  A response with neither ends when the server closes.
+ * Sixteen bytes of state, kept in the TCB. */
+#define HTTP_SCAN_MAX_HDR  16384u   /* header section limit (bytes)  */
+
+enum {
+    HTTP_SCAN_STATUS = 0,       /* status line                          */
+    HTTP_SCAN_NAME,             /* header name                          */
+    HTTP_SCAN_SKIP,             /* rest of a header line                */
+    HTTP_SCAN_CL,               /* Content-Length value                 */
+    HTTP_SCAN_TE,               /* Transfer-Encoding value              */
+    /* Body: from here on the header section is complete */
+    HTTP_SCAN_BODY,             /* Content-Length body                  */
+    HTTP_SCAN_CHUNK,            /* chunk-size digits                    */
+    HTTP_SCAN_CHUNK_EXT,        /* rest of the chunk-size line          */
+    HTTP_SCAN_DATA,             /* chunk data                           */
+    HTTP_SCAN_DATA_END,         /* CRLF after the chunk data            */
+    HTTP_SCAN_TRAILER,          /* trailer section                      */
+    HTTP_SCAN_EOF,              /* body delimited by the close          */
+};
+
+typedef struct {
+    uint64_t body_left;         /**< body or chunk bytes still to skip;
+                                     the number being parsed before      */
+    uint16_t status;            /**< valid once the status line is in   */
+    uint16_t hdr_bytes;         /**< header section bytes so far        */
+    uint8_t  phase;             /**< HTTP_SCAN_*                        */
+    uint8_t  line_pos;          /**< position in the name, value or
+                                     line being matched                  */
+    uint8_t  hdr;               /**< header name being matched          */
+    uint8_t  flags;             /**< framing headers seen               */
+} http_rsp_scan_t;
+
+static inline void
+http11_rsp_scan_init(http_rsp_scan_t *s)
+{
+    *s = (http_rsp_scan_t){ 0 };
+}
+
+/** The header section is complete: the parser is in the body. */
+static inline bool
+http11_rsp_scan_in_body(const http_rsp_scan_t *s)
+{
+    return s->phase >= HTTP_SCAN_BODY;
+}
+
+/** The response has no length: it is complete when the server closes. */
+static inline bool
+http11_rsp_scan_eof(const http_rsp_scan_t *s)
+{
+    return s->phase == HTTP_SCAN_EOF;
+}
+
+/** The response just returned was 101 Switching Protocols: nothing after
+ *  it on the connection is HTTP. */
+static inline bool
+http11_rsp_scan_switched(const http_rsp_scan_t *s)
+{
+    return s->status == 101;
+}
+
+/**
+ * Advance the parser over `len` bytes.  Returns 1 when a response ended
+ * (*used = its bytes in `data`; s->status holds its code, call
+ * http11_rsp_scan_init() before the next), 0 when all of `data` was
+ * consumed mid-response, -1 when the stream is not an HTTP/1.x response
+ * or is malformed (bad status line, Content-Length or chunk size, header
+ * section over HTTP_SCAN_MAX_HDR).
+ * `head`: the request was HEAD, so no body follows.
+ * Interim 1xx responses are skipped, except 101 Switching Protocols: it
+ * ends at its header section and is returned like a final response, and
+ * the bytes after it belong to another protocol (see
+ * http11_rsp_scan_switched()).
+ */
+int http11_rsp_scan(http_rsp_scan_t *s, const uint8_t *data, uint32_t len,
+                    bool head, uint32_t *used);
+
 /* ------------------------------------------------------------------ */
 /* Completion callback                                                  */
 /* ------------------------------------------------------------------ */
@@ -0,0 +1,267 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: open-loop HTTP request scheduling.
+ */
+#include "http_ol.h"
+#include "../core/core_assign.h"
+#include "../core/rate_sched.h"
+#include "../common/util.h"
+#include "../net/tcp_fsm.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_log.h>
+
+http_ol_t **g_http_ol[TGEN_MAX_WORKERS];
+
+int http_ol_start(uint32_t worker_idx, uint32_t flow_idx,
+                  uint32_t max_conns, bool poisson, uint64_t now)
+{
+    uint32_t lcore  = g_core_map.worker_lcores[worker_idx];
+    int      socket = (int)g_core_map.socket_of_lcore[lcore];
+    http_ol_t **tab = g_http_ol[worker_idx];
+    if (!tab) {
+        tab = rte_zmalloc_socket("http_ol_tab",
+                                 TGEN_MAX_CLIENT_FLOWS * sizeof(*tab),
+                                 RTE_CACHE_LINE_SIZE, socket);
+        if (!tab) {
+            RTE_LOG(ERR, HTTP, "open loop: no memory for worker %u\n",
+                    worker_idx);
+            return -ENOMEM;
+        }
+        __atomic_store_n(&g_http_ol[worker_idx], tab, __ATOMIC_RELEASE);
+    }
+    http_ol_t *ol = tab[flow_idx];
+    if (!ol) {
+        ol = rte_zmalloc_socket("http_ol", sizeof(*ol), RTE_CACHE_LINE_SIZE,
+                                socket);
+        if (!ol) {
+            RTE_LOG(ERR, HTTP, "open loop: no memory for worker %u flow %u\n",
+                    worker_idx, flow_idx);
+            return -ENOMEM;
+        }
+        __atomic_store_n(&tab[flow_idx], ol, __ATOMIC_RELEASE);
+    }
+
+    /* Connections of a previous run may still be waiting for a response
+     * from the old target; tcb_free() takes them off the pool. */
+    if (ol->conns > 0) {
+        tcb_store_t *store = &g_tcb_stores[worker_idx];
+        for (uint32_t i = 0; i < store->capacity && ol->conns > 0; i++) {
+            tcb_t *tcb = &store->tcbs[i];
+            if (tcb->in_use && tcb->http_ol != HTTP_OL_NONE &&
+                tcb->flow_idx == flow_idx)
+                tcp_fsm_reset(worker_idx, tcb);
+        }
+    }
+
+    memset(ol, 0, offsetof(http_ol_t, idle));
+    ol->poisson   = poisson;
+    ol->max_conns = TGEN_MIN(TGEN_MAX(max_conns, 1u), HTTP_OL_MAX_CONNS);
+    ol->next_tsc  = now;
+    ol->running   = true;
+    return 0;
+}
+
+void http_ol_stop(uint32_t worker_idx, uint32_t flow_idx)
+{
+    http_ol_t *ol = http_ol_of(worker_idx, flow_idx);
+    if (!ol || !ol->running)
+        return;
+    ol->running = false;
+
+    tcb_store_t *store = &g_tcb_stores[worker_idx];
+    while (ol->n_idle > 0) {
+        tcb_t *tcb = &store->tcbs[ol->idle[--ol->n_idle]];
+        /* app_state stays 9 so the TLS session is detached at free */
+        tcb->http_ol = HTTP_OL_READY;
+        tcp_fsm_close(worker_idx, tcb);
+    }
+}
+
+/* Hand the head of the schedule to `tcb` and advance it. */
+static void
+ol_take(http_ol_t *ol, tcb_t *tcb, uint64_t now)
+{
+    uint64_t lag = now - ol->next_tsc;
+
+    tcb->http_intended_tsc = ol->next_tsc;
+    ol->sent++;
+    ol->lag_sum += lag;
+    if (lag > ol->lag_max)
+        ol->lag_max = lag;
+
+    if (ol->poisson) {
+        ol->next_tsc += (uint64_t)(rate_sched_exp_draw() *
+                                   (double)g_tsc_hz / (double)ol->rate);
+    } else {
+        ol->next_tsc += g_tsc_hz / ol->rate;
+        ol->frac     += g_tsc_hz % ol->rate;
+        if (ol->frac >= ol->rate) {
+            ol->frac -= ol->rate;
+            ol->next_tsc++;
+        }
+    }
+}
+
+uint32_t http_ol_dispatch(uint32_t worker_idx, uint32_t flow_idx,
+                          uint64_t rate, uint64_t now)
+{
+    http_ol_t *ol = http_ol_of(worker_idx, flow_idx);
+    if (!ol || !ol->running)
+        return 0;
+    ol->rate    = rate;
+    ol->stalled = false;
+    if (rate == 0) {
+        /* Nothing is intended while the ramp is at zero. */
+        ol->next_tsc = now;
+        return 0;
+    }
+
+    tcb_store_t *store = &g_tcb_stores[worker_idx];
+    while (ol->next_tsc <= now && ol->n_idle > 0) {
+        tcb_t *tcb = &store->tcbs[ol->idle[--ol->n_idle]];
+        tcb->http_ol = HTTP_OL_READY;
+        if (tcb->state != TCP_ESTABLISHED) {
+            /* The server closed it while idle. */
+            tcp_fsm_close(worker_idx, tcb);
+            continue;
+        }
+        ol_take(ol, tcb, now);
+        tcb->app_state = 4;
+        tcp_fsm_http_send_next(worker_idx, tcb);
+    }
+    if (ol->next_tsc > now)
+        return 0;
+
+    /* Every intended time in [next_tsc, now] is waiting for a connection;
+     * those already opening will take one each. */
+    double due = (double)(now - ol->next_tsc) * (double)rate /
+                 (double)g_tsc_hz + 1.0;
+    uint64_t pending = due < (double)UINT32_MAX ? (uint64_t)due : UINT32_MAX;
+    if (pending <= ol->opening || ol->conns >= ol->max_conns) {
+        /* Only a response or a closed connection changes this */
+        ol->stalled = true;
+        return 0;
+    }
+    return (uint32_t)TGEN_MIN(pending - ol->opening,
+                              (uint64_t)(ol->max_conns - ol->conns));
+}
+
+void http_ol_opened(uint32_t worker_idx, tcb_t *tcb)
+{
+    http_ol_t *ol = http_ol_of(worker_idx, tcb->flow_idx);
+    tcb->http_ol = HTTP_OL_OPENING;
+    ol->conns++;
+    ol->opening++;
+    ol->conns_opened++;
+    if (ol->conns > ol->conns_peak)
+        ol->conns_peak = ol->conns;
+}
+
+uint8_t http_ol_next(uint32_t worker_idx, tcb_t *tcb)
+{
+    http_ol_t *ol = http_ol_of(worker_idx, tcb->flow_idx);
+    if (tcb->http_ol == HTTP_OL_OPENING) {
+        tcb->http_ol = HTTP_OL_READY;
+        ol->opening--;
+    }
+    tcb->http_intended_tsc = 0;
+    if (!ol->running)
+        return 0;
+
+    uint64_t now = rte_rdtsc();
+    if (ol->rate > 0 && ol->next_tsc <= now) {
+        ol_take(ol, tcb, now);
+        return 4;
+    }
+    if (ol->n_idle >= HTTP_OL_MAX_CONNS)
+        return 0;
+    ol->idle[ol->n_idle++] = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
+    tcb->http_ol           = HTTP_OL_IDLE;
+    tcb->http_req_sent_tsc = 0;     /* no response timeout while idle */
+    return HTTP_OL_APP_IDLE;
+}
+
+void http_ol_conn_gone(uint32_t worker_idx, const tcb_t *tcb)
+{
+    http_ol_t *ol = http_ol_of(worker_idx, tcb->flow_idx);
+    if (!ol || ol->conns == 0)
+        return;
+    ol->conns--;
+    if (tcb->http_ol == HTTP_OL_OPENING && ol->opening > 0)
+        ol->opening--;
+    if (tcb->http_ol != HTTP_OL_IDLE)
+        return;
+
+    uint32_t ci = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
+    for (uint32_t i = 0; i < ol->n_idle; i++) {
+        if (ol->idle[i] != ci)
+            continue;
+        memmove(&ol->idle[i], &ol->idle[i + 1],
+                (ol->n_idle - i - 1) * sizeof(ol->idle[0]));
+        ol->n_idle--;
+        return;
+    }
+}
+
+void http_ol_worker_reset(uint32_t worker_idx)
+{
+    http_ol_t **tab = g_http_ol[worker_idx];
+    for (uint32_t f = 0; tab && f < TGEN_MAX_CLIENT_FLOWS; f++) {
+        http_ol_t *ol = tab[f];
+        if (!ol)
+            continue;
+        ol->conns   = 0;
+        ol->opening = 0;
+        ol->n_idle  = 0;
+    }
+}
+
+void http_ol_report(uint32_t flow_idx, uint32_t n_workers,
+                    http_ol_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    uint64_t lag_sum = 0, lag_max = 0;
+    uint64_t now = rte_rdtsc();
+
+    for (uint32_t w = 0; w < n_workers; w++) {
+        http_ol_t **tab = __atomic_load_n(&g_http_ol[w], __ATOMIC_ACQUIRE);
+        const http_ol_t *ol = tab
+            ? __atomic_load_n(&tab[flow_idx], __ATOMIC_ACQUIRE) : NULL;
+        if (!ol)
+            continue;
+        out->generators++;
+        out->max_conns    += ol->max_conns;
+        out->conns        += ol->conns;
+        out->conns_peak   += ol->conns_peak;
+        out->conns_opened += ol->conns_opened;
+        out->sent         += ol->sent;
+        lag_sum           += ol->lag_sum;
+        lag_max            = TGEN_MAX(lag_max, ol->lag_max);
+        uint64_t next = ol->next_tsc, rate = ol->rate;
+        if (ol->running && rate > 0 && next < now)
+            out->backlog += (uint64_t)((double)(now - next) * (double)rate /
+                                       (double)g_tsc_hz);
+    }
+    if (out->sent > 0)
+        out->lag_mean_us = (double)lag_sum / (double)out->sent *
+                           1e6 / (double)g_tsc_hz;
+    out->lag_max_us = (double)lag_max * 1e6 / (double)g_tsc_hz;
+}
+
+void http_ol_destroy(void)
+{
+    for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
+        http_ol_t **tab = g_http_ol[w];
+        if (!tab)
+            continue;
+        for (uint32_t f = 0; f < TGEN_MAX_CLIENT_FLOWS; f++)
+            rte_free(tab[f]);
+        rte_free(tab);
+        g_http_ol[w] = NULL;
+    }
+}
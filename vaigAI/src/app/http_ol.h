@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: open-loop HTTP request scheduling (start --open-loop).
+ *
+ * The closed-loop client sends a connection's next request when the
+ * previous response arrives, so a slow server slows the load down and
+ * the requests it would have delayed are never measured (coordinated
+ * omission); hist_record_corrected() can only guess them afterwards.
+ * In open-loop mode each (worker, flow) keeps a schedule of intended send
+ * times at its share of --rate requests/s, uniform or with Poisson gaps,
+ * independent of the responses:
+ *
+ *   dispatch   a request that is due goes out on an idle keep-alive
+ *              connection of the flow (LIFO), and the connection records
+ *              the request's intended time
+ *   grow       while requests are due and none is idle, the generator
+ *              opens connections, up to the flow's --conns share; a new
+ *              connection takes the oldest due request once ready
+ *   latency    measured at the response from the intended time, so time
+ *              spent waiting for a connection is in the histogram and
+ *              no correction is applied
+ *
+ * A request is never dropped: when the pool is saturated the schedule
+ * falls behind and the backlog is the span between its head and now.
+ *
+ * Pools are allocated by the worker on the flow's first open-loop START
+ * and written only by it; management reads the counters racily.
+ */
+#ifndef TGEN_HTTP_OL_H
+#define TGEN_HTTP_OL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+#include "../common/util.h"
+#include "../net/tcp_tcb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_OL_APP_IDLE   9        /* tcb->app_state: no request to send */
+#define HTTP_OL_MAX_CONNS  4096u    /* connections per (worker, flow)     */
+#define HTTP_OL_DEF_CONNS  256u     /* per worker without --conns         */
+#define HTTP_OL_STALL_US   100u     /* re-check of a saturated pool       */
+
+/* tcb->http_ol */
+#define HTTP_OL_NONE       0        /* closed loop or not HTTP            */
+#define HTTP_OL_OPENING    1        /* handshake (TCP, TLS) in progress   */
+#define HTTP_OL_READY      2        /* carries a request                  */
+#define HTTP_OL_IDLE       3        /* on the flow's idle list            */
+
+typedef struct {
+    bool     running;
+    bool     poisson;           /* exponential gaps at the mean rate    */
+    uint32_t max_conns;
+    uint32_t conns;             /* open or opening                      */
+    uint32_t opening;
+    uint32_t n_idle;
+    uint64_t rate;              /* requests/s on this worker, now       */
+    uint64_t next_tsc;          /* intended time of the next request    */
+    uint64_t frac;              /* remainder of hz / rate, 1/rate cycles */
+    bool     stalled;           /* behind, nothing to open or send      */
+    /* Telemetry since START */
+    uint64_t sent;
+    uint64_t lag_sum;           /* Σ send − intended, TSC cycles        */
+    uint64_t lag_max;
+    uint64_t conns_opened;
+    uint32_t conns_peak;
+    uint32_t idle[HTTP_OL_MAX_CONNS];   /* TCB indices, top = newest    */
+} __rte_cache_aligned http_ol_t;
+
+/** Aggregated view of one flow (management thread). */
+typedef struct {
+    uint32_t generators;
+    uint32_t max_conns;         /* Σ over workers                       */
+    uint32_t conns;
+    uint32_t conns_peak;        /* Σ per-worker peaks                   */
+    uint64_t conns_opened;
+    uint64_t sent;
+    uint64_t backlog;           /* requests due but not sent, now       */
+    double   lag_mean_us;       /* intended → sent                      */
+    double   lag_max_us;
+} http_ol_report_t;
+
+/** [worker][flow], NULL until the flow first runs open-loop there.  A
+ *  worker's table of TGEN_MAX_CLIENT_FLOWS pointers is itself allocated
+ *  by its first open-loop START. */
+extern http_ol_t **g_http_ol[TGEN_MAX_WORKERS];
+
+/** Pool of `flow_idx` on worker `worker_idx`, or NULL. */
+static inline http_ol_t *
+http_ol_of(uint32_t worker_idx, uint32_t flow_idx)
+{
+    http_ol_t **tab = g_http_ol[worker_idx];
+    return tab ? tab[flow_idx] : NULL;
+}
+
+/** Worker, on START: allocate or reset the flow's pool.  Connections
+ *  left from an earlier run in the slot are reset.  Returns 0 or
+ *  -ENOMEM. */
+int  http_ol_start(uint32_t worker_idx, uint32_t flow_idx,
+                   uint32_t max_conns, bool poisson, uint64_t now);
+
+/** Worker: stop scheduling and close the idle connections; busy ones
+ *  close at their response. */
+void http_ol_stop(uint32_t worker_idx, uint32_t flow_idx);
+
+/** Worker: send due requests on idle connections at `rate` requests/s;
+ *  returns how many connections should be opened for the rest. */
+uint32_t http_ol_dispatch(uint32_t worker_idx, uint32_t flow_idx,
+                          uint64_t rate, uint64_t now);
+
+/** Worker: the generator opened `tcb` for the pool. */
+void http_ol_opened(uint32_t worker_idx, tcb_t *tcb);
+
+/**
+ * Worker: `tcb` is ready for a request — just established, or its
+ * response is in.  Returns the app_state to continue with: 4 with
+ * tcb->http_intended_tsc set (send it now), HTTP_OL_APP_IDLE (it has
+ * joined the idle list) or 0 (the flow stopped: close).
+ */
+uint8_t http_ol_next(uint32_t worker_idx, tcb_t *tcb);
+
+/** Worker: a pool connection is being freed (from tcb_free()). */
+void http_ol_conn_gone(uint32_t worker_idx, const tcb_t *tcb);
+
+/** Worker: every TCB was dropped (store reset). */
+void http_ol_worker_reset(uint32_t worker_idx);
+
+/** Earliest TSC the generator has work: the next intended time, or
+ *  HTTP_OL_STALL_US from now while the pool is saturated.  Responses
+ *  take the backlog themselves then, so the generator has nothing to do
+ *  until a connection closes and can be replaced. */
+static inline uint64_t
+http_ol_next_tsc(uint32_t worker_idx, uint32_t flow_idx, uint64_t now)
+{
+    const http_ol_t *ol = http_ol_of(worker_idx, flow_idx);
+    if (!ol || ol->next_tsc > now)
+        return ol ? ol->next_tsc : now;
+    return ol->stalled ? now + HTTP_OL_STALL_US * g_tsc_hz / 1000000u
+                       : now;
+}
+
+/** Management: aggregate a flow over `n_workers`. */
+void http_ol_report(uint32_t flow_idx, uint32_t n_workers,
+                    http_ol_report_t *out);
+
+void http_ol_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_HTTP_OL_H */
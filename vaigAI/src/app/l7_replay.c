@@ -0,0 +1,746 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: stateful L7 replay — capture compiler and connection driver.
+ *
+ * The compiler tracks TCP conversations by 4-tuple while reading the
+ * capture, keeping only pointers into the mapping; the payload is copied
+ * once into the program after the conversations to keep are chosen.
+ */
+#include "l7_replay.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_hash_crc.h>
+#include <rte_malloc.h>
+
+#include "../core/pcap_replay.h"
+#include "../core/core_assign.h"
+#include "../net/tcp_fsm.h"
+#include "../net/tcp_snd_buf.h"
+#include "../net/tcp_timer.h"
+#include "../telemetry/metrics.h"
+#include "../telemetry/log.h"
+
+l7_prog_t *g_l7_progs[TGEN_MAX_CLIENT_FLOWS];
+l7_prog_t *g_l7_srv_prog;
+
+/* Programs replaced while TCBs may still point at them */
+#define L7_RETIRED_MAX  (2 * TGEN_MAX_CLIENT_FLOWS + 2)
+static l7_prog_t *g_retired[L7_RETIRED_MAX];
+
+#define L7_CRC_INIT     0xFFFFFFFFu
+#define TCP_F_FIN       0x01
+#define TCP_F_SYN       0x02
+#define TCP_F_RST       0x04
+#define TCP_F_ACK       0x10
+
+/* ── Capture parsing ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint8_t  ip[16];            /* IPv4 in the first 4 bytes             */
+    uint16_t port;
+} ep_t;
+
+typedef struct {
+    ep_t           src, dst;
+    const uint8_t *payload;
+    uint32_t       len;         /* per the IP header                     */
+    uint32_t       avail;       /* of which captured                     */
+    uint32_t       seq;
+    uint8_t        flags;
+} tcp_seg_t;
+
+static inline uint16_t
+be16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static inline uint32_t
+be32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+           (uint32_t)p[2] << 8 | p[3];
+}
+
+/* Unfragmented TCP over IPv4 or IPv6 (no extension headers). */
+static bool
+parse_tcp(const pcap_rec_t *rec, tcp_seg_t *s)
+{
+    const uint8_t *f = rec->data;
+    uint32_t caplen = rec->caplen;
+    if (!rec->eth || caplen < RTE_ETHER_HDR_LEN)
+        return false;
+    uint32_t off = pcap_l2_type_off(f, caplen);
+    if (off + 2 > caplen)
+        return false;
+    uint16_t type = be16(f + off);
+    const uint8_t *ip = f + off + 2;
+    uint32_t room = caplen - off - 2;
+    uint32_t ip_len, hl;
+
+    memset(s, 0, sizeof(*s));
+    if (type == RTE_ETHER_TYPE_IPV4) {
+        if (room < 20 || (ip[0] >> 4) != 4 || ip[9] != IPPROTO_TCP)
+            return false;
+        if (be16(ip + 6) & 0x3FFF)          /* MF or fragment offset */
+            return false;
+        hl     = (ip[0] & 0x0F) * 4u;
+        ip_len = be16(ip + 2);
+        memcpy(s->src.ip, ip + 12, 4);
+        memcpy(s->dst.ip, ip + 16, 4);
+    } else if (type == RTE_ETHER_TYPE_IPV6) {
+        if (room < 40 || ip[6] != IPPROTO_TCP)
+            return false;
+        hl     = 40;
+        ip_len = 40u + be16(ip + 4);
+        memcpy(s->src.ip, ip + 8, 16);
+        memcpy(s->dst.ip, ip + 24, 16);
+    } else {
+        return false;
+    }
+    if (hl < 20 || ip_len < hl + 20 || room < hl + 20)
+        return false;
+    const uint8_t *tcp = ip + hl;
+    uint32_t doff = (tcp[12] >> 4) * 4u;
+    if (doff < 20 || ip_len < hl + doff)
+        return false;
+    s->src.port = be16(tcp);
+    s->dst.port = be16(tcp + 2);
+    s->seq      = be32(tcp + 4);
+    s->flags    = tcp[13];
+    s->payload  = tcp + doff;
+    s->len      = ip_len - hl - doff;
+    uint32_t cap_end = TGEN_MIN(room, ip_len);    /* no Ethernet padding */
+    s->avail    = cap_end > hl + doff ? cap_end - hl - doff : 0;
+    if (s->avail > s->len)
+        s->avail = s->len;
+    return true;
+}
+
+/* ── Conversation tracking ────────────────────────────────────────────────── */
+
+typedef struct {
+    const uint8_t *p;           /* into the mapping                      */
+    uint32_t       len;
+    uint8_t        dir;         /* 0 client → server                     */
+} seg_ref_t;
+
+typedef struct {
+    ep_t       cli, srv;        /* cli sent the SYN                      */
+    uint32_t   next[2];         /* next expected sequence, by direction  */
+    bool       syn[2];          /* SYN / SYN-ACK seen: next[] valid      */
+    bool       fin[2];
+    bool       bad;             /* mid-stream start, gap or truncation   */
+    bool       closed;          /* both FINs, or a RST                   */
+    int8_t     closer;          /* direction of the first FIN/RST, or -1 */
+    seg_ref_t *segs;
+    uint32_t   n_segs;
+    uint32_t   cap_segs;
+    uint64_t   bytes;
+} conv_b_t;
+
+typedef struct {
+    conv_b_t *cb;
+    uint32_t  n;
+    uint32_t  cap;
+    uint32_t *ht;               /* conversation index + 1, 0 = empty     */
+    uint32_t  ht_mask;
+} tracker_t;
+
+static inline bool
+ep_eq(const ep_t *a, const ep_t *b)
+{
+    return a->port == b->port && memcmp(a->ip, b->ip, 16) == 0;
+}
+
+static inline uint32_t
+ep_hash(const ep_t *e)
+{
+    return rte_hash_crc(e->ip, 16, e->port);
+}
+
+/* Slot of the tuple's entry, or of the empty slot ending its probe. */
+static uint32_t
+ht_slot(const tracker_t *t, const ep_t *a, const ep_t *b)
+{
+    uint32_t i = (ep_hash(a) + ep_hash(b)) & t->ht_mask;     /* symmetric */
+    for (;;) {
+        uint32_t v = t->ht[i];
+        if (v == 0)
+            return i;
+        const conv_b_t *c = &t->cb[v - 1];
+        if ((ep_eq(&c->cli, a) && ep_eq(&c->srv, b)) ||
+            (ep_eq(&c->cli, b) && ep_eq(&c->srv, a)))
+            return i;
+        i = (i + 1) & t->ht_mask;
+    }
+}
+
+static conv_b_t *
+conv_new(tracker_t *t, uint32_t slot, const ep_t *cli, const ep_t *srv)
+{
+    if (t->n == L7_REPLAY_TRACK_MAX)
+        return NULL;
+    if (t->n == t->cap) {
+        uint32_t cap = t->cap ? t->cap * 2 : 1024;
+        conv_b_t *cb = realloc(t->cb, cap * sizeof(*cb));
+        if (!cb)
+            return NULL;
+        t->cb  = cb;
+        t->cap = cap;
+    }
+    conv_b_t *c = &t->cb[t->n++];
+    memset(c, 0, sizeof(*c));
+    c->cli    = *cli;
+    c->srv    = *srv;
+    c->closer = -1;
+    t->ht[slot] = t->n;         /* a reused tuple now means this one */
+    return c;
+}
+
+static void
+conv_payload(conv_b_t *c, uint8_t dir, const tcp_seg_t *s)
+{
+    if (c->bad)
+        return;
+    if (!c->syn[dir]) {
+        c->bad = true;
+        return;
+    }
+    int32_t d = (int32_t)(s->seq - c->next[dir]);
+    if (d > 0) {                /* the capture missed a segment */
+        c->bad = true;
+        return;
+    }
+    uint32_t skip = (uint32_t)-d;
+    if (skip >= s->len)
+        return;                 /* retransmission */
+    if (s->avail < s->len) {    /* snaplen cut the payload */
+        c->bad = true;
+        return;
+    }
+    if (c->n_segs == c->cap_segs) {
+        uint32_t cap = c->cap_segs ? c->cap_segs * 2 : 8;
+        seg_ref_t *sg = realloc(c->segs, cap * sizeof(*sg));
+        if (!sg) {
+            c->bad = true;
+            return;
+        }
+        c->segs     = sg;
+        c->cap_segs = cap;
+    }
+    c->segs[c->n_segs++] = (seg_ref_t){ s->payload + skip, s->len - skip, dir };
+    c->next[dir] += s->len - skip;
+    c->bytes     += s->len - skip;
+}
+
+static int
+track(tracker_t *t, const tcp_seg_t *s)
+{
+    uint32_t slot = ht_slot(t, &s->src, &s->dst);
+    conv_b_t *c = t->ht[slot] ? &t->cb[t->ht[slot] - 1] : NULL;
+    bool syn = (s->flags & TCP_F_SYN) != 0;
+    bool ack = (s->flags & TCP_F_ACK) != 0;
+
+    if (syn && !ack) {
+        /* A new ISN, or a SYN after the close, is a new conversation */
+        if (!c || c->closed || !ep_eq(&c->cli, &s->src) ||
+            (c->syn[0] && c->next[0] != s->seq + 1)) {
+            c = conv_new(t, slot, &s->src, &s->dst);
+            if (!c)
+                return -ENOMEM;
+        }
+        c->syn[0]  = true;
+        c->next[0] = s->seq + 1;
+        return 0;
+    }
+    if (!c) {                   /* joined mid-stream */
+        c = conv_new(t, slot, &s->src, &s->dst);
+        if (!c)
+            return -ENOMEM;
+        c->bad = true;
+    }
+    uint8_t dir = ep_eq(&c->cli, &s->src) ? 0 : 1;
+    if (syn) {
+        if (dir == 1 && !c->syn[1]) {
+            c->syn[1]  = true;
+            c->next[1] = s->seq + 1;
+        }
+        return 0;
+    }
+    if (s->len)
+        conv_payload(c, dir, s);
+    if (s->flags & (TCP_F_FIN | TCP_F_RST)) {
+        if (c->closer < 0)
+            c->closer = (int8_t)dir;
+        if (s->flags & TCP_F_FIN)
+            c->fin[dir] = true;
+        c->closed = (s->flags & TCP_F_RST) || (c->fin[0] && c->fin[1]);
+    }
+    return 0;
+}
+
+static void
+tracker_free(tracker_t *t)
+{
+    for (uint32_t i = 0; i < t->n; i++)
+        free(t->cb[i].segs);
+    free(t->cb);
+    free(t->ht);
+}
+
+/* ── Program building ─────────────────────────────────────────────────────── */
+
+static uint32_t
+conv_msgs(const conv_b_t *c)
+{
+    uint32_t n = 1;
+    for (uint32_t i = 1; i < c->n_segs; i++)
+        n += c->segs[i].dir != c->segs[i - 1].dir;
+    return n;
+}
+
+/* Opening message: length and CRC across its segments. */
+static void
+conv_key(const conv_b_t *c, uint32_t *len, uint32_t *crc)
+{
+    uint32_t l = 0, h = L7_CRC_INIT;
+    for (uint32_t i = 0; i < c->n_segs && c->segs[i].dir == c->segs[0].dir; i++) {
+        h  = rte_hash_crc(c->segs[i].p, c->segs[i].len, h);
+        l += c->segs[i].len;
+    }
+    *len = l;
+    *crc = h;
+}
+
+/* Insert into a set of (len, crc) keys; false if already present. */
+static bool
+key_set_add(uint64_t *set, uint32_t mask, uint32_t len, uint32_t crc)
+{
+    uint64_t k = (uint64_t)len << 32 | crc;     /* len > 0: never 0 */
+    uint32_t i = (crc ^ len * 0x9E3779B1u) & mask;
+    while (set[i]) {
+        if (set[i] == k)
+            return false;
+        i = (i + 1) & mask;
+    }
+    set[i] = k;
+    return true;
+}
+
+typedef struct {
+    uint32_t len;
+    uint32_t crc;
+    uint16_t idx;
+} key_ent_t;
+
+static int
+key_cmp(const void *a, const void *b)
+{
+    const key_ent_t *x = a, *y = b;
+    if (x->len != y->len)
+        return x->len < y->len ? -1 : 1;
+    if (x->crc != y->crc)
+        return x->crc < y->crc ? -1 : 1;
+    return 0;
+}
+
+static void
+prog_free(l7_prog_t *p)
+{
+    if (!p)
+        return;
+    rte_free(p->data);
+    rte_free(p->msgs);
+    rte_free(p->convs);
+    rte_free(p->by_key);
+    rte_free(p);
+}
+
+/* Choose the conversations to keep (keep[i]) and fill the counts. */
+static void
+select_convs(const tracker_t *t, bool *keep, l7_prog_t *p,
+             uint64_t *n_msgs, uint64_t *n_bytes)
+{
+    uint32_t mask = 2 * L7_REPLAY_MAX_CONVS - 1;
+    uint64_t *set = calloc(mask + 1, sizeof(*set));
+    l7_replay_info_t *in = &p->info;
+
+    for (uint32_t i = 0; i < t->n; i++) {
+        const conv_b_t *c = &t->cb[i];
+        in->tcp_convs++;
+        if (c->bad || !c->syn[0] || !c->syn[1]) {
+            in->incomplete++;
+            continue;
+        }
+        if (c->n_segs == 0) {
+            in->empty++;
+            continue;
+        }
+        /* The server can only tell conversations apart by what the
+         * client says first: one opener per program, and a program
+         * opened by the server replays a single conversation. */
+        bool sf = c->segs[0].dir == 1;
+        if (p->n_convs == 0)
+            p->server_first = sf;
+        uint32_t msgs = conv_msgs(c);
+        if (sf != p->server_first || (sf && p->n_convs == 1) || !set ||
+            msgs > L7_REPLAY_MAX_MSGS || p->n_convs == L7_REPLAY_MAX_CONVS ||
+            *n_bytes + c->bytes > L7_REPLAY_MAX_BYTES) {
+            in->dropped++;
+            continue;
+        }
+        if (!sf) {
+            uint32_t len, crc;
+            conv_key(c, &len, &crc);
+            if (!key_set_add(set, mask, len, crc)) {
+                in->dropped++;
+                continue;
+            }
+        }
+        keep[i] = true;
+        p->n_convs++;
+        *n_msgs  += msgs;
+        *n_bytes += c->bytes;
+    }
+    free(set);
+}
+
+static int
+build(const tracker_t *t, l7_prog_t *p)
+{
+    bool *keep = calloc(t->n ? t->n : 1, sizeof(*keep));
+    if (!keep)
+        return -ENOMEM;
+    uint64_t n_msgs = 0, n_bytes = 0;
+    select_convs(t, keep, p, &n_msgs, &n_bytes);
+    if (p->n_convs == 0) {
+        free(keep);
+        return -EINVAL;
+    }
+
+    p->data   = rte_malloc("l7_data", n_bytes, 0);
+    p->msgs   = rte_malloc("l7_msgs", n_msgs * sizeof(*p->msgs), 0);
+    p->convs  = rte_zmalloc("l7_convs", p->n_convs * sizeof(*p->convs), 0);
+    p->by_key = rte_malloc("l7_keys", p->n_convs * sizeof(*p->by_key), 0);
+    key_ent_t *keys = calloc(p->n_convs, sizeof(*keys));
+    if (!p->data || !p->msgs || !p->convs || !p->by_key || !keys) {
+        free(keys);
+        free(keep);
+        return -ENOMEM;
+    }
+
+    uint32_t ci = 0, mi = 0, off = 0;
+    for (uint32_t i = 0; i < t->n; i++) {
+        if (!keep[i])
+            continue;
+        const conv_b_t *c = &t->cb[i];
+        l7_conv_t *cv = &p->convs[ci];
+        cv->msg0 = mi;
+        cv->port = c->srv.port;
+        cv->server_closes = c->closer == 1;
+        for (uint32_t s = 0; s < c->n_segs; s++) {
+            const seg_ref_t *g = &c->segs[s];
+            if (s == 0 || g->dir != c->segs[s - 1].dir) {
+                p->msgs[mi++] = (l7_msg_t){ off, 0 };
+                cv->n_msgs++;
+            }
+            memcpy(p->data + off, g->p, g->len);
+            p->msgs[mi - 1].len += g->len;
+            off += g->len;
+            if (g->dir == 0)
+                p->info.c2s_bytes += g->len;
+            else
+                p->info.s2c_bytes += g->len;
+        }
+        conv_key(c, &cv->key_len, &cv->key_crc);
+        if (cv->key_len > p->key_max)
+            p->key_max = cv->key_len;
+        keys[ci] = (key_ent_t){ cv->key_len, cv->key_crc, (uint16_t)ci };
+        ci++;
+    }
+    p->info.msgs = mi;
+
+    qsort(keys, p->n_convs, sizeof(*keys), key_cmp);
+    for (uint32_t i = 0; i < p->n_convs; i++)
+        p->by_key[i] = keys[i].idx;
+    free(keys);
+    free(keep);
+    return 0;
+}
+
+int
+l7_replay_compile(const char *path, l7_prog_t **out)
+{
+    *out = NULL;
+    const uint8_t *base;
+    size_t len;
+    int rc = pcap_file_map(path, &base, &len);
+    if (rc < 0)
+        return rc;
+
+    tracker_t t;
+    memset(&t, 0, sizeof(t));
+    t.ht_mask = 2 * L7_REPLAY_TRACK_MAX - 1;
+    t.ht = calloc(t.ht_mask + 1, sizeof(*t.ht));
+    l7_prog_t *p = rte_zmalloc("l7_prog", sizeof(*p), 0);
+    if (!t.ht || !p) {
+        rc = -ENOMEM;
+        goto out;
+    }
+
+    pcap_reader_t r;
+    pcap_rec_t rec;
+    if (pcap_reader_open(&r, base, len) < 0) {
+        TGEN_ERR(TGEN_LOG_MGMT, "l7: %s: not a pcap or pcapng file\n", path);
+        rc = -EINVAL;
+        goto out;
+    }
+    while ((rc = pcap_reader_next(&r, &rec)) > 0) {
+        tcp_seg_t s;
+        if (parse_tcp(&rec, &s) && (rc = track(&t, &s)) < 0)
+            break;
+    }
+    if (rc == -ENOMEM && t.n == L7_REPLAY_TRACK_MAX) {
+        TGEN_ERR(TGEN_LOG_MGMT, "l7: %s: more than %u TCP conversations\n",
+                 path, L7_REPLAY_TRACK_MAX);
+        rc = -EINVAL;
+        goto out;
+    }
+    if (rc < 0) {
+        if (rc == -EINVAL)
+            TGEN_ERR(TGEN_LOG_MGMT, "l7: %s: malformed at offset %zu\n",
+                     path, (size_t)(r.p - base));
+        goto out;
+    }
+    rc = build(&t, p);
+    if (rc == -EINVAL)
+        TGEN_ERR(TGEN_LOG_MGMT, "l7: %s: none of %u TCP conversations is "
+                 "complete with payload\n", path, p->info.tcp_convs);
+
+out:
+    tracker_free(&t);
+    pcap_file_unmap(base, len);
+    if (rc < 0) {
+        prog_free(p);
+        return rc;
+    }
+    *out = p;
+    return 0;
+}
+
+/* ── Lifetime ─────────────────────────────────────────────────────────────── */
+
+void
+l7_replay_reap(void)
+{
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++)
+        if (__atomic_load_n(&g_tcb_stores[w].count, __ATOMIC_RELAXED))
+            return;
+    for (uint32_t i = 0; i < L7_RETIRED_MAX; i++) {
+        prog_free(g_retired[i]);
+        g_retired[i] = NULL;
+    }
+}
+
+void
+l7_replay_install(l7_prog_t **slot, l7_prog_t *p)
+{
+    l7_prog_t *old = *slot;
+    *slot = p;
+    if (old) {
+        uint32_t i = 0;
+        while (i < L7_RETIRED_MAX && g_retired[i])
+            i++;
+        if (i < L7_RETIRED_MAX)
+            g_retired[i] = old;
+        else
+            TGEN_WARN(TGEN_LOG_MGMT, "l7: leaking a retired program\n");
+    }
+    l7_replay_reap();
+}
+
+/* ── Connection driver ────────────────────────────────────────────────────── */
+
+static inline bool
+is_server(const tcb_t *tcb)
+{
+    return tcb->app_state == L7_REPLAY_APP_SERVER;
+}
+
+/* Is message k sent by the server? */
+static inline bool
+by_server(const l7_prog_t *p, uint32_t k)
+{
+    return ((k & 1) == 0) == p->server_first;
+}
+
+/* Waiting for the peer: its bytes or its FIN, within the response timeout
+ * that the timer wheel already enforces through http_req_sent_tsc. */
+static inline void
+wait_peer(uint32_t worker_idx, tcb_t *tcb)
+{
+    if (tcb->http_req_sent_tsc == 0) {
+        tcb->http_req_sent_tsc = rte_rdtsc();
+        tcp_timer_resched(worker_idx, tcb);
+    }
+}
+
+static void
+next_msg(uint32_t worker_idx, tcb_t *tcb, const l7_conv_t *c)
+{
+    tcb->l7_msg++;
+    tcb->l7_off = 0;
+    if (tcb->l7_msg == c->n_msgs) {
+        worker_metrics_add_l7_done(worker_idx);
+        flow_metrics_inc(worker_idx, tcb->flow_idx, l7_conv_done);
+    }
+}
+
+static int
+fail(uint32_t worker_idx, tcb_t *tcb)
+{
+    worker_metrics_add_l7_fail(worker_idx);
+    flow_metrics_inc(worker_idx, tcb->flow_idx, l7_conv_fail);
+    tcp_fsm_reset(worker_idx, tcb);
+    return -1;
+}
+
+void
+l7_replay_client_init(tcb_t *tcb, const l7_prog_t *p, uint32_t conv)
+{
+    tcb->app_state = L7_REPLAY_APP_CLIENT;
+    tcb->app_ctx   = (void *)(uintptr_t)p;
+    tcb->l7_conv   = (uint16_t)conv;
+    tcb->l7_msg    = 0;
+    tcb->l7_off    = 0;
+}
+
+int
+l7_replay_server_init(uint32_t worker_idx, tcb_t *tcb)
+{
+    const l7_prog_t *p = g_l7_srv_prog;
+    if (!p) {
+        tcp_fsm_reset(worker_idx, tcb);
+        return -1;
+    }
+    tcb->app_state = L7_REPLAY_APP_SERVER;
+    tcb->app_ctx   = (void *)(uintptr_t)p;
+    tcb->l7_conv   = p->server_first ? 0 : L7_CONV_NONE;
+    tcb->l7_msg    = 0;
+    tcb->l7_off    = 0;
+    tcb->l7_crc    = L7_CRC_INIT;
+    if (p->server_first)
+        return (int)l7_replay_pump(worker_idx, tcb);
+    wait_peer(worker_idx, tcb);
+    return 0;
+}
+
+uint32_t
+l7_replay_pump(uint32_t worker_idx, tcb_t *tcb)
+{
+    const l7_prog_t *p = tcb->app_ctx;
+    if (!p || tcb->l7_conv == L7_CONV_NONE)
+        return 0;
+    const l7_conv_t *c = &p->convs[tcb->l7_conv];
+    bool server = is_server(tcb);
+    uint32_t queued = 0;
+
+    while (tcb->l7_msg < c->n_msgs) {
+        if (by_server(p, tcb->l7_msg) != server) {
+            wait_peer(worker_idx, tcb);
+            return queued;
+        }
+        tcb->http_req_sent_tsc = 0;
+        const l7_msg_t *m = &p->msgs[c->msg0 + tcb->l7_msg];
+        int n = tcp_fsm_send(worker_idx, tcb, p->data + m->off + tcb->l7_off,
+                             m->len - tcb->l7_off);
+        if (n <= 0)
+            return queued;      /* send buffer full: resumed on an ACK */
+        queued      += (uint32_t)n;
+        tcb->l7_off += (uint32_t)n;
+        if (tcb->l7_off < m->len)
+            return queued;
+        next_msg(worker_idx, tcb, c);
+    }
+
+    /* Conversation over: the side that closed in the capture closes,
+     * once everything it queued has left. */
+    if (c->server_closes != server) {
+        wait_peer(worker_idx, tcb);
+        return queued;
+    }
+    if (tcb->snd_buf &&
+        tcp_snd_buf_unsent_len(tcb->snd_buf, tcb->snd_nxt - tcb->snd_una))
+        return queued;
+    tcb->http_req_sent_tsc = 0;
+    tcp_fsm_close(worker_idx, tcb);
+    return queued;
+}
+
+/* Server: the conversation whose opening message is (len, crc), or -1. */
+static int
+find_key(const l7_prog_t *p, uint32_t len, uint32_t crc)
+{
+    uint32_t lo = 0, hi = p->n_convs;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        const l7_conv_t *c = &p->convs[p->by_key[mid]];
+        if (c->key_len < len || (c->key_len == len && c->key_crc < crc))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < p->n_convs) {
+        const l7_conv_t *c = &p->convs[p->by_key[lo]];
+        if (c->key_len == len && c->key_crc == crc)
+            return p->by_key[lo];
+    }
+    return -1;
+}
+
+int
+l7_replay_on_data(uint32_t worker_idx, tcb_t *tcb,
+                  const uint8_t *data, uint32_t len)
+{
+    const l7_prog_t *p = tcb->app_ctx;
+    if (!p)
+        return 0;
+    tcb->http_req_sent_tsc = rte_rdtsc();       /* the peer is alive */
+
+    if (tcb->l7_conv == L7_CONV_NONE) {
+        /* The client's whole opening message arrives before it waits
+         * for us, so it is identified once the bytes match a key. */
+        tcb->l7_crc  = rte_hash_crc(data, len, tcb->l7_crc);
+        tcb->l7_off += len;
+        int ci = find_key(p, tcb->l7_off, tcb->l7_crc);
+        if (ci < 0)
+            return tcb->l7_off >= p->key_max ? fail(worker_idx, tcb) : 0;
+        tcb->l7_conv = (uint16_t)ci;
+        tcb->l7_msg  = 0;
+        next_msg(worker_idx, tcb, &p->convs[ci]);
+        return (int)l7_replay_pump(worker_idx, tcb);
+    }
+
+    const l7_conv_t *c = &p->convs[tcb->l7_conv];
+    bool server = is_server(tcb);
+    while (len > 0) {
+        if (tcb->l7_msg >= c->n_msgs || by_server(p, tcb->l7_msg) == server)
+            return fail(worker_idx, tcb);       /* more than the peer sent */
+        const l7_msg_t *m = &p->msgs[c->msg0 + tcb->l7_msg];
+        uint32_t take = TGEN_MIN(len, m->len - tcb->l7_off);
+        tcb->l7_off += take;
+        len         -= take;
+        if (tcb->l7_off == m->len)
+            next_msg(worker_idx, tcb, c);
+    }
+    return (int)l7_replay_pump(worker_idx, tcb);
+}
@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: stateful L7 replay of captured TCP conversations.
+ *
+ * l7_replay_compile() reads a pcap/pcapng on the management lcore and
+ * turns every complete TCP conversation (handshake seen, no sequence gap)
+ * into a list of messages: the bytes one side sent before the other
+ * answered.  Connections then replay a conversation over the native stack:
+ *
+ *   client  start --proto l7 --pcap <file>: tx_gen opens connections with
+ *           tcp_fsm_connect(), cycling through the conversations
+ *   server  serve --listen tcp:<port>:replay --pcap <file>: srv_on_data()
+ *           identifies the conversation by its opening message
+ *
+ * Each side sends its own messages in order and waits for the peer's by
+ * byte count, so segmentation, windows, retransmission and timing are the
+ * live stack's, not the capture's.  The side that sent the first FIN (or
+ * RST) in the capture closes.
+ *
+ * Programs are side data like g_pcap_replays: installed before the START
+ * or SERVE IPC, then retired — not freed — while TCBs may point at them.
+ */
+#ifndef TGEN_L7_REPLAY_H
+#define TGEN_L7_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+#include "../net/tcp_tcb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define L7_REPLAY_MAX_CONVS   4096u         /* conversations per program   */
+#define L7_REPLAY_MAX_MSGS    65535u        /* messages per conversation   */
+#define L7_REPLAY_MAX_BYTES   (256u << 20)  /* payload per program         */
+#define L7_REPLAY_TRACK_MAX   (1u << 18)    /* conversations in a capture  */
+
+/* tcb->app_state of a replaying connection */
+#define L7_REPLAY_APP_CLIENT  8
+#define L7_REPLAY_APP_SERVER  13            /* >= 10: srv_on_data() path  */
+
+#define L7_CONV_NONE          UINT16_MAX    /* server: not identified yet  */
+
+typedef struct {
+    uint32_t off;               /* into l7_prog_t.data                   */
+    uint32_t len;
+} l7_msg_t;
+
+/* Message k of a conversation is sent by the program's opener when k is
+ * even, by the other side when odd. */
+typedef struct {
+    uint32_t msg0;              /* first message in l7_prog_t.msgs       */
+    uint16_t n_msgs;
+    uint16_t port;              /* server port in the capture            */
+    uint32_t key_len;           /* opening message length and CRC: the   */
+    uint32_t key_crc;           /* server's lookup key                   */
+    bool     server_closes;     /* first FIN/RST came from the server    */
+} l7_conv_t;
+
+/* What a compile found, for the start/serve banner. */
+typedef struct {
+    uint32_t tcp_convs;         /* TCP conversations in the capture      */
+    uint32_t incomplete;        /* no handshake, gap or truncated frame  */
+    uint32_t empty;             /* handshake only, no payload            */
+    uint32_t dropped;           /* same opening message, other opener,
+                                   or past the limits                    */
+    uint64_t msgs;
+    uint64_t c2s_bytes;
+    uint64_t s2c_bytes;
+} l7_replay_info_t;
+
+typedef struct {
+    uint8_t          *data;     /* all payload                           */
+    l7_msg_t         *msgs;
+    l7_conv_t        *convs;
+    uint16_t         *by_key;   /* conversations by (key_len, key_crc)   */
+    uint32_t          n_convs;
+    uint32_t          key_max;  /* longest opening message               */
+    bool              server_first;
+    l7_replay_info_t  info;
+} l7_prog_t;
+
+/** Per-flow client programs (g_l7_progs[flow_idx]) and the program of
+ *  the replay listeners. */
+extern l7_prog_t *g_l7_progs[TGEN_MAX_CLIENT_FLOWS];
+extern l7_prog_t *g_l7_srv_prog;
+
+/**
+ * Compile a capture (management lcore).  Returns 0, -errno on open,
+ * -EINVAL for a malformed capture or one with no replayable conversation,
+ * or -ENOMEM.
+ */
+int l7_replay_compile(const char *path, l7_prog_t **out);
+
+/** Put `p` (may be NULL) in `slot`, retiring what it held. */
+void l7_replay_install(l7_prog_t **slot, l7_prog_t *p);
+
+/** Free retired programs once no worker holds a TCB. */
+void l7_replay_reap(void);
+
+/* ── Worker side ──────────────────────────────────────────────────────────── */
+
+/** Client: mark a connecting TCB to replay conversation `conv` of `p`. */
+void l7_replay_client_init(tcb_t *tcb, const l7_prog_t *p, uint32_t conv);
+
+/** Server: attach an established TCB to g_l7_srv_prog.
+ *  Returns payload bytes queued, or -1 if the connection was reset. */
+int l7_replay_server_init(uint32_t worker_idx, tcb_t *tcb);
+
+/**
+ * Queue the TCB's own messages until it is the peer's turn or the send
+ * buffer is full; close when the conversation ends on this side.  Called
+ * on ESTABLISHED and on every ACK.  Returns payload bytes queued.
+ */
+uint32_t l7_replay_pump(uint32_t worker_idx, tcb_t *tcb);
+
+/**
+ * In-order payload from the peer.  Returns payload bytes queued in reply,
+ * or -1 if the bytes don't fit the conversation and the connection was
+ * reset (the TCB is free).
+ */
+int l7_replay_on_data(uint32_t worker_idx, tcb_t *tcb,
+                      const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_L7_REPLAY_H */
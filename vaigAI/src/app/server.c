@@ -3,6 +3,7 @@
  */
 #include "server.h"
 #include "http11.h"
+#include "l7_replay.h"
 #include "../net/tcp_fsm.h"
 #include "../net/tcp_tcb.h"
 #include "../net/tcp_snd_buf.h"
@@ -33,6 +34,7 @@ static const char *handler_names[] = {
     [SRV_HANDLER_HTTP]     = "http",
     [SRV_HANDLER_HTTPS]    = "https",
     [SRV_HANDLER_TLS_ECHO] = "tls_echo",
+    [SRV_HANDLER_REPLAY]   = "replay",
 };
 
 const char *srv_handler_name(srv_handler_t h)
@@ -193,6 +195,15 @@ void srv_on_established(uint32_t worker_idx, void *tcb_ptr,
         tcb->app_state = 11;
         break;
 
+    case SRV_HANDLER_REPLAY: {
+        /* app_state = 13; sends the opening message of a server-first
+         * capture, otherwise waits for the client's. */
+        int n = l7_replay_server_init(worker_idx, tcb);
+        if (n > 0)
+            l->tx_bytes += (uint64_t)n;
+        break;
+    }
+
     default:
         break;
     }
@@ -256,6 +267,13 @@ int srv_on_data(uint32_t worker_idx, void *tcb_ptr,
         return (int)len;
     }
 
+    case SRV_HANDLER_REPLAY: {
+        int n = l7_replay_on_data(worker_idx, tcb, data, len);
+        if (n > 0)
+            l->tx_bytes += (uint64_t)n;
+        return (int)len;
+    }
+
     case SRV_HANDLER_HTTPS:
     case SRV_HANDLER_TLS_ECHO: {
         uint32_t conn_idx = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
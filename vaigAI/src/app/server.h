@@ -31,6 +31,7 @@ typedef enum {
     SRV_HANDLER_HTTP,        /* parse HTTP/1.1 request, send pre-built rsp */
     SRV_HANDLER_HTTPS,       /* TLS accept + HTTP response                 */
     SRV_HANDLER_TLS_ECHO,    /* TLS accept + echo plaintext                */
+    SRV_HANDLER_REPLAY,      /* replay captured conversations (l7_replay)  */
     SRV_HANDLER_MAX,
 } srv_handler_t;
 
@@ -53,7 +53,7 @@
 #define TGEN_OOO_QUEUE_SZ       8
 #define TGEN_TEMPLATE_MAX_SZ    (64 * 1024)
 #define TGEN_IFNAMESIZ          16
-#define TGEN_MAX_CLIENT_FLOWS   16    /* concurrent client traffic flows */
+#define TGEN_MAX_CLIENT_FLOWS   4096  /* concurrent client traffic flows */
 #define CACHE_LINE_SIZE         64
 
 /* ── IPv4 helpers ─────────────────────────────────────────────────────────── */
@@ -91,7 +91,8 @@ typedef enum {
 /* ── Load-shape mode ──────────────────────────────────────────────────────── */
 typedef enum {
     LOAD_UNLIMITED = 0,
-    LOAD_CONSTANT,
+    LOAD_CONSTANT,      /* fixed offered rate (--rate, --bps)      */
+    LOAD_TARGET,        /* closed loop on a load_metric_t (--target) */
 } load_mode_t;
 
 /* ── Target metric for load shaping ─────────────────────────────────────── */
@@ -100,6 +101,8 @@ typedef enum {
     METRIC_RPS,
     METRIC_TPS,
     METRIC_MBPS,
+    METRIC_CONC,        /* open connections                        */
+    METRIC_MAX,
 } load_metric_t;
 
 /* ── Generic result ───────────────────────────────────────────────────────── */
@@ -101,6 +101,37 @@ int tgen_parse_cidr(const char *str, uint32_t *out_net, uint8_t *out_len)
     return tgen_parse_ipv4(tmp, out_net);
 }
 
+/* ── Bit rates ────────────────────────────────────────────────────────────── */
+int tgen_parse_bps(const char *str, uint64_t *out_bps)
+{
+    char *end;
+    double v = strtod(str, &end);
+    if (end == str || v <= 0)
+        return -1;
+    switch (*end) {
+    case 'k': case 'K': v *= 1e3;  end++; break;
+    case 'm': case 'M': v *= 1e6;  end++; break;
+    case 'g': case 'G': v *= 1e9;  end++; break;
+    case 't': case 'T': v *= 1e12; end++; break;
+    default: break;
+    }
+    if (*end != '\0' || v < 1 || v > (double)TGEN_BPS_MAX)
+        return -1;
+    *out_bps = (uint64_t)(v + 0.5);
+    return 0;
+}
+
+const char *tgen_bps_str(uint64_t bps, char *buf, size_t len)
+{
+    if (bps >= 1000000000ULL)
+        snprintf(buf, len, "%.3f Gbps", (double)bps / 1e9);
+    else if (bps >= 1000000ULL)
+        snprintf(buf, len, "%.3f Mbps", (double)bps / 1e6);
+    else
+        snprintf(buf, len, "%.3f kbps", (double)bps / 1e3);
+    return buf;
+}
+
 /* ── Power-of-two ─────────────────────────────────────────────────────────── */
 uint64_t tgen_next_pow2_u64(uint64_t v)
 {
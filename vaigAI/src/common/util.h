@@ -49,6 +49,19 @@ int tgen_parse_ipv4(const char *str, uint32_t *out_net);
  *  Returns 0 on success, -1 on parse error. */
 int tgen_parse_cidr(const char *str, uint32_t *out_net, uint8_t *out_len);
 
+/** Highest bit rate tgen_parse_bps() accepts: 1.6 Tbps, the fastest
+ *  Ethernet line rate. */
+#define TGEN_BPS_MAX 1600000000000ULL
+
+/** Parse a bit rate: a decimal number with an optional k, m, g or t
+ *  suffix (powers of 1000), e.g. "9.5g" or "1.6t".  Returns 0 on
+ *  success, -1 on parse error, a rate below 1 bps or above
+ *  TGEN_BPS_MAX. */
+int tgen_parse_bps(const char *str, uint64_t *out_bps);
+
+/** Format a bit rate as "9.500 Gbps" / "250.000 Mbps" / "64.000 kbps". */
+const char *tgen_bps_str(uint64_t bps, char *buf, size_t len);
+
 /** Format an IPv6 address to a caller-supplied buffer (at least 46 bytes). */
 const char *tgen_ipv6_str(const uint8_t *addr6, char *buf, size_t len);
 
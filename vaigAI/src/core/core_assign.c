@@ -151,6 +151,32 @@ int tgen_core_assign_init(uint32_t num_worker_hint,
     return 0;
 }
 
+void tgen_core_assign_sw_dist(uint32_t num_ports)
+{
+    for (uint32_t p = 0; p < num_ports && p < TGEN_MAX_PORTS; p++) {
+        uint32_t n_w = g_core_map.port_num_workers[p];
+        if (n_w < 2)
+            continue;
+
+        struct rte_eth_dev_info info;
+        if (rte_eth_dev_info_get((uint16_t)p, &info) != 0 ||
+            info.nb_rx_queues != 1)
+            continue;
+
+        /* Every target transmits on its own TX queue */
+        uint32_t n_t = TGEN_MIN(n_w, (uint32_t)info.nb_tx_queues);
+        if (n_t < 2) {
+            RTE_LOG(WARNING, TGEN,
+                "sw-dist: port %u has %u TX queue(s), not distributing\n",
+                p, info.nb_tx_queues);
+            continue;
+        }
+        g_core_map.port_dist_targets[p] = n_t;
+        RTE_LOG(INFO, TGEN,
+            "sw-dist: port %u RX fanned out to %u workers\n", p, n_t);
+    }
+}
+
 void tgen_core_assign_dump(void)
 {
     RTE_LOG(INFO, TGEN,
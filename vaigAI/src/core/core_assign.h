@@ -13,6 +13,11 @@
 extern "C" {
 #endif
 
+/* Virtual RETA size used by the software distributor.  Entry r maps to
+ * distribution target r % port_dist_targets[port]; rss_steer.c builds its
+ * owner table from the same layout. */
+#define TGEN_SW_DIST_RETA_SIZE 128u
+
 /* ── Core map ─────────────────────────────────────────────────────────────── */
 typedef struct {
     uint32_t      worker_lcores[TGEN_MAX_WORKERS];
@@ -26,6 +31,10 @@ typedef struct {
     /* Which worker lcores service each port? */
     uint32_t      port_workers[TGEN_MAX_PORTS][TGEN_MAX_WORKERS];
     uint32_t      port_num_workers[TGEN_MAX_PORTS];
+    /* Software distributor: workers 0..n-1 of a single-RX-queue port
+     * share its traffic; worker 0 polls the queue and fans out.
+     * 0 = port not distributed. */
+    uint32_t      port_dist_targets[TGEN_MAX_PORTS];
 } core_map_t;
 
 /** The global core map — populated by tgen_core_assign_init(). */
@@ -39,6 +48,11 @@ int tgen_core_assign_init(uint32_t num_worker_hint,
                           bool     manual_mode,
                           uint32_t num_ports);
 
+/** Enable the software distributor on every port that has a single RX
+ *  queue but several workers.  Must be called after tgen_ports_init()
+ *  (queue counts are known) and before tgen_worker_ctx_init(). */
+void tgen_core_assign_sw_dist(uint32_t num_ports);
+
 /** Dump the core map to the log at INFO level. */
 void tgen_core_assign_dump(void);
 
@@ -42,6 +42,8 @@ static const struct option g_long_opts[] = {
     { "src-ip6",                required_argument, NULL, '6' },
     { "verbose",                no_argument,       NULL, 'v' },
     { "server",                 no_argument,       NULL, 'S' },
+    { "sw-dist",                no_argument,       NULL, 'D' },
+    { "tx-timestamp",           no_argument,       NULL, 'T' },
     { NULL, 0, NULL, 0 },
 };
 
@@ -73,7 +75,7 @@ static int parse_tgen_args(int argc, char **argv, tgen_eal_args_t *a)
     optind = 1;
     opterr = 0; /* suppress errors for unknown options (belong to EAL) */
 
-    while ((opt = getopt_long(argc, argv, "W:M:P:r:t:d:C:X:R:I:G:N:K:O:6:vS", g_long_opts,
+    while ((opt = getopt_long(argc, argv, "W:M:P:r:t:d:C:X:R:I:G:N:K:O:6:vSDT", g_long_opts,
                               &opt_idx)) != -1) {
         switch (opt) {
         case 'W': a->num_worker_cores = (uint32_t)atoi(optarg); break;
@@ -120,6 +122,8 @@ static int parse_tgen_args(int argc, char **argv, tgen_eal_args_t *a)
             break;
         case 'v': a->verbose = true; break;
         case 'S': a->server_mode = true; break;
+        case 'D': a->sw_dist = true; break;
+        case 'T': a->tx_timestamp = true; break;
         default:  break; /* unknown → EAL handles */
         }
     }
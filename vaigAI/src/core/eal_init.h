@@ -46,6 +46,8 @@ typedef struct {
 
     bool        verbose;            /* -v/--verbose: show all startup log messages */
     bool        server_mode;        /* --server: start in server mode */
+    bool        sw_dist;            /* --sw-dist: software RX distributor */
+    bool        tx_timestamp;       /* --tx-timestamp: NIC scheduled send */
 } tgen_eal_args_t;
 
 /** Parse argv, populate tgen_eal_args_t, then call rte_eal_init().
@@ -0,0 +1,257 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-packet field variation — parsing and value generation.
+ *
+ * Frame patching and checksum fix-up live with the builders in tx_gen.c.
+ */
+#include "field_var.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include <rte_byteorder.h>
+#include <rte_malloc.h>
+#include <rte_branch_prediction.h>
+
+#include "../common/util.h"
+
+field_var_prog_t *g_field_progs[TGEN_MAX_CLIENT_FLOWS];
+
+field_var_prog_t *
+field_var_slot(uint32_t flow_idx)
+{
+    if (!g_field_progs[flow_idx])
+        g_field_progs[flow_idx] = rte_zmalloc("field_prog",
+                                              sizeof(field_var_prog_t), 0);
+    return g_field_progs[flow_idx];
+}
+
+/* ── Parsing ──────────────────────────────────────────────────────────────── */
+
+static const struct {
+    const char *name;
+    uint8_t     field;
+} k_fields[] = {
+    { "src-ip",   FV_SRC_IP   },
+    { "dst-ip",   FV_DST_IP   },
+    { "src-port", FV_SRC_PORT },
+    { "dst-port", FV_DST_PORT },
+    { "src-mac",  FV_SRC_MAC  },
+    { "dst-mac",  FV_DST_MAC  },
+    { "vlan",     FV_VLAN     },
+    { "dscp",     FV_DSCP     },
+};
+
+static bool
+is_ip_field(uint8_t field)
+{
+    return field == FV_SRC_IP || field == FV_DST_IP;
+}
+
+/* Parse one value: dotted quad for IP fields, else decimal/hex. */
+static int
+parse_value(const field_var_t *v, const char *s, uint32_t *out)
+{
+    if (is_ip_field(v->field)) {
+        uint32_t ip;
+        if (tgen_parse_ipv4(s, &ip) < 0)
+            return -EINVAL;
+        *out = rte_be_to_cpu_32(ip);
+        return 0;
+    }
+    char *end;
+    unsigned long long x = strtoull(s, &end, 0);
+    if (end == s || *end != '\0' || x > field_var_field_max(v))
+        return -EINVAL;
+    *out = (uint32_t)x;
+    return 0;
+}
+
+static int
+parse_field(const char *s, field_var_t *v)
+{
+    for (uint32_t i = 0; i < TGEN_ARRAY_SIZE(k_fields); i++) {
+        if (strcmp(s, k_fields[i].name) == 0) {
+            v->field = k_fields[i].field;
+            return 0;
+        }
+    }
+    /* payload@<offset>/<size> */
+    if (strncmp(s, "payload@", 8) != 0)
+        return -EINVAL;
+    char *end;
+    unsigned long off = strtoul(s + 8, &end, 10);
+    if (end == s + 8 || *end != '/' || off > UINT16_MAX)
+        return -EINVAL;
+    unsigned long sz = strtoul(end + 1, &end, 10);
+    if (*end != '\0' || (sz != 1 && sz != 2 && sz != 4))
+        return -EINVAL;
+    v->field  = FV_PAYLOAD;
+    v->offset = (uint16_t)off;
+    v->size   = (uint8_t)sz;
+    return 0;
+}
+
+int
+field_var_parse(const char *spec, field_var_t *v)
+{
+    char buf[256];
+    if (strlen(spec) >= sizeof(buf))
+        return -EINVAL;
+    strcpy(buf, spec);
+    memset(v, 0, sizeof(*v));
+
+    char *save = NULL;
+    char *f  = strtok_r(buf, ":", &save);
+    char *op = strtok_r(NULL, ":", &save);
+    char *vals = strtok_r(NULL, ":", &save);
+    char *step = strtok_r(NULL, ":", &save);
+    if (!f || !op || !vals || strtok_r(NULL, ":", &save))
+        return -EINVAL;
+    if (parse_field(f, v) < 0)
+        return -EINVAL;
+
+    if (strcmp(op, "list") == 0) {
+        v->op = FV_OP_LIST;
+        char *lsave = NULL;
+        for (char *t = strtok_r(vals, ",", &lsave); t;
+             t = strtok_r(NULL, ",", &lsave)) {
+            if (v->list_n == FIELD_VAR_LIST_MAX ||
+                parse_value(v, t, &v->list[v->list_n]) < 0)
+                return -EINVAL;
+            v->list_n++;
+        }
+        return (v->list_n > 0 && !step) ? 0 : -EINVAL;
+    }
+
+    if (strcmp(op, "inc") == 0)
+        v->op = FV_OP_INC;
+    else if (strcmp(op, "dec") == 0)
+        v->op = FV_OP_DEC;
+    else if (strcmp(op, "rand") == 0)
+        v->op = FV_OP_RANDOM;
+    else
+        return -EINVAL;
+
+    char *dash = strchr(vals, '-');
+    if (!dash)
+        return -EINVAL;
+    *dash = '\0';
+    if (parse_value(v, vals, &v->min) < 0 ||
+        parse_value(v, dash + 1, &v->max) < 0 || v->max < v->min)
+        return -EINVAL;
+
+    v->step = 1;
+    if (step) {
+        if (v->op == FV_OP_RANDOM)
+            return -EINVAL;
+        char *end;
+        unsigned long s = strtoul(step, &end, 0);
+        if (end == step || *end != '\0' || s == 0 || s > UINT32_MAX)
+            return -EINVAL;
+        v->step = (uint32_t)s;
+    }
+    return 0;
+}
+
+uint32_t
+field_var_field_max(const field_var_t *v)
+{
+    switch (v->field) {
+    case FV_SRC_PORT:
+    case FV_DST_PORT: return UINT16_MAX;
+    case FV_VLAN:     return 4094;
+    case FV_DSCP:     return 63;
+    case FV_PAYLOAD:  return v->size >= 4 ? UINT32_MAX
+                                          : (1u << (8 * v->size)) - 1;
+    default:          return UINT32_MAX;    /* IPs, MAC low 32 bits */
+    }
+}
+
+/* ── Evaluation ───────────────────────────────────────────────────────────── */
+
+/* Odometer radix of a variable, 0 for random ones. */
+static uint64_t
+var_count(const field_var_t *v)
+{
+    switch (v->op) {
+    case FV_OP_INC:
+    case FV_OP_DEC:  return ((uint64_t)v->max - v->min) / v->step + 1;
+    case FV_OP_LIST: return v->list_n;
+    default:         return 0;
+    }
+}
+
+uint64_t
+field_var_period(const field_var_prog_t *p)
+{
+    uint64_t period = 1;
+    for (uint32_t i = 0; i < p->n_vars; i++) {
+        uint64_t c = var_count(&p->vars[i]);
+        if (c == 0)
+            continue;
+        if (period > UINT64_MAX / c)
+            return UINT64_MAX;
+        period *= c;
+    }
+    return period;
+}
+
+/* Move the odometer k positions; the carry out of the last digit wraps. */
+static inline void
+odometer_advance(field_var_state_t *s, uint64_t k)
+{
+    for (uint32_t i = 0; i < s->prog.n_vars && k; i++) {
+        uint64_t c = s->count[i];
+        if (c == 0)
+            continue;
+        uint64_t pos = s->pos[i] + k;
+        if (likely(pos < c)) {
+            s->pos[i] = pos;
+            return;
+        }
+        s->pos[i] = pos % c;
+        k = pos / c;
+    }
+}
+
+void
+field_var_init(field_var_state_t *s, const field_var_prog_t *p,
+               uint32_t rank, uint32_t n)
+{
+    memset(s, 0, sizeof(*s));
+    memcpy(&s->prog, p, sizeof(*p));
+    if (s->prog.n_vars > FIELD_VAR_MAX)
+        s->prog.n_vars = FIELD_VAR_MAX;
+    for (uint32_t i = 0; i < s->prog.n_vars; i++)
+        s->count[i] = var_count(&s->prog.vars[i]);
+    s->stride = n ? n : 1;
+    odometer_advance(s, rank);
+}
+
+void
+field_var_next(field_var_state_t *s)
+{
+    for (uint32_t i = 0; i < s->prog.n_vars; i++) {
+        const field_var_t *v = &s->prog.vars[i];
+        switch (v->op) {
+        case FV_OP_INC:
+            s->value[i] = v->min + (uint32_t)s->pos[i] * v->step;
+            break;
+        case FV_OP_DEC:
+            s->value[i] = v->max - (uint32_t)s->pos[i] * v->step;
+            break;
+        case FV_OP_LIST:
+            s->value[i] = v->list[s->pos[i]];
+            break;
+        default: {
+            /* Multiply-shift maps 32 random bits onto [min, max]. */
+            uint64_t span = (uint64_t)v->max - v->min + 1;
+            uint64_t r    = tgen_rand64() >> 32;
+            s->value[i] = v->min + (uint32_t)((r * span) >> 32);
+            break;
+        }
+        }
+    }
+    odometer_advance(s, s->stride);
+}
@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-packet field variation for stateless (ICMP/UDP) flows.
+ *
+ * A flow carries up to FIELD_VAR_MAX variables, each bound to a header
+ * field (IP, port, MAC, VLAN ID, DSCP) or to 1/2/4 payload bytes.  A
+ * variable draws its value from an increment, decrement, random or list
+ * distribution; tx_gen writes it into every frame and adjusts the IP and
+ * L4 checksums incrementally (RFC 1624).
+ *
+ * The sequential variables (inc, dec, list) form an odometer: the first
+ * one declared turns every packet and carries into the next one when it
+ * wraps, so the flow walks the full cross product of their ranges before
+ * repeating — e.g. 65536 source IPs × 50000 source ports gives 3.3e9
+ * distinct tuples.  Generators sharing a flow interleave: generator r of
+ * n starts at position r and advances n positions per packet.
+ *
+ * Programs are set by the CLI in g_field_progs[flow_idx] before the
+ * START IPC (same hand-off as g_http_custom_hdrs); each worker copies
+ * its flow's program in tx_gen_configure().  A slot is allocated on the
+ * first START that uses it and kept for the next one.
+ */
+#ifndef TGEN_FIELD_VAR_H
+#define TGEN_FIELD_VAR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FIELD_VAR_MAX       8   /* variables per flow               */
+#define FIELD_VAR_LIST_MAX  16  /* values of a list distribution    */
+
+/** Field a variable writes. */
+typedef enum {
+    FV_SRC_IP = 0,
+    FV_DST_IP,
+    FV_SRC_PORT,        /* UDP only                                  */
+    FV_DST_PORT,        /* UDP only                                  */
+    FV_SRC_MAC,         /* low 4 bytes of the address               */
+    FV_DST_MAC,
+    FV_VLAN,            /* VLAN ID of the 802.1Q tag (needs --vlan)  */
+    FV_DSCP,
+    FV_PAYLOAD,         /* `size` bytes at `offset` into L4 payload  */
+    FV_FIELD_MAX,
+} field_var_field_t;
+
+/** Value distribution. */
+typedef enum {
+    FV_OP_INC = 0,      /* min, min+step, … max, wrap               */
+    FV_OP_DEC,          /* max, max-step, … min, wrap               */
+    FV_OP_RANDOM,       /* uniform in [min, max], per packet        */
+    FV_OP_LIST,         /* list[0], list[1], … wrap                 */
+} field_var_op_t;
+
+typedef struct {
+    uint8_t  field;     /* field_var_field_t                         */
+    uint8_t  op;        /* field_var_op_t                            */
+    uint8_t  size;      /* FV_PAYLOAD: bytes written (1, 2 or 4)     */
+    uint8_t  list_n;    /* FV_OP_LIST: values in list[]              */
+    uint16_t offset;    /* FV_PAYLOAD: offset into the L4 payload    */
+    uint32_t min;       /* host order (IPs as host-order u32)        */
+    uint32_t max;
+    uint32_t step;      /* FV_OP_INC / FV_OP_DEC, ≥ 1                */
+    uint32_t list[FIELD_VAR_LIST_MAX];
+} field_var_t;
+
+typedef struct {
+    uint32_t    n_vars;
+    field_var_t vars[FIELD_VAR_MAX];
+} field_var_prog_t;
+
+/** Worker-side evaluation state (lives in tx_gen_state_t). */
+typedef struct {
+    field_var_prog_t prog;
+    uint64_t         pos[FIELD_VAR_MAX];    /* odometer digit          */
+    uint64_t         count[FIELD_VAR_MAX];  /* digit radix (0 = random) */
+    uint32_t         value[FIELD_VAR_MAX];  /* value for this packet   */
+    uint32_t         stride;                /* generators on the flow  */
+} field_var_state_t;
+
+/** Per-flow programs, written by the CLI before CFG_CMD_START
+ *  (NULL until the slot first uses one). */
+extern field_var_prog_t *g_field_progs[TGEN_MAX_CLIENT_FLOWS];
+
+/** Management: the program slot of `flow_idx`, allocated on first use;
+ *  NULL when out of memory. */
+field_var_prog_t *field_var_slot(uint32_t flow_idx);
+
+/**
+ * Parse one "<field>:<op>:<values>[:<step>]" spec into `v`.
+ *   field:  src-ip | dst-ip | src-port | dst-port | src-mac | dst-mac |
+ *           vlan | dscp | payload@<offset>/<1|2|4>
+ *   op:     inc | dec | rand | list
+ *   values: <min>-<max> (inc/dec/rand) or <v>,<v>,… (list); IPs dotted.
+ * Returns 0 or -EINVAL.
+ */
+int field_var_parse(const char *spec, field_var_t *v);
+
+/** Largest value a field can hold (payload: by size). */
+uint32_t field_var_field_max(const field_var_t *v);
+
+/** Distinct sequential combinations of a program (saturates at
+ *  UINT64_MAX); 1 if it only has random variables. */
+uint64_t field_var_period(const field_var_prog_t *p);
+
+/** Load a program and position generator `rank` of `n` on it. */
+void field_var_init(field_var_state_t *s, const field_var_prog_t *p,
+                    uint32_t rank, uint32_t n);
+
+/** Compute value[] for the next packet and advance the odometer. */
+void field_var_next(field_var_state_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_FIELD_VAR_H */
@@ -18,6 +18,8 @@
 #include <inttypes.h>
 
 struct rte_mempool *g_worker_mempools[TGEN_MAX_WORKERS];
+tgen_mbuf_stats_t   g_mbuf_stats[TGEN_MAX_WORKERS];
+tgen_mbuf_stash_t   g_mbuf_stash[TGEN_MAX_WORKERS];
 
 /* Try to create a mempool with 1 GB pages, then 2 MB, then 4 KB. */
 static struct rte_mempool *create_pool_with_fallback(const char *name,
@@ -96,6 +98,14 @@ int tgen_mempool_create_all(uint32_t num_rx_desc, uint32_t num_tx_desc,
     return 0;
 }
 
+void tgen_mbuf_stash_drain(uint32_t worker_idx)
+{
+    tgen_mbuf_stash_t *s = &g_mbuf_stash[worker_idx];
+    if (s->n)
+        rte_pktmbuf_free_bulk(s->m, s->n);
+    s->n = 0;
+}
+
 void tgen_mempool_destroy_all(void)
 {
     for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
@@ -1,10 +1,20 @@
 /* SPDX-License-Identifier: BSD-3-Clause
  * vaigAI: per-worker mempool factory (§1.2).
+ *
+ * Data-path mbufs are taken in bulk: the stateless generator allocates a
+ * whole burst with one tgen_mbuf_alloc_bulk() call, and the TCP stack pulls
+ * single segments from a per-worker stash that is refilled in bulk.  Each
+ * bulk request is classified as a hit when the lcore's mempool cache holds
+ * enough objects to serve it without touching the shared ring.
  */
 #ifndef TGEN_MEMPOOL_H
 #define TGEN_MEMPOOL_H
 
+#include <errno.h>
+
 #include <rte_mempool.h>
+#include <rte_mbuf.h>
+#include <rte_lcore.h>
 #include "../common/types.h"
 
 #ifdef __cplusplus
@@ -14,6 +24,69 @@ extern "C" {
 /** Per-worker mempool handle array (indexed by worker index). */
 extern struct rte_mempool *g_worker_mempools[TGEN_MAX_WORKERS];
 
+/** Mbufs held by a worker's single-segment stash. */
+#define TGEN_MBUF_STASH_SZ  32u
+
+/** Per-worker bulk allocation counters (written by the owning worker only). */
+typedef struct {
+    uint64_t bulk_reqs;     /* rte_pktmbuf_alloc_bulk() calls */
+    uint64_t bulk_mbufs;    /* mbufs obtained by successful bulk calls */
+    uint64_t cache_hits;    /* bulk calls served from the lcore cache */
+    uint64_t bulk_fail;     /* bulk calls the pool could not satisfy */
+    uint64_t stash_gets;    /* single mbufs handed out by the stash */
+} __rte_cache_aligned tgen_mbuf_stats_t;
+
+/** Per-worker stash of pre-allocated mbufs for the TCP TX path. */
+typedef struct {
+    struct rte_mbuf *m[TGEN_MBUF_STASH_SZ];
+    uint32_t         n;
+} __rte_cache_aligned tgen_mbuf_stash_t;
+
+extern tgen_mbuf_stats_t g_mbuf_stats[TGEN_MAX_WORKERS];
+extern tgen_mbuf_stash_t g_mbuf_stash[TGEN_MAX_WORKERS];
+
+/** Allocate n mbufs from mp in one call, all or nothing.
+ *  Returns 0 on success or -ENOENT when the pool is short. */
+static inline int
+tgen_mbuf_alloc_bulk(uint32_t worker_idx, struct rte_mempool *mp,
+                     struct rte_mbuf **pkts, unsigned int n)
+{
+    tgen_mbuf_stats_t *st = &g_mbuf_stats[worker_idx];
+    struct rte_mempool_cache *c = rte_mempool_default_cache(mp, rte_lcore_id());
+
+    st->bulk_reqs++;
+    if (c && n <= c->len)
+        st->cache_hits++;
+    if (unlikely(rte_pktmbuf_alloc_bulk(mp, pkts, n) != 0)) {
+        st->bulk_fail++;
+        return -ENOENT;
+    }
+    st->bulk_mbufs += n;
+    return 0;
+}
+
+/** Take one mbuf from the worker's stash, refilling it in bulk from the
+ *  worker's mempool when empty.  Falls back to a single allocation when
+ *  the pool is too low for a full refill.  Returns NULL on exhaustion. */
+static inline struct rte_mbuf *
+tgen_mbuf_stash_get(uint32_t worker_idx)
+{
+    tgen_mbuf_stash_t *s = &g_mbuf_stash[worker_idx];
+
+    if (unlikely(s->n == 0)) {
+        struct rte_mempool *mp = g_worker_mempools[worker_idx];
+        if (tgen_mbuf_alloc_bulk(worker_idx, mp, s->m,
+                                 TGEN_MBUF_STASH_SZ) != 0)
+            return rte_pktmbuf_alloc(mp);
+        s->n = TGEN_MBUF_STASH_SZ;
+    }
+    g_mbuf_stats[worker_idx].stash_gets++;
+    return s->m[--s->n];
+}
+
+/** Return the stashed mbufs of a worker to its pool (worker exit). */
+void tgen_mbuf_stash_drain(uint32_t worker_idx);
+
 /** Create per-worker mempools.
  *  @param num_rx_desc  RX descriptors per queue
  *  @param num_tx_desc  TX descriptors per queue
@@ -0,0 +1,644 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: pcap / pcapng replay — capture parsing and preload.
+ *
+ * Two passes over the mapped file: the first validates it and counts each
+ * generator's frames, the second copies them into mbufs.  The send side
+ * is in tx_gen.c (pcap_burst()).  The reader is shared with the L7
+ * replay compiler (app/l7_replay.c).
+ */
+#include "pcap_replay.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+
+#include "../common/util.h"
+#include "../telemetry/log.h"
+#include "core_assign.h"
+#include "worker_loop.h"
+
+pcap_replay_t *g_pcap_replays[TGEN_MAX_CLIENT_FLOWS];
+
+/* Released pools whose mbufs a TX ring may still hold */
+#define PCAP_RETIRED_MAX  (2 * TGEN_MAX_CLIENT_FLOWS)
+static struct rte_mempool *g_retired[PCAP_RETIRED_MAX];
+
+#define PCAP_MAGIC_US     0xA1B2C3D4u
+#define PCAP_MAGIC_NS     0xA1B23C4Du
+#define PCAPNG_SHB        0x0A0D0D0Au
+#define PCAPNG_IDB        0x00000001u
+#define PCAPNG_SPB        0x00000003u
+#define PCAPNG_EPB        0x00000006u
+#define PCAPNG_BOM        0x1A2B3C4Du
+#define LINKTYPE_ETHERNET 1u
+
+/* ── Capture reader ───────────────────────────────────────────────────────── */
+
+static inline uint16_t
+rd16(const pcap_reader_t *r, const uint8_t *p)
+{
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return r->swap ? rte_bswap16(v) : v;
+}
+
+static inline uint32_t
+rd32(const pcap_reader_t *r, const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return r->swap ? rte_bswap32(v) : v;
+}
+
+static uint64_t
+units_to_ns(uint64_t ts, uint64_t hz)
+{
+    if (hz == 1000000000ULL)
+        return ts;
+    return ts / hz * 1000000000ULL +
+           (uint64_t)((double)(ts % hz) * 1e9 / (double)hz);
+}
+
+int
+pcap_reader_open(pcap_reader_t *r, const uint8_t *base, size_t len)
+{
+    memset(r, 0, sizeof(*r));
+    r->p   = base;
+    r->end = base + len;
+    if (len < 24)
+        return -EINVAL;
+    uint32_t magic;
+    memcpy(&magic, base, sizeof(magic));
+    if (magic == PCAPNG_SHB) {
+        r->ng = true;           /* the SHB is parsed as the first block */
+        return 0;
+    }
+    if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+        r->swap = false;
+    } else if (rte_bswap32(magic) == PCAP_MAGIC_US ||
+               rte_bswap32(magic) == PCAP_MAGIC_NS) {
+        r->swap = true;
+        magic   = rte_bswap32(magic);
+    } else {
+        return -EINVAL;
+    }
+    r->pcap_ns   = magic == PCAP_MAGIC_NS ? 1 : 1000;
+    r->pcap_link = rd32(r, base + 20) & 0x0FFFFFFF;
+    r->p        += 24;
+    return 0;
+}
+
+/* pcapng if_tsresol option (code 9) of an IDB: units per second. */
+static uint64_t
+idb_tsresol(const pcap_reader_t *r, const uint8_t *opt, const uint8_t *end)
+{
+    while (opt + 4 <= end) {
+        uint16_t code = rd16(r, opt);
+        uint16_t olen = rd16(r, opt + 2);
+        if (code == 0 || opt + 4 + olen > end)
+            break;
+        if (code == 9 && olen >= 1) {
+            uint8_t v = opt[4];
+            uint32_t e = v & 0x7F;
+            uint64_t hz = 1;
+            if (v & 0x80) {
+                if (e > 63)
+                    return 0;
+                hz <<= e;
+            } else {
+                if (e > 19)
+                    return 0;
+                while (e--)
+                    hz *= 10;
+            }
+            return hz;
+        }
+        opt += 4 + ((olen + 3u) & ~3u);
+    }
+    return 1000000;
+}
+
+/* Next record: 1, 0 at the end, or -EINVAL. */
+static int
+reader_next_pcap(pcap_reader_t *r, pcap_rec_t *rec)
+{
+    if (r->p == r->end)
+        return 0;
+    if (r->end - r->p < 16)
+        return -EINVAL;
+    uint32_t sec  = rd32(r, r->p);
+    uint32_t frac = rd32(r, r->p + 4);
+    rec->caplen   = rd32(r, r->p + 8);
+    rec->origlen  = rd32(r, r->p + 12);
+    if (rec->caplen > (size_t)(r->end - r->p - 16))
+        return -EINVAL;
+    rec->data  = r->p + 16;
+    rec->ts_ns = (uint64_t)sec * 1000000000ULL + (uint64_t)frac * r->pcap_ns;
+    rec->eth   = r->pcap_link == LINKTYPE_ETHERNET;
+    r->p += 16 + rec->caplen;
+    return 1;
+}
+
+static int
+reader_next_ng(pcap_reader_t *r, pcap_rec_t *rec)
+{
+    while (r->p != r->end) {
+        if (r->end - r->p < 12)
+            return -EINVAL;
+        uint32_t type;
+        memcpy(&type, r->p, sizeof(type));
+        if (type == PCAPNG_SHB) {
+            uint32_t bom;
+            memcpy(&bom, r->p + 8, sizeof(bom));
+            if (bom == PCAPNG_BOM)
+                r->swap = false;
+            else if (rte_bswap32(bom) == PCAPNG_BOM)
+                r->swap = true;
+            else
+                return -EINVAL;
+            r->n_if = 0;        /* interface ids are per section */
+        } else {
+            type = rd32(r, r->p);
+        }
+        uint32_t blen = rd32(r, r->p + 4);
+        if (blen < 12 || (blen & 3) || blen > (size_t)(r->end - r->p))
+            return -EINVAL;
+        const uint8_t *b   = r->p;
+        const uint8_t *end = b + blen - 4;
+        r->p += blen;
+
+        if (type == PCAPNG_IDB) {
+            if (blen < 20)
+                return -EINVAL;
+            if (r->n_if < PCAPNG_IF_MAX) {
+                r->if_link[r->n_if] = rd16(r, b + 8);
+                r->if_hz[r->n_if]   = idb_tsresol(r, b + 16, end);
+                if (r->if_hz[r->n_if] == 0)
+                    return -EINVAL;
+            }
+            r->n_if++;
+        } else if (type == PCAPNG_EPB) {
+            if (blen < 32)
+                return -EINVAL;
+            uint32_t ifc = rd32(r, b + 8);
+            uint64_t ts  = ((uint64_t)rd32(r, b + 12) << 32) | rd32(r, b + 16);
+            rec->caplen  = rd32(r, b + 20);
+            rec->origlen = rd32(r, b + 24);
+            if (rec->caplen > (size_t)(end - b - 28))
+                return -EINVAL;
+            if (ifc >= r->n_if || ifc >= PCAPNG_IF_MAX)
+                return -EINVAL;
+            rec->data  = b + 28;
+            rec->ts_ns = r->last_ns = units_to_ns(ts, r->if_hz[ifc]);
+            rec->eth   = r->if_link[ifc] == LINKTYPE_ETHERNET;
+            return 1;
+        } else if (type == PCAPNG_SPB) {
+            if (blen < 16 || r->n_if == 0)
+                return -EINVAL;
+            rec->origlen = rd32(r, b + 8);
+            rec->caplen  = (uint32_t)(end - b - 12);
+            if (rec->caplen > rec->origlen)
+                rec->caplen = rec->origlen;
+            rec->data  = b + 12;
+            rec->ts_ns = r->last_ns;
+            rec->eth   = r->if_link[0] == LINKTYPE_ETHERNET;
+            return 1;
+        }
+        /* Other blocks (NRB, ISB, custom …) carry no frames */
+    }
+    return 0;
+}
+
+int
+pcap_reader_next(pcap_reader_t *r, pcap_rec_t *rec)
+{
+    return r->ng ? reader_next_ng(r, rec) : reader_next_pcap(r, rec);
+}
+
+/* ── Frame inspection ─────────────────────────────────────────────────────── */
+
+uint32_t
+pcap_l2_type_off(const uint8_t *f, uint32_t len)
+{
+    uint32_t off = 12;
+    while (off + 6 <= len) {
+        uint16_t t = (uint16_t)(f[off] << 8 | f[off + 1]);
+        if (t != RTE_ETHER_TYPE_VLAN && t != RTE_ETHER_TYPE_QINQ)
+            break;
+        off += 4;
+    }
+    return off;
+}
+
+static inline uint32_t
+fmix32(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline uint32_t
+ld32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint16_t
+ld16(const uint8_t *p)
+{
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Symmetric flow hash: both directions of a 5-tuple (or a MAC pair for
+ * non-IP frames) hash alike, so they share a TX queue. */
+static uint32_t
+frame_hash(const uint8_t *f, uint32_t len)
+{
+    uint32_t off = pcap_l2_type_off(f, len);
+    uint16_t type = off + 2 <= len ? (uint16_t)(f[off] << 8 | f[off + 1]) : 0;
+    const uint8_t *l3 = f + off + 2;
+    uint32_t room = len > off + 2 ? len - off - 2 : 0;
+    uint32_t h = 0, ports = 0;
+    uint8_t  proto = 0;
+    const uint8_t *l4 = NULL;
+
+    if (type == RTE_ETHER_TYPE_IPV4 && room >= 20) {
+        uint32_t ihl = (l3[0] & 0x0F) * 4u;
+        proto = l3[9];
+        h = ld32(l3 + 12) ^ ld32(l3 + 16);
+        bool first = (rte_be_to_cpu_16(ld16(l3 + 6)) & 0x1FFF) == 0;
+        bool more  = (l3[6] & 0x20) != 0;
+        /* Fragments of a datagram carry no ports: leave them out of all
+         * of its fragments so they stay together. */
+        if (first && !more && ihl >= 20 && room >= ihl + 4)
+            l4 = l3 + ihl;
+    } else if (type == RTE_ETHER_TYPE_IPV6 && room >= 40) {
+        proto = l3[6];
+        for (uint32_t i = 8; i < 40; i += 4)
+            h ^= ld32(l3 + i);
+        if (room >= 44)
+            l4 = l3 + 40;
+    } else {
+        return fmix32(ld32(f) ^ ld32(f + 6) ^
+                      (uint32_t)(ld16(f + 4) ^ ld16(f + 10)));
+    }
+    if (l4 && (proto == IPPROTO_TCP || proto == IPPROTO_UDP ||
+               proto == IPPROTO_SCTP))
+        ports = (uint32_t)(ld16(l4) ^ ld16(l4 + 2));
+    return fmix32(h ^ (ports * 0x9E3779B1u) ^ proto);
+}
+
+/* RFC 1624 eqn. 3 for a 32-bit field of a checksummed header. */
+static void
+cksum_patch32(uint8_t *ck, uint32_t old_v, uint32_t new_v, bool udp)
+{
+    uint16_t c = ld16(ck);
+    if (udp && c == 0)
+        return;                 /* no UDP checksum: stays none */
+    uint32_t acc = (uint16_t)~c;
+    acc += (uint16_t)~(old_v >> 16) + (new_v >> 16);
+    acc += (uint16_t)~(old_v & 0xFFFF) + (new_v & 0xFFFF);
+    acc  = (acc & 0xFFFF) + (acc >> 16);
+    acc  = (acc & 0xFFFF) + (acc >> 16);
+    c = (uint16_t)~acc;
+    if (udp && c == 0)
+        c = 0xFFFF;
+    memcpy(ck, &c, sizeof(c));
+}
+
+/* Map the IPv4 source and destination; returns true if either changed. */
+static bool
+rewrite_ip(uint8_t *f, uint32_t len, const pcap_replay_opts_t *o)
+{
+    uint32_t off = pcap_l2_type_off(f, len);
+    if (off + 2 + 20 > len ||
+        (uint16_t)(f[off] << 8 | f[off + 1]) != RTE_ETHER_TYPE_IPV4)
+        return false;
+    uint8_t *ip  = f + off + 2;
+    uint32_t ihl = (ip[0] & 0x0F) * 4u;
+    uint32_t room = len - off - 2;
+    bool first = (rte_be_to_cpu_16(ld16(ip + 6)) & 0x1FFF) == 0;
+    uint8_t *l4ck = NULL;
+    bool udp = false;
+    if (first && ihl >= 20) {
+        if (ip[9] == IPPROTO_TCP && room >= ihl + 18)
+            l4ck = ip + ihl + 16;
+        else if (ip[9] == IPPROTO_UDP && room >= ihl + 8) {
+            l4ck = ip + ihl + 6;
+            udp  = true;
+        }
+    }
+
+    bool changed = false;
+    for (uint32_t a = 12; a <= 16; a += 4) {
+        uint32_t v = ld32(ip + a);
+        for (uint32_t k = 0; k < o->n_maps; k++) {
+            if (v != o->map_from[k])
+                continue;
+            memcpy(ip + a, &o->map_to[k], 4);
+            cksum_patch32(ip + 10, v, o->map_to[k], false);
+            if (l4ck)           /* pseudo-header */
+                cksum_patch32(l4ck, v, o->map_to[k], udp);
+            changed = true;
+            break;
+        }
+    }
+    return changed;
+}
+
+/* ── Map parsing ──────────────────────────────────────────────────────────── */
+
+int
+pcap_replay_parse_map(const char *spec, pcap_replay_opts_t *o)
+{
+    char buf[512];
+    if (strlen(spec) >= sizeof(buf))
+        return -EINVAL;
+    strcpy(buf, spec);
+    char *save = NULL;
+    for (char *t = strtok_r(buf, ",", &save); t;
+         t = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(t, '=');
+        if (!eq || o->n_maps == PCAP_REPLAY_MAX_MAPS)
+            return -EINVAL;
+        *eq = '\0';
+        if (tgen_parse_ipv4(t, &o->map_from[o->n_maps]) < 0 ||
+            tgen_parse_ipv4(eq + 1, &o->map_to[o->n_maps]) < 0)
+            return -EINVAL;
+        o->n_maps++;
+    }
+    return 0;
+}
+
+/* ── Slots ────────────────────────────────────────────────────────────────── */
+
+static void
+retired_reap(void)
+{
+    for (uint32_t i = 0; i < PCAP_RETIRED_MAX; i++) {
+        if (g_retired[i] && rte_mempool_full(g_retired[i])) {
+            rte_mempool_free(g_retired[i]);
+            g_retired[i] = NULL;
+        }
+    }
+}
+
+static void
+slot_free(pcap_replay_t *pr)
+{
+    for (uint32_t g = 0; g < TGEN_MAX_WORKERS; g++) {
+        pcap_replay_q_t *q = &pr->q[g];
+        for (uint32_t i = 0; i < q->n; i++)
+            rte_pktmbuf_free(q->m[i]);      /* drops our reference */
+        rte_free(q->m);
+        rte_free(q->due);
+    }
+    if (pr->mp) {
+        /* A TX ring may not have recycled the last frames yet */
+        uint32_t i = 0;
+        while (i < PCAP_RETIRED_MAX && g_retired[i])
+            i++;
+        if (i < PCAP_RETIRED_MAX)
+            g_retired[i] = pr->mp;
+        else
+            TGEN_WARN(TGEN_LOG_MGMT, "pcap: leaking pool %s\n", pr->mp->name);
+    }
+    memset(pr, 0, sizeof(*pr));
+    retired_reap();
+}
+
+void
+pcap_replay_release(uint32_t flow_idx)
+{
+    if (flow_idx < TGEN_MAX_CLIENT_FLOWS && g_pcap_replays[flow_idx])
+        slot_free(g_pcap_replays[flow_idx]);
+    else
+        retired_reap();
+}
+
+bool
+pcap_replay_done(uint32_t flow_idx)
+{
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS || !g_pcap_replays[flow_idx])
+        return false;
+    const pcap_replay_t *pr = g_pcap_replays[flow_idx];
+    return pr->busy > 0 &&
+           __atomic_load_n(&pr->done, __ATOMIC_ACQUIRE) >= pr->busy;
+}
+
+/* Generator ranks on the port, as in the START rate split of a stateless
+ * flow. */
+static uint32_t
+port_ranks(uint16_t port_id, uint16_t *ranks)
+{
+    uint32_t n = 0;
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++) {
+        const worker_ctx_t *ctx = &g_worker_ctx[w];
+        for (uint32_t pp = 0; pp < ctx->num_ports; pp++)
+            if (ctx->ports[pp] == port_id)
+                ranks[n++] = ctx->port_rank[pp];
+    }
+    return n;
+}
+
+/* ── Load ─────────────────────────────────────────────────────────────────── */
+
+static inline bool
+rec_usable(const pcap_rec_t *rec)
+{
+    return rec->eth && rec->caplen >= RTE_ETHER_HDR_LEN &&
+           rec->caplen <= PCAP_REPLAY_FRAME_MAX;
+}
+
+static int
+preload(pcap_replay_t *pr, uint32_t flow_idx, const uint8_t *base,
+        size_t len, const pcap_replay_opts_t *o)
+{
+    uint16_t ranks[TGEN_MAX_WORKERS];
+    uint32_t n_gen = port_ranks(o->port_id, ranks);
+    if (n_gen == 0)
+        return -ENODEV;
+
+    /* Pass 1: validate, count per generator, time span */
+    pcap_reader_t r;
+    pcap_rec_t rec;
+    uint32_t cnt[TGEN_MAX_WORKERS] = {0};
+    uint64_t t_min = UINT64_MAX, t_max = 0, total = 0;
+    uint32_t max_len = 0;
+    int rc;
+    if (pcap_reader_open(&r, base, len) < 0) {
+        TGEN_ERR(TGEN_LOG_MGMT, "pcap: %s: not a pcap or pcapng file\n",
+                 o->path);
+        return -EINVAL;
+    }
+    pr->info.pcapng = r.ng;
+    while ((rc = pcap_reader_next(&r, &rec)) > 0) {
+        if (!rec_usable(&rec)) {
+            pr->info.skipped++;
+            continue;
+        }
+        if (++total > PCAP_REPLAY_MAX_PKTS)
+            return -E2BIG;
+        cnt[ranks[frame_hash(rec.data, rec.caplen) % n_gen]]++;
+        if (rec.ts_ns < t_min) t_min = rec.ts_ns;
+        if (rec.ts_ns > t_max) t_max = rec.ts_ns;
+        if (rec.caplen > max_len) max_len = rec.caplen;
+    }
+    if (rc < 0) {
+        TGEN_ERR(TGEN_LOG_MGMT, "pcap: %s: malformed at offset %zu\n",
+                 o->path, (size_t)(r.p - base));
+        return -EINVAL;
+    }
+    if (total == 0) {
+        TGEN_ERR(TGEN_LOG_MGMT, "pcap: %s: no Ethernet frames\n", o->path);
+        return -EINVAL;
+    }
+
+    char name[RTE_MEMPOOL_NAMESIZE];
+    snprintf(name, sizeof(name), "pcap_%u_%" PRIx64, flow_idx, rte_rdtsc());
+    pr->mp = rte_pktmbuf_pool_create(name, (uint32_t)total, 0, 0,
+                                     (uint16_t)(RTE_PKTMBUF_HEADROOM + max_len),
+                                     rte_eth_dev_socket_id(o->port_id));
+    if (!pr->mp) {
+        TGEN_ERR(TGEN_LOG_MGMT, "pcap: pool of %" PRIu64 " x %u B: %s\n",
+                 total, max_len, rte_strerror(rte_errno));
+        return -ENOMEM;
+    }
+
+    /* Timing: offsets from the earliest frame; a pass lasts the span plus
+     * one mean gap so the loop seam looks like any other gap. */
+    uint64_t hz   = rte_get_tsc_hz();
+    double   span = (double)(t_max - t_min);
+    double   scale = o->speed > 0 ? (double)hz / 1e9 / o->speed : 0;
+    if (o->speed > 0)
+        pr->period = (uint64_t)((span + (total > 1 ? span / (total - 1) : 1e6)) *
+                                scale) + 1;
+    pr->info.span_s = span / 1e9;
+
+    for (uint32_t g = 0; g < TGEN_MAX_WORKERS; g++) {
+        if (cnt[g] == 0)
+            continue;
+        pcap_replay_q_t *q = &pr->q[g];
+        int sock = rte_eth_dev_socket_id(o->port_id);
+        q->m = rte_zmalloc_socket("pcap_q", cnt[g] * sizeof(*q->m), 0, sock);
+        if (o->speed > 0)
+            q->due = rte_zmalloc_socket("pcap_due", cnt[g] * sizeof(uint64_t),
+                                        0, sock);
+        if (!q->m || (o->speed > 0 && !q->due))
+            return -ENOMEM;
+        pr->busy++;
+    }
+    pr->info.generators = pr->busy;
+
+    /* Pass 2: copy and rewrite.  Within a queue the due times never go
+     * backwards — a frame can't leave before the one ahead of it. */
+    pcap_reader_open(&r, base, len);
+    while (pcap_reader_next(&r, &rec) > 0) {
+        if (!rec_usable(&rec))
+            continue;
+        pcap_replay_q_t *q = &pr->q[ranks[frame_hash(rec.data, rec.caplen) %
+                                         n_gen]];
+        struct rte_mbuf *m = rte_pktmbuf_alloc(pr->mp);
+        if (!m)
+            return -ENOMEM;
+        uint8_t *f = (uint8_t *)rte_pktmbuf_append(m, (uint16_t)rec.caplen);
+        memcpy(f, rec.data, rec.caplen);
+        if (o->rewrite_mac) {
+            struct rte_ether_hdr *eth = (struct rte_ether_hdr *)f;
+            rte_ether_addr_copy(&o->dst_mac, &eth->dst_addr);
+            rte_ether_addr_copy(&o->src_mac, &eth->src_addr);
+        }
+        if (o->n_maps && rewrite_ip(f, rec.caplen, o))
+            pr->info.rewritten++;
+        if (rec.caplen < rec.origlen)
+            pr->info.truncated++;
+        if (q->due) {
+            uint64_t d = (uint64_t)((double)(rec.ts_ns - t_min) * scale);
+            if (q->n && d < q->due[q->n - 1])
+                d = q->due[q->n - 1];
+            q->due[q->n] = d;
+        }
+        q->m[q->n++] = m;
+        pr->info.pkts++;
+        pr->info.bytes += rec.caplen;
+    }
+    return 0;
+}
+
+int
+pcap_file_map(const char *path, const uint8_t **base, size_t *len)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -errno;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return -EINVAL;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -errno;
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *base = p;
+    *len  = (size_t)st.st_size;
+    return 0;
+}
+
+void
+pcap_file_unmap(const uint8_t *base, size_t len)
+{
+    munmap((void *)(uintptr_t)base, len);
+}
+
+int
+pcap_replay_load(uint32_t flow_idx, const pcap_replay_opts_t *o)
+{
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS)
+        return -EINVAL;
+    /* The slot is kept once allocated: a stopping flow's generators may
+     * still hold it. */
+    if (!g_pcap_replays[flow_idx])
+        g_pcap_replays[flow_idx] = rte_zmalloc("pcap_replay",
+                                               sizeof(pcap_replay_t),
+                                               RTE_CACHE_LINE_SIZE);
+    pcap_replay_t *pr = g_pcap_replays[flow_idx];
+    if (!pr)
+        return -ENOMEM;
+    slot_free(pr);
+
+    const uint8_t *base;
+    size_t len;
+    int rc = pcap_file_map(o->path, &base, &len);
+    if (rc < 0)
+        return rc;
+    rc = preload(pr, flow_idx, base, len, o);
+    pcap_file_unmap(base, len);
+    if (rc < 0) {
+        slot_free(pr);
+        return rc;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: pcap / pcapng replay (TX_GEN_PROTO_PCAP).
+ *
+ * `start --proto pcap --pcap <file>` memory-maps a capture on the
+ * management lcore and copies every Ethernet frame once into an mbuf of a
+ * pool sized for the file.  Frames are partitioned over the port's
+ * generators by a symmetric hash of the IP 5-tuple (MAC pair for non-IP),
+ * so both directions of a flow land in one TX queue and keep their order.
+ * Optional rewrites (src/dst MAC, IPv4 address map with checksum fix-up)
+ * are applied while copying.
+ *
+ * Workers then only reference their share — refcnt bumped per send, as
+ * with the replay ring — with no file I/O or copies while running:
+ *
+ *   timed     each frame leaves at its capture offset / --speed, every
+ *             pass one capture span (plus a mean gap) after the last
+ *   untimed   --speed max: back to back, or at --rate / --bps
+ *
+ * Like the other per-flow side data, g_pcap_replays[flow_idx] is written
+ * before the START IPC and released after the flow stops.
+ */
+#ifndef TGEN_PCAP_REPLAY_H
+#define TGEN_PCAP_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCAP_REPLAY_MAX_PKTS   (1u << 24)  /* frames per load             */
+#define PCAP_REPLAY_FRAME_MAX  9600u       /* larger frames are skipped   */
+#define PCAP_REPLAY_MAX_MAPS   16u         /* --rewrite-ip pairs          */
+#define PCAPNG_IF_MAX          64u         /* interfaces per section      */
+
+/* ── Capture reader ───────────────────────────────────────────────────────── */
+
+/* Cursor over a mapped pcap or pcapng file. */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool           ng;
+    bool           swap;
+    uint64_t       pcap_ns;     /* pcap: ns per fraction unit            */
+    uint32_t       pcap_link;
+    uint32_t       n_if;        /* pcapng: interfaces of the section     */
+    uint16_t       if_link[PCAPNG_IF_MAX];
+    uint64_t       if_hz[PCAPNG_IF_MAX];   /* timestamp units per second */
+    uint64_t       last_ns;     /* for blocks without a timestamp        */
+} pcap_reader_t;
+
+/* One captured frame; data points into the mapping. */
+typedef struct {
+    const uint8_t *data;
+    uint32_t       caplen;
+    uint32_t       origlen;
+    uint64_t       ts_ns;
+    bool           eth;
+} pcap_rec_t;
+
+/** Map a capture read-only.  Returns 0, -errno on open/mmap, or -EINVAL
+ *  for an empty file. */
+int pcap_file_map(const char *path, const uint8_t **base, size_t *len);
+
+void pcap_file_unmap(const uint8_t *base, size_t len);
+
+/** Start reading at the file header.  Returns 0 or -EINVAL. */
+int pcap_reader_open(pcap_reader_t *r, const uint8_t *base, size_t len);
+
+/** Next frame: 1, 0 at the end, or -EINVAL for a malformed block. */
+int pcap_reader_next(pcap_reader_t *r, pcap_rec_t *rec);
+
+/** Offset of the EtherType after any 802.1Q / 802.1ad tags. */
+uint32_t pcap_l2_type_off(const uint8_t *f, uint32_t len);
+
+/* ── Replay ───────────────────────────────────────────────────────────────── */
+
+/* One generator's share, in capture order. */
+typedef struct {
+    struct rte_mbuf **m;
+    uint64_t         *due;      /* TSC cycles into a pass; NULL untimed  */
+    uint32_t          n;
+} pcap_replay_q_t;
+
+/* What a load found, for the start banner and the result. */
+typedef struct {
+    uint64_t pkts;
+    uint64_t bytes;             /* frames as sent, no FCS                */
+    uint64_t skipped;           /* not Ethernet, runt or over FRAME_MAX  */
+    uint64_t truncated;         /* captured short of the wire length     */
+    uint64_t rewritten;         /* frames changed by an IPv4 map         */
+    double   span_s;            /* first to last timestamp               */
+    uint32_t generators;        /* TX queues the frames were spread over */
+    bool     pcapng;
+} pcap_replay_info_t;
+
+typedef struct {
+    struct rte_mempool *mp;     /* NULL = slot empty                     */
+    uint64_t            period; /* TSC cycles per pass; 0 = untimed      */
+    uint32_t            busy;   /* generators with frames                */
+    uint32_t            done;   /* of which finished --loops (atomic)    */
+    pcap_replay_info_t  info;
+    pcap_replay_q_t     q[TGEN_MAX_WORKERS];   /* by rank on the port    */
+} pcap_replay_t;
+
+/** Per-flow captures, loaded by the CLI before CFG_CMD_START (NULL
+ *  until the slot first replays one). */
+extern pcap_replay_t *g_pcap_replays[TGEN_MAX_CLIENT_FLOWS];
+
+/** Load options. */
+typedef struct {
+    const char           *path;
+    uint16_t              port_id;
+    double                speed;        /* × capture timing, 0 = untimed */
+    bool                  rewrite_mac;  /* src/dst MAC := these          */
+    struct rte_ether_addr src_mac;
+    struct rte_ether_addr dst_mac;
+    uint32_t              n_maps;
+    uint32_t              map_from[PCAP_REPLAY_MAX_MAPS]; /* network order */
+    uint32_t              map_to[PCAP_REPLAY_MAX_MAPS];
+} pcap_replay_opts_t;
+
+/**
+ * Append "<old>=<new>[,<old>=<new>…]" IPv4 pairs to o->map_*.
+ * Returns 0 or -EINVAL.
+ */
+int pcap_replay_parse_map(const char *spec, pcap_replay_opts_t *o);
+
+/**
+ * Map, parse and preload a capture into g_pcap_replays[flow_idx],
+ * replacing what the slot held (management lcore, flow stopped).
+ * Returns 0, -ENOENT/-EACCES on open, -EINVAL for a malformed or empty
+ * capture, -E2BIG past PCAP_REPLAY_MAX_PKTS, or -ENOMEM.
+ */
+int pcap_replay_load(uint32_t flow_idx, const pcap_replay_opts_t *o);
+
+/** Drop a slot's frames once its flow has stopped.  Pools still
+ *  referenced by a TX ring are freed on a later call. */
+void pcap_replay_release(uint32_t flow_idx);
+
+/** @return true once every generator of the flow finished its --loops. */
+bool pcap_replay_done(uint32_t flow_idx);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_PCAP_REPLAY_H */
@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: rate schedules — parsing and compilation to TSC segments.
+ *
+ * The schedule clock and the exponential draws used per burst are inline
+ * in rate_sched.h; the bucket refills that use them live in tx_gen.c.
+ */
+#include "rate_sched.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <math.h>
+
+#include <rte_malloc.h>
+
+rate_sched_t *g_rate_scheds[TGEN_MAX_CLIENT_FLOWS];
+float        g_rate_sched_exp[RATE_SCHED_EXP_N];
+
+#define RATE_SCHED_DUR_MAX_S  (30.0 * 86400)
+
+rate_sched_t *
+rate_sched_slot(uint32_t flow_idx)
+{
+    if (!g_rate_scheds[flow_idx])
+        g_rate_scheds[flow_idx] = rte_zmalloc("rate_sched",
+                                              sizeof(rate_sched_t), 0);
+    return g_rate_scheds[flow_idx];
+}
+
+/* ── Parsing ──────────────────────────────────────────────────────────────── */
+
+/* "<n>[us|ms|s|m|h]" → TSC cycles, at least one microsecond. */
+static int
+parse_dur(const char *s, char **end, uint64_t hz, uint64_t *out)
+{
+    double v = strtod(s, end);
+    if (*end == s || !(v > 0))
+        return -EINVAL;
+    double mult = 1.0;
+    if (strncmp(*end, "us", 2) == 0) {
+        mult = 1e-6;
+        *end += 2;
+    } else if (strncmp(*end, "ms", 2) == 0) {
+        mult = 1e-3;
+        *end += 2;
+    } else if (**end == 's') {
+        (*end)++;
+    } else if (**end == 'm') {
+        mult = 60.0;
+        (*end)++;
+    } else if (**end == 'h') {
+        mult = 3600.0;
+        (*end)++;
+    }
+    double secs = v * mult;
+    if (secs < 1e-6 || secs > RATE_SCHED_DUR_MAX_S)
+        return -EINVAL;
+    *out = (uint64_t)llround(secs * (double)hz);
+    return *out > 0 ? 0 : -EINVAL;
+}
+
+/* "<pct>[%]", 0-100 → fraction. */
+static int
+parse_level(const char *s, char **end, float *out)
+{
+    double v = strtod(s, end);
+    if (*end == s || v < 0 || v > 100)
+        return -EINVAL;
+    if (**end == '%')
+        (*end)++;
+    *out = (float)(v / 100.0);
+    return 0;
+}
+
+static int
+add_seg(rate_sched_t *s, uint64_t dur, float lo, float hi)
+{
+    if (s->n == RATE_SCHED_MAX)
+        return -EINVAL;
+    rate_sched_seg_t *g = &s->seg[s->n++];
+    g->t    = s->period;
+    g->area = s->period_area;
+    g->lo   = lo;
+    g->hi   = hi;
+    s->period      += dur;
+    s->period_area += (uint64_t)((double)dur * (lo + hi) / 2.0);
+    return 0;
+}
+
+/* "<dur>@<lvl>[-<lvl>]" */
+static int
+parse_step(const char *t, uint64_t hz, rate_sched_t *s)
+{
+    char *end;
+    uint64_t dur;
+    float lo, hi;
+    if (parse_dur(t, &end, hz, &dur) < 0 || *end != '@' ||
+        parse_level(end + 1, &end, &lo) < 0)
+        return -EINVAL;
+    hi = lo;
+    if (*end == '-' && parse_level(end + 1, &end, &hi) < 0)
+        return -EINVAL;
+    return *end == '\0' ? add_seg(s, dur, lo, hi) : -EINVAL;
+}
+
+static int
+parse_steps(char *list, uint64_t hz, rate_sched_t *s)
+{
+    char *save = NULL;
+    for (char *t = strtok_r(list, ",", &save); t;
+         t = strtok_r(NULL, ",", &save))
+        if (parse_step(t, hz, s) < 0)
+            return -EINVAL;
+    return 0;
+}
+
+/* "<period>:<lo>-<hi>" */
+static int
+parse_sine(const char *a, uint64_t hz, rate_sched_t *s)
+{
+    char *end;
+    uint64_t period;
+    float lo, hi;
+    if (parse_dur(a, &end, hz, &period) < 0 || *end != ':' ||
+        parse_level(end + 1, &end, &lo) < 0 || *end != '-' ||
+        parse_level(end + 1, &end, &hi) < 0 || *end != '\0')
+        return -EINVAL;
+    if (period < RATE_SCHED_SINE_SEGS * (hz / 1000000))
+        return -EINVAL;
+    uint64_t prev = 0;
+    float    lprev = lo;
+    for (uint32_t k = 1; k <= RATE_SCHED_SINE_SEGS; k++) {
+        uint64_t t = period * k / RATE_SCHED_SINE_SEGS;
+        float    l = lo + (hi - lo) *
+                     (float)((1.0 - cos(2.0 * M_PI * k / RATE_SCHED_SINE_SEGS))
+                             / 2.0);
+        if (add_seg(s, t - prev, lprev, l) < 0)
+            return -EINVAL;
+        prev  = t;
+        lprev = l;
+    }
+    return 0;
+}
+
+/* "<on>:<off>[@<lvl>]" */
+static int
+parse_onoff(const char *a, uint64_t hz, rate_sched_t *s)
+{
+    char *end;
+    uint64_t on, off;
+    float lvl = 1.0f;
+    if (parse_dur(a, &end, hz, &on) < 0 || *end != ':' ||
+        parse_dur(end + 1, &end, hz, &off) < 0)
+        return -EINVAL;
+    if (*end == '@' && parse_level(end + 1, &end, &lvl) < 0)
+        return -EINVAL;
+    if (*end != '\0')
+        return -EINVAL;
+    if (add_seg(s, on, lvl, lvl) < 0 || add_seg(s, off, 0, 0) < 0)
+        return -EINVAL;
+    return 0;
+}
+
+int
+rate_sched_parse(const char *spec, uint64_t hz, rate_sched_t *s)
+{
+    char buf[256];
+    if (strlen(spec) >= sizeof(buf))
+        return -EINVAL;
+    memset(s, 0, sizeof(*s));
+    snprintf(s->spec, sizeof(s->spec), "%s", spec);
+    strcpy(buf, spec);
+
+    char *args = strchr(buf, ':');
+    if (!args)
+        return -EINVAL;
+    *args++ = '\0';
+
+    int rc;
+    if (strcmp(buf, "steps") == 0) {
+        rc = parse_steps(args, hz, s);
+    } else if (strcmp(buf, "cycle") == 0) {
+        s->loop = true;
+        rc = parse_steps(args, hz, s);
+    } else if (strcmp(buf, "sine") == 0) {
+        s->loop = true;
+        rc = parse_sine(args, hz, s);
+    } else if (strcmp(buf, "onoff") == 0) {
+        s->loop = true;
+        rc = parse_onoff(args, hz, s);
+    } else {
+        return -EINVAL;
+    }
+    if (rc < 0 || s->n == 0)
+        return -EINVAL;
+
+    /* End sentinel: the segment search and the hold level read it */
+    rate_sched_seg_t *g = &s->seg[s->n];
+    g->t    = s->period;
+    g->area = s->period_area;
+    g->lo   = s->seg[s->n - 1].hi;
+    g->hi   = g->lo;
+    return 0;
+}
+
+double
+rate_sched_mean(const rate_sched_t *s)
+{
+    return s->period ? (double)s->period_area / (double)s->period : 0;
+}
+
+/* ── Exponential draws ────────────────────────────────────────────────────── */
+
+/* Midpoint quantiles of Exponential(1), rescaled so the table mean is 1
+ * and the long-run arrival rate stays exact.  The tail is cut at
+ * ln(2N) ≈ 9 mean gaps. */
+void
+rate_sched_exp_init(void)
+{
+    if (g_rate_sched_exp[RATE_SCHED_EXP_N - 1] > 0)
+        return;
+    double sum = 0;
+    double q[RATE_SCHED_EXP_N];
+    for (uint32_t i = 0; i < RATE_SCHED_EXP_N; i++) {
+        q[i] = -log(1.0 - (i + 0.5) / RATE_SCHED_EXP_N);
+        sum += q[i];
+    }
+    double scale = RATE_SCHED_EXP_N / sum;
+    for (uint32_t i = 0; i < RATE_SCHED_EXP_N; i++)
+        g_rate_sched_exp[i] = (float)(q[i] * scale);
+}
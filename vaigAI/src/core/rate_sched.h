@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: time-series rate schedules (load profiles) for client flows.
+ *
+ * A schedule scales a flow's rate (--rate/--cps or --bps, the peak) by a
+ * level in [0, 1] that follows time since START:
+ *
+ *   steps:<dur>@<lvl>[-<lvl>],…   segments in order, then hold the last level
+ *   cycle:<dur>@<lvl>[-<lvl>],…   the same, repeated
+ *   sine:<period>:<lo>-<hi>       lo at t = 0, hi at period / 2, repeated
+ *   onoff:<on>:<off>[@<lvl>]      square wave, lvl (default 100%) then 0
+ *
+ * Durations take us, ms, s (default), m or h; levels are percent of the
+ * flow rate, "a-b" ramping linearly across the segment.  A sine is
+ * compiled into RATE_SCHED_SINE_SEGS linear segments.
+ *
+ * The CLI compiles the spec into TSC cycles in g_rate_scheds[flow_idx]
+ * before the START IPC (same hand-off as g_size_dists); workers evaluate
+ * it locally, with no IPC while the flow runs.  Rather than multiplying
+ * the rate at an instant, tx_gen runs its token buckets on the schedule
+ * clock: the integral of the level over time.  Credit earned across a
+ * segment boundary is therefore exact, down to microsecond ON/OFF periods.
+ *
+ * Independently of any schedule, `--arrivals poisson` replaces the even
+ * refill of the packet/connection bucket with exponential inter-arrival
+ * gaps drawn from g_rate_sched_exp[].
+ */
+#ifndef TGEN_RATE_SCHED_H
+#define TGEN_RATE_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+#include "../common/util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RATE_SCHED_MAX        64    /* segments per schedule             */
+#define RATE_SCHED_SINE_SEGS  32    /* linear segments per sine period   */
+#define RATE_SCHED_EXP_BITS   12
+#define RATE_SCHED_EXP_N      (1u << RATE_SCHED_EXP_BITS)
+
+typedef struct {
+    uint64_t t;         /* start, TSC cycles after START                 */
+    uint64_t area;      /* ∫ level over [0, t), in cycles                */
+    float    lo;        /* level at t                                    */
+    float    hi;        /* level at the next segment's t                 */
+} rate_sched_seg_t;
+
+typedef struct {
+    uint32_t         n;
+    bool             loop;
+    uint64_t         period;        /* = seg[n].t                        */
+    uint64_t         period_area;   /* = seg[n].area                     */
+    rate_sched_seg_t seg[RATE_SCHED_MAX + 1];   /* seg[n]: end sentinel  */
+    char             spec[64];      /* as given, for display             */
+} rate_sched_t;
+
+/** Per-flow schedules, written by the CLI before CFG_CMD_START
+ *  (NULL until the slot first uses one). */
+extern rate_sched_t *g_rate_scheds[TGEN_MAX_CLIENT_FLOWS];
+
+/** Management: the schedule slot of `flow_idx`, allocated on first use;
+ *  NULL when out of memory. */
+rate_sched_t *rate_sched_slot(uint32_t flow_idx);
+
+/** Exponential(1) quantiles, mean exactly 1 (rate_sched_exp_init()). */
+extern float g_rate_sched_exp[RATE_SCHED_EXP_N];
+
+/**
+ * Parse and compile a schedule for a TSC of `hz`.
+ * Returns 0 or -EINVAL.
+ */
+int rate_sched_parse(const char *spec, uint64_t hz, rate_sched_t *s);
+
+/** Mean level over one period (or the segments, for steps). */
+double rate_sched_mean(const rate_sched_t *s);
+
+/** Fill g_rate_sched_exp[]; idempotent, management lcore. */
+void rate_sched_exp_init(void);
+
+/**
+ * Schedule clock: ∫ level over [0, t) for `t` cycles after START.
+ * Past the end, a loop wraps and steps hold the last level.
+ */
+static inline uint64_t
+rate_sched_clock(const rate_sched_t *s, uint64_t t)
+{
+    uint64_t base = 0;
+    if (t >= s->period) {
+        if (!s->loop)
+            return s->period_area +
+                   (uint64_t)((double)(t - s->period) * s->seg[s->n - 1].hi);
+        base = t / s->period * s->period_area;
+        t   %= s->period;
+    }
+    uint32_t lo = 0, hi = s->n;     /* seg[lo].t <= t < seg[hi].t */
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        if (s->seg[mid].t <= t)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const rate_sched_seg_t *g = &s->seg[lo];
+    double x = (double)(t - g->t);
+    double d = (double)(s->seg[lo + 1].t - g->t);
+    return base + g->area +
+           (uint64_t)(x * (g->lo + (g->hi - g->lo) * x / (2.0 * d)));
+}
+
+/** One Exponential(1) draw from the calling lcore's PRNG. */
+static inline double
+rate_sched_exp_draw(void)
+{
+    return g_rate_sched_exp[tgen_rand64() >> (64 - RATE_SCHED_EXP_BITS)];
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_RATE_SCHED_H */
@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: frame-size distributions — parsing and schedule expansion.
+ *
+ * Frame cutting and checksum fix-up live with the builders in tx_gen.c.
+ */
+#include "size_dist.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <rte_malloc.h>
+
+#include "../common/util.h"
+
+size_dist_t *g_size_dists[TGEN_MAX_CLIENT_FLOWS];
+
+size_dist_t *
+size_dist_slot(uint32_t flow_idx)
+{
+    if (!g_size_dists[flow_idx])
+        g_size_dists[flow_idx] = rte_zmalloc("size_dist",
+                                             sizeof(size_dist_t), 0);
+    return g_size_dists[flow_idx];
+}
+
+#define SIZE_DIST_WEIGHT_MAX  1000000u
+
+/* ── Profiles ─────────────────────────────────────────────────────────────── */
+
+static const struct {
+    const char *name;
+    const char *spec;
+} k_profiles[] = {
+    /* Simple IMIX: 64, 570 and 1518-byte frames at 7:4:1 */
+    { "imix",       "64:7,570:4,1518:1" },
+    /* Tolly/Agilent IMIX: 55% 64, 5% 78, 17% 576, 23% 1518 */
+    { "imix-tolly", "64:55,78:5,576:17,1518:23" },
+};
+
+/* ── Parsing ──────────────────────────────────────────────────────────────── */
+
+static int
+parse_size(const char *s, char **end, uint16_t *out)
+{
+    unsigned long x = strtoul(s, end, 10);
+    if (*end == s || x < SIZE_DIST_FRAME_MIN || x > SIZE_DIST_FRAME_MAX)
+        return -EINVAL;
+    *out = (uint16_t)x;
+    return 0;
+}
+
+/* "<size>[:<weight>]" or "<lo>-<hi>[:<weight>]" */
+static int
+parse_entry(const char *s, size_dist_ent_t *e)
+{
+    char *end;
+    if (parse_size(s, &end, &e->lo) < 0)
+        return -EINVAL;
+    e->hi = e->lo;
+    if (*end == '-' && parse_size(end + 1, &end, &e->hi) < 0)
+        return -EINVAL;
+    if (e->hi < e->lo)
+        return -EINVAL;
+    e->weight = 1;
+    if (*end == ':') {
+        const char *w = end + 1;
+        unsigned long x = strtoul(w, &end, 10);
+        if (end == w || x == 0 || x > SIZE_DIST_WEIGHT_MAX)
+            return -EINVAL;
+        e->weight = (uint32_t)x;
+    }
+    return *end == '\0' ? 0 : -EINVAL;
+}
+
+int
+size_dist_parse(const char *spec, size_dist_t *d)
+{
+    char buf[256];
+    if (strlen(spec) >= sizeof(buf))
+        return -EINVAL;
+    memset(d, 0, sizeof(*d));
+    snprintf(d->spec, sizeof(d->spec), "%s", spec);
+
+    const char *list = spec;
+    for (uint32_t i = 0; i < TGEN_ARRAY_SIZE(k_profiles); i++) {
+        if (strcmp(spec, k_profiles[i].name) == 0) {
+            list = k_profiles[i].spec;
+            break;
+        }
+    }
+    strcpy(buf, list);
+
+    char *save = NULL;
+    for (char *t = strtok_r(buf, ",", &save); t;
+         t = strtok_r(NULL, ",", &save)) {
+        if (d->n == SIZE_DIST_MAX || parse_entry(t, &d->ent[d->n]) < 0)
+            return -EINVAL;
+        d->n++;
+    }
+    return d->n > 0 ? 0 : -EINVAL;
+}
+
+uint16_t
+size_dist_min(const size_dist_t *d)
+{
+    uint16_t m = UINT16_MAX;
+    for (uint32_t i = 0; i < d->n; i++)
+        if (d->ent[i].lo < m)
+            m = d->ent[i].lo;
+    return d->n ? m : 0;
+}
+
+uint16_t
+size_dist_max(const size_dist_t *d)
+{
+    uint16_t m = 0;
+    for (uint32_t i = 0; i < d->n; i++)
+        if (d->ent[i].hi > m)
+            m = d->ent[i].hi;
+    return m;
+}
+
+double
+size_dist_mean(const size_dist_t *d)
+{
+    double sum = 0, w = 0;
+    for (uint32_t i = 0; i < d->n; i++) {
+        sum += (d->ent[i].lo + d->ent[i].hi) / 2.0 * d->ent[i].weight;
+        w   += d->ent[i].weight;
+    }
+    return w > 0 ? sum / w : 0;
+}
+
+/* ── Schedule ─────────────────────────────────────────────────────────────── */
+
+/* Slots per entry for a schedule of `len`: floor shares, then the
+ * leftover slots to the largest remainders. */
+static void
+apportion(const size_dist_t *d, uint64_t wsum, uint32_t len,
+          uint32_t count[SIZE_DIST_MAX])
+{
+    uint64_t rem[SIZE_DIST_MAX];
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < d->n; i++) {
+        uint64_t x = (uint64_t)d->ent[i].weight * len;
+        count[i] = (uint32_t)(x / wsum);
+        rem[i]   = x % wsum;
+        used    += count[i];
+    }
+    for (; used < len; used++) {
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < d->n; i++)
+            if (rem[i] > rem[best])
+                best = i;
+        count[best]++;
+        rem[best] = 0;
+    }
+}
+
+uint32_t
+size_dist_schedule(const size_dist_t *d, uint16_t sub, uint16_t *sched,
+                   uint32_t seed)
+{
+    if (d->n == 0)
+        return 0;
+    uint64_t wsum = 0;
+    for (uint32_t i = 0; i < d->n; i++)
+        wsum += d->ent[i].weight;
+    uint32_t len = wsum <= SIZE_DIST_SCHED
+                 ? (uint32_t)(SIZE_DIST_SCHED / wsum * wsum) : SIZE_DIST_SCHED;
+
+    uint32_t count[SIZE_DIST_MAX];
+    apportion(d, wsum, len, count);
+
+    /* A range's slots take the midpoints of `c` equal slices of it. */
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < d->n; i++) {
+        const size_dist_ent_t *e = &d->ent[i];
+        uint64_t span = (uint64_t)e->hi - e->lo + 1;
+        for (uint32_t j = 0; j < count[i]; j++) {
+            uint32_t f = e->lo + (uint32_t)(span * (2 * j + 1) / (2 * count[i]));
+            sched[k++] = (uint16_t)(f - sub);
+        }
+    }
+
+    /* Fisher-Yates with xorshift32: spreads the sizes through the pass
+     * instead of sending runs of one size. */
+    uint32_t x = seed * 0x9E3779B9u + 0x6A09E667u;
+    if (x == 0)
+        x = 1;
+    for (uint32_t i = len - 1; i > 0; i--) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        uint32_t j = (uint32_t)(((uint64_t)x * (i + 1)) >> 32);
+        uint16_t t = sched[i];
+        sched[i] = sched[j];
+        sched[j] = t;
+    }
+    return len;
+}
+
+/* ── Histogram labels ─────────────────────────────────────────────────────── */
+
+const char *
+size_dist_bin_name(uint32_t bin)
+{
+    static const char *const k_bins[SIZE_BINS] = {
+        "64", "65-127", "128-255", "256-511", "512-1023", "1024-1518", "1519+",
+    };
+    return bin < SIZE_BINS ? k_bins[bin] : "?";
+}
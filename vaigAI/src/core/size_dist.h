@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: frame-size distributions (IMIX) for stateless (ICMP/UDP) flows.
+ *
+ * A distribution is a weighted list of frame sizes or uniform size
+ * ranges, given as a named profile ("imix", "imix-tolly") or a custom
+ * "<size>[:<weight>],<lo>-<hi>[:<weight>],…" list.  Sizes are Ethernet
+ * frame lengths including the FCS (and the 802.1Q tag when --vlan is
+ * set), as in RFC 2544.
+ *
+ * Nothing is drawn per packet: each generator expands the distribution
+ * into a schedule of up to SIZE_DIST_SCHED frame lengths — exact counts
+ * by largest remainder, range entries spread evenly over their span —
+ * shuffled once with a per-generator seed, and walks it one slot per
+ * packet.  tx_gen cuts every frame from a template built at the largest
+ * size and fixes the lengths and checksums up (see tx_gen.c).
+ *
+ * Distributions are set by the CLI in g_size_dists[flow_idx] before the
+ * START IPC (same hand-off as g_field_progs).
+ */
+#ifndef TGEN_SIZE_DIST_H
+#define TGEN_SIZE_DIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIZE_DIST_MAX        16     /* entries per distribution          */
+#define SIZE_DIST_SCHED      1024   /* schedule slots per generator      */
+#define SIZE_DIST_FRAME_MIN  64
+#define SIZE_DIST_FRAME_MAX  9216
+
+/* TX frame-size histogram bins (RFC 2819 etherStatsPkts*Octets). */
+#define SIZE_BINS  7
+
+typedef struct {
+    uint16_t lo;        /* frame size incl. FCS                      */
+    uint16_t hi;        /* = lo for a single size                    */
+    uint32_t weight;
+} size_dist_ent_t;
+
+typedef struct {
+    uint32_t        n;
+    size_dist_ent_t ent[SIZE_DIST_MAX];
+    char            spec[48];   /* as given, for display             */
+} size_dist_t;
+
+/** Per-flow distributions, written by the CLI before CFG_CMD_START
+ *  (NULL until the slot first uses one). */
+extern size_dist_t *g_size_dists[TGEN_MAX_CLIENT_FLOWS];
+
+/** Management: the distribution slot of `flow_idx`, allocated on first
+ *  use; NULL when out of memory. */
+size_dist_t *size_dist_slot(uint32_t flow_idx);
+
+/**
+ * Parse a distribution:
+ *   imix | imix-tolly | <entry>[,<entry>…]
+ *   entry: <size>[:<weight>] or <lo>-<hi>[:<weight>], weight default 1.
+ * Returns 0 or -EINVAL.
+ */
+int size_dist_parse(const char *spec, size_dist_t *d);
+
+/** Smallest and largest frame of a distribution. */
+uint16_t size_dist_min(const size_dist_t *d);
+uint16_t size_dist_max(const size_dist_t *d);
+
+/** Weighted mean frame size. */
+double size_dist_mean(const size_dist_t *d);
+
+/**
+ * Expand `d` into sched[] as frame sizes less `sub` bytes (the FCS, so
+ * the slots are the lengths to build) and shuffle it with `seed`.
+ * Returns the number of slots used (≤ SIZE_DIST_SCHED): the largest
+ * multiple of the weight sum that fits, so small-integer ratios such as
+ * IMIX 7:4:1 are exact over every pass.
+ */
+uint32_t size_dist_schedule(const size_dist_t *d, uint16_t sub,
+                            uint16_t *sched, uint32_t seed);
+
+/** Histogram bin of a frame size incl. FCS: 64, 65-127, 128-255,
+ *  256-511, 512-1023, 1024-1518, 1519+ (runts count as 64). */
+static inline uint32_t size_dist_bin(uint32_t frame)
+{
+    if (frame <= 64)   return 0;
+    if (frame < 128)   return 1;
+    if (frame < 256)   return 2;
+    if (frame < 512)   return 3;
+    if (frame < 1024)  return 4;
+    if (frame <= 1518) return 5;
+    return 6;
+}
+
+/** Label of a histogram bin ("64", "65-127", …). */
+const char *size_dist_bin_name(uint32_t bin);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_SIZE_DIST_H */
@@ -12,6 +12,8 @@
 #include "tx_gen.h"
 
 #include <string.h>
+#include <errno.h>
+#include <math.h>
 #include <netinet/in.h>
 
 #include <rte_cycles.h>
@@ -20,48 +22,71 @@
 #include <rte_ip.h>
 #include <rte_icmp.h>
 #include <rte_udp.h>
+#include <rte_tcp.h>
+#include <rte_memcpy.h>
+#include <rte_malloc.h>
+#include <rte_lcore.h>
 #include <rte_log.h>
+#include <rte_mbuf_dyn.h>
 
 #include "../common/types.h"
+#include "../common/util.h"
+#include "mempool.h"
 #include "../telemetry/metrics.h"
 #include "../net/tcp_fsm.h"
 #include "../net/tcp_port_pool.h"
+#include "../net/tcp_hs_win.h"
+#include "../net/rss_steer.h"
+#include "../net/udp_probe.h"
+#include "../port/port_init.h"
+#include "rate_sched.h"
+#include "pcap_replay.h"
+#include "core_assign.h"
+#include "worker_loop.h"
 #include "../net/tcp_tcb.h"
 #include "../app/http11.h"
+#include "../app/l7_replay.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 #include "../tls/tls_session.h"
 #include "../tls/tls_engine.h"
 
 #define TX_GEN_MAX_BURST   32
 #define ICMP_HDR_LEN        8
 
-/* Limit concurrent in-flight TCP connections (SYN_SENT) to prevent
- * overwhelming the peer's SYN backlog.  Connections complete in
- * microseconds when the server can keep up, so a modest limit
- * doesn't reduce sustained CPS — it just prevents the initial burst
- * from causing mass SYN drops and 200 ms RTO retransmit storms. */
-#define TCP_MAX_INFLIGHT   4096
+/* Payload filler bytes; constant so a cut frame's payload sum has a
+ * closed form (fill_sum()). */
+#define FILL_ICMP          0xAB
+#define FILL_UDP           0xBE
 
-static uint8_t g_tp_zero_buf[1400]; /* zero-filled plaintext for throughput
+static uint8_t g_tp_zero_buf[TX_GEN_TP_SEG_LEN]; /* zero-filled plaintext for throughput
                                       * Keep small enough that TLS record
                                       * (plaintext + ~29B overhead) fits in
                                       * one MSS (1460). */
 
-/* ── Pre-built HTTP request (one per worker, reused across connections) ──── */
-http_prebuilt_req_t g_http_req[TGEN_MAX_WORKERS];
-
 /* ── Per-flow custom HTTP headers (set by CLI, consumed by tx_gen_burst) ── */
-char g_http_custom_hdrs[TGEN_MAX_CLIENT_FLOWS][512];
+char *g_http_custom_hdrs[TGEN_MAX_CLIENT_FLOWS];
+
+char *
+tx_gen_http_hdrs_slot(uint32_t flow_idx)
+{
+    if (!g_http_custom_hdrs[flow_idx])
+        g_http_custom_hdrs[flow_idx] = rte_zmalloc("http_hdrs",
+                                                   TX_GEN_HTTP_HDRS_MAX, 0);
+    return g_http_custom_hdrs[flow_idx];
+}
 
 /* ══════════════════════════════════════════════════════════════════════════
  *  Protocol-specific builders
- *  Each returns a single rte_mbuf ready for TX, or NULL on alloc failure.
+ *  Each fills one pre-allocated mbuf from the burst's bulk allocation and
+ *  returns false if the frame does not fit (the caller frees the mbuf).
  * ══════════════════════════════════════════════════════════════════════════ */
 
 /* ── ICMP Echo Request ────────────────────────────────────────────────────── */
-static struct rte_mbuf *
-build_icmp_echo(tx_gen_state_t *state, struct rte_mempool *mp)
+static bool
+build_icmp_echo(tx_gen_state_t *state, struct rte_mbuf *m,
+                uint16_t payload_len)
 {
-    uint16_t payload_len = state->cfg.pkt_size;
     uint16_t vlan_id = state->cfg.vlan_id;
     size_t eth_sz = sizeof(struct rte_ether_hdr)
                   + (vlan_id ? sizeof(struct rte_vlan_hdr) : 0);
@@ -69,11 +94,8 @@ build_icmp_echo(tx_gen_state_t *state, struct rte_mempool *mp)
                  + sizeof(struct rte_ipv4_hdr)
                  + ICMP_HDR_LEN + payload_len;
 
-    struct rte_mbuf *m = rte_pktmbuf_alloc(mp);
-    if (unlikely(!m)) return NULL;
-
     char *buf = rte_pktmbuf_append(m, (uint16_t)total);
-    if (unlikely(!buf)) { rte_pktmbuf_free(m); return NULL; }
+    if (unlikely(!buf)) return false;
 
     /* Ethernet (with optional 802.1Q VLAN) */
     struct rte_ether_hdr *eth = (struct rte_ether_hdr *)buf;
@@ -123,20 +145,20 @@ build_icmp_echo(tx_gen_state_t *state, struct rte_mempool *mp)
     *((uint16_t *)((uint8_t *)icmp + 4)) = rte_cpu_to_be_16(state->ident);
     *((uint16_t *)((uint8_t *)icmp + 6)) = rte_cpu_to_be_16(state->seq);
     /* fill payload */
-    memset((uint8_t *)icmp + ICMP_HDR_LEN, 0xAB, payload_len);
+    memset((uint8_t *)icmp + ICMP_HDR_LEN, FILL_ICMP, payload_len);
     /* checksum */
     uint16_t ck = rte_raw_cksum(icmp, ICMP_HDR_LEN + payload_len);
     icmp->icmp_cksum = (ck == 0xFFFF) ? ck : (uint16_t)~ck;
 
     state->seq++;
-    return m;
+    return true;
 }
 
 /* ── UDP Datagram ─────────────────────────────────────────────────────────── */
-static struct rte_mbuf *
-build_udp_datagram(tx_gen_state_t *state, struct rte_mempool *mp)
+static bool
+build_udp_datagram(tx_gen_state_t *state, struct rte_mbuf *m,
+                   uint16_t payload_len)
 {
-    uint16_t payload_len = state->cfg.pkt_size;
     uint16_t udp_total   = (uint16_t)(sizeof(struct rte_udp_hdr) + payload_len);
     uint16_t vlan_id = state->cfg.vlan_id;
     size_t eth_sz = sizeof(struct rte_ether_hdr)
@@ -145,11 +167,8 @@ build_udp_datagram(tx_gen_state_t *state, struct rte_mempool *mp)
                          + sizeof(struct rte_ipv4_hdr)
                          + udp_total;
 
-    struct rte_mbuf *m = rte_pktmbuf_alloc(mp);
-    if (unlikely(!m)) return NULL;
-
     char *buf = rte_pktmbuf_append(m, (uint16_t)total);
-    if (unlikely(!buf)) { rte_pktmbuf_free(m); return NULL; }
+    if (unlikely(!buf)) return false;
 
     /* Ethernet (with optional 802.1Q VLAN) */
     struct rte_ether_hdr *eth = (struct rte_ether_hdr *)buf;
@@ -198,32 +217,1093 @@ build_udp_datagram(tx_gen_state_t *state, struct rte_mempool *mp)
     udp->dgram_cksum = 0;
 
     /* Fill payload */
-    memset((uint8_t *)udp + sizeof(*udp), 0xBE, payload_len);
+    memset((uint8_t *)udp + sizeof(*udp), FILL_UDP, payload_len);
 
     /* UDP checksum (optional per RFC 768 for IPv4, but good practice) */
     udp->dgram_cksum = rte_ipv4_udptcp_cksum(ip, udp);
 
     state->seq++;
-    return m;
+    return true;
 }
 
-/* ── Builder dispatch ─────────────────────────────────────────────────────── */
-static inline struct rte_mbuf *
-build_packet(tx_gen_state_t *state, struct rte_mempool *mp)
-{
-    switch (state->cfg.proto) {
-    case TX_GEN_PROTO_ICMP:
-        return build_icmp_echo(state, mp);
-    case TX_GEN_PROTO_UDP:
-        return build_udp_datagram(state, mp);
-    /* Future protocols go here: */
-    case TX_GEN_PROTO_TCP_SYN:
-    case TX_GEN_PROTO_HTTP:
+/* ── Template-patching builder (ICMP / UDP) ──────────────────────────────── */
+
+/* RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m') for a 16-bit field m → m'. */
+static inline uint32_t
+cksum_acc16(uint32_t acc, uint16_t old_v, uint16_t new_v)
+{
+    return acc + (uint16_t)~old_v + new_v;
+}
+
+static inline uint32_t
+cksum_acc32(uint32_t acc, uint32_t old_v, uint32_t new_v)
+{
+    acc = cksum_acc16(acc, (uint16_t)(old_v >> 16), (uint16_t)(new_v >> 16));
+    return cksum_acc16(acc, (uint16_t)old_v, (uint16_t)new_v);
+}
+
+static inline uint16_t
+cksum_fold(uint32_t acc)
+{
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    return (uint16_t)~acc;
+}
+
+/* rte_raw_cksum() of `len` bytes of `fill` (16-bit aligned), without
+ * touching memory: every whole word is fill:fill, an odd tail byte is
+ * padded with zero. */
+static inline uint16_t
+fill_sum(uint8_t fill, uint32_t len)
+{
+    uint32_t acc = (len / 2) * (fill * 0x0101u);
+    if (len & 1) {
+        uint16_t tail = 0;
+        memcpy(&tail, &fill, 1);
+        acc += tail;
+    }
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    return (uint16_t)acc;
+}
+
+/* Source IP for the next packet: cycle the IP range pool. */
+static inline uint32_t
+next_src_ip(tx_gen_state_t *state)
+{
+    if (state->cfg.src_ip_count <= 1)
+        return state->cfg.src_ip;
+    uint32_t off = state->ip_pool_idx % state->cfg.src_ip_count;
+    state->ip_pool_idx++;
+    return rte_cpu_to_be_32(rte_be_to_cpu_32(state->cfg.src_ip) + off);
+}
+
+/* Build the flow's frame once with packet_id/seq 0 and the base src_ip.
+ * Field layout matches build_icmp_echo() / build_udp_datagram(). */
+static void
+tmpl_build(tx_gen_state_t *state)
+{
+    const tx_gen_config_t *cfg = &state->cfg;
+    bool icmp = cfg->proto == TX_GEN_PROTO_ICMP;
+    uint16_t l4_len = (uint16_t)((icmp ? ICMP_HDR_LEN
+                                       : sizeof(struct rte_udp_hdr)) +
+                                 cfg->pkt_size);
+    uint16_t l3_off = (uint16_t)(sizeof(struct rte_ether_hdr) +
+                                 (cfg->vlan_id ? sizeof(struct rte_vlan_hdr) : 0));
+    uint32_t total  = l3_off + sizeof(struct rte_ipv4_hdr) + l4_len;
+
+    state->frame_len   = (uint16_t)total;
+    state->tmpl_l3_off = l3_off;
+    state->tmpl_ok     = total <= TX_GEN_TMPL_MAX;
+    state->size_bin    = (uint16_t)size_dist_bin(total + RTE_ETHER_CRC_LEN);
+    state->size_fill_ck = fill_sum(icmp ? FILL_ICMP : FILL_UDP, cfg->pkt_size);
+    if (!state->tmpl_ok)
+        return;
+
+    uint8_t *buf = state->tmpl;
+    memset(buf, 0, total);
+
+    struct rte_ether_hdr *eth = (struct rte_ether_hdr *)buf;
+    rte_ether_addr_copy(&cfg->src_mac, &eth->src_addr);
+    rte_ether_addr_copy(&cfg->dst_mac, &eth->dst_addr);
+    if (cfg->vlan_id) {
+        eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN);
+        struct rte_vlan_hdr *vh = (struct rte_vlan_hdr *)(eth + 1);
+        vh->vlan_tci  = rte_cpu_to_be_16(cfg->vlan_id & 0x0FFF);
+        vh->eth_proto = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+    } else {
+        eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+    }
+
+    struct rte_ipv4_hdr *ip = (struct rte_ipv4_hdr *)(buf + l3_off);
+    ip->version_ihl     = RTE_IPV4_VHL_DEF;
+    ip->type_of_service = (uint8_t)(cfg->dscp << 2);
+    ip->total_length    = rte_cpu_to_be_16(
+        (uint16_t)(sizeof(*ip) + l4_len));
+    ip->fragment_offset = rte_cpu_to_be_16(RTE_IPV4_HDR_DF_FLAG);
+    ip->time_to_live    = 64;
+    ip->next_proto_id   = icmp ? IPPROTO_ICMP : IPPROTO_UDP;
+    ip->src_addr        = cfg->src_ip;
+    ip->dst_addr        = cfg->dst_ip;
+    ip->hdr_checksum    = rte_ipv4_cksum(ip);
+    state->tmpl_ip_ck   = ip->hdr_checksum;
+
+    uint8_t *l4 = (uint8_t *)(ip + 1);
+    if (icmp) {
+        struct rte_icmp_hdr *ih = (struct rte_icmp_hdr *)l4;
+        ih->icmp_type = RTE_ICMP_TYPE_ECHO_REQUEST;
+        *((uint16_t *)(l4 + 4)) = rte_cpu_to_be_16(state->ident);
+        memset(l4 + ICMP_HDR_LEN, FILL_ICMP, cfg->pkt_size);
+        ih->icmp_cksum = (uint16_t)~rte_raw_cksum(l4, l4_len);
+        state->tmpl_l4_ck = ih->icmp_cksum;
+    } else {
+        struct rte_udp_hdr *uh = (struct rte_udp_hdr *)l4;
+        uh->src_port  = rte_cpu_to_be_16(cfg->src_port);
+        uh->dst_port  = rte_cpu_to_be_16(cfg->dst_port);
+        uh->dgram_len = rte_cpu_to_be_16(l4_len);
+        memset(l4 + sizeof(*uh), FILL_UDP, cfg->pkt_size);
+        state->tmpl_hw_l4 = cfg->port_id < TGEN_MAX_PORTS &&
+                            g_port_caps[cfg->port_id].has_udp_cksum_offload;
+        uh->dgram_cksum   = rte_ipv4_udptcp_cksum(ip, uh);
+        state->tmpl_l4_ck = uh->dgram_cksum;
+    }
+}
+
+/* Copy the first `len` bytes of the template and patch IP ID, ICMP seq
+ * and src IP.  A frame shorter than the template (TX_GEN_F_SIZES) is the
+ * template with the payload cut: the length fields are patched and the
+ * filler's sum swapped for the shorter one.  Checksums are adjusted from
+ * the template's (never accumulated), or the UDP one is left to the NIC. */
+static bool
+build_from_template(tx_gen_state_t *state, struct rte_mbuf *m, uint16_t len)
+{
+    char *buf = rte_pktmbuf_append(m, len);
+    if (unlikely(!buf)) return false;
+    rte_memcpy(buf, state->tmpl, len);
+
+    struct rte_ipv4_hdr *ip =
+        (struct rte_ipv4_hdr *)(buf + state->tmpl_l3_off);
+    uint16_t id     = rte_cpu_to_be_16(state->seq);
+    uint32_t src_ip = next_src_ip(state);
+    uint32_t base   = state->cfg.src_ip;
+    uint16_t cut    = (uint16_t)(state->frame_len - len);
+    bool     icmp   = state->cfg.proto == TX_GEN_PROTO_ICMP;
+
+    ip->packet_id = id;
+    ip->src_addr  = src_ip;
+    uint32_t acc  = (uint16_t)~state->tmpl_ip_ck;
+    acc = cksum_acc16(acc, 0, id);
+    acc = cksum_acc32(acc, base, src_ip);
+    if (cut) {
+        uint16_t tl = rte_cpu_to_be_16(
+            (uint16_t)(rte_be_to_cpu_16(ip->total_length) - cut));
+        acc = cksum_acc16(acc, ip->total_length, tl);
+        ip->total_length = tl;
+    }
+    ip->hdr_checksum = cksum_fold(acc);
+
+    uint8_t *l4 = (uint8_t *)(ip + 1);
+    uint32_t l4_acc = (uint16_t)~state->tmpl_l4_ck;
+    if (cut)
+        l4_acc = cksum_acc16(l4_acc, state->size_fill_ck,
+                             fill_sum(icmp ? FILL_ICMP : FILL_UDP,
+                                      state->cfg.pkt_size - cut));
+    if (icmp) {
+        struct rte_icmp_hdr *ih = (struct rte_icmp_hdr *)l4;
+        *((uint16_t *)(l4 + 6)) = id;
+        ih->icmp_cksum = cksum_fold(cksum_acc16(l4_acc, 0, id));
+    } else {
+        struct rte_udp_hdr *uh = (struct rte_udp_hdr *)l4;
+        if (cut) {
+            /* dgram_len counts twice: header and pseudo-header */
+            uint16_t ul = rte_cpu_to_be_16(
+                (uint16_t)(rte_be_to_cpu_16(uh->dgram_len) - cut));
+            l4_acc = cksum_acc16(l4_acc, uh->dgram_len, ul);
+            l4_acc = cksum_acc16(l4_acc, uh->dgram_len, ul);
+            uh->dgram_len = ul;
+        }
+        if (state->tmpl_hw_l4) {
+            m->l2_len    = state->tmpl_l3_off;
+            m->l3_len    = sizeof(*ip);
+            m->ol_flags |= RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_UDP_CKSUM;
+            uh->dgram_cksum = rte_ipv4_phdr_cksum(ip, m->ol_flags);
+        } else if (src_ip != base || cut) {
+            uint16_t ck = cksum_fold(cksum_acc32(l4_acc, base, src_ip));
+            uh->dgram_cksum = ck ? ck : 0xFFFF;   /* 0 = no checksum */
+        }
+    }
+
+    state->seq++;
+    return true;
+}
+
+/* ── Field variation ──────────────────────────────────────────────────────── */
+
+/* Write len (≤ 4) bytes at base + off and return the RFC 1624 sum of the
+ * change of the 16-bit words they touch, counted from base. */
+static inline uint32_t
+patch_bytes(uint8_t *base, uint32_t off, const void *val, uint32_t len)
+{
+    uint32_t lo = off & ~1u, hi = (off + len + 1) & ~1u;
+    uint16_t old[3], w;
+    uint32_t acc = 0;
+
+    for (uint32_t o = lo, k = 0; o < hi; o += 2, k++)
+        memcpy(&old[k], base + o, 2);
+    memcpy(base + off, val, len);
+    for (uint32_t o = lo, k = 0; o < hi; o += 2, k++) {
+        memcpy(&w, base + o, 2);
+        acc = cksum_acc16(acc, old[k], w);
+    }
+    return acc;
+}
+
+/* Write this packet's variable values into a built frame and adjust the
+ * IP and ICMP/UDP checksums from their current values.  With UDP checksum
+ * offload only the pseudo-header sum needs redoing, and only when an
+ * address changed. */
+static void
+fv_apply(tx_gen_state_t *state, struct rte_mbuf *m)
+{
+    field_var_state_t *fs = &state->fv;
+    uint8_t *frame = rte_pktmbuf_mtod(m, uint8_t *);
+    uint16_t l3_off = state->tmpl_l3_off;
+    struct rte_ipv4_hdr *ip = (struct rte_ipv4_hdr *)(frame + l3_off);
+    uint8_t *l4  = (uint8_t *)(ip + 1);
+    bool udp     = state->cfg.proto == TX_GEN_PROTO_UDP;
+    bool ip_dirty = false, l4_dirty = false, addr = false;
+    uint32_t ip_acc = 0, l4_acc = 0;
+
+    field_var_next(fs);
+    for (uint32_t i = 0; i < fs->prog.n_vars; i++) {
+        const field_var_t *v = &fs->prog.vars[i];
+        uint32_t x = fs->value[i];
+        switch (v->field) {
+        case FV_SRC_IP:
+        case FV_DST_IP: {
+            uint32_t be = rte_cpu_to_be_32(x);
+            uint32_t d  = patch_bytes((uint8_t *)ip,
+                                      v->field == FV_SRC_IP ? 12 : 16, &be, 4);
+            ip_acc += d;
+            l4_acc += udp ? d : 0;   /* UDP pseudo-header */
+            ip_dirty = addr = true;
+            l4_dirty |= udp;
+            break;
+        }
+        case FV_SRC_PORT:
+        case FV_DST_PORT: {
+            uint16_t be = rte_cpu_to_be_16((uint16_t)x);
+            l4_acc += patch_bytes(l4, v->field == FV_SRC_PORT ? 0 : 2, &be, 2);
+            l4_dirty = true;
+            break;
+        }
+        case FV_SRC_MAC:
+        case FV_DST_MAC: {
+            uint32_t be = rte_cpu_to_be_32(x);
+            memcpy(frame + (v->field == FV_DST_MAC ? 2 : 8), &be, 4);
+            break;
+        }
+        case FV_VLAN:
+            if (l3_off > sizeof(struct rte_ether_hdr)) {
+                struct rte_vlan_hdr *vh = (struct rte_vlan_hdr *)(
+                    frame + sizeof(struct rte_ether_hdr));
+                vh->vlan_tci = rte_cpu_to_be_16((uint16_t)(
+                    (rte_be_to_cpu_16(vh->vlan_tci) & 0xF000) | (x & 0x0FFF)));
+            }
+            break;
+        case FV_DSCP: {
+            uint8_t tos = (uint8_t)((x << 2) | (ip->type_of_service & 0x3));
+            ip_acc += patch_bytes((uint8_t *)ip, 1, &tos, 1);
+            ip_dirty = true;
+            break;
+        }
+        case FV_PAYLOAD: {
+            uint8_t be[4];
+            for (uint32_t k = 0; k < v->size; k++)
+                be[k] = (uint8_t)(x >> (8 * (v->size - 1 - k)));
+            /* ICMP echo and UDP headers are both 8 bytes */
+            l4_acc += patch_bytes(l4, 8u + v->offset, be, v->size);
+            l4_dirty = true;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (ip_dirty)
+        ip->hdr_checksum = cksum_fold((uint16_t)~ip->hdr_checksum + ip_acc);
+    if (!l4_dirty)
+        return;
+    if (!udp) {
+        struct rte_icmp_hdr *ih = (struct rte_icmp_hdr *)l4;
+        ih->icmp_cksum = cksum_fold((uint16_t)~ih->icmp_cksum + l4_acc);
+    } else {
+        struct rte_udp_hdr *uh = (struct rte_udp_hdr *)l4;
+        if (m->ol_flags & RTE_MBUF_F_TX_UDP_CKSUM) {
+            if (addr)
+                uh->dgram_cksum = rte_ipv4_phdr_cksum(ip, m->ol_flags);
+        } else {
+            uint16_t ck = cksum_fold((uint16_t)~uh->dgram_cksum + l4_acc);
+            uh->dgram_cksum = ck ? ck : 0xFFFF;   /* 0 = no checksum */
+        }
+    }
+}
+
+/* ── UDP probe stamp ──────────────────────────────────────────────────────── */
+
+/* Write the probe header over the start of the UDP payload, last thing
+ * before transmit, and adjust the UDP checksum by the changed words. */
+static inline void
+probe_stamp(tx_gen_state_t *state, struct rte_mbuf *m, uint32_t worker_idx)
+{
+    uint8_t *l4 = rte_pktmbuf_mtod_offset(m, uint8_t *,
+                      state->tmpl_l3_off + sizeof(struct rte_ipv4_hdr));
+    struct rte_udp_hdr *uh = (struct rte_udp_hdr *)l4;
+    uint8_t *pl = l4 + sizeof(*uh);
+    udp_probe_hdr_t h = {
+        .magic     = UDP_PROBE_MAGIC,
+        .flow_id   = (uint16_t)state->cfg.flow_idx,
+        .tx_worker = (uint16_t)worker_idx,
+        .seq       = (uint32_t)state->probe_seq++,
+        .tx_tsc    = (uint32_t)rte_rdtsc(),
+    };
+
+    if (m->ol_flags & RTE_MBUF_F_TX_UDP_CKSUM) {
+        memcpy(pl, &h, sizeof(h));
+        return;
+    }
+    uint16_t old = rte_raw_cksum(pl, UDP_PROBE_LEN);
+    memcpy(pl, &h, sizeof(h));
+    uint16_t ck = cksum_fold((uint32_t)(uint16_t)~uh->dgram_cksum +
+                             (uint16_t)~old + rte_raw_cksum(pl, UDP_PROBE_LEN));
+    uh->dgram_cksum = ck ? ck : 0xFFFF;   /* 0 = no checksum */
+}
+
+/* ── Pre-built packet ring replay ─────────────────────────────────────────── */
+
+static void
+replay_release(tx_gen_state_t *state)
+{
+    if (!state->replay)
+        return;
+    for (uint16_t i = 0; i < state->replay_n; i++)
+        rte_pktmbuf_free(state->replay[i]);   /* drops our reference */
+    rte_free(state->replay);
+    state->replay   = NULL;
+    state->replay_n = 0;
+}
+
+/* Build the ring from the template: one packet per source IP of the range
+ * (rounded up to whole cycles of at least one burst), each with its own
+ * IP ID.  Ranges longer than TX_GEN_REPLAY_MAX replay their first
+ * TX_GEN_REPLAY_MAX addresses.  Returns false on allocation failure;
+ * the caller then keeps patching templates. */
+static bool
+replay_build(tx_gen_state_t *state, struct rte_mempool *mp,
+             uint32_t worker_idx)
+{
+    uint32_t cnt = state->cfg.src_ip_count > 1 ? state->cfg.src_ip_count : 1;
+    uint32_t n   = cnt >= TX_GEN_REPLAY_MAX ? TX_GEN_REPLAY_MAX
+                 : cnt * ((TX_GEN_MAX_BURST + cnt - 1) / cnt);
+    if (n > TX_GEN_REPLAY_MAX)
+        n = TX_GEN_REPLAY_MAX;
+
+    state->replay = rte_zmalloc_socket("tx_replay",
+                                       n * sizeof(struct rte_mbuf *), 0,
+                                       rte_socket_id());
+    if (!state->replay)
+        return false;
+    if (tgen_mbuf_alloc_bulk(worker_idx, mp, state->replay, n) != 0) {
+        replay_release(state);
+        return false;
+    }
+    state->replay_n = (uint16_t)n;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!build_from_template(state, state->replay[i],
+                                 state->frame_len)) {
+            replay_release(state);
+            return false;
+        }
+    }
+    state->replay_idx = 0;
+    return true;
+}
+
+/* ── Pacing (TX_GEN_F_PACE) ───────────────────────────────────────────────── */
+
+/* Behind by more than this many gaps, the schedule restarts at now
+ * instead of catching up in back-to-back bursts. */
+#define PACE_RESYNC_GAPS   32
+/* Scheduled send: stamp the packets due within this lead of now. */
+#define PACE_HW_LEAD_US    20
+/* Scheduled send: re-read the device clock this often. */
+#define PACE_REBASE_MS     10
+
+/* `rate` as in force at `now`, ramp-up applied. */
+static inline uint64_t
+eff_rate(const tx_gen_state_t *state, uint64_t now, uint64_t rate)
+{
+    if (state->cfg.ramp_s > 0) {
+        uint64_t age = (now - state->start_tsc) / rte_get_tsc_hz();
+        if (age < state->cfg.ramp_s)
+            rate = rate * (age + 1) / state->cfg.ramp_s;
+    }
+    return rate;
+}
+
+/* Clock the rate buckets run on: the TSC, or with a schedule the
+ * integral of its level since START, so credit follows the profile. */
+static inline uint64_t
+flow_clock(const tx_gen_state_t *state, uint64_t now)
+{
+    if (likely(!(state->cfg.gen_flags & TX_GEN_F_SCHED)))
+        return now;
+    return state->start_tsc + rate_sched_clock(
+        g_rate_scheds[state->cfg.flow_idx],
+        now - state->start_tsc);
+}
+
+/* Poisson arrivals: one token per arrival due by `clk`, gaps drawn as
+ * Exponential(hz / rate).  A full bucket drops the backlog rather than
+ * replaying it as a burst. */
+static void
+poisson_refill(tx_gen_state_t *state, uint64_t clk, uint64_t rate)
+{
+    if (rate == 0)
+        return;
+    double mean = (double)rte_get_tsc_hz() / (double)rate;
+    while (state->pois_next <= clk) {
+        if (state->tokens >= TX_GEN_MAX_BURST) {
+            state->pois_next = clk;
+            break;
+        }
+        state->tokens++;
+        state->pois_next += (uint64_t)(mean * rate_sched_exp_draw()) + 1;
+    }
+}
+
+static void
+pace_start(tx_gen_state_t *state, uint64_t now)
+{
+    state->pace_next = now;
+    state->pace_frac = 0;
+    state->pace_last = 0;
+    state->pace_hw   = false;
+
+    /* Scheduled send writes the mbuf, so not with the shared replay
+     * ring; that falls back to software pacing. */
+    const port_caps_t *caps = &g_port_caps[state->cfg.port_id];
+    uint64_t nic;
+    if ((state->cfg.gen_flags & (TX_GEN_F_PACE_SW | TX_GEN_F_REPLAY)) ||
+        !caps->has_tx_timestamp || g_tx_ts_offset < 0 ||
+        rte_eth_read_clock(state->cfg.port_id, &nic) != 0)
+        return;
+    state->pace_hw          = true;
+    state->pace_nic_per_tsc = (double)caps->tx_ts_hz / (double)rte_get_tsc_hz();
+    state->pace_tsc_base    = state->pace_tsc0 = rte_rdtsc();
+    state->pace_nic_base    = state->pace_nic0 = nic;
+}
+
+/* Re-anchor the NIC clock mapping.  The ratio is refined over the whole
+ * run, so TSC and device clock drift apart by no more than one rebase
+ * interval's worth of error. */
+static void
+pace_rebase(tx_gen_state_t *state, uint64_t now)
+{
+    if (now - state->pace_tsc_base < PACE_REBASE_MS * rte_get_tsc_hz() / 1000)
+        return;
+    uint64_t nic;
+    if (rte_eth_read_clock(state->cfg.port_id, &nic) != 0)
+        return;
+    uint64_t tsc = rte_rdtsc();
+    if (nic > state->pace_nic0 && tsc > state->pace_tsc0)
+        state->pace_nic_per_tsc = (double)(nic - state->pace_nic0) /
+                                  (double)(tsc - state->pace_tsc0);
+    state->pace_tsc_base = tsc;
+    state->pace_nic_base = nic;
+}
+
+/* Packets due now (or, with scheduled send, within the lead): when[i]
+ * is packet i's launch time and when[i+1] / frac[i+1] the schedule after
+ * it.  The burst shrinks to what is due — usually one packet when the
+ * gap is longer than a loop iteration. */
+static uint32_t
+pace_due(tx_gen_state_t *state, tx_gen_pace_stats_t *ps, uint64_t now,
+         uint64_t rate, uint64_t when[], uint64_t frac[])
+{
+    uint64_t hz  = rte_get_tsc_hz();
+    uint64_t gap = hz / rate;
+    uint64_t rem = hz % rate;
+    if (unlikely(gap == 0)) {
+        gap = 1;
+        rem = 0;
+    }
+    /* The rate may have dropped since the remainder was carried */
+    if (state->pace_frac >= rate)
+        state->pace_frac = 0;
+    ps->target_ns = tgen_tsc_to_ns(gap);
+    ps->hw        = state->pace_hw;
+
+    uint64_t horizon = now;
+    if (state->pace_hw)
+        horizon += PACE_HW_LEAD_US * hz / 1000000;
+    if (state->pace_next > horizon)
+        return 0;
+    if (now > state->pace_next &&
+        now - state->pace_next > PACE_RESYNC_GAPS * gap) {
+        state->pace_next = now;
+        state->pace_frac = 0;
+        ps->resyncs++;
+    }
+
+    uint32_t n = 0;
+    when[0] = state->pace_next;
+    frac[0] = state->pace_frac;
+    while (n < TX_GEN_MAX_BURST && when[n] <= horizon) {
+        when[n + 1] = when[n] + gap;
+        frac[n + 1] = frac[n] + rem;
+        if (frac[n + 1] >= rate) {
+            frac[n + 1] -= rate;
+            when[n + 1]++;
+        }
+        n++;
+    }
+    return n;
+}
+
+/* Hand each packet's launch time to the NIC (scheduled send). */
+static inline void
+pace_stamp(const tx_gen_state_t *state, struct rte_mbuf **pkts, uint32_t n,
+           const uint64_t when[])
+{
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t d = (int64_t)(when[i] - state->pace_tsc_base);
+        *RTE_MBUF_DYNFIELD(pkts[i], g_tx_ts_offset, uint64_t *) =
+            state->pace_nic_base +
+            (uint64_t)((double)d * state->pace_nic_per_tsc);
+        pkts[i]->ol_flags |= g_tx_ts_flag;
+    }
+}
+
+static inline void
+pace_gap(tx_gen_pace_stats_t *ps, uint64_t ns)
+{
+    ps->gaps++;
+    ps->sum_ns   += ns;
+    ps->sumsq_ns += (double)ns * (double)ns;
+    if (ps->gaps == 1 || ns < ps->min_ns)
+        ps->min_ns = ns;
+    if (ns > ps->max_ns)
+        ps->max_ns = ns;
+}
+
+/* Record the gaps of `n` sent packets launched by the tx_burst call at
+ * tx_tsc, and how late the first one left. */
+static void
+pace_account(tx_gen_state_t *state, tx_gen_pace_stats_t *ps,
+             const uint64_t when[], uint32_t n, uint64_t tx_tsc)
+{
+    if (tx_tsc > when[0]) {
+        uint64_t late = tgen_tsc_to_ns(tx_tsc - when[0]);
+        if (late > ps->late_max_ns)
+            ps->late_max_ns = late;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t t = state->pace_hw ? when[i] : tx_tsc;
+        if (state->pace_last)
+            pace_gap(ps, t > state->pace_last
+                         ? tgen_tsc_to_ns(t - state->pace_last) : 0);
+        state->pace_last = t;
+    }
+}
+
+void
+tx_gen_pace_report(uint32_t flow_idx, tx_gen_pace_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS)
+        return;
+
+    /* Pooled over generators: the moments add, then mean and variance
+     * come from the totals. */
+    uint64_t sum = 0;
+    double   sumsq = 0, target = 0;
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++) {
+        const tx_gen_state_t *st = __atomic_load_n(
+            &g_worker_ctx[w].tx_gen[flow_idx], __ATOMIC_ACQUIRE);
+        if (!st)
+            continue;
+        const tx_gen_pace_stats_t *ps = &st->pace;
+        if (ps->target_ns == 0)
+            continue;
+        out->generators++;
+        out->hw      += ps->hw;
+        target       += (double)ps->target_ns;
+        out->resyncs += ps->resyncs;
+        if (ps->late_max_ns > out->late_max_ns)
+            out->late_max_ns = ps->late_max_ns;
+        if (ps->gaps == 0)
+            continue;
+        if (out->gaps == 0 || ps->min_ns < out->min_ns)
+            out->min_ns = ps->min_ns;
+        if (ps->max_ns > out->max_ns)
+            out->max_ns = ps->max_ns;
+        out->gaps += ps->gaps;
+        sum       += ps->sum_ns;
+        sumsq     += ps->sumsq_ns;
+    }
+    if (out->generators)
+        out->target_ns = target / out->generators;
+    if (out->gaps) {
+        out->mean_ns = (double)sum / (double)out->gaps;
+        double var = sumsq / (double)out->gaps - out->mean_ns * out->mean_ns;
+        out->stddev_ns = var > 0 ? sqrt(var) : 0;
+    }
+}
+
+/* ── Byte rate control (rate_bps, port caps) ──────────────────────────────── */
+
+/* Bucket depths: a burst of full-size frames. */
+#define BYTES_DEPTH(len)  ((int64_t)TX_GEN_MAX_BURST * \
+                           ((len) + METRICS_L1_OVERHEAD))
+/* Throughput mode: headers around each segment's payload */
+#define TP_SEG_HDRS       (RTE_ETHER_HDR_LEN + sizeof(struct rte_ipv4_hdr) + \
+                           sizeof(struct rte_tcp_hdr))
+/* A SYN as tcp_options_write_syn() builds it: MSS, SACK-permitted,
+ * timestamps and window scale take 20 option bytes at most. */
+#define SYN_FRAME_LEN     (TP_SEG_HDRS + 20u)
+
+uint64_t        g_port_cap_bps[TGEN_MAX_PORTS];
+tx_gen_bucket_t g_port_shaper[TGEN_MAX_WORKERS][TGEN_MAX_PORTS];
+
+/* Bytes that `n` frames of `len` bytes in total (as built: no FCS, VLAN
+ * tag included) count for at `layer`. */
+static inline int64_t
+layer_bytes(const tx_gen_state_t *state, uint8_t layer, uint64_t len,
+            uint32_t n)
+{
+    switch (layer) {
+    case TX_GEN_LAYER_L2:
+        return (int64_t)(len + (uint64_t)n * RTE_ETHER_CRC_LEN);
+    case TX_GEN_LAYER_L3:
+        return (int64_t)len - (int64_t)n *
+               (RTE_ETHER_HDR_LEN +
+                (state->cfg.vlan_id ? sizeof(struct rte_vlan_hdr) : 0));
     default:
+        return (int64_t)(len + (uint64_t)n * METRICS_L1_OVERHEAD);
+    }
+}
+
+/* Credit the bytes `bps` earned since the last refill.  The remainder is
+ * carried in bit-cycles so no fraction of a byte is lost between polls.
+ * Elapsed time is clamped to 10 ms, well past any depth.  bps is split
+ * into whole bytes per cycle and a remainder below 8 * hz before the
+ * multiply, so neither product can leave 64 bits at any rate
+ * tgen_parse_bps() accepts and any TSC up to 10 GHz. */
+static void
+bucket_refill(tx_gen_bucket_t *b, uint64_t now, uint64_t bps, int64_t depth)
+{
+    uint64_t hz = rte_get_tsc_hz();
+    if (unlikely(b->last_tsc == 0)) {
+        b->last_tsc = now;
+        return;
+    }
+    uint64_t elapsed = now - b->last_tsc;
+    b->last_tsc = now;
+    if (elapsed > hz / 100)
+        elapsed = hz / 100;
+    uint64_t unit = 8 * hz;
+    uint64_t acc  = b->frac + elapsed * (bps % unit);
+    b->tokens += (int64_t)(elapsed * (bps / unit) + acc / unit);
+    b->frac    = acc % unit;
+    if (b->tokens > depth) {
+        b->tokens = depth;
+        b->frac   = 0;
+    }
+}
+
+static inline int64_t
+flow_depth(const tx_gen_state_t *state)
+{
+    return BYTES_DEPTH(state->frame_len > RTE_ETHER_MAX_LEN
+                       ? state->frame_len : RTE_ETHER_MAX_LEN);
+}
+
+/* Charge a throughput-mode segment of `payload` bytes. */
+static inline void
+tp_charge(const tx_gen_state_t *state, tx_gen_bucket_t *fb,
+          tx_gen_bucket_t *pb, uint32_t payload)
+{
+    uint64_t len = payload + TP_SEG_HDRS +
+                   (state->cfg.vlan_id ? sizeof(struct rte_vlan_hdr) : 0);
+    if (fb)
+        fb->tokens -= layer_bytes(state, state->cfg.rate_layer, len, 1);
+    if (pb)
+        pb->tokens -= layer_bytes(state, TX_GEN_LAYER_L1, len, 1);
+}
+
+/* This worker's bucket for the port's cap, refilled; NULL if uncapped. */
+static tx_gen_bucket_t *
+port_shaper(const tx_gen_state_t *state, uint32_t worker_idx, uint64_t now)
+{
+    uint16_t port = state->cfg.port_id;
+    uint64_t cap  = __atomic_load_n(&g_port_cap_bps[port], __ATOMIC_RELAXED);
+    if (cap == 0)
         return NULL;
+    tx_gen_bucket_t *b = &g_port_shaper[worker_idx][port];
+    bucket_refill(b, now, cap / (state->cap_n ? state->cap_n : 1),
+                  BYTES_DEPTH(RTE_ETHER_MAX_LEN));
+    return b;
+}
+
+/* Packets the byte budgets allow: walks the coming frame lengths without
+ * consuming them and stops after the one that uses up either budget. */
+static uint32_t
+budget_pkts(const tx_gen_state_t *state, int64_t flow, int64_t port,
+            uint32_t max)
+{
+    uint32_t n = 0, idx = state->size_idx;
+    while (n < max && flow > 0 && port > 0) {
+        uint32_t len = state->frame_len;
+        if (state->size_n) {
+            len = state->size_sched[idx];
+            if (++idx == state->size_n)
+                idx = 0;
+        }
+        flow -= layer_bytes(state, state->cfg.rate_layer, len, 1);
+        port -= layer_bytes(state, TX_GEN_LAYER_L1, len, 1);
+        n++;
+    }
+    return n;
+}
+
+/* ── Capture replay (TX_GEN_PROTO_PCAP) ───────────────────────────────────── */
+
+/* Move past frame `idx` of the share; a wrap starts the next pass one
+ * period later. */
+static inline void
+pcap_step(const pcap_replay_t *pr, const pcap_replay_q_t *q, uint32_t *idx,
+          uint32_t *loop, uint64_t *base)
+{
+    if (++*idx == q->n) {
+        *idx = 0;
+        (*loop)++;
+        *base += pr->period;
     }
 }
 
+/* Send the next frames of this generator's share: those due by now when
+ * timed, else as many as the packet and byte budgets allow.  Frames go
+ * out by reference and in order; unsent ones are retried next time. */
+static uint32_t
+pcap_burst(tx_gen_state_t *state, uint32_t worker_idx, uint64_t now,
+           uint32_t to_send)
+{
+    pcap_replay_t         *pr = g_pcap_replays[state->cfg.flow_idx];
+    const pcap_replay_q_t *q  = &pr->q[state->rate_rank % TGEN_MAX_WORKERS];
+    uint32_t loops = state->cfg.pcap_loops;
+    if (q->n == 0 || (loops && state->pcap_loop >= loops)) {
+        __atomic_store_n(&state->active, false, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+    tx_gen_bucket_t *pb = port_shaper(state, worker_idx, now);
+    int64_t flow = state->cfg.rate_bps ? state->bytes.tokens : INT64_MAX;
+    int64_t port = pb ? pb->tokens : INT64_MAX;
+    struct rte_mbuf *pkts[TX_GEN_MAX_BURST];
+    uint16_t lens[TX_GEN_MAX_BURST];
+    uint32_t idx  = state->pcap_idx, loop = state->pcap_loop;
+    uint64_t base = state->pcap_base;
+    uint32_t n = 0;
+    while (n < to_send && flow > 0 && port > 0 &&
+           !(loops && loop >= loops)) {
+        if (q->due && base + q->due[idx] > now)
+            break;
+        struct rte_mbuf *m = q->m[idx];
+        lens[n] = (uint16_t)m->pkt_len;
+        flow -= layer_bytes(state, state->cfg.rate_layer, lens[n], 1);
+        port -= layer_bytes(state, TX_GEN_LAYER_L1, lens[n], 1);
+        rte_mbuf_refcnt_update(m, 1);
+        pkts[n++] = m;
+        pcap_step(pr, q, &idx, &loop, &base);
+    }
+    if (n == 0)
+        return 0;
+
+    uint16_t sent = rte_eth_tx_burst(state->cfg.port_id, state->tx_queue_id,
+                                     pkts, (uint16_t)n);
+    for (uint32_t i = sent; i < n; i++) {
+        rte_pktmbuf_free(pkts[i]);      /* drops the extra reference */
+        state->pkts_dropped++;
+    }
+    if (sent < n) {
+        idx  = state->pcap_idx;
+        loop = state->pcap_loop;
+        base = state->pcap_base;
+        for (uint32_t i = 0; i < sent; i++)
+            pcap_step(pr, q, &idx, &loop, &base);
+    }
+    state->pcap_idx  = idx;
+    state->pcap_loop = loop;
+    state->pcap_base = base;
+    state->pkts_sent += sent;
+    if (state->cfg.rate_pps > 0 && sent <= state->tokens)
+        state->tokens -= sent;
+
+    uint64_t bytes = 0;
+    for (uint16_t i = 0; i < sent; i++) {
+        bytes += lens[i];
+        worker_metrics_add_tx_size(worker_idx,
+            size_dist_bin(lens[i] + RTE_ETHER_CRC_LEN), 1);
+    }
+    worker_metrics_add_tx(worker_idx, sent, bytes);
+    flow_metrics_add_tx(worker_idx, state->cfg.flow_idx, sent, bytes);
+    if (state->cfg.rate_bps > 0)
+        state->bytes.tokens -= layer_bytes(state, state->cfg.rate_layer,
+                                           bytes, sent);
+    if (pb)
+        pb->tokens -= layer_bytes(state, TX_GEN_LAYER_L1, bytes, sent);
+
+    /* Last pass out: this generator is done */
+    if (loops && loop >= loops) {
+        __atomic_store_n(&state->active, false, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&pr->done, 1, __ATOMIC_RELEASE);
+    }
+    return sent;
+}
+
+/* ── Builder dispatch ─────────────────────────────────────────────────────── */
+
+/* Length of the next frame (no FCS): the fixed one, or the next slot of
+ * the size schedule. */
+static inline uint16_t
+next_frame_len(tx_gen_state_t *state)
+{
+    if (likely(state->size_n == 0))
+        return state->frame_len;
+    uint16_t len = state->size_sched[state->size_idx];
+    if (++state->size_idx == state->size_n)
+        state->size_idx = 0;
+    return len;
+}
+
+static inline bool
+build_packet(tx_gen_state_t *state, struct rte_mbuf *m, uint32_t worker_idx)
+{
+    uint16_t len = next_frame_len(state);
+    uint16_t payload_len = (uint16_t)(state->cfg.pkt_size -
+                                      (state->frame_len - len));
+    bool ok;
+    if (likely(state->tmpl_ok)) {
+        ok = build_from_template(state, m, len);
+    } else {
+        switch (state->cfg.proto) {
+        case TX_GEN_PROTO_ICMP:
+            ok = build_icmp_echo(state, m, payload_len);
+            break;
+        case TX_GEN_PROTO_UDP:
+            ok = build_udp_datagram(state, m, payload_len);
+            break;
+        /* Future protocols go here: */
+        case TX_GEN_PROTO_TCP_SYN:
+        case TX_GEN_PROTO_HTTP:
+        default:
+            return false;
+        }
+    }
+    if (!ok)
+        return false;
+    if (state->cfg.gen_flags & TX_GEN_F_FIELDS)
+        fv_apply(state, m);
+    if (state->cfg.gen_flags & TX_GEN_F_PROBE)
+        probe_stamp(state, m, worker_idx);
+    return true;
+}
+
+/* ── TCP source tuple selection ───────────────────────────────────────────── */
+
+/* Probes per connection before giving up on an exhausted IP range.  With
+ * RSS steering each IP only contributes the ports whose return traffic
+ * lands on this worker, so single IPs can run dry ahead of the others. */
+#define TX_GEN_SRC_PROBES   8
+
+/* Cycle the source IP range and allocate an ephemeral port on the first
+ * IP that still has one for this worker.  Returns 0 or -ENOSPC. */
+static int
+alloc_src_tuple(tx_gen_state_t *state, uint32_t worker_idx,
+                uint32_t *src_ip, uint16_t *src_port)
+{
+    uint32_t count  = state->cfg.src_ip_count > 1 ? state->cfg.src_ip_count : 1;
+    uint32_t probes = TGEN_MIN(count, (uint32_t)TX_GEN_SRC_PROBES);
+
+    for (uint32_t p = 0; p < probes; p++) {
+        uint32_t offset = state->ip_pool_idx % count;
+        state->ip_pool_idx++;
+        /* src_ip is network byte order — convert, add, convert back */
+        uint32_t ip = rte_cpu_to_be_32(
+            rte_be_to_cpu_32(state->cfg.src_ip) + offset);
+        if (tcp_port_alloc(worker_idx, state->cfg.steer_ctx,
+                           ip, src_port) == 0) {
+            *src_ip = ip;
+            return 0;
+        }
+    }
+    return -ENOSPC;
+}
+
+/* Pre-build the flow's HTTP request headers at START. */
+static void
+http_prebuild(tx_gen_state_t *state)
+{
+    http_prebuilt_req_t *hpb = &state->http_req;
+    memset(hpb, 0, sizeof(*hpb));
+
+    bool ol   = state->cfg.http_open_loop;
+    bool pool = state->cfg.pool_max > 0;
+    bool pipe = state->cfg.http_pipeline > 1;
+    bool ka   = state->cfg.txn_per_conn > 1 || ol || pool || pipe;
+    http_conn_t tmp;
+    http11_conn_init(&tmp);
+    const char *extra = g_http_custom_hdrs[state->cfg.flow_idx];
+    http_request_t req = {
+        .method        = (http_method_t)state->cfg.http_method,
+        .url           = state->cfg.http_url[0] ? state->cfg.http_url : "/",
+        .host          = state->cfg.http_host[0] ? state->cfg.http_host : "localhost",
+        .keep_alive    = ka,
+        .extra_headers = (extra && extra[0]) ? extra : NULL,
+    };
+    int n = http11_tx_request(&tmp, &req);
+    if (n > 0) {
+        memcpy(hpb->hdr, tmp.tx_hdr, (size_t)n);
+        hpb->hdr_len = (uint32_t)n;
+        hpb->keep_alive = ka;
+        /* A pooled connection goes back to the pool after its batch;
+         * a pipelined one carries at least one full batch. */
+        uint32_t txns = state->cfg.txn_per_conn;
+        if (pool)
+            txns = TGEN_MAX(txns, 1u);
+        hpb->pipe_depth = 0;
+        if (pipe) {
+            uint32_t depth = TGEN_MIN((uint32_t)state->cfg.http_pipeline,
+                                      TX_GEN_PIPE_BYTES / (uint32_t)n);
+            depth = TGEN_MIN(depth, (uint32_t)TX_GEN_PIPE_MAX);
+            for (uint32_t i = 0; i < depth; i++)
+                memcpy(hpb->pipe + i * (uint32_t)n, tmp.tx_hdr, (size_t)n);
+            if (depth > 1)
+                hpb->pipe_depth = (uint8_t)depth;
+            txns = TGEN_MAX(txns, depth);
+        }
+        hpb->head = req.method == HTTP_METHOD_HEAD;
+        hpb->txn_per_conn = txns;
+        hpb->think_time_us = state->cfg.think_time_us;
+        hpb->expected_interval_us = tx_gen_http_interval_us(state);
+    }
+}
+
+/* Open one client connection of the flow and mark it for its
+ * application.  NULL when the port pool or the TCB store is exhausted. */
+static tcb_t *
+conn_open(tx_gen_state_t *state, uint32_t worker_idx)
+{
+    uint32_t cur_src_ip;
+    uint16_t src_port;
+    if (alloc_src_tuple(state, worker_idx, &cur_src_ip, &src_port) < 0)
+        return NULL;   /* port pool exhausted */
+    tcb_t *tcb = tcp_fsm_connect(worker_idx,
+                     cur_src_ip, src_port,
+                     state->cfg.dst_ip, state->cfg.dst_port,
+                     state->cfg.port_id,
+                     (uint16_t)state->cfg.flow_idx);
+    if (!tcb) {
+        tcp_port_free_immediate(worker_idx, state->cfg.steer_ctx,
+                                cur_src_ip, src_port);
+        return NULL;   /* TCB store full */
+    }
+    tcb->steer_ctx = state->cfg.steer_ctx;
+    tcb->dscp    = state->cfg.dscp;
+    tcb->vlan_id = state->cfg.vlan_id;
+    tcb->cc_algo = state->cfg.cc_algo;
+    if (state->cfg.max_initiations > 0)
+        tcb->graceful_close = true;
+    /* Mark connection for HTTP request after ESTABLISHED */
+    if (state->cfg.proto == TX_GEN_PROTO_HTTP) {
+        tcb->app_ctx = &state->http_req;
+        if (state->cfg.enable_tls) {
+            /* HTTPS: TLS handshake first, then HTTP after TLS done.
+             * app_state 1 → TLS handshake → app_state 3 (TLS ok) →
+             * then the ESTABLISHED data handler sends HTTP. */
+            tcb->app_state = 1; /* 1 = TLS requested */
+        } else {
+            /* Plain HTTP: send request immediately after TCP ESTABLISHED */
+            tcb->app_state = 4; /* 4 = HTTP send request */
+        }
+    } else if (state->cfg.proto == TX_GEN_PROTO_L7) {
+        /* Cycle through the capture's conversations */
+        const l7_prog_t *lp = g_l7_progs[state->cfg.flow_idx];
+        l7_replay_client_init(tcb, lp,
+                              state->l7_next++ % lp->n_convs);
+    } else if (state->cfg.enable_tls) {
+        /* Raw TLS (no HTTP): just do TLS handshake */
+        tcb->app_state = 1; /* 1 = TLS requested */
+    }
+    return tcb;
+}
+
+/* Open-loop HTTP: requests due by the flow's schedule go out on idle
+ * pool connections; for the rest, open connections within the pool
+ * size and the SYN window.  Returns the connections opened. */
+static uint32_t
+ol_burst(tx_gen_state_t *state, uint32_t worker_idx, uint64_t now)
+{
+    if (state->cfg.steer_ctx != RSS_STEER_NONE &&
+        !rss_steer_serves(state->cfg.steer_ctx, worker_idx))
+        return 0;
+
+    uint32_t want = http_ol_dispatch(worker_idx, state->cfg.flow_idx,
+                        eff_rate(state, now, state->cfg.rate_pps), now);
+    want = TGEN_MIN(want, (uint32_t)TX_GEN_MAX_BURST);
+    want = TGEN_MIN(want, tcp_hs_win_room(worker_idx, state->cfg.flow_idx));
+
+    uint32_t opened = 0;
+    while (opened < want) {
+        tcb_t *tcb = conn_open(state, worker_idx);
+        if (!tcb)
+            break;
+        http_ol_opened(worker_idx, tcb);
+        opened++;
+    }
+    state->pkts_sent += opened;
+    return opened;
+}
+
+/* Connection pool: start up to `n` transactions on parked connections
+ * of the flow's target.  A connection may have been opened by another
+ * flow to the same target: it takes on the borrower's request, and with
+ * it the borrower's txn_per_conn, counted afresh, DSCP and --one close.
+ * Returns the transactions started. */
+static uint32_t
+pool_lend(tx_gen_state_t *state, uint32_t worker_idx, uint32_t n)
+{
+    uint32_t lent = 0;
+    tcb_t *tcb;
+
+    while (lent < n &&
+           (tcb = conn_pool_get(worker_idx, state->pool_key)) != NULL) {
+        tcb->flow_idx       = (uint16_t)state->cfg.flow_idx;
+        tcb->app_ctx        = &state->http_req;
+        tcb->http_txn_count = 0;
+        tcb->dscp           = state->cfg.dscp;
+        tcb->graceful_close = state->cfg.max_initiations > 0;
+        tcb->app_state      = 4;
+        tcp_fsm_http_send_next(worker_idx, tcb);
+        lent++;
+    }
+    return lent;
+}
+
+/* Connection pool: open connections ahead of demand until the target's
+ * idle + warming count reaches its min, within the SYN window and at
+ * most `max`.  They park on ESTABLISHED (TLS done for https) and take no
+ * tokens.  Returns the connections opened. */
+static uint32_t
+pool_warm(tx_gen_state_t *state, uint32_t worker_idx, uint32_t max)
+{
+    uint32_t n = conn_pool_deficit(worker_idx, state->pool_key);
+    n = TGEN_MIN(n, max);
+    n = TGEN_MIN(n, tcp_hs_win_room(worker_idx, state->cfg.flow_idx));
+
+    uint32_t opened = 0;
+    while (opened < n) {
+        tcb_t *tcb = conn_open(state, worker_idx);
+        if (!tcb)
+            break;
+        conn_pool_opened(worker_idx, tcb, state->pool_key, true);
+        opened++;
+    }
+    return opened;
+}
+
 /* ══════════════════════════════════════════════════════════════════════════
  *  Public API
  * ══════════════════════════════════════════════════════════════════════════ */
@@ -232,10 +1312,27 @@ void
 tx_gen_configure(tx_gen_state_t *state, const tx_gen_config_t *cfg,
                  uint16_t tx_queue)
 {
+    replay_release(state);
     memset(state, 0, sizeof(*state));
     memcpy(&state->cfg, cfg, sizeof(*cfg));
     state->ident       = (uint16_t)(rte_rdtsc() & 0xFFFF);
     state->tx_queue_id = tx_queue;
+    if (cfg->proto == TX_GEN_PROTO_PCAP)     /* frames come from the file */
+        state->cfg.gen_flags &= (uint8_t)(TX_GEN_F_SCHED | TX_GEN_F_POISSON);
+    else if (tx_gen_proto_stateless(cfg->proto))
+        tmpl_build(state);
+    else
+        state->cfg.gen_flags &= (uint8_t)~(TX_GEN_F_FIELDS | TX_GEN_F_SIZES |
+                                           TX_GEN_F_PACE | TX_GEN_F_PACE_SW);
+    if (cfg->proto != TX_GEN_PROTO_UDP)
+        state->cfg.gen_flags &= (uint8_t)~TX_GEN_F_PROBE;
+    /* A pre-built ring can't vary per packet */
+    if (state->cfg.gen_flags &
+        (TX_GEN_F_FIELDS | TX_GEN_F_PROBE | TX_GEN_F_SIZES))
+        state->cfg.gen_flags &= (uint8_t)~TX_GEN_F_REPLAY;
+    /* Pacing keeps its own launch schedule */
+    if (state->cfg.gen_flags & TX_GEN_F_PACE)
+        state->cfg.gen_flags &= (uint8_t)~(TX_GEN_F_SCHED | TX_GEN_F_POISSON);
 }
 
 void
@@ -244,17 +1341,44 @@ tx_gen_start(tx_gen_state_t *state)
     uint64_t now = rte_rdtsc();
     state->start_tsc       = now;
     state->last_refill_tsc = now;
+    state->pois_next       = now;
     state->pkts_sent       = 0;
     state->pkts_dropped    = 0;
     state->seq             = 0;
+    state->probe_seq       = 0;
+    state->pcap_idx        = 0;
+    state->pcap_loop       = 0;
+    state->pcap_base       = now;
+    if (state->cfg.gen_flags & TX_GEN_F_FIELDS)
+        field_var_init(&state->fv, g_field_progs[state->cfg.flow_idx],
+                       state->rate_rank, state->rate_n);
+    /* Each generator shuffles its own schedule, so generators sharing a
+     * flow don't send the same size sequence in lockstep. */
+    state->size_n   = 0;
+    state->size_idx = 0;
+    if (state->cfg.gen_flags & TX_GEN_F_SIZES)
+        state->size_n = (uint16_t)size_dist_schedule(
+            g_size_dists[state->cfg.flow_idx],
+            RTE_ETHER_CRC_LEN, state->size_sched,
+            (state->cfg.flow_idx << 8) | state->rate_rank);
+    if (state->cfg.gen_flags & TX_GEN_F_PACE)
+        pace_start(state, now);
+    /* After the rate share is set: the CO interval is per generator */
+    if (state->cfg.proto == TX_GEN_PROTO_HTTP)
+        http_prebuild(state);
 
     /* Cap initial token allowance when max_initiations is set,
      * so a --one command doesn't burst 32 connections on first tick. */
     if (state->cfg.max_initiations > 0 &&
         state->cfg.max_initiations < TX_GEN_MAX_BURST)
         state->tokens = state->cfg.max_initiations;
+    else if (state->cfg.gen_flags & TX_GEN_F_POISSON)
+        state->tokens = 0;      /* no opening burst: arrivals only */
     else
         state->tokens = TX_GEN_MAX_BURST;
+    state->bytes.tokens   = flow_depth(state);
+    state->bytes.frac     = 0;
+    state->bytes.last_tsc = now;
 
     if (state->cfg.duration_s > 0)
         state->deadline_tsc = now +
@@ -269,6 +1393,7 @@ void
 tx_gen_stop(tx_gen_state_t *state)
 {
     __atomic_store_n(&state->active, false, __ATOMIC_RELEASE);
+    replay_release(state);
 }
 
 uint32_t
@@ -294,7 +1419,9 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
             state->tp_n_streams = 0;
             state->tp_phase = 0;
         }
-        __atomic_store_n(&state->active, false, __ATOMIC_RELEASE);
+        if (state->cfg.http_open_loop)
+            http_ol_stop(worker_idx, state->cfg.flow_idx);
+        tx_gen_stop(state);
         return 0;
     }
 
@@ -308,115 +1435,113 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
         return 0;
     }
 
+    /* ── Open-loop HTTP: the request schedule replaces the tokens ───── */
+    if (state->cfg.http_open_loop)
+        return ol_burst(state, worker_idx, now);
+
+    /* ── Per-packet schedule (stateless, --pace) ────────────────────── */
+    uint64_t when[TX_GEN_MAX_BURST + 1], frac[TX_GEN_MAX_BURST + 1];
+    tx_gen_pace_stats_t *ps = NULL;
+    uint32_t due = 0;
+    if ((state->cfg.gen_flags & TX_GEN_F_PACE) && state->cfg.rate_pps > 0) {
+        uint64_t rate = eff_rate(state, now, state->cfg.rate_pps);
+        if (rate == 0)
+            return 0;
+        ps = &state->pace;
+        if (state->pace_hw)
+            pace_rebase(state, now);
+        due = pace_due(state, ps, now, rate, when, frac);
+        if (due == 0)
+            return 0;
+    }
+
     /* ── Token-bucket rate control ──────────────────────────────────── */
     uint32_t to_send = TX_GEN_MAX_BURST;
-    if (state->cfg.rate_pps > 0) {
-        /* Compute effective rate (with optional ramp-up) */
-        uint64_t eff_rate = state->cfg.rate_pps;
-        if (state->cfg.ramp_s > 0) {
-            uint64_t age = (now - state->start_tsc) / rte_get_tsc_hz();
-            if (age < state->cfg.ramp_s)
-                eff_rate = state->cfg.rate_pps * (age + 1) / state->cfg.ramp_s;
-        }
-        uint64_t elapsed  = now - state->last_refill_tsc;
-        uint64_t new_tok  = elapsed * eff_rate / rte_get_tsc_hz();
-        if (new_tok > 0) {
-            state->tokens += new_tok;
-            state->last_refill_tsc = now;
-            if (state->tokens > TX_GEN_MAX_BURST)
-                state->tokens = TX_GEN_MAX_BURST;
+    if (ps) {
+        to_send = due;
+    } else if (state->cfg.rate_bps > 0) {
+        /* Byte bucket: the packet count is worked out against the
+         * frame lengths below */
+        bucket_refill(&state->bytes, flow_clock(state, now),
+                      eff_rate(state, now, state->cfg.rate_bps),
+                      flow_depth(state));
+        if (state->bytes.tokens <= 0)
+            return 0;
+    } else if (state->cfg.rate_pps > 0) {
+        uint64_t clk  = flow_clock(state, now);
+        uint64_t rate = eff_rate(state, now, state->cfg.rate_pps);
+        if (state->cfg.gen_flags & TX_GEN_F_POISSON) {
+            poisson_refill(state, clk, rate);
+        } else {
+            uint64_t elapsed = clk - state->last_refill_tsc;
+            uint64_t new_tok = elapsed * rate / rte_get_tsc_hz();
+            if (new_tok > 0) {
+                state->tokens += new_tok;
+                state->last_refill_tsc = clk;
+                if (state->tokens > TX_GEN_MAX_BURST)
+                    state->tokens = TX_GEN_MAX_BURST;
+            }
         }
         to_send = (uint32_t)state->tokens;
         if (to_send == 0)
             return 0;
     }
 
+    if (state->cfg.proto == TX_GEN_PROTO_PCAP)
+        return pcap_burst(state, worker_idx, now, to_send);
+
     /* ── TCP SYN TPS: use tcp_fsm_connect() instead of raw packets ── */
     if (state->cfg.proto == TX_GEN_PROTO_TCP_SYN ||
-        state->cfg.proto == TX_GEN_PROTO_HTTP) {
+        state->cfg.proto == TX_GEN_PROTO_HTTP ||
+        state->cfg.proto == TX_GEN_PROTO_L7) {
 
-        /* Pace connection opens: limit concurrent in-flight TCBs to
-         * prevent a SYN storm that overwhelms the peer's backlog. */
-        uint32_t in_flight = g_tcb_stores[worker_idx].count;
-        if (in_flight >= TCP_MAX_INFLIGHT) {
-            return 0;   /* wait for existing connections to complete */
-        }
-        to_send = TGEN_MIN(to_send, TCP_MAX_INFLIGHT - in_flight);
-
-        /* Pre-build HTTP request headers on first burst */
-        if (state->cfg.proto == TX_GEN_PROTO_HTTP &&
-            g_http_req[worker_idx].hdr_len == 0) {
-            bool ka = state->cfg.txn_per_conn > 1;
-            http_conn_t tmp;
-            http11_conn_init(&tmp);
-            const char *extra = g_http_custom_hdrs[state->cfg.flow_idx];
-            http_request_t req = {
-                .method        = (http_method_t)state->cfg.http_method,
-                .url           = state->cfg.http_url[0] ? state->cfg.http_url : "/",
-                .host          = state->cfg.http_host[0] ? state->cfg.http_host : "localhost",
-                .keep_alive    = ka,
-                .extra_headers = (extra && extra[0]) ? extra : NULL,
-            };
-            int n = http11_tx_request(&tmp, &req);
-            if (n > 0) {
-                memcpy(g_http_req[worker_idx].hdr, tmp.tx_hdr, (size_t)n);
-                g_http_req[worker_idx].hdr_len = (uint32_t)n;
-                g_http_req[worker_idx].keep_alive = ka;
-                g_http_req[worker_idx].txn_per_conn = state->cfg.txn_per_conn;
-                g_http_req[worker_idx].think_time_us = state->cfg.think_time_us;
-                g_http_req[worker_idx].expected_interval_us =
-                    state->cfg.rate_pps > 0
-                        ? 1000000ULL / state->cfg.rate_pps : 0;
-            }
-        }
+        /* No RETA entry maps to this worker's RX queue: any SYN-ACK
+         * would be delivered to another worker, so originate nothing. */
+        if (state->cfg.steer_ctx != RSS_STEER_NONE &&
+            !rss_steer_serves(state->cfg.steer_ctx, worker_idx))
+            return 0;
 
-        uint32_t initiated = 0;
-        for (uint32_t i = 0; i < to_send; i++) {
-            /* IP range pool: cycle through src IPs */
-            uint32_t cur_src_ip = state->cfg.src_ip;
-            if (state->cfg.src_ip_count > 1) {
-                uint32_t offset = state->ip_pool_idx %
-                                  state->cfg.src_ip_count;
-                state->ip_pool_idx++;
-                /* src_ip is network byte order — convert, add, convert back */
-                cur_src_ip = rte_cpu_to_be_32(
-                    rte_be_to_cpu_32(state->cfg.src_ip) + offset);
-            }
-            uint16_t src_port;
-            if (tcp_port_alloc(worker_idx, cur_src_ip,
-                               &src_port) < 0)
-                break;   /* port pool exhausted */
-            tcb_t *tcb = tcp_fsm_connect(worker_idx,
-                             cur_src_ip, src_port,
-                             state->cfg.dst_ip, state->cfg.dst_port,
-                             state->cfg.port_id);
-            if (!tcb) {
-                tcp_port_free_immediate(worker_idx, cur_src_ip, src_port);
-                break;   /* TCB store full */
-            }
-            tcb->dscp    = state->cfg.dscp;
-            tcb->vlan_id = state->cfg.vlan_id;
-            tcb->cc_algo = state->cfg.cc_algo;
-            if (state->cfg.max_initiations > 0)
-                tcb->graceful_close = true;
-            /* Mark connection for HTTP request after ESTABLISHED */
-            if (state->cfg.proto == TX_GEN_PROTO_HTTP) {
-                tcb->app_ctx = &g_http_req[worker_idx];
-                if (state->cfg.enable_tls) {
-                    /* HTTPS: TLS handshake first, then HTTP after TLS done.
-                     * app_state 1 → TLS handshake → app_state 3 (TLS ok) →
-                     * then the ESTABLISHED data handler sends HTTP. */
-                    tcb->app_state = 1; /* 1 = TLS requested */
-                } else {
-                    /* Plain HTTP: send request immediately after TCP ESTABLISHED */
-                    tcb->app_state = 4; /* 4 = HTTP send request */
-                }
-            } else if (state->cfg.enable_tls) {
-                /* Raw TLS (no HTTP): just do TLS handshake */
-                tcb->app_state = 1; /* 1 = TLS requested */
-            }
+        /* The port cap counts the SYNs this generator sends; the rest
+         * of each connection is paced by TCP, not here. */
+        tx_gen_bucket_t *pb = port_shaper(state, worker_idx, now);
+        int64_t syn_l1 = layer_bytes(state, TX_GEN_LAYER_L1,
+                             SYN_FRAME_LEN + (state->cfg.vlan_id
+                                 ? sizeof(struct rte_vlan_hdr) : 0), 1);
+        if (pb && pb->tokens <= 0)
+            return 0;
+        uint32_t syn_max = pb ? (uint32_t)TGEN_MIN(
+                                    (pb->tokens + syn_l1 - 1) / syn_l1,
+                                    (int64_t)UINT32_MAX)
+                              : UINT32_MAX;
+
+        /* Pooled HTTP: transactions go to parked connections first */
+        uint32_t lent = 0;
+        if (state->pool_key != 0)
+            lent = pool_lend(state, worker_idx, to_send);
+
+        /* Pace connection opens: keep this flow's handshakes in flight
+         * within its SYN window so a burst cannot overrun the peer's
+         * SYN backlog and stall in RTO retransmit storms. */
+        uint32_t room = tcp_hs_win_room(worker_idx, state->cfg.flow_idx);
+        if (room == 0 && lent == 0)
+            return 0;   /* wait for handshakes to complete */
+        to_send = lent + TGEN_MIN(TGEN_MIN(to_send - lent, room), syn_max);
+
+        uint32_t initiated = lent;
+        tcb_t *tcb;
+        while (initiated < to_send &&
+               (tcb = conn_open(state, worker_idx)) != NULL) {
+            if (state->pool_key != 0)
+                conn_pool_opened(worker_idx, tcb, state->pool_key, false);
             initiated++;
         }
+        uint32_t syns = initiated - lent;
+        if (state->pool_key != 0)
+            syns += pool_warm(state, worker_idx,
+                              TGEN_MIN(syn_max - syns,
+                                       (uint32_t)TX_GEN_MAX_BURST));
+        if (pb)
+            pb->tokens -= (int64_t)syns * syn_l1;
         state->pkts_sent += initiated;
         if (state->cfg.rate_pps > 0) {
             /* Always consume at least 1 token per attempt so that
@@ -444,17 +1569,20 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
             state->tp_n_streams = 0;
             for (uint32_t i = 0; i < streams; i++) {
                 uint16_t src_port;
-                if (tcp_port_alloc(worker_idx, state->cfg.src_ip,
-                                   &src_port) < 0)
+                if (tcp_port_alloc(worker_idx, state->cfg.steer_ctx,
+                                   state->cfg.src_ip, &src_port) < 0)
                     break;
                 tcb_t *tcb = tcp_fsm_connect(worker_idx,
                                  state->cfg.src_ip, src_port,
                                  state->cfg.dst_ip, state->cfg.dst_port,
-                                 state->cfg.port_id);
+                                 state->cfg.port_id,
+                                 (uint16_t)state->cfg.flow_idx);
                 if (!tcb) {
-                    tcp_port_free(worker_idx, state->cfg.src_ip, src_port);
+                    tcp_port_free(worker_idx, state->cfg.steer_ctx,
+                                  state->cfg.src_ip, src_port);
                     break;
                 }
+                tcb->steer_ctx = state->cfg.steer_ctx;
                 tcb->app_ctx = (void *)1; /* mark as throughput (not SYN-only) */
                 tcb->dscp    = state->cfg.dscp;
                 tcb->vlan_id = state->cfg.vlan_id;
@@ -469,10 +1597,15 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
             return state->tp_n_streams;
         }
 
-        /* Phase 1: Pump data on established connections */
+        /* Phase 1: Pump data on established connections, each segment
+         * charged to the byte buckets as payload plus headers. */
         uint32_t sent_total = 0;
         uint8_t ct_buf[2048];
+        tx_gen_bucket_t *pb = port_shaper(state, worker_idx, now);
+        tx_gen_bucket_t *fb = state->cfg.rate_bps ? &state->bytes : NULL;
         for (uint32_t i = 0; i < state->tp_n_streams; i++) {
+            if ((fb && fb->tokens <= 0) || (pb && pb->tokens <= 0))
+                break;
             tcb_t *tcb = (tcb_t *)state->tp_tcbs[i];
             if (!tcb || (tcb->state != TCP_ESTABLISHED &&
                          tcb->state != TCP_CLOSE_WAIT))
@@ -489,6 +1622,7 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
                                      ct_buf, (uint32_t)ct_len);
                         if (rc > 0) {
                             sent_total++;
+                            tp_charge(state, fb, pb, (uint32_t)rc);
                             worker_metrics_add_tls_tx(worker_idx);
                         }
                     }
@@ -496,10 +1630,13 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
             } else if (!tls) {
                 /* Send multiple segments to fill the TCP window */
                 for (int seg = 0; seg < 32; seg++) {
+                    if ((fb && fb->tokens <= 0) || (pb && pb->tokens <= 0))
+                        break;
                     int rc = tcp_fsm_send(worker_idx, tcb,
                                  g_tp_zero_buf, (uint32_t)sizeof(g_tp_zero_buf));
                     if (rc <= 0) break; /* window full or error */
                     sent_total++;
+                    tp_charge(state, fb, pb, (uint32_t)rc);
                 }
             }
         }
@@ -508,19 +1645,58 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
     }
 
     /* ── Build packet burst (ICMP / UDP) ────────────────────────────── */
+    /* A bounded flow (rfc2544 back-to-back bursts) sends exactly
+     * max_initiations frames, not up to a burst more. */
+    if (state->cfg.max_initiations > 0)
+        to_send = TGEN_MIN(to_send, (uint32_t)(state->cfg.max_initiations -
+                                               state->pkts_sent));
+    tx_gen_bucket_t *pb = port_shaper(state, worker_idx, now);
+    if (state->cfg.rate_bps > 0 || pb)
+        to_send = budget_pkts(state,
+                              state->cfg.rate_bps ? state->bytes.tokens : INT64_MAX,
+                              pb ? pb->tokens : INT64_MAX, to_send);
+    if (to_send == 0)
+        return 0;
     struct rte_mbuf *pkts[TX_GEN_MAX_BURST];
+    uint16_t lens[TX_GEN_MAX_BURST];    /* TX_GEN_F_SIZES only */
     uint32_t built = 0;
-    for (uint32_t i = 0; i < to_send; i++) {
-        pkts[built] = build_packet(state, mp);
-        if (pkts[built])
-            built++;
-        else
-            break;   /* mempool exhaustion — stop building */
+    if ((state->cfg.gen_flags & TX_GEN_F_REPLAY) && !state->replay &&
+        state->tmpl_ok && !replay_build(state, mp, worker_idx))
+        state->cfg.gen_flags &= (uint8_t)~TX_GEN_F_REPLAY;
+    if (state->replay) {
+        /* Replay: reference the pre-built mbufs, the PMD's free after
+         * transmit just drops the extra reference. */
+        uint16_t idx = state->replay_idx;
+        for (; built < to_send; built++) {
+            struct rte_mbuf *m = state->replay[idx];
+            if (++idx == state->replay_n)
+                idx = 0;
+            rte_mbuf_refcnt_update(m, 1);
+            pkts[built] = m;
+        }
+        state->replay_idx = idx;
+    }
+    /* One bulk allocation for the rest of the burst; if the pool can't
+     * cover it whole, skip this round rather than trickle packets out. */
+    if (built < to_send &&
+        tgen_mbuf_alloc_bulk(worker_idx, mp, &pkts[built],
+                             to_send - built) == 0) {
+        uint32_t n = to_send;
+        for (; built < n; built++) {
+            if (unlikely(!build_packet(state, pkts[built], worker_idx))) {
+                rte_pktmbuf_free_bulk(&pkts[built], n - built);
+                break;
+            }
+            lens[built] = (uint16_t)pkts[built]->pkt_len;
+        }
     }
     if (built == 0)
         return 0;
+    if (ps && state->pace_hw)
+        pace_stamp(state, pkts, built, when);
 
     /* ── Transmit ───────────────────────────────────────────────────── */
+    uint64_t tx_tsc = ps ? rte_rdtsc() : 0;
     uint16_t sent = rte_eth_tx_burst(state->cfg.port_id,
                                      state->tx_queue_id,
                                      pkts, (uint16_t)built);
@@ -532,21 +1708,119 @@ tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
     }
 
     state->pkts_sent += sent;
-    if (state->cfg.rate_pps > 0 && sent <= state->tokens)
+    if (ps) {
+        /* Only sent packets consume their slots; the rest stay due */
+        if (sent > 0) {
+            pace_account(state, ps, when, sent, tx_tsc);
+            state->pace_next = when[sent];
+            state->pace_frac = frac[sent];
+        }
+    } else if (state->cfg.rate_pps > 0 && sent <= state->tokens) {
         state->tokens -= sent;
+    }
+
+    /* Unsent probes are the highest sequences of the burst: hand them
+     * out again so the receiver sees no gap for a local TX drop. */
+    if (state->cfg.gen_flags & TX_GEN_F_PROBE) {
+        state->probe_seq -= built - sent;
+        g_udp_probe_tx[worker_idx][state->cfg.flow_idx %
+                                   UDP_PROBE_MAX_FLOWS] += sent;
+    }
+    /* Likewise their size slots, keeping the schedule's ratios exact */
+    if (state->size_n)
+        state->size_idx = (uint16_t)((state->size_idx + state->size_n -
+                                      (built - sent) % state->size_n) %
+                                     state->size_n);
 
     /* ── Metrics ────────────────────────────────────────────────────── */
-    uint64_t tx_total_bytes = 0;
-    for (uint16_t i = 0; i < sent; i++)
-        tx_total_bytes += pkts[i]->pkt_len;
-    worker_metrics_add_tx(worker_idx, sent, tx_total_bytes);
+    /* Sent mbufs may already have been recycled by the PMD, so don't
+     * read them back: lengths come from lens[] or the fixed frame_len. */
+    uint64_t bytes = 0;
+    if (state->size_n) {
+        for (uint16_t i = 0; i < sent; i++) {
+            bytes += lens[i];
+            worker_metrics_add_tx_size(worker_idx,
+                size_dist_bin(lens[i] + RTE_ETHER_CRC_LEN), 1);
+        }
+    } else {
+        bytes = (uint64_t)sent * state->frame_len;
+        worker_metrics_add_tx_size(worker_idx, state->size_bin, sent);
+    }
+    worker_metrics_add_tx(worker_idx, sent, bytes);
+    flow_metrics_add_tx(worker_idx, state->cfg.flow_idx, sent, bytes);
+    if (state->cfg.rate_bps > 0)
+        state->bytes.tokens -= layer_bytes(state, state->cfg.rate_layer,
+                                           bytes, sent);
+    if (pb)
+        pb->tokens -= layer_bytes(state, TX_GEN_LAYER_L1, bytes, sent);
     if (state->cfg.proto == TX_GEN_PROTO_ICMP) {
         for (uint16_t i = 0; i < sent; i++)
             worker_metrics_add_icmp_echo_tx(worker_idx);
+        flow_metrics_add(worker_idx, state->cfg.flow_idx, icmp_echo_tx, sent);
     } else if (state->cfg.proto == TX_GEN_PROTO_UDP) {
         for (uint16_t i = 0; i < sent; i++)
             worker_metrics_add_udp_tx(worker_idx);
+        flow_metrics_add(worker_idx, state->cfg.flow_idx, udp_tx, sent);
     }
 
     return sent;
 }
+
+uint64_t
+tx_gen_next_tsc(const tx_gen_state_t *state, uint32_t worker_idx,
+                uint64_t now)
+{
+    uint64_t hz = rte_get_tsc_hz();
+    uint64_t t  = now;
+
+    if (state->cfg.http_open_loop) {
+        /* The next intended request (now while behind, backing off
+         * while the pool is saturated) */
+        t = http_ol_next_tsc(worker_idx, state->cfg.flow_idx, now);
+    } else if ((state->cfg.gen_flags & TX_GEN_F_PACE) && state->cfg.rate_pps > 0) {
+        /* The next slot, less the scheduled-send lead */
+        t = state->pace_next;
+        if (state->pace_hw)
+            t -= PACE_HW_LEAD_US * hz / 1000000;
+    } else if (state->cfg.gen_flags & TX_GEN_F_SCHED) {
+        /* The schedule clock runs at the profile's level, not the TSC:
+         * nothing to work out, poll */
+    } else if (state->cfg.rate_bps > 0) {
+        /* Until the refill lifts the byte bucket to one byte */
+        if (state->bytes.tokens <= 0) {
+            uint64_t bps  = eff_rate(state, now, state->cfg.rate_bps);
+            uint64_t need = (uint64_t)(1 - state->bytes.tokens) * 8 * hz -
+                            state->bytes.frac;
+            t = bps ? state->bytes.last_tsc + (need + bps - 1) / bps
+                    : UINT64_MAX;
+        }
+    } else if (state->cfg.rate_pps > 0 && state->tokens == 0) {
+        /* Until the next token */
+        uint64_t rate = eff_rate(state, now, state->cfg.rate_pps);
+        if (state->cfg.gen_flags & TX_GEN_F_POISSON)
+            t = state->pois_next;
+        else
+            t = rate ? state->last_refill_tsc + (hz + rate - 1) / rate
+                     : UINT64_MAX;
+    }
+
+    if (state->cfg.proto == TX_GEN_PROTO_PCAP) {
+        /* Timed capture: not before the next frame is due */
+        const pcap_replay_t   *pr = g_pcap_replays[state->cfg.flow_idx];
+        const pcap_replay_q_t *q  = &pr->q[state->rate_rank %
+                                          TGEN_MAX_WORKERS];
+        if (q->due && state->pcap_idx < q->n) {
+            uint64_t f = state->pcap_base + q->due[state->pcap_idx];
+            if (f > t)
+                t = f;
+        }
+    } else if (!tx_gen_proto_stateless(state->cfg.proto) &&
+               state->cfg.steer_ctx != RSS_STEER_NONE &&
+               !rss_steer_serves(state->cfg.steer_ctx, worker_idx)) {
+        t = UINT64_MAX;         /* this worker never originates */
+    }
+
+    if (state->deadline_tsc > 0 && state->deadline_tsc < t)
+        t = state->deadline_tsc;
+    return t;
+}
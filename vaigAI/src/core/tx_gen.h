@@ -16,6 +16,8 @@
 #include <rte_mbuf.h>
 #include <rte_ether.h>
 #include "../common/types.h"
+#include "field_var.h"
+#include "size_dist.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,9 +30,36 @@ typedef enum {
     TX_GEN_PROTO_TCP_SYN,       /* TCP SYN TPS                          */
     TX_GEN_PROTO_HTTP,          /* HTTP request TPS                     */
     TX_GEN_PROTO_THROUGHPUT,    /* TCP bulk data throughput              */
+    TX_GEN_PROTO_PCAP,          /* capture replay (pcap_replay.h)       */
+    TX_GEN_PROTO_L7,            /* stateful L7 replay (l7_replay.h)     */
     TX_GEN_PROTO_MAX,
 } tx_gen_proto_t;
 
+/* Largest stateless frame served from the per-flow template; bigger frames
+ * fall back to building every field. */
+#define TX_GEN_TMPL_MAX  1536
+
+/* Throughput mode (TCP --reuse): payload offered per segment. */
+#define TX_GEN_TP_SEG_LEN 1400
+
+/* Replay ring bounds (TX_GEN_F_REPLAY): packets pre-built per worker. */
+#define TX_GEN_REPLAY_MAX 1024
+
+/* tx_gen_config_t.gen_flags */
+#define TX_GEN_F_REPLAY   0x01  /* transmit a pre-built packet ring */
+#define TX_GEN_F_FIELDS   0x02  /* apply g_field_progs[flow_idx] per packet */
+#define TX_GEN_F_PROBE    0x04  /* UDP: stamp a udp_probe_hdr_t payload  */
+#define TX_GEN_F_SIZES    0x08  /* frame sizes from g_size_dists[flow_idx] */
+#define TX_GEN_F_PACE     0x10  /* per-packet launch schedule (needs rate) */
+#define TX_GEN_F_PACE_SW  0x20  /* PACE: never hand launch times to the NIC */
+#define TX_GEN_F_SCHED    0x40  /* rate follows g_rate_scheds[flow_idx]  */
+#define TX_GEN_F_POISSON  0x80  /* rate_pps: exponential inter-arrivals  */
+
+/* tx_gen_config_t.rate_layer: the bytes rate_bps counts per frame */
+#define TX_GEN_LAYER_L1   0     /* frame + FCS + preamble, SFD and IFG */
+#define TX_GEN_LAYER_L2   1     /* frame incl. FCS                     */
+#define TX_GEN_LAYER_L3   2     /* IP packet                           */
+
 /* ── Configuration (sent from mgmt → worker via IPC payload) ─────────────
  *    Must fit in the 248-byte config_update_t.payload field.            */
 typedef struct {
@@ -41,7 +70,8 @@ typedef struct {
     struct rte_ether_addr src_mac;
     uint16_t              dst_port;     /* host byte order (UDP/TCP)     */
     uint16_t              src_port;     /* host byte order (UDP/TCP)     */
-    uint16_t              pkt_size;     /* protocol payload size (bytes) */
+    uint16_t              pkt_size;     /* protocol payload size (bytes);
+                                           TX_GEN_F_SIZES: the largest  */
     uint16_t              port_id;      /* DPDK port to transmit on      */
     uint64_t              rate_pps;     /* 0 = unlimited (line rate)     */
     uint32_t              duration_s;   /* 0 = run until stopped         */
@@ -49,22 +79,106 @@ typedef struct {
     bool                  enable_tls;   /* initiate TLS after TCP 3WHS   */
     uint8_t               http_method;  /* http_method_t (0=GET,1=POST…) */
     uint8_t               throughput_streams; /* streams for THROUGHPUT (1-16) */
-    uint8_t               _pad[1];      /* alignment padding             */
+    uint8_t               steer_ctx;    /* RSS steering ctx (0 = none)   */
     uint32_t              ramp_s;       /* ramp-up duration (0 = instant) */
     uint32_t              txn_per_conn; /* HTTP txns per conn (0 = 1 shot) */
     uint32_t              think_time_us;/* think time between txns in µs  */
     char                  http_url[64]; /* URL path for HTTP TPS         */
     char                  http_host[64];/* Host: header for HTTP TPS    */
-    uint32_t              flow_idx;     /* client flow slot (0-15)       */
+    uint32_t              flow_idx;     /* client flow slot              */
     uint8_t               dscp;         /* DSCP value (0-63), shifted to TOS */
     uint8_t               cc_algo;      /* 0=NewReno, 1=CUBIC           */
     uint16_t              vlan_id;      /* 802.1Q VLAN ID (0=none)       */
     uint32_t              src_ip_count; /* IP range: #IPs from src_ip (0/1=single) */
+    uint8_t               gen_flags;    /* TX_GEN_F_*                    */
+    uint8_t               rate_layer;   /* TX_GEN_LAYER_* of rate_bps    */
+    uint64_t              rate_bps;     /* bits/s, replaces rate_pps (udp,
+                                           icmp, tcp --reuse); 0 = off  */
+    uint32_t              pcap_loops;   /* PCAP: passes, 0 = until stopped */
+    uint32_t              syn_window;   /* TCP/HTTP/L7: handshakes in flight
+                                           per worker (ceiling if adaptive),
+                                           0 = TCP_HS_WIN_DEFAULT         */
+    bool                  syn_adaptive; /* AIMD the SYN window            */
+    bool                  http_open_loop; /* HTTP: requests at rate_pps on a
+                                           connection pool (app/http_ol.h) */
+    uint32_t              ol_conns;     /* open loop: pool size over all
+                                           workers, 0 = HTTP_OL_DEF_CONNS
+                                           per worker                    */
+    uint16_t              pool_max;     /* HTTP: idle connections kept per
+                                           worker (app/conn_pool.h),
+                                           0 = no pool                   */
+    uint16_t              pool_min;     /* pool: opened ahead of demand  */
+    uint32_t              pool_idle_ms; /* pool: idle timeout, 0 = default */
+    uint8_t               http_pipeline;/* HTTP: requests per pipelined
+                                           batch (≤ 1 = no pipelining)  */
 } tx_gen_config_t;
 
 _Static_assert(sizeof(tx_gen_config_t) <= 248,
                "tx_gen_config_t must fit in IPC payload");
 
+/* ── Byte token bucket ────────────────────────────────────────────────────── */
+
+/* Shapes rate_bps and the per-port caps.  A burst is cut after the packet
+ * that empties the bucket and the overdraft is carried as negative
+ * tokens, so the mean rate is exact for any mix of frame sizes. */
+typedef struct {
+    int64_t  tokens;            /* bytes                              */
+    uint64_t frac;              /* refill remainder, bit-cycles       */
+    uint64_t last_tsc;          /* 0 = not started                    */
+} tx_gen_bucket_t;
+
+/* Per-port L1 caps (bits/s, 0 = none), set by mgmt at any time.  Each
+ * generating worker on the port gets an even share, shaped by its own
+ * bucket across all of its flows: g_port_shaper[worker][port]. */
+extern uint64_t        g_port_cap_bps[TGEN_MAX_PORTS];
+extern tx_gen_bucket_t g_port_shaper[TGEN_MAX_WORKERS][TGEN_MAX_PORTS];
+
+/* CFG_CMD_SET_RATE payload */
+typedef struct {
+    uint64_t rate;              /* pps, or bits/s with bps            */
+    uint32_t flow_idx;          /* UINT32_MAX = every flow            */
+    bool     bps;
+    uint8_t  layer;             /* TX_GEN_LAYER_* with bps            */
+} tx_gen_rate_update_t;
+
+/* ── Pacing statistics ────────────────────────────────────────────────────── */
+
+/* Per generator, in its tx_gen_state_t; written by the generator only
+ * and zeroed by each START of its slot.  Gaps are launch-to-launch: the
+ * TSC of the tx_burst call in software mode (packets sharing a call
+ * count as 0), the stamped times with scheduled send.  The latter are
+ * what the NIC was asked for, not what it did; reports label them. */
+typedef struct {
+    uint64_t gaps;
+    uint64_t sum_ns;
+    double   sumsq_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t late_max_ns;       /* worst launch behind its due time   */
+    uint64_t resyncs;           /* schedule dropped after falling behind */
+    uint64_t target_ns;         /* gap at the current rate            */
+    bool     hw;                /* scheduled send                     */
+} tx_gen_pace_stats_t;
+
+/* ── Pre-built HTTP request (one per generator, reused across connections) */
+#define TX_GEN_PIPE_MAX    16       /* requests per pipelined batch     */
+#define TX_GEN_PIPE_BYTES  4000     /* batch bytes: one TLS record in a
+                                       4 KiB ciphertext buffer         */
+
+typedef struct {
+    uint8_t  hdr[1024];
+    uint32_t hdr_len;
+    bool     keep_alive;          /* recycle: state 4→5→4 loop */
+    uint32_t txn_per_conn;        /* max transactions per conn (0 = 1 shot) */
+    uint32_t think_time_us;       /* inter-transaction think time in µs */
+    uint64_t expected_interval_us;/* CO correction: tx_gen_http_interval_us() */
+    /* Pipelining: pipe_depth copies of hdr back to back; a batch of k
+     * requests is the first k * hdr_len bytes.  pipe_depth ≤ 1 = off. */
+    uint8_t  pipe_depth;
+    bool     head;                /* HEAD: responses carry no body */
+    uint8_t  pipe[TX_GEN_PIPE_BYTES];
+} http_prebuilt_req_t;
+
 /* ── Per-worker generation state ──────────────────────────────────────────── */
 
 typedef struct {
@@ -75,9 +189,13 @@ typedef struct {
     uint64_t        start_tsc;
     uint64_t        deadline_tsc;       /* 0 = no deadline              */
 
-    /* Token bucket (rate limiting) */
+    /* Token bucket (rate limiting).  The buckets run on the flow clock:
+     * the TSC, or the schedule clock with TX_GEN_F_SCHED. */
     uint64_t        tokens;
     uint64_t        last_refill_tsc;
+    uint64_t        pois_next;          /* TX_GEN_F_POISSON: next arrival */
+    tx_gen_bucket_t bytes;              /* cfg.rate_bps                 */
+    uint16_t        cap_n;              /* workers sharing the port cap */
 
     /* Counters */
     uint64_t        pkts_sent;
@@ -96,23 +214,129 @@ typedef struct {
 
     /* IP range pool: round-robin index for src_ip cycling */
     uint32_t        ip_pool_idx;
+
+    /* Rate split: this worker is generator rate_rank of rate_n on the
+     * port; cfg.rate_pps holds its share of the flow's total rate. */
+    uint16_t        rate_rank;
+    uint16_t        rate_n;
+
+    /* Stateless (ICMP/UDP) frame template, built by tx_gen_configure().
+     * Holds the frame for packet_id = 0, seq = 0 and the base src_ip;
+     * per-packet fields are patched and checksums adjusted (RFC 1624). */
+    uint16_t        frame_len;          /* bytes per generated frame    */
+    uint16_t        tmpl_l3_off;        /* IPv4 header offset in frame  */
+    uint16_t        tmpl_ip_ck;         /* IPv4 cksum of the template   */
+    uint16_t        tmpl_l4_ck;         /* ICMP/UDP cksum of template   */
+    bool            tmpl_ok;            /* frame fits in tmpl[]         */
+    bool            tmpl_hw_l4;         /* UDP cksum left to the NIC    */
+    uint8_t         tmpl[TX_GEN_TMPL_MAX] __rte_cache_aligned;
+
+    /* Replay ring (TX_GEN_F_REPLAY): pre-built mbufs transmitted by
+     * reference — refcnt bumped per send, never written again. */
+    struct rte_mbuf **replay;
+    uint16_t        replay_n;
+    uint16_t        replay_idx;
+
+    /* Capture replay (TX_GEN_PROTO_PCAP): position in this generator's
+     * share of g_pcap_replays[flow] and the TSC its current pass began. */
+    uint32_t        pcap_idx;
+    uint32_t        pcap_loop;
+    uint64_t        pcap_base;
+
+    /* L7 replay (TX_GEN_PROTO_L7): conversation of the next connection */
+    uint32_t        l7_next;
+
+    /* Connection pool (cfg.pool_max): target key, set at START */
+    uint8_t         pool_key;
+
+    /* Field variation (TX_GEN_F_FIELDS), positioned by tx_gen_start() */
+    field_var_state_t fv;
+
+    /* UDP probes (TX_GEN_F_PROBE): next sequence of this generator */
+    uint64_t        probe_seq;
+
+    /* Frame sizes (TX_GEN_F_SIZES): shuffled schedule of frame lengths
+     * (no FCS), one slot per packet; frame_len is the largest. */
+    uint16_t        size_n;
+    uint16_t        size_idx;
+    uint16_t        size_bin;           /* fixed size: histogram bin    */
+    uint16_t        size_fill_ck;       /* payload sum of the template  */
+    uint16_t        size_sched[SIZE_DIST_SCHED];
+
+    /* Pacing (TX_GEN_F_PACE): TSC launch time of every packet, one gap
+     * of the effective rate apart.  pace_frac carries the remainder of
+     * hz / rate so the mean gap is exact at any rate. */
+    uint64_t        pace_next;          /* due time of the next packet  */
+    uint64_t        pace_frac;          /* remainder, 1/rate cycles     */
+    uint64_t        pace_last;          /* launch of the previous one   */
+    /* Scheduled send: due times are stamped in NIC clock units,
+     * nic = nic_base + (tsc - tsc_base) * nic_per_tsc, rebased against
+     * the device clock while running. */
+    bool            pace_hw;
+    double          pace_nic_per_tsc;
+    uint64_t        pace_tsc_base;
+    uint64_t        pace_nic_base;
+    uint64_t        pace_tsc0;          /* first anchor, for the ratio  */
+    uint64_t        pace_nic0;
+    tx_gen_pace_stats_t pace;           /* for tx_gen_pace_report()     */
+
+    /* HTTP: the flow's request, built by tx_gen_start(); the flow's
+     * connections point tcb->app_ctx here. */
+    http_prebuilt_req_t http_req;
 } tx_gen_state_t;
 
-/* ── Pre-built HTTP request (one per worker, reused across connections) ──── */
+/** Aggregated pacing view of one flow (management thread). */
 typedef struct {
-    uint8_t  hdr[1024];
-    uint32_t hdr_len;
-    bool     keep_alive;          /* recycle: state 4→5→4 loop */
-    uint32_t txn_per_conn;        /* max transactions per conn (0 = 1 shot) */
-    uint32_t think_time_us;       /* inter-transaction think time in µs */
-    uint64_t expected_interval_us;/* CO correction: 1M/rate_pps (0 = disabled) */
-} http_prebuilt_req_t;
+    uint32_t generators;
+    uint32_t hw;                /* generators using scheduled send    */
+    uint64_t gaps;
+    double   target_ns;         /* mean over generators               */
+    double   mean_ns;
+    double   stddev_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t late_max_ns;
+    uint64_t resyncs;
+} tx_gen_pace_report_t;
 
-extern http_prebuilt_req_t g_http_req[TGEN_MAX_WORKERS];
-extern char g_http_custom_hdrs[TGEN_MAX_CLIENT_FLOWS][512];
+/* Per-flow custom HTTP headers, "Name: value\r\n"…; NULL until the slot
+ * first uses them. */
+#define TX_GEN_HTTP_HDRS_MAX  512
+extern char *g_http_custom_hdrs[TGEN_MAX_CLIENT_FLOWS];
+
+/** Management: the custom-header slot of `flow_idx` (TX_GEN_HTTP_HDRS_MAX
+ *  bytes), allocated on first use; NULL when out of memory. */
+char *tx_gen_http_hdrs_slot(uint32_t flow_idx);
 
 /* ── API ──────────────────────────────────────────────────────────────────── */
 
+/** True for protocols that need no RX on the generating worker. */
+static inline bool tx_gen_proto_stateless(tx_gen_proto_t proto)
+{
+    return proto == TX_GEN_PROTO_ICMP || proto == TX_GEN_PROTO_UDP ||
+           proto == TX_GEN_PROTO_PCAP;
+}
+
+/** Share of a flow-total rate for generator `rank` of `n`: the total
+ *  divided evenly, remainder going to the lowest ranks.  0 = no share
+ *  (only possible when total < n; total 0 stays "unlimited"). */
+static inline uint64_t tx_gen_rate_share(uint64_t total, uint32_t rank,
+                                         uint32_t n)
+{
+    if (total == 0 || n <= 1)
+        return total;
+    return total / n + (rank < total % n ? 1 : 0);
+}
+
+/** CO-correction interval of an HTTP generator: one request gap at its
+ *  rate share, in µs.  0 without a rate, and for open loop, which
+ *  measures from intended send times instead. */
+static inline uint64_t tx_gen_http_interval_us(const tx_gen_state_t *state)
+{
+    return (state->cfg.rate_pps > 0 && !state->cfg.http_open_loop)
+               ? 1000000ULL / state->cfg.rate_pps : 0;
+}
+
 /** Load configuration into the generator (does NOT start it).
  *  @param tx_queue  TX queue this worker owns on the target port. */
 void tx_gen_configure(tx_gen_state_t *state, const tx_gen_config_t *cfg,
@@ -124,11 +348,20 @@ void tx_gen_start(tx_gen_state_t *state);
 /** Disarm the generator — stops packet production immediately. */
 void tx_gen_stop(tx_gen_state_t *state);
 
+/** Management: pool a flow's pacing statistics over all workers. */
+void tx_gen_pace_report(uint32_t flow_idx, tx_gen_pace_report_t *out);
+
 /** Generate and transmit a burst of packets (called from worker loop).
  *  Returns number of packets successfully transmitted. */
 uint32_t tx_gen_burst(tx_gen_state_t *state, struct rte_mempool *mp,
                       uint32_t worker_idx);
 
+/** Earliest TSC the generator can send again after a burst at `now`:
+ *  the next token, byte credit, pacing slot or capture frame, or its
+ *  deadline.  `now` or earlier = poll again next iteration. */
+uint64_t tx_gen_next_tsc(const tx_gen_state_t *state, uint32_t worker_idx,
+                         uint64_t now);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-worker active-flow scheduler — calendar queue.
+ */
+#include "tx_sched.h"
+
+#include <string.h>
+
+#define BUCKET_MASK  (TX_SCHED_BUCKETS - 1)
+
+_Static_assert((TX_SCHED_BUCKETS & BUCKET_MASK) == 0,
+               "TX_SCHED_BUCKETS must be a power of two");
+
+void
+tx_sched_init(tx_sched_t *s, uint64_t hz, uint64_t now)
+{
+    memset(s->head, 0xFF, sizeof(s->head));
+    memset(s->chain, 0xFF, sizeof(s->chain));
+    __atomic_store_n(&s->n_act, 0, __ATOMIC_RELEASE);
+
+    /* Largest power of two not above the target width */
+    uint64_t width = hz / (1000000000ull / TX_SCHED_BUCKET_NS);
+    s->shift = 0;
+    while (width > 1 && (2ull << s->shift) <= width)
+        s->shift++;
+    s->horizon = hz / 1000000 * TX_SCHED_HORIZON_US;
+    uint64_t half = ((uint64_t)TX_SCHED_BUCKETS / 2) << s->shift;
+    if (s->horizon > half)
+        s->horizon = half;
+    s->cur = now >> s->shift;
+}
+
+static inline void
+chain_unlink(tx_sched_t *s, uint32_t f)
+{
+    uint16_t c = s->chain[f];
+    if (c == TX_SCHED_NIL)
+        return;
+    uint16_t n = s->next[f], p = s->prev[f];
+    if (p == TX_SCHED_NIL)
+        s->head[c] = n;
+    else
+        s->next[p] = n;
+    if (n != TX_SCHED_NIL)
+        s->prev[n] = p;
+    s->chain[f] = TX_SCHED_NIL;
+}
+
+static inline void
+chain_push(tx_sched_t *s, uint32_t f, uint16_t c)
+{
+    uint16_t h = s->head[c];
+    s->next[f]  = h;
+    s->prev[f]  = TX_SCHED_NIL;
+    if (h != TX_SCHED_NIL)
+        s->prev[h] = (uint16_t)f;
+    s->head[c]  = (uint16_t)f;
+    s->chain[f] = c;
+}
+
+void
+tx_sched_add(tx_sched_t *s, uint32_t flow, uint64_t due, uint64_t now)
+{
+    if (!tx_sched_has(s, flow)) {
+        s->pos[flow] = (uint16_t)s->n_act;
+        s->act[s->n_act] = (uint16_t)flow;
+        __atomic_store_n(&s->n_act, s->n_act + 1, __ATOMIC_RELEASE);
+    }
+    chain_unlink(s, flow);
+    if (due <= now) {
+        chain_push(s, flow, TX_SCHED_READY);
+        return;
+    }
+    if (due - now > s->horizon)
+        due = now + s->horizon;
+    uint64_t bt = due >> s->shift;
+    if (bt < s->cur)
+        bt = s->cur;            /* that bucket was scanned already */
+    s->due[flow] = bt;
+    chain_push(s, flow, (uint16_t)(bt & BUCKET_MASK));
+}
+
+void
+tx_sched_remove(tx_sched_t *s, uint32_t flow)
+{
+    if (!tx_sched_has(s, flow))
+        return;
+    chain_unlink(s, flow);
+    uint32_t p    = s->pos[flow];
+    uint16_t last = s->act[s->n_act - 1];
+    s->act[p]    = last;
+    s->pos[last] = (uint16_t)p;
+    __atomic_store_n(&s->n_act, s->n_act - 1, __ATOMIC_RELEASE);
+}
+
+uint32_t
+tx_sched_due(tx_sched_t *s, uint64_t now)
+{
+    uint32_t n = 0;
+    for (uint16_t f = s->head[TX_SCHED_READY]; f != TX_SCHED_NIL;
+         f = s->next[f]) {
+        s->chain[f] = TX_SCHED_NIL;
+        s->run[n++] = f;
+    }
+    s->head[TX_SCHED_READY] = TX_SCHED_NIL;
+
+    /* Scan the buckets from the cursor up to now; after a long gap one
+     * full turn covers them all. */
+    uint64_t nt = now >> s->shift;
+    if (nt >= s->cur + TX_SCHED_BUCKETS)
+        s->cur = nt - TX_SCHED_BUCKETS + 1;
+    for (; s->cur <= nt; s->cur++) {
+        uint16_t f = s->head[s->cur & BUCKET_MASK];
+        while (f != TX_SCHED_NIL) {
+            uint16_t nx = s->next[f];
+            if (s->due[f] <= nt) {
+                chain_unlink(s, f);
+                s->run[n++] = f;
+            }
+            f = nx;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-worker active-flow scheduler for the TX generators.
+ *
+ * A worker may carry thousands of client flows, most of them waiting on
+ * a token bucket, a pacing slot or a capture timestamp.  Rather than
+ * visiting every slot each loop iteration, the worker keeps:
+ *
+ *   act[]      a dense list of its active flows (stop, set rate, idle
+ *              accounting and the management "any active" check walk it)
+ *   calendar   TX_SCHED_BUCKETS buckets of 2^shift TSC cycles (≈ 4 µs),
+ *              one intrusive chain each, holding every active flow at
+ *              the time tx_gen_next_tsc() says it can next send
+ *   ready      a chain run every iteration: flows that are due now
+ *              (unlimited rate, tokens left, waiting on connections)
+ *
+ * tx_sched_due() takes the ready chain and every calendar bucket up to
+ * the current time into run[]; the worker bursts each and puts it back
+ * with tx_sched_add() or, once the generator went inactive, removes it.
+ * Waits are capped at TX_SCHED_HORIZON_US, or half a turn of the
+ * calendar if shorter.  Each flow also records the bucket time it was
+ * queued for, so one filed a turn ahead (after a long gap between scans)
+ * is passed over until it is due.  Everything is single-writer (the owning worker); management reads
+ * only the active count.
+ */
+#ifndef TGEN_TX_SCHED_H
+#define TGEN_TX_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TX_SCHED_BUCKETS     512u          /* power of two              */
+#define TX_SCHED_BUCKET_NS   4000u         /* target bucket width       */
+#define TX_SCHED_HORIZON_US  1000u         /* longest wait before a poll */
+#define TX_SCHED_NIL         UINT16_MAX    /* end of chain / unqueued   */
+#define TX_SCHED_READY       TX_SCHED_BUCKETS   /* chain index of ready */
+
+_Static_assert(TGEN_MAX_CLIENT_FLOWS < TX_SCHED_NIL,
+               "flow indices must fit the scheduler's 16-bit links");
+
+typedef struct {
+    uint64_t cur;                   /* next bucket time to scan         */
+    uint64_t horizon;               /* TX_SCHED_HORIZON_US in cycles    */
+    uint32_t shift;                 /* bucket time = tsc >> shift       */
+    uint32_t n_act;
+    uint16_t head[TX_SCHED_BUCKETS + 1];   /* [TX_SCHED_READY] = ready  */
+    uint16_t act[TGEN_MAX_CLIENT_FLOWS];
+    uint16_t pos[TGEN_MAX_CLIENT_FLOWS];   /* flow → index in act[]     */
+    uint16_t next[TGEN_MAX_CLIENT_FLOWS];
+    uint16_t prev[TGEN_MAX_CLIENT_FLOWS];
+    uint16_t chain[TGEN_MAX_CLIENT_FLOWS]; /* TX_SCHED_NIL = not queued */
+    uint64_t due[TGEN_MAX_CLIENT_FLOWS];   /* bucket time queued for    */
+    uint16_t run[TGEN_MAX_CLIENT_FLOWS];   /* tx_sched_due() output     */
+} tx_sched_t;
+
+/** Empty the scheduler; `now` anchors the calendar. */
+void tx_sched_init(tx_sched_t *s, uint64_t hz, uint64_t now);
+
+/** True if `flow` is in the active list. */
+static inline bool
+tx_sched_has(const tx_sched_t *s, uint32_t flow)
+{
+    uint32_t p = s->pos[flow];
+    return p < s->n_act && s->act[p] == flow;
+}
+
+/** Active flows (safe from the management thread). */
+static inline uint32_t
+tx_sched_count(const tx_sched_t *s)
+{
+    return __atomic_load_n(&s->n_act, __ATOMIC_ACQUIRE);
+}
+
+/** Make `flow` active if it isn't and queue it for `due` (≤ now: the
+ *  next tx_sched_due()). */
+void tx_sched_add(tx_sched_t *s, uint32_t flow, uint64_t due, uint64_t now);
+
+/** Dequeue `flow` and drop it from the active list. */
+void tx_sched_remove(tx_sched_t *s, uint32_t flow);
+
+/** Move the flows due by `now` to run[] and return how many.  They stay
+ *  active but unqueued until tx_sched_add() or tx_sched_remove(). */
+uint32_t tx_sched_due(tx_sched_t *s, uint64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_TX_SCHED_H */
@@ -8,11 +8,20 @@
 #include "tx_gen.h"
 
 #include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <netinet/in.h>
 #include <rte_ethdev.h>
 #include <rte_mbuf.h>
 #include <rte_cycles.h>
 #include <rte_lcore.h>
 #include <rte_log.h>
+#include <rte_ring.h>
+#include <rte_malloc.h>
+#include <rte_thash.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
 
 #include "../common/util.h"
 #include "../common/types.h"
@@ -26,9 +35,13 @@
 #include "../net/tcp_timer.h"
 /* tcp_tx_flush() declared in tcp_fsm.h — flushes batched TCP TX segments */
 #include "../net/tcp_port_pool.h"
+#include "../net/rss_steer.h"
+#include "../net/tcp_hs_win.h"
 #include "../telemetry/metrics.h"
 #include "../telemetry/cpu_stats.h"
 #include "../app/server.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 
 /* ── Globals ─────────────────────────────────────────────────────────────── */
 volatile int      g_run = 0;
@@ -39,6 +52,20 @@ volatile int      g_run = 0;
 _Atomic int       g_traffic = 0;
 worker_ctx_t      g_worker_ctx[TGEN_MAX_WORKERS];
 
+/* Software distributor rings, [port][target position]; target 0 is the
+ * distributing worker itself and has no ring. */
+#define SW_DIST_RING_SZ   4096
+static struct rte_ring *g_dist_rings[TGEN_MAX_PORTS][TGEN_MAX_WORKERS];
+
+/* Workers attached to each port: ranks [0, n_rx) receive, ranks
+ * [n_rx, n_all) are TX-only.  Flow rates are split over these. */
+static uint32_t g_port_gen_rx[TGEN_MAX_PORTS];
+static uint32_t g_port_gen_all[TGEN_MAX_PORTS];
+
+/* Worker that receives RX queue q of each port (or distributor target q
+ * with --sw-dist), UINT16_MAX if none: [port][q]. */
+static uint16_t g_rxq_worker[TGEN_MAX_PORTS][TGEN_MAX_WORKERS];
+
 /* ── TX drain helper ─────────────────────────────────────────────────────── */
 static inline void tx_drain(worker_ctx_t *ctx,
                               struct rte_mbuf **tx_pkts, uint32_t n)
@@ -55,6 +82,106 @@ static inline void tx_drain(worker_ctx_t *ctx,
     }
 }
 
+/* ── Software distributor ─────────────────────────────────────────────────── */
+/*
+ * Target position for a packet on a distributed port.  Uses the symmetric
+ * Toeplitz key over (src, dst, sport|dport) and the virtual RETA layout
+ * that rss_steer.c assumes, so the worker whose port pool allocated a
+ * tuple is the one that receives its return traffic.  Non-IPv4 and
+ * fragments stay on the distributor.
+ */
+static inline uint32_t sw_dist_target(const struct rte_mbuf *m, uint32_t n_t)
+{
+    const struct rte_ether_hdr *eth =
+        rte_pktmbuf_mtod(m, const struct rte_ether_hdr *);
+    uint32_t off = sizeof(*eth);
+    uint16_t et  = eth->ether_type;
+    if (et == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN)) {
+        const struct rte_vlan_hdr *vh =
+            rte_pktmbuf_mtod_offset(m, const struct rte_vlan_hdr *, off);
+        et   = vh->eth_proto;
+        off += sizeof(*vh);
+    }
+    if (et != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) ||
+        m->data_len < off + sizeof(struct rte_ipv4_hdr) + 4)
+        return 0;
+
+    const struct rte_ipv4_hdr *ip =
+        rte_pktmbuf_mtod_offset(m, const struct rte_ipv4_hdr *, off);
+    uint16_t foff = rte_be_to_cpu_16(ip->fragment_offset);
+    if ((foff & RTE_IPV4_HDR_MF_FLAG) || (foff & RTE_IPV4_HDR_OFFSET_MASK))
+        return 0;
+
+    uint32_t tuple[3];
+    tuple[0] = rte_be_to_cpu_32(ip->src_addr);
+    tuple[1] = rte_be_to_cpu_32(ip->dst_addr);
+    uint32_t len = 2;
+    uint32_t l4  = off + (uint32_t)(ip->version_ihl & 0x0F) * 4;
+    if ((ip->next_proto_id == IPPROTO_TCP ||
+         ip->next_proto_id == IPPROTO_UDP) && m->data_len >= l4 + 4) {
+        /* sport and dport are the first 4 bytes of both headers */
+        const uint16_t *ports = rte_pktmbuf_mtod_offset(m, const uint16_t *, l4);
+        tuple[2] = ((uint32_t)rte_be_to_cpu_16(ports[0]) << 16) |
+                   rte_be_to_cpu_16(ports[1]);
+        len = 3;
+    }
+    uint32_t h = rte_softrss(tuple, len, tgen_rss_key());
+    return (h & (TGEN_SW_DIST_RETA_SIZE - 1)) % n_t;
+}
+
+/* Fan a burst out to the port's targets.  Packets for this worker are
+ * compacted in place; returns how many remain in pkts[]. */
+static uint16_t sw_dist_split(uint16_t port, struct rte_mbuf **pkts,
+                              uint16_t n)
+{
+    uint32_t n_t = g_core_map.port_dist_targets[port];
+    struct rte_mbuf *out[TGEN_MAX_WORKERS][TGEN_MAX_RX_BURST];
+    uint16_t n_out[TGEN_MAX_WORKERS];
+    memset(n_out, 0, n_t * sizeof(n_out[0]));
+
+    uint16_t keep = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        uint32_t t = sw_dist_target(pkts[i], n_t);
+        if (t == 0)
+            pkts[keep++] = pkts[i];
+        else
+            out[t][n_out[t]++] = pkts[i];
+    }
+    for (uint32_t t = 1; t < n_t; t++) {
+        if (n_out[t] == 0)
+            continue;
+        unsigned q = rte_ring_sp_enqueue_burst(g_dist_rings[port][t],
+                                               (void * const *)out[t],
+                                               n_out[t], NULL);
+        /* Target is behind — drop like a full RX ring would */
+        for (unsigned i = q; i < n_out[t]; i++)
+            rte_pktmbuf_free(out[t][i]);
+    }
+    return keep;
+}
+
+static int sw_dist_rings_init(uint16_t port)
+{
+    uint32_t n_t = g_core_map.port_dist_targets[port];
+    for (uint32_t t = 1; t < n_t; t++) {
+        if (g_dist_rings[port][t])
+            continue;
+        char name[32];
+        snprintf(name, sizeof(name), "dist_p%u_w%u", port, t);
+        uint32_t lc = g_core_map.port_workers[port][t];
+        g_dist_rings[port][t] = rte_ring_create(name, SW_DIST_RING_SZ,
+                                    (int)g_core_map.socket_of_lcore[lc],
+                                    RING_F_SP_ENQ | RING_F_SC_DEQ);
+        if (!g_dist_rings[port][t]) {
+            RTE_LOG(ERR, TGEN,
+                "Failed to create distributor ring port %u target %u\n",
+                port, t);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 /* ── Packet classification helper ────────────────────────────────────────── */
 /*
  * Returns an rte_mbuf* to enqueue for TX if the packet generates an
@@ -113,8 +240,18 @@ static inline struct rte_mbuf *classify_and_process(worker_ctx_t *ctx,
 int tgen_worker_ctx_init(void)
 {
     memset(g_worker_ctx, 0, sizeof(g_worker_ctx));
+    memset(g_port_gen_rx, 0, sizeof(g_port_gen_rx));
+    memset(g_port_gen_all, 0, sizeof(g_port_gen_all));
+    memset(g_rxq_worker, 0xff, sizeof(g_rxq_worker));
     uint32_t n_workers = g_core_map.num_workers;
 
+    uint32_t n_avail = rte_eth_dev_count_avail();
+    for (uint32_t p = 0; p < n_avail && p < TGEN_MAX_PORTS; p++) {
+        if (g_core_map.port_dist_targets[p] &&
+            sw_dist_rings_init((uint16_t)p) < 0)
+            g_core_map.port_dist_targets[p] = 0;
+    }
+
     for (uint32_t w = 0; w < n_workers; w++) {
         worker_ctx_t *ctx = &g_worker_ctx[w];
         ctx->worker_idx  = w;
@@ -144,20 +281,150 @@ int tgen_worker_ctx_init(void)
             /* Skip port if this worker would duplicate an RX queue
              * already owned by an earlier worker.  AF_PACKET / TAP
              * ports expose only 1 RX queue — only the first worker
-             * in the list should poll them. */
-            if (my_pw >= max_rxq)
-                continue;
+             * in the list should poll them, unless the software
+             * distributor feeds the others through rings. */
+            uint32_t n_dist = g_core_map.port_dist_targets[p];
+            bool tx_only = false;
+            if (my_pw >= max_rxq && my_pw >= n_dist) {
+                /* Surplus worker: attach TX-only if the port configured a
+                 * TX queue for its position that mgmt doesn't use. */
+                struct rte_eth_dev_info info;
+                if (rte_eth_dev_info_get((uint16_t)p, &info) != 0 ||
+                    my_pw >= info.nb_tx_queues ||
+                    my_pw == g_port_caps[p].mgmt_tx_q)
+                    continue;
+                tx_only = true;
+            }
 
             uint32_t idx = ctx->num_ports++;
             ctx->ports[idx]     = (uint16_t)p;
-            ctx->rx_queues[idx] = (uint16_t)my_pw;
-            ctx->tx_queues[idx] = (uint16_t)(my_pw % max_txq);
+            ctx->rx_queues[idx] = n_dist ? 0 : (uint16_t)my_pw;
+            ctx->tx_queues[idx] = n_dist ? (uint16_t)my_pw
+                                         : (uint16_t)(my_pw % max_txq);
+            ctx->rx_dist[idx]   = n_dist && my_pw == 0;
+            ctx->rx_rings[idx]  = n_dist ? g_dist_rings[p][my_pw] : NULL;
+            ctx->tx_only[idx]   = tx_only;
+            ctx->port_rank[idx] = (uint16_t)my_pw;  /* densified below */
+            if (tx_only)
+                ctx->tx_queues[idx] = (uint16_t)my_pw;
+            if (!tx_only) {
+                g_port_gen_rx[p]++;
+                g_rxq_worker[p][my_pw] = (uint16_t)w;
+            }
+            g_port_gen_all[p]++;
             if (ctx->num_ports >= TGEN_MAX_PORTS) break;
         }
     }
+
+    /* Positions skipped above (no queue, mgmt's TX queue) leave holes, and
+     * the START rate split needs ranks 0..n-1: renumber the attached
+     * workers in position order.  RX workers hold the low positions, so
+     * ranks below g_port_gen_rx[p] are exactly the RX generators. */
+    for (uint32_t p = 0; p < n_avail && p < TGEN_MAX_PORTS; p++) {
+        uint16_t next = 0;
+        for (uint32_t pos = 0; pos < g_core_map.port_num_workers[p]; pos++) {
+            for (uint32_t w = 0; w < n_workers; w++) {
+                worker_ctx_t *ctx = &g_worker_ctx[w];
+                uint32_t pp = 0;
+                while (pp < ctx->num_ports && ctx->ports[pp] != p)
+                    pp++;
+                if (pp < ctx->num_ports &&
+                    g_core_map.port_workers[p][pos] == ctx->lcore_id) {
+                    ctx->port_rank[pp] = next++;
+                    break;
+                }
+            }
+        }
+    }
     return 0;
 }
 
+uint32_t
+tgen_rx_queue_worker(uint16_t port_id, uint16_t q)
+{
+    if (port_id >= TGEN_MAX_PORTS || q >= TGEN_MAX_WORKERS ||
+        g_rxq_worker[port_id][q] == UINT16_MAX)
+        return UINT32_MAX;
+    return g_rxq_worker[port_id][q];
+}
+
+uint32_t
+tgen_port_generators(uint16_t port_id, bool stateless)
+{
+    if (port_id >= TGEN_MAX_PORTS)
+        return 0;
+    return stateless ? g_port_gen_all[port_id] : g_port_gen_rx[port_id];
+}
+
+/* ── Flow table ──────────────────────────────────────────────────────────── */
+
+/* The flow's generator on this worker, allocated on its first START.
+ * States are never freed while the worker runs, so a pointer management
+ * has loaded stays valid. */
+static tx_gen_state_t *
+flow_state(worker_ctx_t *ctx, uint32_t flow_idx)
+{
+    tx_gen_state_t *st = ctx->tx_gen[flow_idx];
+    if (likely(st != NULL))
+        return st;
+    st = rte_zmalloc_socket("tx_gen", sizeof(*st), RTE_CACHE_LINE_SIZE,
+                            (int)ctx->socket_id);
+    if (st)
+        __atomic_store_n(&ctx->tx_gen[flow_idx], st, __ATOMIC_RELEASE);
+    return st;
+}
+
+/* Stop one active flow; an open-loop pool closes its idle connections. */
+static void
+flow_stop(worker_ctx_t *ctx, uint16_t f)
+{
+    if (ctx->tx_gen[f]->cfg.http_open_loop)
+        http_ol_stop(ctx->worker_idx, f);
+    tx_gen_stop(ctx->tx_gen[f]);
+    tx_sched_remove(&ctx->sched, f);
+}
+
+/* Stop every active flow (STOP, STOP_FLOW all). */
+static void
+flows_stop_all(worker_ctx_t *ctx)
+{
+    tx_sched_t *ts = &ctx->sched;
+    while (ts->n_act > 0)
+        flow_stop(ctx, ts->act[ts->n_act - 1]);
+}
+
+/* Steering contexts of the flows this worker runs, bit ctx - 1, except
+ * flow `skip` (the one being started). */
+static uint64_t
+steer_live(const worker_ctx_t *ctx, uint32_t skip)
+{
+    uint64_t live = 0;
+    for (uint32_t a = 0; a < ctx->sched.n_act; a++) {
+        uint16_t f = ctx->sched.act[a];
+        uint8_t sc = ctx->tx_gen[f]->cfg.steer_ctx;
+        if (f != skip && sc != RSS_STEER_NONE)
+            live |= 1ull << (sc - 1);
+    }
+    return live;
+}
+
+void
+tgen_worker_flow_counters(uint32_t flow_idx, uint64_t *sent,
+                          uint64_t *dropped)
+{
+    *sent = *dropped = 0;
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS)
+        return;
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++) {
+        const tx_gen_state_t *st = __atomic_load_n(
+            &g_worker_ctx[w].tx_gen[flow_idx], __ATOMIC_ACQUIRE);
+        if (!st)
+            continue;
+        *sent    += st->pkts_sent;
+        *dropped += st->pkts_dropped;
+    }
+}
+
 /* ── Main worker loop ────────────────────────────────────────────────────── */
 int tgen_worker_loop(void *arg)
 {
@@ -173,6 +440,8 @@ int tgen_worker_loop(void *arg)
 
     cpu_stats_t *cstats = &g_cpu_stats[ctx->worker_idx];
     cstats->window_start_tsc = rte_rdtsc();
+    tx_sched_t *ts = &ctx->sched;
+    tx_sched_init(ts, rte_get_tsc_hz(), cstats->window_start_tsc);
 
     while (__atomic_load_n(&g_run, __ATOMIC_RELAXED)) {
 
@@ -188,41 +457,116 @@ int tgen_worker_loop(void *arg)
             if (cmd.cmd == CFG_CMD_START) {
                 tx_gen_config_t *gcfg = (tx_gen_config_t *)cmd.payload;
                 uint32_t si = gcfg->flow_idx;
+                int rc = 0;
                 if (si >= TGEN_MAX_CLIENT_FLOWS)
                     si = 0;
                 /* Only reset TCP state if this is the first active flow.
                  * Subsequent flows share the connection space. */
-                bool any_active = false;
-                for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++) {
-                    if (s != si && ctx->tx_gen[s].active) {
-                        any_active = true;
-                        break;
-                    }
-                }
+                bool any_active = ts->n_act > (tx_sched_has(ts, si) ? 1u : 0u);
                 if (!any_active)
                     tcp_fsm_reset_all(ctx->worker_idx);
-                /* Clear pre-built HTTP request for this worker */
-                if (gcfg->proto == TX_GEN_PROTO_HTTP)
-                    g_http_req[ctx->worker_idx].hdr_len = 0;
+                else
+                    tcp_fsm_reset_flow(ctx->worker_idx, (uint16_t)si);
+                /* Counters of an earlier run in this slot go, whether or
+                 * not this worker takes a share of the new one.  Its
+                 * connections are gone, so nothing refills the slab. */
+                flow_metrics_clear(ctx->worker_idx, si);
+                if (ctx->tx_gen[si]) {
+                    ctx->tx_gen[si]->pkts_sent    = 0;
+                    ctx->tx_gen[si]->pkts_dropped = 0;
+                    memset(&ctx->tx_gen[si]->pace, 0,
+                           sizeof(ctx->tx_gen[si]->pace));
+                }
+                tcp_hs_win_start(ctx->worker_idx, si, gcfg->syn_window,
+                                 gcfg->syn_adaptive);
                 /* Only start traffic generation if this worker owns the
-                 * target port. */
-                uint16_t tx_q = UINT16_MAX;
-                for (uint32_t pp = 0; pp < ctx->num_ports; pp++) {
-                    if (ctx->ports[pp] == gcfg->port_id) {
-                        tx_q = ctx->tx_queues[pp];
-                        break;
+                 * target port.  TX-only workers take stateless flows. */
+                bool stateless = tx_gen_proto_stateless(gcfg->proto);
+                uint32_t pp = 0;
+                while (pp < ctx->num_ports &&
+                       ctx->ports[pp] != gcfg->port_id)
+                    pp++;
+                if (pp < ctx->num_ports && (stateless || !ctx->tx_only[pp])) {
+                    /* Split the flow's rate over the port's generators.
+                     * A count (max_initiations) is not split: the CLI
+                     * (--one) and RFC 2544 bursts send it to one worker,
+                     * which takes the whole count at the whole rate. */
+                    uint32_t n_gen = tgen_port_generators(gcfg->port_id,
+                                                          stateless);
+                    if (gcfg->max_initiations > 0)
+                        n_gen = 1;
+                    uint32_t rank = n_gen > 1 ? ctx->port_rank[pp] : 0;
+                    uint64_t share = tx_gen_rate_share(gcfg->rate_pps,
+                                                       rank, n_gen);
+                    uint64_t share_bps = tx_gen_rate_share(gcfg->rate_bps,
+                                                           rank, n_gen);
+                    if ((gcfg->rate_pps == 0 || share > 0) &&
+                        (gcfg->rate_bps == 0 || share_bps > 0)) {
+                        tx_gen_state_t *st = flow_state(ctx, si);
+                        /* A context staged for a new target: connections
+                         * of stopped flows still hold ports of the old
+                         * ranges, so RST them and re-size the pools. */
+                        if (st && tcp_port_pool_stale(ctx->worker_idx,
+                                                      gcfg->steer_ctx)) {
+                            uint64_t live = steer_live(ctx, si);
+                            tcp_fsm_reset_steer(ctx->worker_idx, ~live);
+                            if (tcp_port_pool_apply(ctx->worker_idx,
+                                    gcfg->steer_ctx, live) < 0)
+                                st = NULL;
+                        }
+                        /* Open loop: the worker's share of the pool */
+                        if (st && gcfg->http_open_loop) {
+                            uint64_t conns = gcfg->ol_conns
+                                ? TGEN_MAX(tx_gen_rate_share(gcfg->ol_conns,
+                                                             rank, n_gen), 1u)
+                                : HTTP_OL_DEF_CONNS;
+                            if (http_ol_start(ctx->worker_idx, si,
+                                    (uint32_t)conns,
+                                    gcfg->gen_flags & TX_GEN_F_POISSON,
+                                    rte_rdtsc()) < 0)
+                                st = NULL;
+                        }
+                        if (st) {
+                            tx_gen_configure(st, gcfg, ctx->tx_queues[pp]);
+                            st->cfg.rate_pps = share;
+                            st->cfg.rate_bps = share_bps;
+                            st->rate_rank = (uint16_t)rank;
+                            st->rate_n    = (uint16_t)n_gen;
+                            st->cap_n     = (uint16_t)g_port_gen_all[gcfg->port_id];
+                            /* Pooled HTTP: this worker's pool for the target */
+                            if (gcfg->pool_max > 0) {
+                                conn_pool_target_t pt = {
+                                    .dst_ip   = gcfg->dst_ip,
+                                    .dst_port = gcfg->dst_port,
+                                    .tls      = gcfg->enable_tls,
+                                    .cc_algo  = gcfg->cc_algo,
+                                    .port_id  = gcfg->port_id,
+                                    .vlan_id  = gcfg->vlan_id,
+                                };
+                                rc = conn_pool_configure(ctx->worker_idx, &pt,
+                                        gcfg->pool_min, gcfg->pool_max,
+                                        gcfg->pool_idle_ms);
+                                if (rc > 0) {
+                                    st->pool_key = (uint8_t)rc;
+                                    rc = 0;
+                                }
+                            }
+                            if (rc == 0) {
+                                tx_gen_start(st);
+                                tx_sched_add(ts, si, 0, st->start_tsc);
+                            }
+                        } else {
+                            RTE_LOG(ERR, TGEN, "Worker %u: no memory for "
+                                    "flow %u\n", ctx->worker_idx, si);
+                            rc = -ENOMEM;
+                        }
                     }
                 }
-                if (tx_q != UINT16_MAX) {
-                    tx_gen_configure(&ctx->tx_gen[si], gcfg, tx_q);
-                    tx_gen_start(&ctx->tx_gen[si]);
-                }
-                tgen_ipc_ack(ctx->worker_idx, cmd.seq, 0);
+                tgen_ipc_ack(ctx->worker_idx, cmd.seq, rc);
                 continue;
             }
             if (cmd.cmd == CFG_CMD_STOP) {
-                for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++)
-                    tx_gen_stop(&ctx->tx_gen[s]);
+                flows_stop_all(ctx);
                 /* Also stop server listeners if serving */
                 if (g_srv_tables[ctx->worker_idx].serving) {
                     tcp_fsm_reset_all(ctx->worker_idx);
@@ -236,10 +580,10 @@ int tgen_worker_loop(void *arg)
                 uint32_t si;
                 memcpy(&si, cmd.payload, sizeof(si));
                 if (si == UINT32_MAX) {
-                    for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++)
-                        tx_gen_stop(&ctx->tx_gen[s]);
-                } else if (si < TGEN_MAX_CLIENT_FLOWS) {
-                    tx_gen_stop(&ctx->tx_gen[si]);
+                    flows_stop_all(ctx);
+                } else if (si < TGEN_MAX_CLIENT_FLOWS &&
+                           tx_sched_has(ts, si)) {
+                    flow_stop(ctx, (uint16_t)si);
                 }
                 tgen_ipc_ack(ctx->worker_idx, cmd.seq, 0);
                 continue;
@@ -252,10 +596,37 @@ int tgen_worker_loop(void *arg)
                 continue;
             }
             if (cmd.cmd == CFG_CMD_SET_RATE) {
-                uint64_t new_rate;
-                memcpy(&new_rate, cmd.payload, sizeof(new_rate));
-                for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++)
-                    ctx->tx_gen[s].cfg.rate_pps = new_rate;
+                tx_gen_rate_update_t ru;
+                memcpy(&ru, cmd.payload, sizeof(ru));
+                /* Running flows only: START configures the others */
+                uint64_t now = rte_rdtsc();
+                for (uint32_t a = 0; a < ts->n_act; a++) {
+                    uint16_t s = ts->act[a];
+                    if (ru.flow_idx != UINT32_MAX && ru.flow_idx != s)
+                        continue;
+                    tx_gen_state_t *st = ctx->tx_gen[s];
+                    uint64_t share = tx_gen_rate_share(ru.rate,
+                                         st->rate_rank, st->rate_n);
+                    /* Keep a running generator running (0 = unlimited) */
+                    if (ru.rate && !share)
+                        share = 1;
+                    if (!ru.bps) {
+                        st->cfg.rate_pps = share;
+                        st->cfg.rate_bps = 0;
+                    } else if (tx_gen_proto_stateless(st->cfg.proto) ||
+                               st->cfg.proto == TX_GEN_PROTO_THROUGHPUT) {
+                        /* A bit rate has no meaning for connection
+                         * rates; those flows keep theirs. */
+                        st->cfg.rate_bps   = share;
+                        st->cfg.rate_layer = ru.layer;
+                        st->cfg.rate_pps   = 0;
+                    }
+                    /* The flow's CO interval follows its new rate */
+                    if (st->cfg.proto == TX_GEN_PROTO_HTTP)
+                        st->http_req.expected_interval_us =
+                            tx_gen_http_interval_us(st);
+                    tx_sched_add(ts, s, now, now);  /* re-plan at the new rate */
+                }
                 tgen_ipc_ack(ctx->worker_idx, cmd.seq, 0);
                 continue;
             }
@@ -290,9 +661,19 @@ int tgen_worker_loop(void *arg)
         uint16_t nb_rx_total = 0;
         n_tx = 0;
         for (uint32_t p = 0; p < ctx->num_ports; p++) {
-            uint16_t nb_rx = rte_eth_rx_burst(ctx->ports[p],
-                                               ctx->rx_queues[p],
-                                               rx_pkts, TGEN_MAX_RX_BURST);
+            if (ctx->tx_only[p])
+                continue;
+            uint16_t nb_rx;
+            if (ctx->rx_rings[p]) {
+                nb_rx = (uint16_t)rte_ring_sc_dequeue_burst(ctx->rx_rings[p],
+                                        (void **)rx_pkts, TGEN_MAX_RX_BURST,
+                                        NULL);
+            } else {
+                nb_rx = rte_eth_rx_burst(ctx->ports[p], ctx->rx_queues[p],
+                                         rx_pkts, TGEN_MAX_RX_BURST);
+                if (ctx->rx_dist[p] && nb_rx > 0)
+                    nb_rx = sw_dist_split(ctx->ports[p], rx_pkts, nb_rx);
+            }
             if (nb_rx == 0) continue;
             nb_rx_total += nb_rx;
 
@@ -330,11 +711,19 @@ int tgen_worker_loop(void *arg)
         /* In server mode, workers are reactive — no tx_gen.  Server-side
          * TX (echo, HTTP response, chargen) is handled inline by
          * srv_on_data() / srv_on_established() from tcp_fsm_input(). */
+        /* Only the flows the scheduler finds due are visited; each is
+         * filed again at the time it can next send. */
         if (!g_srv_tables[ctx->worker_idx].serving) {
-            for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++) {
-                if (ctx->tx_gen[s].active)
-                    tx_gen_burst(&ctx->tx_gen[s], ctx->mempool,
-                                 ctx->worker_idx);
+            uint32_t n_run = tx_sched_due(ts, t2);
+            for (uint32_t i = 0; i < n_run; i++) {
+                uint16_t f = ts->run[i];
+                tx_gen_state_t *st = ctx->tx_gen[f];
+                tx_gen_burst(st, ctx->mempool, ctx->worker_idx);
+                if (st->active)
+                    tx_sched_add(ts, f,
+                                 tx_gen_next_tsc(st, ctx->worker_idx, t2), t2);
+                else
+                    tx_sched_remove(ts, f);
             }
         }
 
@@ -357,16 +746,13 @@ int tgen_worker_loop(void *arg)
         cstats->cycles_tx    += (t3 - t2);
         cstats->cycles_timer += (t4 - t3);
         cstats->cycles_total += (t4 - t0);
-        bool any_gen_active = false;
-        for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++) {
-            if (ctx->tx_gen[s].active) { any_gen_active = true; break; }
-        }
-        if (nb_rx_total == 0 && !any_gen_active)
+        if (nb_rx_total == 0 && ts->n_act == 0)
             cstats->cycles_idle += (t4 - t0);
         cstats->loop_count++;
     }
 
 done:
+    tgen_mbuf_stash_drain(ctx->worker_idx);
     RTE_LOG(INFO, TGEN, "Worker %u exiting\n", ctx->worker_idx);
     return 0;
 }
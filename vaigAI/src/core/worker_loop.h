@@ -9,6 +9,7 @@
 #include <rte_atomic.h>
 #include "../common/types.h"
 #include "tx_gen.h"
+#include "tx_sched.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,16 +29,40 @@ typedef struct {
     uint16_t ports[TGEN_MAX_PORTS];
     uint16_t rx_queues[TGEN_MAX_PORTS];
     uint16_t tx_queues[TGEN_MAX_PORTS];
+    /* Software distributor (--sw-dist): rx_rings[p] != NULL → pull this
+     * port's packets from the ring instead of the NIC; rx_dist[p] → this
+     * worker polls the queue and fans packets out to the other workers. */
+    struct rte_ring *rx_rings[TGEN_MAX_PORTS];
+    bool     rx_dist[TGEN_MAX_PORTS];
+    /* TX-only attachment: surplus worker with a TX queue but no RX
+     * queue on the port; generates stateless (ICMP/UDP) flows only. */
+    bool     tx_only[TGEN_MAX_PORTS];
+    /* Dense rank among the port's generators, in port_workers[] order:
+     * RX workers 0..n_rx-1, then TX-only workers. */
+    uint16_t port_rank[TGEN_MAX_PORTS];
     uint32_t num_ports;
     /* Mempool */
     struct rte_mempool *mempool;
-    /* TX generator state — one slot per concurrent client flow */
-    tx_gen_state_t tx_gen[TGEN_MAX_CLIENT_FLOWS];
+    /* TX generator state per client flow, allocated on the flow's first
+     * START on this worker and kept (reused) until exit; NULL = never
+     * started here.  The scheduler holds the flows currently active. */
+    tx_gen_state_t *tx_gen[TGEN_MAX_CLIENT_FLOWS];
+    tx_sched_t      sched;
 } worker_ctx_t;
 
 /** Array of worker contexts, indexed by worker index. */
 extern worker_ctx_t g_worker_ctx[TGEN_MAX_WORKERS];
 
+/** Workers a flow's rate and connections are split over on `port_id`:
+ *  all attached ones for stateless protocols, those polling an RX queue
+ *  for the rest. */
+uint32_t tgen_port_generators(uint16_t port_id, bool stateless);
+
+/** Worker index polling RX queue `q` of `port_id` (the distributor's
+ *  target `q` with --sw-dist), or UINT32_MAX if no worker does.
+ *  Valid after tgen_worker_ctx_init(). */
+uint32_t tgen_rx_queue_worker(uint16_t port_id, uint16_t q);
+
 /** Initialise all worker contexts after port + mempool setup.
  *  Returns 0 on success. */
 int tgen_worker_ctx_init(void);
@@ -46,6 +71,11 @@ int tgen_worker_ctx_init(void);
  *  arg = (worker_ctx_t *). */
 int tgen_worker_loop(void *arg);
 
+/** Management: a flow's generator counters summed over the workers
+ *  (packets, or connections initiated, since its last START). */
+void tgen_worker_flow_counters(uint32_t flow_idx, uint64_t *sent,
+                               uint64_t *dropped);
+
 /** Management core: signal all workers to stop. */
 void tgen_workers_stop(void);
 
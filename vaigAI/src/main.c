@@ -42,6 +42,10 @@
 #include "net/tcp_tcb.h"
 #include "net/tcp_timer.h"
 #include "net/tcp_port_pool.h"
+#include "net/rss_steer.h"
+#include "net/tcp_hs_win.h"
+#include "app/http_ol.h"
+#include "app/conn_pool.h"
 #include "net/arp.h"
 #include "net/icmp.h"
 #include "net/icmpv6.h"
@@ -107,7 +111,11 @@ tgen_cleanup(void)
 
     RTE_LOG(INFO, USER1, "Releasing resources...\n");
     pktrace_destroy();
+    rss_steer_fini();       /* flow rules go before the ports stop */
     tcp_port_pool_fini();
+    tcp_hs_win_destroy();
+    http_ol_destroy();
+    conn_pool_destroy();
     tls_session_store_fini();
     cryptodev_fini();
     icmpv6_destroy();
@@ -191,12 +199,16 @@ main(int argc, char **argv)
     }
 
     /* ---- 5. Port initialisation ---- */
-    rc = tgen_ports_init(eal_args.num_rx_desc, eal_args.num_tx_desc);
+    rc = tgen_ports_init(eal_args.num_rx_desc, eal_args.num_tx_desc,
+                         eal_args.tx_timestamp);
     if (rc < 0) {
         RTE_LOG(ERR, USER1, "Port init failed\n");
         goto fail_pools;
     }
 
+    if (eal_args.sw_dist)
+        tgen_core_assign_sw_dist(rte_eth_dev_count_avail());
+
     /* ---- 5a. ARP + ICMP subsystems ---- */
     rc = arp_init();
     if (rc < 0) {
@@ -332,6 +344,12 @@ main(int argc, char **argv)
         goto fail_tcb;
     }
 
+    rc = tcp_hs_win_init();
+    if (rc < 0) {
+        RTE_LOG(ERR, USER1, "SYN window init failed\n");
+        goto fail_tcb;
+    }
+
     /* ---- 10. Cryptodev ---- */
     cryptodev_init(); /* failure is non-fatal — falls back to SW */
 
@@ -367,6 +385,7 @@ main(int argc, char **argv)
 
     /* Error paths */
 fail_tcb:
+    tcp_hs_win_destroy();
     tcb_stores_destroy();
 fail_tls:
     tls_session_store_fini();
@@ -5,6 +5,8 @@
 #include "cli_server.h"
 #include "config_mgr.h"
 #include "mgmt_loop.h"
+#include "rfc2544.h"
+#include "load_ctl.h"
 #include "../net/icmp.h"
 #include "../net/icmpv6.h"
 #include "../net/ndp.h"
@@ -13,6 +15,9 @@
 #include "../net/tcp_fsm.h"
 #include "../net/tcp_tcb.h"
 #include "../net/tcp_port_pool.h"
+#include "../net/tcp_hs_win.h"
+#include "../net/rss_steer.h"
+#include "../net/udp_probe.h"
 #include "../net/tcp_congestion.h"
 #include "../telemetry/pktrace.h"
 #include "../common/util.h"
@@ -24,6 +29,8 @@
 #include "../telemetry/output.h"
 #include "../core/ipc.h"
 #include "../core/tx_gen.h"
+#include "../core/rate_sched.h"
+#include "../core/pcap_replay.h"
 #include "../core/worker_loop.h"
 #include "../core/core_assign.h"
 #include "../port/port_init.h"
@@ -31,6 +38,9 @@
 #include "../tls/tls_engine.h"
 #include "../app/http11.h"
 #include "../app/server.h"
+#include "../app/l7_replay.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -42,6 +52,7 @@
 #include <poll.h>
 #include <arpa/inet.h>
 #include <rte_ethdev.h>
+#include <rte_tcp.h>
 
 #ifdef HAVE_READLINE
 # include <readline/readline.h>
@@ -93,6 +104,7 @@ static void dispatch(char *line);
 typedef struct {
     bool rate;      /* --rate: 1-second delta */
     int  core;      /* --core N (-1 = all) */
+    int  flow;      /* --flow N (-1 = all flows; stat net only) */
 } stat_opts_t;
 
 static void
@@ -100,11 +112,14 @@ stat_parse_opts(int argc, char **argv, int start, stat_opts_t *opts)
 {
     opts->rate  = false;
     opts->core  = -1;
+    opts->flow  = -1;
     for (int i = start; i < argc; i++) {
         if (strcmp(argv[i], "--rate") == 0)
             opts->rate = true;
         else if (strcmp(argv[i], "--core") == 0 && i + 1 < argc) {
             opts->core = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--flow") == 0 && i + 1 < argc) {
+            opts->flow = atoi(argv[++i]);
         }
     }
 }
@@ -182,20 +197,38 @@ stat_mem(const stat_opts_t *opts)
 }
 
 /* ── stat net ──────────────────────────────────────────────────────────────── */
+/* Worker slabs, or with --flow N the slabs of that one flow */
+static void
+net_snapshot(const stat_opts_t *opts, metrics_snapshot_t *snap)
+{
+    uint32_t nw = g_core_map.num_workers;
+    if (opts->flow >= 0)
+        flow_metrics_snapshot(snap, (uint32_t)opts->flow, nw);
+    else
+        metrics_snapshot(snap, nw);
+}
+
 static void
 stat_net(const stat_opts_t *opts)
 {
     uint32_t nw = g_core_map.num_workers;
     char buf[16384];
 
+    if (opts->flow >= 0 && !flow_metrics_present((uint32_t)opts->flow)) {
+        printf("stat: flow #%d has not run\n", opts->flow);
+        return;
+    }
+    if (opts->flow >= 0)
+        printf("--- flow #%d ---\n", opts->flow);
+
     if (opts->core >= 0) {
         /* Per-worker breakdown with TCP state */
         if (opts->rate) {
             metrics_snapshot_t s1, s2;
-            metrics_snapshot(&s1, nw);
+            net_snapshot(opts, &s1);
             struct timespec ts = { .tv_sec = 1, .tv_nsec = 0 };
             nanosleep(&ts, NULL);
-            metrics_snapshot(&s2, nw);
+            net_snapshot(opts, &s2);
 
             uint32_t c = (uint32_t)opts->core;
             if (c < nw) {
@@ -214,23 +247,24 @@ stat_net(const stat_opts_t *opts)
             }
         } else {
             metrics_snapshot_t snap;
-            metrics_snapshot(&snap, nw);
+            net_snapshot(opts, &snap);
             export_net_core_text(&snap, (uint32_t)opts->core, buf, sizeof(buf));
             puts(buf);
         }
     } else if (opts->rate) {
         metrics_snapshot_t s1, s2;
-        metrics_snapshot(&s1, nw);
+        net_snapshot(opts, &s1);
         struct timespec ts = { .tv_sec = 1, .tv_nsec = 0 };
         nanosleep(&ts, NULL);
-        metrics_snapshot(&s2, nw);
+        net_snapshot(opts, &s2);
 
         const worker_metrics_t *t1 = &s1.total;
         const worker_metrics_t *t2 = &s2.total;
         printf("--- rates (1-second sample) ---\n");
-        printf("  TX: %"PRIu64" pps   %.1f Mbps\n",
+        printf("  TX: %"PRIu64" pps   %.1f Mbps   %.1f Mbps L1\n",
                t2->tx_pkts - t1->tx_pkts,
-               (double)(t2->tx_bytes - t1->tx_bytes) * 8.0 / 1e6);
+               (double)(t2->tx_bytes - t1->tx_bytes) * 8.0 / 1e6,
+               (metrics_tx_l1_bits(t2) - metrics_tx_l1_bits(t1)) / 1e6);
         printf("  RX: %"PRIu64" pps   %.1f Mbps\n",
                t2->rx_pkts - t1->rx_pkts,
                (double)(t2->rx_bytes - t1->rx_bytes) * 8.0 / 1e6);
@@ -242,6 +276,11 @@ stat_net(const stat_opts_t *opts)
             printf("  HTTP req/s: %"PRIu64"   rsp/s: %"PRIu64"\n",
                    t2->http_req_tx - t1->http_req_tx,
                    t2->http_rsp_rx - t1->http_rsp_rx);
+    } else if (opts->flow >= 0) {
+        metrics_snapshot_t snap;
+        net_snapshot(opts, &snap);
+        export_net_text(&snap, buf, sizeof(buf));
+        puts(buf);
     } else {
         /* Default: JSON dump of all network counters */
         cli_print_stats();
@@ -299,6 +338,129 @@ stat_port(const stat_opts_t *opts)
     }
 }
 
+/* "--flow N" of a stat sub-command: N below `max`, or -1 for every flow.
+ * Returns -2 after a message when N is not a flow index. */
+static int
+stat_flow_opt(int argc, char **argv, uint32_t max)
+{
+    int only = -1;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--flow") == 0 && i + 1 < argc) {
+            const char *v = argv[++i];
+            char *end = NULL;
+            errno = 0;
+            unsigned long n = strtoul(v, &end, 10);
+            if (errno || end == v || *end != '\0' || n >= max) {
+                printf("stat: --flow must be a flow number 0-%u\n", max - 1);
+                return -2;
+            }
+            only = (int)n;
+        }
+    }
+    return only;
+}
+
+/* ── stat probe ────────────────────────────────────────────────────────────── */
+static void
+stat_probe(int argc, char **argv)
+{
+    int only = stat_flow_opt(argc, argv, UDP_PROBE_MAX_FLOWS);
+    if (only == -2)
+        return;
+
+    bool any = false;
+    for (uint32_t f = 0; f < UDP_PROBE_MAX_FLOWS; f++) {
+        if (only >= 0 && (uint32_t)only != f) continue;
+        udp_probe_report_t r;
+        udp_probe_report(f, &r);
+        if (r.tx == 0 && r.rx == 0) continue;
+        any = true;
+        double loss = r.tx ? (double)r.lost * 100.0 / (double)r.tx : 0;
+        printf("--- flow #%u probes ---\n", f);
+        printf("  tx: %" PRIu64 "  rx: %" PRIu64 "  lost: %" PRIu64
+               " (%.4f%%)  dup: %" PRIu64 "\n",
+               r.tx, r.rx, r.lost, loss, r.dup);
+        printf("  reordered: %" PRIu64 "  distance avg %.1f max %" PRIu64
+               "  open gaps: %" PRIu64 "\n",
+               r.reordered, r.reorder_avg, r.reorder_max, r.gaps);
+        if (r.lat.total_count > 0) {
+            printf("  latency ns: min %" PRIu64 "  avg %" PRIu64
+                   "  p50 %" PRIu64 "  p99 %" PRIu64 "  p99.9 %" PRIu64
+                   "  max %" PRIu64 "\n",
+                   r.lat.min_val, r.lat.total_sum / r.lat.total_count,
+                   hist_percentile(&r.lat, 50.0),
+                   hist_percentile(&r.lat, 99.0),
+                   hist_percentile(&r.lat, 99.9), r.lat.max_val);
+            printf("  jitter (RFC 3550): %.1f ns\n", r.jitter_ns);
+        }
+    }
+    if (!any)
+        printf("No probe traffic (start a udp flow with --probe)\n");
+}
+
+/* ── stat pace ─────────────────────────────────────────────────────────────── */
+static void
+stat_pace(int argc, char **argv)
+{
+    int only = stat_flow_opt(argc, argv, TGEN_MAX_CLIENT_FLOWS);
+    if (only == -2)
+        return;
+
+    bool any = false;
+    char buf[512];
+    for (uint32_t f = 0; f < TGEN_MAX_CLIENT_FLOWS; f++) {
+        if (only >= 0 && (uint32_t)only != f) continue;
+        tx_gen_pace_report_t r;
+        tx_gen_pace_report(f, &r);
+        if (r.generators == 0) continue;
+        any = true;
+        export_pace_text(f, &r, buf, sizeof(buf));
+        fputs(buf, stdout);
+    }
+    if (!any)
+        printf("No paced traffic (start a udp/icmp flow with --rate and --pace)\n");
+}
+
+/* ── stat handshake ────────────────────────────────────────────────────────── */
+static void
+stat_handshake(int argc, char **argv)
+{
+    int only = stat_flow_opt(argc, argv, TGEN_MAX_CLIENT_FLOWS);
+    if (only == -2)
+        return;
+
+    bool any = false;
+    char buf[512];
+    for (uint32_t f = 0; f < g_client_flow_count; f++) {
+        if (only >= 0 && (uint32_t)only != f) continue;
+        const traffic_gen_state_t *ts = &g_client_flows[f];
+        if (!ts->handshakes) continue;
+        tcp_hs_win_report_t r;
+        tcp_hs_win_report(f, ts->n_workers, &r);
+        any = true;
+        export_handshake_text(f, &r, buf, sizeof(buf));
+        fputs(buf, stdout);
+    }
+    if (!any)
+        printf("No connection-opening flows (start a tcp, http or l7 flow)\n");
+}
+
+/* ── stat pool ─────────────────────────────────────────────────────────────── */
+static void
+stat_pool(void)
+{
+    conn_pool_report_t r[CONN_POOL_MAX_KEYS];
+    uint32_t n = conn_pool_report(g_core_map.num_workers, r,
+                                  CONN_POOL_MAX_KEYS);
+    char buf[512];
+    for (uint32_t i = 0; i < n; i++) {
+        export_pool_text(&r[i], buf, sizeof(buf));
+        fputs(buf, stdout);
+    }
+    if (n == 0)
+        printf("No connection pools (start an http/https flow with --pool)\n");
+}
+
 /* ── stat (dispatcher) ─────────────────────────────────────────────────────── */
 static void
 cmd_stat(int argc, char **argv)
@@ -349,8 +511,14 @@ cmd_stat(int argc, char **argv)
     else if (strcmp(sub, "mem") == 0)  stat_mem(&opts);
     else if (strcmp(sub, "net") == 0)  stat_net(&opts);
     else if (strcmp(sub, "port") == 0) stat_port(&opts);
+    else if (strcmp(sub, "probe") == 0) stat_probe(argc, argv);
+    else if (strcmp(sub, "pace")  == 0) stat_pace(argc, argv);
+    else if (strcmp(sub, "handshake") == 0) stat_handshake(argc, argv);
+    else if (strcmp(sub, "pool") == 0) stat_pool();
+    else if (strcmp(sub, "target") == 0) load_ctl_status();
     else printf("Unknown stat sub-command: %s\n"
-                "Usage: stat [cpu|mem|net|port] [--rate] [--core N]\n",
+                "Usage: stat [cpu|mem|net|port|probe|pace|handshake|pool|target] "
+                "[--rate] [--core N]\n",
                 sub);
 }
 
@@ -476,21 +644,70 @@ typedef struct {
     uint16_t    vlan_id;    /* --vlan: 802.1Q VLAN ID (0=none) */
     const char *cc;         /* --cc: congestion control algorithm */
     uint32_t    src_ip_count; /* --src-ip-count: IPs in source range */
+    bool        steer_flow; /* --steer flow: rte_flow return steering */
+    bool        replay;     /* --replay: pre-built packet ring (udp/icmp) */
+    field_var_prog_t fields; /* --field: per-packet variables (udp/icmp) */
+    bool        probe;      /* --probe: seq/timestamp payload (udp) */
+    size_dist_t sizes;      /* --sizes: frame-size distribution (udp/icmp) */
+    uint8_t     pace;       /* --pace [sw]: 0 off, 1 auto, 2 software only */
+    uint32_t    syn_window; /* --syn-window: handshakes in flight/worker */
+    bool        syn_auto;   /* --syn-window auto[:N]: AIMD up to N */
+    bool        open_loop;  /* --open-loop: HTTP requests at --rate */
+    uint32_t    conns;      /* --conns: open-loop pool, all workers */
+    uint32_t    pool_max;   /* --pool: idle connections per worker */
+    uint32_t    pool_min;
+    uint32_t    pool_idle_ms;
+    uint32_t    pipeline;   /* --pipeline: requests per batch */
+    uint64_t    bps;        /* --bps: bit-rate target, replaces --rate */
+    int         layer;      /* --layer: TX_GEN_LAYER_*, -1 = not given */
+    rate_sched_t sched;     /* --profile: load shape over time */
+    bool        has_sched;
+    bool        poisson;    /* --arrivals poisson */
+    bool        has_target; /* --target: closed-loop set point */
+    uint8_t     target_metric; /* load_metric_t */
+    double      target;
+    const char *pcap;       /* --pcap: capture for --proto pcap or l7 */
+    double      speed;      /* --speed: × capture timing, 0 = max */
+    bool        has_speed;
+    uint32_t    loops;      /* --loops: passes, 0 = until --duration */
+    pcap_replay_opts_t rewrite; /* --rewrite-mac, --rewrite-ip */
     /* Custom HTTP headers: accumulated "Name: Value\r\n" strings */
-    char        custom_hdrs[512];
+    char        custom_hdrs[TX_GEN_HTTP_HDRS_MAX];
     uint32_t    custom_hdrs_len;
 } start_args_t;
 
+/* "l1" | "l2" | "l3" → TX_GEN_LAYER_*, -1 if neither. */
+static int
+parse_layer(const char *s)
+{
+    if (strcmp(s, "l1") == 0) return TX_GEN_LAYER_L1;
+    if (strcmp(s, "l2") == 0) return TX_GEN_LAYER_L2;
+    if (strcmp(s, "l3") == 0) return TX_GEN_LAYER_L3;
+    return -1;
+}
+
+static const char *const k_layer_names[] = { "L1", "L2", "L3" };
+
 static const char *
 start_usage(void)
 {
     return "Usage: start --ip <addr> --port <N> --duration <secs>\n"
-           "             [--proto tcp|http|https|udp|icmp|tls]\n"
+           "             [--proto tcp|http|https|udp|icmp|tls|pcap|l7]\n"
+           "             [--pcap <file>] [--speed <x>|max] [--loops <N>]\n"
+           "             [--rewrite-mac] [--rewrite-ip <old>=<new>,...]\n"
            "             [--rate <pps>] [--cps <N>] [--ramp <secs>]\n"
-           "             [--size <bytes>] [--reuse] [--streams <N>]\n"
-           "             [--url <path>] [--host <name>] [--tls]\n"
+           "             [--bps <rate>[k|m|g]] [--layer l1|l2|l3]\n"
+           "             [--target cps|rps|tps|mbps|conc:<value>]\n"
+           "             [--profile <shape>] [--arrivals poisson|uniform]\n"
+           "             [--size <bytes>] [--sizes <dist>] [--reuse]\n"
+           "             [--streams <N>] [--url <path>] [--host <name>] [--tls]\n"
            "             [--one] [--dscp <0-63>] [--vlan <id>]\n"
            "             [--cc newreno|cubic] [--src-ip-count <N>]\n"
+           "             [--steer rss|flow] [--replay] [--probe] [--pace [sw]]\n"
+           "             [--syn-window <N>|auto[:<N>]]\n"
+           "             [--open-loop [--conns <N>]]\n"
+           "             [--pool <max>[:<min>[:<idle_ms>]]] [--pipeline <N>]\n"
+           "             [--field <field>:<op>:<values>[:<step>]]\n"
            "             [--header \"Name: Value\"]\n";
 }
 
@@ -502,6 +719,7 @@ parse_start_args(int argc, char **argv, start_args_t *a)
     a->url   = "/";
     a->size  = 56;
     a->streams = 1;
+    a->layer = -1;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--ip") == 0 && i + 1 < argc) {
@@ -514,6 +732,66 @@ parse_start_args(int argc, char **argv, start_args_t *a)
             a->proto = argv[++i];
         } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
             a->rate = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--bps") == 0 && i + 1 < argc) {
+            i++;
+            if (tgen_parse_bps(argv[i], &a->bps) < 0) {
+                printf("start: invalid --bps '%s'\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--layer") == 0 && i + 1 < argc) {
+            a->layer = parse_layer(argv[++i]);
+            if (a->layer < 0) {
+                printf("start: --layer must be l1, l2 or l3\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) {
+            i++;
+            if (load_ctl_parse(argv[i], &a->target_metric, &a->target) < 0) {
+                printf("start: invalid --target '%s'\n", argv[i]);
+                return -1;
+            }
+            a->has_target = true;
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            i++;
+            if (rate_sched_parse(argv[i], rte_get_tsc_hz(), &a->sched) < 0) {
+                printf("start: invalid --profile '%s'\n", argv[i]);
+                return -1;
+            }
+            a->has_sched = true;
+        } else if (strcmp(argv[i], "--arrivals") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "poisson") == 0)
+                a->poisson = true;
+            else if (strcmp(m, "uniform") != 0) {
+                printf("start: --arrivals must be poisson or uniform\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--pcap") == 0 && i + 1 < argc) {
+            a->pcap = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            const char *v = argv[++i];
+            char *end;
+            a->has_speed = true;
+            if (strcmp(v, "max") == 0) {
+                a->speed = 0;
+            } else {
+                a->speed = strtod(v, &end);
+                if (end == v || *end || !(a->speed > 0) || a->speed > 1e6) {
+                    printf("start: --speed must be a multiplier > 0 or max\n");
+                    return -1;
+                }
+            }
+        } else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+            a->loops = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--rewrite-mac") == 0) {
+            a->rewrite.rewrite_mac = true;
+        } else if (strcmp(argv[i], "--rewrite-ip") == 0 && i + 1 < argc) {
+            i++;
+            if (pcap_replay_parse_map(argv[i], &a->rewrite) < 0) {
+                printf("start: invalid --rewrite-ip '%s' (at most %u "
+                       "<old>=<new> pairs)\n", argv[i], PCAP_REPLAY_MAX_MAPS);
+                return -1;
+            }
         } else if (strcmp(argv[i], "--cps") == 0 && i + 1 < argc) {
             a->rate = strtoull(argv[++i], NULL, 10); /* alias for --rate */
         } else if (strcmp(argv[i], "--ramp") == 0 && i + 1 < argc) {
@@ -524,6 +802,12 @@ parse_start_args(int argc, char **argv, start_args_t *a)
             a->think_time = (uint32_t)strtoul(argv[++i], NULL, 10);
         } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
             a->size = (uint16_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            i++;
+            if (size_dist_parse(argv[i], &a->sizes) < 0) {
+                printf("start: invalid --sizes '%s'\n", argv[i]);
+                return -1;
+            }
         } else if (strcmp(argv[i], "--streams") == 0 && i + 1 < argc) {
             a->streams = (uint32_t)strtoul(argv[++i], NULL, 10);
         } else if (strcmp(argv[i], "--url") == 0 && i + 1 < argc) {
@@ -534,6 +818,66 @@ parse_start_args(int argc, char **argv, start_args_t *a)
             a->reuse = true;
         } else if (strcmp(argv[i], "--tls") == 0) {
             a->tls = true;
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            a->replay = true;
+        } else if (strcmp(argv[i], "--probe") == 0) {
+            a->probe = true;
+        } else if (strcmp(argv[i], "--pace") == 0) {
+            a->pace = 1;
+            if (i + 1 < argc && strcmp(argv[i + 1], "sw") == 0) {
+                a->pace = 2;
+                i++;
+            }
+        } else if (strcmp(argv[i], "--syn-window") == 0 && i + 1 < argc) {
+            const char *v = argv[++i];
+            char *end = NULL;
+            if (strncmp(v, "auto", 4) == 0) {
+                a->syn_auto = true;
+                v += 4;
+                if (*v == ':')
+                    a->syn_window = (uint32_t)strtoul(v + 1, &end, 10);
+                else
+                    end = (char *)v;
+            } else {
+                a->syn_window = (uint32_t)strtoul(v, &end, 10);
+            }
+            if (*end != '\0' || (!a->syn_auto && a->syn_window == 0) ||
+                (a->syn_auto && *v == ':' && a->syn_window < TCP_HS_WIN_MIN)) {
+                printf("start: --syn-window must be <N> >= 1 or auto[:<N>] "
+                       "with N >= %u\n", TCP_HS_WIN_MIN);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--open-loop") == 0) {
+            a->open_loop = true;
+        } else if (strcmp(argv[i], "--conns") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            a->conns = (uint32_t)strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || a->conns == 0) {
+                printf("start: --conns must be >= 1\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--pool") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            a->pool_max = (uint32_t)strtoul(argv[++i], &end, 10);
+            if (*end == ':')
+                a->pool_min = (uint32_t)strtoul(end + 1, &end, 10);
+            if (*end == ':')
+                a->pool_idle_ms = (uint32_t)strtoul(end + 1, &end, 10);
+            if (*end != '\0' || a->pool_max == 0 ||
+                a->pool_max > CONN_POOL_MAX_IDLE ||
+                a->pool_min > a->pool_max) {
+                printf("start: --pool must be <max>[:<min>[:<idle_ms>]] with "
+                       "1 <= max <= %u and min <= max\n", CONN_POOL_MAX_IDLE);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            char *end = NULL;
+            a->pipeline = (uint32_t)strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || a->pipeline < 2 ||
+                a->pipeline > TX_GEN_PIPE_MAX) {
+                printf("start: --pipeline must be 2-%u\n", TX_GEN_PIPE_MAX);
+                return -1;
+            }
         } else if (strcmp(argv[i], "--one") == 0) {
             a->one = true;
         } else if (strcmp(argv[i], "--dscp") == 0 && i + 1 < argc) {
@@ -550,8 +894,35 @@ parse_start_args(int argc, char **argv, start_args_t *a)
             }
         } else if (strcmp(argv[i], "--cc") == 0 && i + 1 < argc) {
             a->cc = argv[++i];
+        } else if (strcmp(argv[i], "--steer") == 0 && i + 1 < argc) {
+            const char *m = argv[++i];
+            if (strcmp(m, "flow") == 0)
+                a->steer_flow = true;
+            else if (strcmp(m, "rss") != 0) {
+                printf("start: --steer must be rss or flow\n");
+                return -1;
+            }
         } else if (strcmp(argv[i], "--src-ip-count") == 0 && i + 1 < argc) {
-            a->src_ip_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+            char *end = NULL;
+            a->src_ip_count = (uint32_t)strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || a->src_ip_count == 0 ||
+                a->src_ip_count > TGEN_PP_MAX_SRC_IPS) {
+                printf("start: --src-ip-count must be 1-%u\n",
+                       TGEN_PP_MAX_SRC_IPS);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--field") == 0 && i + 1 < argc) {
+            i++;
+            if (a->fields.n_vars == FIELD_VAR_MAX) {
+                printf("start: at most %u --field variables\n", FIELD_VAR_MAX);
+                return -1;
+            }
+            if (field_var_parse(argv[i],
+                                &a->fields.vars[a->fields.n_vars]) < 0) {
+                printf("start: invalid --field '%s'\n", argv[i]);
+                return -1;
+            }
+            a->fields.n_vars++;
         } else if (strcmp(argv[i], "--header") == 0 && i + 1 < argc) {
             i++;
             size_t hlen = strlen(argv[i]);
@@ -579,18 +950,535 @@ parse_start_args(int argc, char **argv, start_args_t *a)
     return 0;
 }
 
-static tx_gen_proto_t
-start_resolve_proto(const start_args_t *a)
+static tx_gen_proto_t
+start_resolve_proto(const start_args_t *a)
+{
+    if (strcmp(a->proto, "pcap") == 0)
+        return TX_GEN_PROTO_PCAP;
+    if (strcmp(a->proto, "l7") == 0)
+        return TX_GEN_PROTO_L7;
+    if (a->reuse)
+        return TX_GEN_PROTO_THROUGHPUT;
+    if (strcmp(a->proto, "icmp") == 0)
+        return TX_GEN_PROTO_ICMP;
+    if (strcmp(a->proto, "udp") == 0)
+        return TX_GEN_PROTO_UDP;
+    if (strcmp(a->proto, "http") == 0 || strcmp(a->proto, "https") == 0)
+        return TX_GEN_PROTO_HTTP;
+    return TX_GEN_PROTO_TCP_SYN; /* tcp, tls */
+}
+
+/* Mean frame incl. FCS of a udp/icmp or throughput flow. */
+static double
+start_mean_frame(const start_args_t *a, tx_gen_proto_t proto)
+{
+    double vlan = a->vlan_id ? sizeof(struct rte_vlan_hdr) : 0;
+    if (proto == TX_GEN_PROTO_THROUGHPUT)
+        return TX_GEN_TP_SEG_LEN + RTE_ETHER_HDR_LEN + vlan +
+               sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_tcp_hdr) +
+               RTE_ETHER_CRC_LEN;
+    if (a->sizes.n > 0)
+        return size_dist_mean(&a->sizes);
+    return a->size + RTE_ETHER_HDR_LEN + vlan + sizeof(struct rte_ipv4_hdr) +
+           8 + RTE_ETHER_CRC_LEN;
+}
+
+/* Mean frame of a flow as each TX_GEN_LAYER_* counts it; `in` is the
+ * capture of a pcap flow, NULL otherwise. */
+static void
+start_frames(const start_args_t *a, tx_gen_proto_t proto,
+             const pcap_replay_info_t *in, double out[3])
+{
+    if (in) {
+        double frame = (double)in->bytes / (double)in->pkts;   /* no FCS */
+        out[TX_GEN_LAYER_L1] = frame + METRICS_L1_OVERHEAD;
+        out[TX_GEN_LAYER_L2] = frame + RTE_ETHER_CRC_LEN;
+        out[TX_GEN_LAYER_L3] = frame - RTE_ETHER_HDR_LEN;
+        return;
+    }
+    double frame = start_mean_frame(a, proto);
+    out[TX_GEN_LAYER_L1] = frame + METRICS_L1_OVERHEAD - RTE_ETHER_CRC_LEN;
+    out[TX_GEN_LAYER_L2] = frame;
+    out[TX_GEN_LAYER_L3] = frame - RTE_ETHER_HDR_LEN - RTE_ETHER_CRC_LEN -
+                           (a->vlan_id ? sizeof(struct rte_vlan_hdr) : 0);
+}
+
+/* L1 load of a rate: bits/s counted at `layer` when `bps`, else frames/s. */
+static uint64_t
+frames_l1_bps(const double frames[3], uint64_t rate, bool bps, uint8_t layer)
+{
+    if (bps)
+        return (uint64_t)((double)rate * frames[TX_GEN_LAYER_L1] /
+                          frames[layer]);
+    return (uint64_t)((double)rate * frames[TX_GEN_LAYER_L1] * 8);
+}
+
+/* L1 rate a flow commits on its port, 0 when not known up front
+ * (unlimited, or connections per second). */
+static uint64_t
+start_l1_bps(const start_args_t *a, tx_gen_proto_t proto,
+             const double frames[3])
+{
+    if (a->bps)
+        return frames_l1_bps(frames, a->bps, true, (uint8_t)a->layer);
+    if (a->rate && tx_gen_proto_stateless(proto))
+        return frames_l1_bps(frames, a->rate, false, 0);
+    return 0;
+}
+
+/* Refuse a flow that would take the port's committed L1 load past its
+ * cap, or past the link speed when uncapped. */
+static int
+start_check_port_load(uint16_t port_id, uint64_t l1_bps)
+{
+    if (l1_bps == 0)
+        return 0;
+    uint64_t limit = __atomic_load_n(&g_port_cap_bps[port_id],
+                                     __ATOMIC_RELAXED);
+    const char *what = "cap";
+    if (limit == 0) {
+        struct rte_eth_link link;
+        if (rte_eth_link_get_nowait(port_id, &link) != 0 ||
+            !link.link_status || link.link_speed == RTE_ETH_SPEED_NUM_NONE ||
+            link.link_speed == RTE_ETH_SPEED_NUM_UNKNOWN)
+            return 0;
+        limit = (uint64_t)link.link_speed * 1000000ULL;
+        what  = "link";
+    }
+    uint64_t committed = 0;
+    for (uint32_t i = 0; i < TGEN_MAX_CLIENT_FLOWS; i++) {
+        const traffic_gen_state_t *f = &g_client_flows[i];
+        if (f->active && f->port_id == port_id)
+            committed += f->l1_bps;
+    }
+    if (committed + l1_bps <= limit)
+        return 0;
+    char b1[32], b2[32], b3[32];
+    printf("start: port %u would be oversubscribed: %s L1 requested, "
+           "%s running, %s %s\n", port_id,
+           tgen_bps_str(l1_bps, b1, sizeof(b1)),
+           tgen_bps_str(committed, b2, sizeof(b2)), what,
+           tgen_bps_str(limit, b3, sizeof(b3)));
+    return -1;
+}
+
+/* Validate --target against the flow and the flows already running. */
+static int
+start_check_target(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (!a->has_target) {
+        if (load_ctl_active()) {
+            printf("start: a --target flow is running and must run alone "
+                   "(its controller reads the global counters)\n");
+            return -1;
+        }
+        return 0;
+    }
+    if (a->one || a->bps || a->pace) {
+        printf("start: --target is mutually exclusive with --one, --bps "
+               "and --pace\n");
+        return -1;
+    }
+    if (a->rate && proto == TX_GEN_PROTO_THROUGHPUT) {
+        printf("start: --rate cannot cap a --reuse --target flow\n");
+        return -1;
+    }
+    if (!load_ctl_supports(a->target_metric, proto)) {
+        printf("start: --target %s is not measurable on a %s%s flow\n",
+               load_metric_name(a->target_metric), a->proto,
+               a->reuse ? " --reuse" : "");
+        return -1;
+    }
+    if (a->ramp >= a->duration) {
+        printf("start: --target needs --ramp shorter than --duration "
+               "to leave a hold phase\n");
+        return -1;
+    }
+    if (client_any_active()) {
+        printf("start: a --target flow must run alone (its controller "
+               "reads the global counters)\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Validate --profile and --arrivals: both shape a rate, so need one. */
+static int
+start_check_profile(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (a->has_sched) {
+        if (!a->rate && !a->bps) {
+            printf("start: --profile needs --rate, --cps or --bps as its peak\n");
+            return -1;
+        }
+        if (a->one || a->pace || a->ramp || a->has_target) {
+            printf("start: --profile is mutually exclusive with --one, --pace, "
+                   "--ramp and --target\n");
+            return -1;
+        }
+    }
+    if (a->poisson) {
+        if (!a->rate || a->bps || proto == TX_GEN_PROTO_THROUGHPUT) {
+            printf("start: --arrivals poisson needs --rate or --cps "
+                   "(not --bps or --reuse)\n");
+            return -1;
+        }
+        if (a->one || a->pace) {
+            printf("start: --arrivals poisson is mutually exclusive with "
+                   "--one and --pace\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Validate --open-loop: requests at --rate on a connection pool, so the
+ * flags that pace a connection's own requests don't apply. */
+static int
+start_check_open_loop(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (!a->open_loop) {
+        if (a->conns) {
+            printf("start: --conns requires --open-loop\n");
+            return -1;
+        }
+        return 0;
+    }
+    if (proto != TX_GEN_PROTO_HTTP) {
+        printf("start: --open-loop requires --proto http or https\n");
+        return -1;
+    }
+    if (!a->rate) {
+        printf("start: --open-loop needs --rate (requests/s)\n");
+        return -1;
+    }
+    if (a->one || a->think_time || a->has_sched || a->has_target) {
+        printf("start: --open-loop is mutually exclusive with --one, "
+               "--think-time, --profile and --target\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* --conns is split over the port's generating workers, each holding at
+ * most HTTP_OL_MAX_CONNS: refuse what they cannot hold. */
+static int
+start_check_conns(const start_args_t *a, uint16_t port_id)
+{
+    if (!a->open_loop || !a->conns)
+        return 0;
+    uint32_t n_gen = tgen_port_generators(port_id, false);
+    uint64_t max = (uint64_t)HTTP_OL_MAX_CONNS * TGEN_MAX(n_gen, 1u);
+    if (a->conns > max) {
+        printf("start: --conns must be <= %"PRIu64" on port %u "
+               "(%u per generating worker, %u workers)\n",
+               max, port_id, HTTP_OL_MAX_CONNS, n_gen);
+        return -1;
+    }
+    return 0;
+}
+
+/* Validate --pool: HTTP transactions on shared keep-alive connections.
+ * Open loop keeps its own per-flow pool and --one opens exactly one. */
+static int
+start_check_pool(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (!a->pool_max)
+        return 0;
+    if (proto != TX_GEN_PROTO_HTTP) {
+        printf("start: --pool requires --proto http or https\n");
+        return -1;
+    }
+    if (a->open_loop || a->one) {
+        printf("start: --pool is mutually exclusive with --open-loop "
+               "and --one\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Validate --pipeline: batches of requests on keep-alive connections.
+ * Open loop sends one request per intended time; --one sends one. */
+static int
+start_check_pipeline(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (!a->pipeline)
+        return 0;
+    if (proto != TX_GEN_PROTO_HTTP) {
+        printf("start: --pipeline requires --proto http or https\n");
+        return -1;
+    }
+    if (a->open_loop || a->one) {
+        printf("start: --pipeline is mutually exclusive with --open-loop "
+               "and --one\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Validate --proto pcap: frames, sizes and addresses come from the
+ * capture, so the flags that shape built packets don't apply.
+ * --proto l7 replays the capture's payload over connections to --port. */
+static int
+start_check_pcap(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (proto != TX_GEN_PROTO_PCAP) {
+        if (a->has_speed || a->loops ||
+            a->rewrite.rewrite_mac || a->rewrite.n_maps) {
+            printf("start: --speed, --loops and --rewrite-* "
+                   "require --proto pcap\n");
+            return -1;
+        }
+        if (proto != TX_GEN_PROTO_L7) {
+            if (a->pcap) {
+                printf("start: --pcap requires --proto pcap or l7\n");
+                return -1;
+            }
+            return 0;
+        }
+        if (!a->pcap) {
+            printf("start: --proto l7 needs --pcap <file>\n");
+            return -1;
+        }
+        if (a->reuse || a->replay || a->fields.n_vars || a->probe ||
+            a->sizes.n || a->pace || a->tls || a->txn_per_conn ||
+            a->think_time || a->custom_hdrs_len) {
+            printf("start: --proto l7 sends the capture's payload: --reuse, "
+                   "--replay, --field, --probe, --sizes, --pace, --tls, "
+                   "--txn-per-conn, --think-time and --header don't apply\n");
+            return -1;
+        }
+        return 0;
+    }
+    if (!a->pcap) {
+        printf("start: --proto pcap needs --pcap <file>\n");
+        return -1;
+    }
+    if (a->one || a->reuse || a->replay || a->fields.n_vars || a->probe ||
+        a->sizes.n || a->pace || a->has_target || a->tls || a->vlan_id ||
+        a->dscp || a->src_ip_count > 1) {
+        printf("start: --proto pcap sends the capture's frames: --one, "
+               "--reuse, --replay, --field, --probe, --sizes, --pace, "
+               "--target, --tls, --vlan, --dscp and --src-ip-count "
+               "don't apply\n");
+        return -1;
+    }
+    if (a->has_speed && (a->rate || a->bps)) {
+        printf("start: --speed and --rate/--bps are mutually exclusive\n");
+        return -1;
+    }
+    if (a->ramp && !a->rate && !a->bps) {
+        printf("start: --ramp needs --rate or --bps with --proto pcap\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Capture timing multiplier: 1 by default, 0 (untimed) at --speed max
+ * or when --rate / --bps set the pace. */
+static double
+start_pcap_speed(const start_args_t *a)
+{
+    if (a->rate || a->bps)
+        return 0;
+    return a->has_speed ? a->speed : 1.0;
+}
+
+/* Preload the capture into the flow's slot.  Prints "start: ..." and
+ * returns -1 on failure. */
+static int
+start_load_pcap(const start_args_t *a, uint32_t flow_idx, uint16_t port_id,
+                const struct rte_ether_addr *dst_mac)
+{
+    pcap_replay_opts_t o = a->rewrite;
+    o.path    = a->pcap;
+    o.port_id = port_id;
+    o.speed   = start_pcap_speed(a);
+    o.src_mac = g_arp[port_id].local_mac;
+    o.dst_mac = *dst_mac;
+    int rc = pcap_replay_load(flow_idx, &o);
+    if (rc == -E2BIG)
+        printf("start: %s has more than %u frames\n", a->pcap,
+               PCAP_REPLAY_MAX_PKTS);
+    else if (rc == -ENOMEM)
+        printf("start: not enough hugepage memory to preload %s\n", a->pcap);
+    else if (rc < 0)
+        printf("start: cannot load %s: %s\n", a->pcap,
+               rc == -EINVAL ? "not a usable pcap/pcapng capture (see log)"
+                             : strerror(-rc));
+    return rc < 0 ? -1 : 0;
+}
+
+/* L1 rate a replay commits on its port: the capture's own at --speed,
+ * or --rate / --bps over its mean frame; 0 at max speed. */
+static uint64_t
+start_pcap_l1_bps(const start_args_t *a, const pcap_replay_info_t *in,
+                  const double frames[3])
+{
+    double speed = start_pcap_speed(a);
+    if (a->bps || a->rate)
+        return start_l1_bps(a, TX_GEN_PROTO_PCAP, frames);
+    if (speed > 0 && in->span_s > 0)
+        return (uint64_t)((double)in->pkts * frames[TX_GEN_LAYER_L1] * 8 *
+                          speed / in->span_s);
+    return 0;
+}
+
+/* Expected --target metric per unit of the flow's rate knob: the
+ * controller's starting model, which it corrects as it measures. */
+static double
+start_target_gain(const start_args_t *a, tx_gen_proto_t proto)
+{
+    double frame = start_mean_frame(a, proto);
+    switch (a->target_metric) {
+    case METRIC_RPS:
+    case METRIC_TPS:
+        if (proto == TX_GEN_PROTO_HTTP &&
+            TGEN_MAX(a->txn_per_conn, a->pipeline) > 1)
+            return TGEN_MAX(a->txn_per_conn, a->pipeline);
+        return 1.0;
+    case METRIC_MBPS:
+        if (proto == TX_GEN_PROTO_THROUGHPUT)   /* payload per L1 bit */
+            return TX_GEN_TP_SEG_LEN /
+                   (frame + METRICS_L1_OVERHEAD - RTE_ETHER_CRC_LEN) / 1e6;
+        if (tx_gen_proto_stateless(proto))
+            return (frame - RTE_ETHER_CRC_LEN) * 8.0 / 1e6;
+        return 0.01;            /* ~10 kbit per connection */
+    default:
+        return 1.0;             /* cps; conc assumes a 1 s lifetime */
+    }
+}
+
+/* Reject --field variables the frame can't carry. */
+static int
+start_check_fields(const start_args_t *a, tx_gen_proto_t proto)
+{
+    if (!tx_gen_proto_stateless(proto)) {
+        printf("start: --field requires --proto udp or icmp\n");
+        return -1;
+    }
+    if (a->replay) {
+        printf("start: --field and --replay are mutually exclusive\n");
+        return -1;
+    }
+    for (uint32_t i = 0; i < a->fields.n_vars; i++) {
+        const field_var_t *v = &a->fields.vars[i];
+        if ((v->field == FV_SRC_PORT || v->field == FV_DST_PORT) &&
+            proto != TX_GEN_PROTO_UDP) {
+            printf("start: --field %s-port requires --proto udp\n",
+                   v->field == FV_SRC_PORT ? "src" : "dst");
+            return -1;
+        }
+        if (v->field == FV_VLAN && a->vlan_id == 0) {
+            printf("start: --field vlan requires --vlan\n");
+            return -1;
+        }
+        if (v->field == FV_SRC_IP && a->src_ip_count > 1) {
+            printf("start: --field src-ip replaces --src-ip-count\n");
+            return -1;
+        }
+        if (v->field == FV_PAYLOAD &&
+            (uint32_t)v->offset + v->size > a->size) {
+            printf("start: --field payload@%u/%u is past the %u-byte payload\n",
+                   v->offset, v->size, a->size);
+            return -1;
+        }
+        if (v->field == FV_PAYLOAD && a->probe &&
+            v->offset < UDP_PROBE_LEN) {
+            printf("start: --field payload@%u overlaps the %u-byte probe\n",
+                   v->offset, UDP_PROBE_LEN);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Pick the egress port for dst_ip and ARP-resolve its next hop (waits up
+ * to 3 s).  Prints "<who>: ..." and returns -1 on failure. */
+static int
+resolve_dst(const char *who, const char *ip_str, uint32_t dst_ip,
+            uint16_t *port_out, struct rte_ether_addr *mac_out)
+{
+    /* Select egress port: scan all configured ports, prefer the one whose
+     * subnet contains dst_ip (on-link), fall back to any port with a
+     * default gateway, then port 0. */
+    uint16_t port_id = 0;
+    bool port_matched = false;
+    for (uint16_t p = 0; p < g_n_ports && !port_matched; p++) {
+        rte_rwlock_read_lock(&g_arp[p].lock);
+        uint32_t lip  = g_arp[p].local_ip;
+        uint32_t lmask = g_arp[p].netmask;
+        rte_rwlock_read_unlock(&g_arp[p].lock);
+        if (lip && lmask && (dst_ip & lmask) == (lip & lmask)) {
+            port_id = p;
+            port_matched = true;
+        }
+    }
+    if (!port_matched) {
+        /* No on-link match — use the first port with a gateway configured */
+        for (uint16_t p = 0; p < g_n_ports; p++) {
+            rte_rwlock_read_lock(&g_arp[p].lock);
+            uint32_t gw = g_arp[p].gateway_ip;
+            rte_rwlock_read_unlock(&g_arp[p].lock);
+            if (gw != 0) { port_id = p; break; }
+        }
+    }
+
+    /* ── ARP-resolve destination ────────────────────────────────────── */
+    struct rte_ether_addr dst_mac;
+    uint32_t nexthop = arp_nexthop(port_id, dst_ip);
+    if (!arp_lookup(port_id, nexthop, &dst_mac)) {
+        arp_request(port_id, nexthop);
+        uint64_t deadline = rte_rdtsc() + 3ULL * rte_get_tsc_hz();
+        while (rte_rdtsc() < deadline) {
+            arp_mgmt_tick();
+            pktrace_flush();          /* drain capture ring to avoid drops */
+            if (arp_lookup(port_id, nexthop, &dst_mac)) break;
+            mgmt_delay_ms_flush(10);
+        }
+    }
+    if (!arp_lookup(port_id, nexthop, &dst_mac)) {
+        printf("%s: ARP resolution failed for %s\n", who, ip_str);
+        return -1;
+    }
+    *port_out = port_id;
+    *mac_out  = dst_mac;
+    return 0;
+}
+
+/* Wait up to 100 ms for the START acks of the workers in `sent` and
+ * report those that could not take the flow; the others run it. */
+static void
+start_report_acks(uint32_t flow_idx, uint32_t seq, const bool *sent)
 {
-    if (a->reuse)
-        return TX_GEN_PROTO_THROUGHPUT;
-    if (strcmp(a->proto, "icmp") == 0)
-        return TX_GEN_PROTO_ICMP;
-    if (strcmp(a->proto, "udp") == 0)
-        return TX_GEN_PROTO_UDP;
-    if (strcmp(a->proto, "http") == 0 || strcmp(a->proto, "https") == 0)
-        return TX_GEN_PROTO_HTTP;
-    return TX_GEN_PROTO_TCP_SYN; /* tcp, tls */
+    uint32_t n_workers = g_core_map.num_workers;
+    uint64_t deadline = rte_rdtsc() + rte_get_tsc_hz() / 10;
+    uint32_t pending = 0;
+    bool wait[TGEN_MAX_WORKERS];
+    for (uint32_t w = 0; w < n_workers; w++) {
+        wait[w] = sent[w];
+        pending += sent[w];
+    }
+
+    while (pending > 0 && rte_rdtsc() < deadline) {
+        for (uint32_t w = 0; w < n_workers; w++) {
+            ipc_ack_t ack;
+            while (tgen_ipc_collect_ack(w, &ack)) {
+                if (ack.seq != seq || !wait[w])
+                    continue;
+                wait[w] = false;
+                pending--;
+                if (ack.rc == -ENOSPC)
+                    printf("start: worker %u already pools %u targets, "
+                           "flow #%u does not run there\n",
+                           w, CONN_POOL_MAX_KEYS, flow_idx);
+                else if (ack.rc < 0)
+                    printf("start: worker %u cannot run flow #%u (%s)\n",
+                           w, flow_idx, strerror(-ack.rc));
+            }
+        }
+        rte_pause();
+    }
 }
 
 static void
@@ -608,12 +1496,15 @@ cmd_start(int argc, char **argv)
 
     /* Validate required flags */
     if (!a.has_ip)       { printf("start: --ip is required\n%s",       start_usage()); return; }
-    if (!a.has_port)     { printf("start: --port is required\n%s",     start_usage()); return; }
+    if (!a.has_port && strcmp(a.proto, "pcap") != 0) {
+        printf("start: --port is required\n%s", start_usage());
+        return;
+    }
 
     /* --one is mutually exclusive with --duration and --rate */
     if (a.one) {
-        if (a.has_duration || a.rate) {
-            printf("start: --one is mutually exclusive with --duration and --rate\n");
+        if (a.has_duration || a.rate || a.bps) {
+            printf("start: --one is mutually exclusive with --duration, --rate and --bps\n");
             return;
         }
         a.duration     = 10;  /* safety timeout */
@@ -624,17 +1515,23 @@ cmd_start(int argc, char **argv)
     if (!a.has_duration) { printf("start: --duration is required (or use --one)\n%s", start_usage()); return; }
     if (a.duration == 0) { printf("start: --duration must be > 0\n");  return; }
 
-    /* Find a free flow slot */
+    if (rfc2544_active()) {
+        printf("start: an rfc2544 run is in progress ('rfc2544 stop' aborts it)\n");
+        return;
+    }
+
+    /* Find a free flow slot (probe flows: one with probe state) */
+    uint32_t n_slots = a.probe ? UDP_PROBE_MAX_FLOWS : TGEN_MAX_CLIENT_FLOWS;
     uint32_t flow_idx = UINT32_MAX;
-    for (uint32_t i = 0; i < TGEN_MAX_CLIENT_FLOWS; i++) {
+    for (uint32_t i = 0; i < n_slots; i++) {
         if (!g_client_flows[i].active) {
             flow_idx = i;
             break;
         }
     }
     if (flow_idx == UINT32_MAX) {
-        printf("start: all %d flow slots in use — run 'stop' or 'stop <id>' first\n",
-               TGEN_MAX_CLIENT_FLOWS);
+        printf("start: all %u %sflow slots in use — run 'stop' or 'stop <id>' first\n",
+               n_slots, a.probe ? "probe " : "");
         return;
     }
 
@@ -646,54 +1543,118 @@ cmd_start(int argc, char **argv)
     }
 
     tx_gen_proto_t proto = start_resolve_proto(&a);
-
-    /* Select egress port: scan all configured ports, prefer the one whose
-     * subnet contains dst_ip (on-link), fall back to any port with a
-     * default gateway, then port 0. */
-    uint16_t port_id = 0;
-    bool port_matched = false;
-    for (uint16_t p = 0; p < g_n_ports && !port_matched; p++) {
-        rte_rwlock_read_lock(&g_arp[p].lock);
-        uint32_t lip  = g_arp[p].local_ip;
-        uint32_t lmask = g_arp[p].netmask;
-        rte_rwlock_read_unlock(&g_arp[p].lock);
-        if (lip && lmask && (dst_ip & lmask) == (lip & lmask)) {
-            port_id = p;
-            port_matched = true;
+    if (start_check_pcap(&a, proto) < 0)
+        return;
+    if (a.replay && !tx_gen_proto_stateless(proto)) {
+        printf("start: --replay requires --proto udp or icmp\n");
+        return;
+    }
+    /* --sizes: the payload checks below hold for the smallest frame, the
+     * template is built for the largest. */
+    uint16_t max_payload = a.size;
+    if (a.sizes.n > 0) {
+        uint16_t hdrs = (uint16_t)(RTE_ETHER_HDR_LEN + RTE_ETHER_CRC_LEN +
+                                   (a.vlan_id ? sizeof(struct rte_vlan_hdr) : 0) +
+                                   sizeof(struct rte_ipv4_hdr) + 8);
+        uint16_t room = TGEN_MBUF_DATA_SZ - RTE_PKTMBUF_HEADROOM;
+        if (!tx_gen_proto_stateless(proto) || a.replay) {
+            printf("start: --sizes requires --proto udp or icmp and no --replay\n");
+            return;
         }
+        if (size_dist_max(&a.sizes) - RTE_ETHER_CRC_LEN > room) {
+            printf("start: --sizes frames must be <= %u bytes\n",
+                   room + RTE_ETHER_CRC_LEN);
+            return;
+        }
+        a.size      = (uint16_t)(size_dist_min(&a.sizes) - hdrs);
+        max_payload = (uint16_t)(size_dist_max(&a.sizes) - hdrs);
     }
-    if (!port_matched) {
-        /* No on-link match — use the first port with a gateway configured */
-        for (uint16_t p = 0; p < g_n_ports; p++) {
-            rte_rwlock_read_lock(&g_arp[p].lock);
-            uint32_t gw = g_arp[p].gateway_ip;
-            rte_rwlock_read_unlock(&g_arp[p].lock);
-            if (gw != 0) { port_id = p; break; }
+    if (a.fields.n_vars > 0 && start_check_fields(&a, proto) < 0)
+        return;
+    if (a.probe) {
+        if (proto != TX_GEN_PROTO_UDP || a.replay) {
+            printf("start: --probe requires --proto udp and no --replay\n");
+            return;
+        }
+        if (a.size < UDP_PROBE_LEN) {
+            if (a.sizes.n > 0)
+                printf("start: --probe needs --sizes frames >= %u bytes\n",
+                       (unsigned)(size_dist_min(&a.sizes) +
+                                  UDP_PROBE_LEN - a.size));
+            else
+                printf("start: --probe needs --size >= %u\n", UDP_PROBE_LEN);
+            return;
         }
     }
 
-    /* Clamp streams */
-    if (a.streams > 16) a.streams = 16;
-    if (a.streams == 0) a.streams = 1;
+    if ((a.syn_window || a.syn_auto) &&
+        proto != TX_GEN_PROTO_TCP_SYN && proto != TX_GEN_PROTO_HTTP &&
+        proto != TX_GEN_PROTO_L7) {
+        printf("start: --syn-window requires a connection-opening flow "
+               "(tcp, http, https, tls or l7 without --reuse)\n");
+        return;
+    }
+    if (a.pace && (!tx_gen_proto_stateless(proto) || a.rate == 0)) {
+        printf("start: --pace requires --proto udp or icmp and --rate\n");
+        return;
+    }
+    if (a.bps) {
+        if (a.rate) {
+            printf("start: --bps and --rate are mutually exclusive\n");
+            return;
+        }
+        if (!tx_gen_proto_stateless(proto) && proto != TX_GEN_PROTO_THROUGHPUT) {
+            printf("start: --bps requires --proto udp or icmp, or --reuse\n");
+            return;
+        }
+    } else if (a.layer >= 0) {
+        printf("start: --layer requires --bps\n");
+        return;
+    }
+    if (start_check_target(&a, proto) < 0 ||
+        start_check_profile(&a, proto) < 0 ||
+        start_check_open_loop(&a, proto) < 0 ||
+        start_check_pool(&a, proto) < 0 ||
+        start_check_pipeline(&a, proto) < 0)
+        return;
+    if (a.layer < 0)
+        a.layer = TX_GEN_LAYER_L1;
 
-    /* ── ARP-resolve destination ────────────────────────────────────── */
+    uint16_t port_id;
     struct rte_ether_addr dst_mac;
-    uint32_t nexthop = arp_nexthop(port_id, dst_ip);
-    if (!arp_lookup(port_id, nexthop, &dst_mac)) {
-        arp_request(port_id, nexthop);
-        uint64_t deadline = rte_rdtsc() + 3ULL * rte_get_tsc_hz();
-        while (rte_rdtsc() < deadline) {
-            arp_mgmt_tick();
-            pktrace_flush();          /* drain capture ring to avoid drops */
-            if (arp_lookup(port_id, nexthop, &dst_mac)) break;
-            mgmt_delay_ms_flush(10);
+    if (resolve_dst("start", a.ip, dst_ip, &port_id, &dst_mac) < 0 ||
+        start_check_conns(&a, port_id) < 0)
+        return;
+    bool pcap = proto == TX_GEN_PROTO_PCAP;
+    if (pcap && start_load_pcap(&a, flow_idx, port_id, &dst_mac) < 0)
+        return;
+    if (proto == TX_GEN_PROTO_L7) {
+        l7_prog_t *lp;
+        int lrc = l7_replay_compile(a.pcap, &lp);
+        if (lrc < 0) {
+            printf("start: cannot replay '%s': %s\n", a.pcap,
+                   lrc == -EINVAL ? "no usable TCP conversation (see log)"
+                                  : strerror(-lrc));
+            return;
         }
-    }
-    if (!arp_lookup(port_id, nexthop, &dst_mac)) {
-        printf("start: ARP resolution failed for %s\n", a.ip);
+        l7_replay_install(&g_l7_progs[flow_idx], lp);
+    }
+    const pcap_replay_info_t *pi = pcap ? &g_pcap_replays[flow_idx]->info
+                                        : NULL;
+    double frames[3];
+    start_frames(&a, proto, pi, frames);
+    uint64_t l1_bps = pcap ? start_pcap_l1_bps(&a, pi, frames)
+                           : start_l1_bps(&a, proto, frames);
+    if (start_check_port_load(port_id, l1_bps) < 0) {
+        if (pcap)
+            pcap_replay_release(flow_idx);
         return;
     }
 
+    /* Clamp streams */
+    if (a.streams > 16) a.streams = 16;
+    if (a.streams == 0) a.streams = 1;
+
     /* ── Build TX-gen config ────────────────────────────────────────── */
     tx_gen_config_t gcfg;
     memset(&gcfg, 0, sizeof(gcfg));
@@ -704,9 +1665,11 @@ cmd_start(int argc, char **argv)
     gcfg.src_mac    = g_arp[port_id].local_mac;
     gcfg.dst_port   = a.port;
     gcfg.src_port   = 12345;
-    gcfg.pkt_size   = a.size;
+    gcfg.pkt_size   = max_payload;
     gcfg.port_id    = port_id;
     gcfg.rate_pps   = a.rate;
+    gcfg.rate_bps   = a.bps;
+    gcfg.rate_layer = (uint8_t)a.layer;
     gcfg.duration_s = a.duration;
     gcfg.ramp_s         = a.ramp;
     gcfg.txn_per_conn   = a.txn_per_conn;
@@ -717,6 +1680,57 @@ cmd_start(int argc, char **argv)
     gcfg.dscp = a.dscp;
     gcfg.vlan_id = a.vlan_id;
     gcfg.src_ip_count = a.src_ip_count;
+    gcfg.pcap_loops = a.loops;
+    gcfg.syn_window   = a.syn_window;
+    gcfg.syn_adaptive = a.syn_auto;
+    gcfg.http_open_loop = a.open_loop;
+    gcfg.ol_conns       = a.conns;
+    gcfg.pool_max       = (uint16_t)a.pool_max;
+    gcfg.pool_min       = (uint16_t)a.pool_min;
+    gcfg.pool_idle_ms   = a.pool_idle_ms;
+    gcfg.http_pipeline  = (uint8_t)a.pipeline;
+    if (a.replay)
+        gcfg.gen_flags |= TX_GEN_F_REPLAY;
+    /* Per-flow side data: slots are allocated by the first START that
+     * needs one. */
+    field_var_prog_t *fvp = a.fields.n_vars > 0 ? field_var_slot(flow_idx)
+                                                : NULL;
+    size_dist_t      *sdp = a.sizes.n > 0 ? size_dist_slot(flow_idx) : NULL;
+    rate_sched_t     *rsp = a.has_sched ? rate_sched_slot(flow_idx) : NULL;
+    char             *hdp = a.custom_hdrs_len > 0
+                          ? tx_gen_http_hdrs_slot(flow_idx) : NULL;
+    if ((a.fields.n_vars > 0 && !fvp) || (a.sizes.n > 0 && !sdp) ||
+        (a.has_sched && !rsp) || (a.custom_hdrs_len > 0 && !hdp)) {
+        printf("start: no memory for the settings of flow #%u\n", flow_idx);
+        if (pcap)
+            pcap_replay_release(flow_idx);
+        return;
+    }
+    if (fvp) {
+        memcpy(fvp, &a.fields, sizeof(a.fields));
+        gcfg.gen_flags |= TX_GEN_F_FIELDS;
+    }
+    if (a.probe) {
+        udp_probe_reset(flow_idx);
+        gcfg.gen_flags |= TX_GEN_F_PROBE;
+    }
+    if (sdp) {
+        memcpy(sdp, &a.sizes, sizeof(a.sizes));
+        gcfg.gen_flags |= TX_GEN_F_SIZES;
+    }
+    if (rsp) {
+        memcpy(rsp, &a.sched, sizeof(a.sched));
+        gcfg.gen_flags |= TX_GEN_F_SCHED;
+    }
+    if (a.poisson) {
+        rate_sched_exp_init();
+        gcfg.gen_flags |= TX_GEN_F_POISSON;
+    }
+    if (a.pace) {
+        gcfg.gen_flags |= TX_GEN_F_PACE;
+        if (a.pace == 2)
+            gcfg.gen_flags |= TX_GEN_F_PACE_SW;
+    }
 
     /* CC algorithm: default to NewReno, support CUBIC */
     if (a.cc && strcmp(a.cc, "cubic") == 0)
@@ -735,9 +1749,10 @@ cmd_start(int argc, char **argv)
     }
 
     /* Store custom HTTP headers for this flow */
-    memset(g_http_custom_hdrs[flow_idx], 0, sizeof(g_http_custom_hdrs[0]));
-    if (a.custom_hdrs_len > 0)
-        memcpy(g_http_custom_hdrs[flow_idx], a.custom_hdrs, a.custom_hdrs_len + 1);
+    if (hdp)
+        memcpy(hdp, a.custom_hdrs, a.custom_hdrs_len + 1);
+    else if (g_http_custom_hdrs[flow_idx])
+        g_http_custom_hdrs[flow_idx][0] = '\0';
 
     /* ── Reset counters & push to workers ───────────────────────────── */
     uint32_t n_workers = g_core_map.num_workers;
@@ -746,58 +1761,239 @@ cmd_start(int argc, char **argv)
         metrics_reset(n_workers);
         rte_eth_stats_reset(port_id);
     }
+    if (flow_metrics_prepare(flow_idx, n_workers) < 0)
+        printf("start: no memory for the counters of flow #%u, "
+               "counting per worker only\n", flow_idx);
 
-    /* Apply RSS queue affinity so responses land on the correct worker */
+    /* Steer source tuples so responses land on the originating worker */
+    int steer = RSS_STEER_NONE;
     if (proto == TX_GEN_PROTO_TCP_SYN || proto == TX_GEN_PROTO_HTTP ||
-        proto == TX_GEN_PROTO_THROUGHPUT) {
-        struct rte_eth_dev_info dev_info;
-        int _ri = rte_eth_dev_info_get(port_id, &dev_info); (void)_ri;
-        uint16_t n_rxq = dev_info.nb_rx_queues;
-        port_caps_t *pcap = &g_port_caps[port_id];
-        uint8_t key_len = pcap->rss_key_size;
-        if (key_len == 0 || key_len > tgen_rss_key_max_len())
-            key_len = 40;
+        proto == TX_GEN_PROTO_THROUGHPUT || proto == TX_GEN_PROTO_L7) {
         if (first_flow) {
-            /* Reset pools first then filter */
             for (uint32_t w = 0; w < n_workers; w++)
                 tcp_port_pool_reset(w);
         }
-        tcp_port_pool_apply_rss_filter(n_workers, gcfg.src_ip, dst_ip,
-                                       a.port, tgen_rss_key(), key_len,
-                                       n_rxq);
+        bool fresh = false;
+        steer = rss_steer_acquire(port_id, gcfg.vlan_id,
+                                  gcfg.src_ip, gcfg.src_ip_count,
+                                  dst_ip, a.port,
+                                  a.steer_flow ? RSS_STEER_MODE_FLOW
+                                               : RSS_STEER_MODE_RSS,
+                                  &fresh);
+        if (steer == -EEXIST) {
+            printf("start: source range overlaps a running flow to %s:%u\n",
+                   a.ip, a.port);
+            return;
+        }
+        if (steer < 0) {
+            printf("start: cannot set up RSS steering (%s)\n",
+                   strerror(-steer));
+            return;
+        }
+        if (fresh)
+            tcp_port_pool_set_range((uint8_t)steer, gcfg.src_ip,
+                                    gcfg.src_ip_count);
+        if (a.steer_flow &&
+            rss_steer_mode((uint8_t)steer) != RSS_STEER_MODE_FLOW)
+            printf("start: port %u rejected flow rules, steering by RSS\n",
+                   port_id);
+        gcfg.steer_ctx = (uint8_t)steer;
+    }
+
+    /* --target: the controller owns the rate knob and the ramp */
+    if (a.has_target) {
+        load_ctl_params_t lp;
+        memset(&lp, 0, sizeof(lp));
+        lp.metric     = a.target_metric;
+        lp.proto      = (uint8_t)proto;
+        lp.flow_idx   = flow_idx;
+        lp.n_workers  = n_workers;
+        lp.target     = a.target;
+        lp.ramp_s     = a.ramp;
+        lp.duration_s = a.duration;
+        lp.gain       = start_target_gain(&a, proto);
+        lp.rate_max   = a.rate;
+        uint64_t rate0;
+        if (load_ctl_start(&lp, &rate0) < 0) {
+            printf("start: another --target flow is running\n");
+            if (steer != RSS_STEER_NONE)
+                rss_steer_release((uint8_t)steer);
+            return;
+        }
+        gcfg.ramp_s = 0;
+        if (proto == TX_GEN_PROTO_THROUGHPUT) {
+            gcfg.rate_bps   = rate0;
+            gcfg.rate_layer = TX_GEN_LAYER_L1;
+        } else {
+            gcfg.rate_pps   = rate0;
+        }
     }
 
     /* ── Broadcast START command to all workers ───────────────────── */
     config_update_t cmd;
     memset(&cmd, 0, sizeof(cmd));
+    static uint32_t start_seq;
     cmd.cmd = CFG_CMD_START;
-    cmd.seq = 1;
+    cmd.seq = ++start_seq;
     memcpy(cmd.payload, &gcfg, sizeof(gcfg));
-    /* --one: only one worker should initiate the connection. Worker 0 is
-     * chosen because tcp_port_pool_apply_rss_filter has already seeded
-     * its pool with ports whose RSS hash routes responses back to queue 0.
-     * Broadcasting max_initiations=1 to every worker would send N SYNs. */
-    if (a.one)
-        tgen_ipc_send(0, &cmd);
-    else
-        tgen_ipc_broadcast(&cmd);
+    bool sent[TGEN_MAX_WORKERS] = { false };
+    /* --one: only one worker should initiate the connection, and it must
+     * be one the steering context routes return traffic to — otherwise
+     * its port pool is empty.  Broadcasting max_initiations=1 to every
+     * worker would send N SYNs. */
+    if (a.one) {
+        uint32_t one_w = 0;
+        if (gcfg.steer_ctx != RSS_STEER_NONE) {
+            while (one_w + 1 < n_workers &&
+                   !rss_steer_serves(gcfg.steer_ctx, one_w))
+                one_w++;
+        }
+        sent[one_w] = tgen_ipc_send(one_w, &cmd) == 0;
+    } else {
+        for (uint32_t w = 0; w < n_workers; w++)
+            sent[w] = tgen_ipc_send(w, &cmd) == 0;
+    }
+    start_report_acks(flow_idx, cmd.seq, sent);
 
     /* ── Print initial progress ──────────────────────────────────────── */
     if (a.reuse) {
         printf("[#%u] Traffic %s → %s:%u  streams=%u  duration=%us%s\n",
                flow_idx, a.proto, a.ip, a.port, a.streams, a.duration,
                a.tls ? " [TLS]" : "");
+        if (a.has_target)
+            printf("     target %s %.1f\n",
+                   load_metric_name(a.target_metric), a.target);
         printf("[ ID]  Interval       Transfer     Throughput\n");
     } else if (a.one) {
         printf("[#%u] Single %s → %s:%u%s\n",
                flow_idx, a.proto, a.ip, a.port, a.tls ? " [TLS]" : "");
+    } else if (pcap) {
+        char how[48];
+        double speed = start_pcap_speed(&a);
+        if (a.bps) {
+            char tmp[32];
+            snprintf(how, sizeof(how), "%s %s",
+                     tgen_bps_str(a.bps, tmp, sizeof(tmp)),
+                     k_layer_names[a.layer]);
+        } else if (a.rate) {
+            snprintf(how, sizeof(how), "%" PRIu64 " pps", a.rate);
+        } else if (speed > 0) {
+            snprintf(how, sizeof(how), "capture timing x%g", speed);
+        } else {
+            snprintf(how, sizeof(how), "max speed");
+        }
+        printf("[#%u] Replay %s → port %u via %s  %" PRIu64 " frames "
+               "(%.1f MB, %.3f s captured) over %u queues, %s, ",
+               flow_idx, a.pcap, port_id, a.ip, pi->pkts,
+               (double)pi->bytes / 1e6, pi->span_s, pi->generators, how);
+        if (a.loops)
+            printf("%u pass%s, at most %u seconds\n", a.loops,
+                   a.loops == 1 ? "" : "es", a.duration);
+        else
+            printf("%u seconds\n", a.duration);
+        if (pi->skipped || pi->truncated)
+            printf("     skipped %" PRIu64 " non-Ethernet or oversize frames, "
+                   "%" PRIu64 " captured short of their wire length\n",
+                   pi->skipped, pi->truncated);
+        if (a.rewrite.rewrite_mac)
+            printf("     rewrite: MACs to port %u → next hop of %s\n",
+                   port_id, a.ip);
+        if (a.rewrite.n_maps)
+            printf("     rewrite: %u IPv4 pairs, %" PRIu64 " frames matched\n",
+                   a.rewrite.n_maps, pi->rewritten);
+    } else if (proto == TX_GEN_PROTO_L7) {
+        const l7_prog_t *lp = g_l7_progs[flow_idx];
+        const l7_replay_info_t *in = &lp->info;
+        char rate_str[48];
+        if (a.has_target)
+            snprintf(rate_str, sizeof(rate_str), "target %s %.1f",
+                     load_metric_name(a.target_metric), a.target);
+        else
+            snprintf(rate_str, sizeof(rate_str), "%s",
+                     a.rate ? "rate-limited" : "unlimited");
+        printf("[#%u] Replay %s → %s:%u  %u of %u TCP conversations "
+               "(%" PRIu64 " messages, %" PRIu64 " B client / %" PRIu64
+               " B server), %s, %u seconds\n",
+               flow_idx, a.pcap, a.ip, a.port, lp->n_convs, in->tcp_convs,
+               in->msgs, in->c2s_bytes, in->s2c_bytes, rate_str, a.duration);
+        if (in->incomplete || in->empty || in->dropped)
+            printf("     skipped %u incomplete, %u without payload, "
+                   "%u dropped (other opener, same opening message or "
+                   "past the limits)\n",
+                   in->incomplete, in->empty, in->dropped);
+        if (lp->server_first)
+            printf("     server speaks first: one conversation, the peer "
+                   "must run 'serve ...:replay' on the same capture\n");
     } else {
-        printf("[#%u] Traffic %s → %s:%u  %u-byte payload, %s, %u seconds%s\n",
-               flow_idx, a.proto, a.ip, a.port, a.size,
-               a.rate ? "rate-limited" : "unlimited",
-               a.duration, a.tls ? " [TLS]" : "");
+        char rate_str[48];
+        if (a.has_target) {
+            snprintf(rate_str, sizeof(rate_str), "target %s %.1f",
+                     load_metric_name(a.target_metric), a.target);
+        } else if (a.bps) {
+            char tmp[32];
+            snprintf(rate_str, sizeof(rate_str), "%s %s",
+                     tgen_bps_str(a.bps, tmp, sizeof(tmp)),
+                     k_layer_names[a.layer]);
+        } else {
+            snprintf(rate_str, sizeof(rate_str), "%s",
+                     a.rate ? "rate-limited" : "unlimited");
+        }
+        if (a.sizes.n > 0)
+            printf("[#%u] Traffic %s → %s:%u  %u-%u-byte frames (%s, avg %.0f), "
+                   "%s, %u seconds\n",
+                   flow_idx, a.proto, a.ip, a.port,
+                   size_dist_min(&a.sizes), size_dist_max(&a.sizes),
+                   a.sizes.spec, size_dist_mean(&a.sizes),
+                   rate_str, a.duration);
+        else
+            printf("[#%u] Traffic %s → %s:%u  %u-byte payload, %s, %u seconds%s\n",
+                   flow_idx, a.proto, a.ip, a.port, a.size,
+                   rate_str, a.duration, a.tls ? " [TLS]" : "");
+        if (a.fields.n_vars > 0) {
+            uint64_t period = field_var_period(&a.fields);
+            if (period == UINT64_MAX)
+                printf("     %u field variables, sequence > 2^64 packets\n",
+                       a.fields.n_vars);
+            else
+                printf("     %u field variables, sequence repeats every %"
+                       PRIu64 " packets\n", a.fields.n_vars, period);
+        }
+        if (a.pace) {
+            const port_caps_t *pc = &g_port_caps[port_id];
+            bool hw = a.pace == 1 && !a.replay && pc->has_tx_timestamp;
+            printf("     paced: one packet every %.0f ns flow-wide, %s\n",
+                   1e9 / (double)a.rate,
+                   hw ? "scheduled send (NIC launch time)"
+                 : a.pace == 1 && !a.replay && pc->can_tx_timestamp
+                   ? "software (run with --tx-timestamp for scheduled send)"
+                   : "software");
+        }
     }
 
+    if (a.has_sched)
+        printf("     profile: %s, %s, mean %.1f%% of the rate over %.6g s\n",
+               a.sched.spec, a.sched.loop ? "repeating" : "then holding",
+               rate_sched_mean(&a.sched) * 100.0,
+               (double)a.sched.period / (double)rte_get_tsc_hz());
+    if (a.poisson)
+        printf("     arrivals: poisson (exponential gaps)\n");
+    if (a.open_loop) {
+        if (a.conns)
+            printf("     open loop: %"PRIu64" req/s on up to %u connections, "
+                   "latency from intended send times\n", a.rate, a.conns);
+        else
+            printf("     open loop: %"PRIu64" req/s on up to %u connections "
+                   "per worker, latency from intended send times\n",
+                   a.rate, HTTP_OL_DEF_CONNS);
+    }
+    if (a.pipeline)
+        printf("     pipeline: %u requests per write, %u per connection\n",
+               a.pipeline, TGEN_MAX(a.txn_per_conn, a.pipeline));
+    if (a.pool_max)
+        printf("     pool: up to %u idle connections per worker, %u kept "
+               "warm, %u ms idle timeout\n", a.pool_max, a.pool_min,
+               a.pool_idle_ms ? a.pool_idle_ms : CONN_POOL_DEF_IDLE_MS);
+
     /* ── Set up async traffic gen state ──────────────────────────────── */
     traffic_gen_state_t tgs;
     memset(&tgs, 0, sizeof(tgs));
@@ -809,10 +2005,24 @@ cmd_start(int argc, char **argv)
     tgs.n_workers  = n_workers;
     tgs.port_id    = port_id;
     tgs.rate       = a.rate;
+    tgs.rate_bps   = a.bps;
+    tgs.l1_bps     = l1_bps;
+    tgs.by_frame   = tx_gen_proto_stateless(proto) ||
+                     proto == TX_GEN_PROTO_THROUGHPUT;
+    memcpy(tgs.frames, frames, sizeof(tgs.frames));
     tgs.size       = a.size;
     tgs.tls        = a.tls;
     tgs.streams    = a.streams;
     tgs.dst_port   = a.port;
+    tgs.steer_ctx  = gcfg.steer_ctx;
+    tgs.paced      = a.pace != 0;
+    tgs.pcap       = pcap;
+    tgs.handshakes = proto == TX_GEN_PROTO_TCP_SYN ||
+                     proto == TX_GEN_PROTO_HTTP || proto == TX_GEN_PROTO_L7;
+    tgs.syn_window = a.syn_window || a.syn_auto;
+    tgs.open_loop  = a.open_loop;
+    tgs.load       = a.has_target ? LOAD_TARGET
+                   : (a.rate || a.bps) ? LOAD_CONSTANT : LOAD_UNLIMITED;
     strncpy(tgs.proto, a.proto, sizeof(tgs.proto) - 1);
     strncpy(tgs.dst_ip_str, a.ip, sizeof(tgs.dst_ip_str) - 1);
 
@@ -876,6 +2086,199 @@ cmd_start(int argc, char **argv)
            "'stop' or 'stop %u' to abort)\n", flow_idx);
 }
 
+/* ── rfc2544 ───────────────────────────────────────────────────────────────── */
+/* Shared by the parse errors and the registered help text. */
+#define RFC2544_USAGE \
+    "Usage: rfc2544 --ip <addr> --port <N>\n" \
+    "               [--sizes <bytes,...|imix>] [--tests <list>]\n" \
+    "               [--trial <secs>] [--loss <pct>] [--resolution <pct>]\n" \
+    "               [--step <pct>] [--settle <ms>] [--link <Mbps>]\n" \
+    "               [--dscp <0-63>] [--vlan <id>]\n" \
+    "       rfc2544 status | stop\n"
+
+/* "64,128,imix" → frame sizes (RFC2544_IMIX for imix). */
+static int
+rfc2544_parse_sizes(char *list, rfc2544_params_t *p)
+{
+    char *save = NULL;
+    p->n_frames = 0;
+    for (char *t = strtok_r(list, ",", &save); t;
+         t = strtok_r(NULL, ",", &save)) {
+        if (p->n_frames == RFC2544_MAX_SIZES)
+            return -1;
+        if (strcmp(t, "imix") == 0) {
+            p->frames[p->n_frames++] = RFC2544_IMIX;
+            continue;
+        }
+        char *end;
+        unsigned long f = strtoul(t, &end, 10);
+        if (end == t || *end != '\0' || f == 0 || f > 9216)
+            return -1;
+        p->frames[p->n_frames++] = (uint16_t)f;
+    }
+    return p->n_frames > 0 ? 0 : -1;
+}
+
+/* "throughput,latency,loss,b2b" or "all" → test bitmask. */
+static int
+rfc2544_parse_tests(char *list, uint32_t *mask)
+{
+    char *save = NULL;
+    *mask = 0;
+    for (char *t = strtok_r(list, ",", &save); t;
+         t = strtok_r(NULL, ",", &save)) {
+        if (strcmp(t, "all") == 0) {
+            *mask |= RFC2544_T_ALL;
+            continue;
+        }
+        uint8_t i = 0;
+        while (i < RFC2544_TEST_MAX && strcmp(t, rfc2544_test_name(i)) != 0)
+            i++;
+        if (i == RFC2544_TEST_MAX)
+            return -1;
+        *mask |= 1u << i;
+    }
+    return *mask ? 0 : -1;
+}
+
+static void
+cmd_rfc2544(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "status") == 0) {
+        rfc2544_status();
+        return;
+    }
+    if (argc >= 2 && strcmp(argv[1], "stop") == 0) {
+        if (!rfc2544_abort())
+            printf("rfc2544: no run in progress\n");
+        return;
+    }
+    if (g_config.server_mode) {
+        printf("rfc2544: not available in server mode\n");
+        return;
+    }
+    if (argc < 2) { printf("%s", RFC2544_USAGE); return; }
+
+    static const uint16_t k_sizes[] = { 64, 128, 256, 512, 1024, 1280, 1518 };
+    rfc2544_params_t p;
+    memset(&p, 0, sizeof(p));
+    memcpy(p.frames, k_sizes, sizeof(k_sizes));
+    p.n_frames       = TGEN_ARRAY_SIZE(k_sizes);
+    p.tests          = RFC2544_T_ALL;
+    p.trial_s        = 60;
+    p.settle_ms      = 2000;
+    p.resolution_pct = 0.1;
+    p.loss_step_pct  = 10;
+    const char *ip = NULL;
+    bool has_port = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ip") == 0 && i + 1 < argc) {
+            ip = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            p.dst_port = (uint16_t)strtoul(argv[++i], NULL, 10);
+            has_port = true;
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            if (rfc2544_parse_sizes(argv[++i], &p) < 0) {
+                printf("rfc2544: invalid --sizes\n");
+                return;
+            }
+        } else if (strcmp(argv[i], "--tests") == 0 && i + 1 < argc) {
+            if (rfc2544_parse_tests(argv[++i], &p.tests) < 0) {
+                printf("rfc2544: --tests takes throughput,latency,loss,b2b or all\n");
+                return;
+            }
+        } else if (strcmp(argv[i], "--trial") == 0 && i + 1 < argc) {
+            p.trial_s = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            p.loss_pct = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            p.resolution_pct = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            p.loss_step_pct = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--settle") == 0 && i + 1 < argc) {
+            p.settle_ms = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+            p.link_mbps = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--dscp") == 0 && i + 1 < argc) {
+            p.dscp = (uint8_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--vlan") == 0 && i + 1 < argc) {
+            p.vlan_id = (uint16_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            printf("Unknown flag: %s\n%s", argv[i], RFC2544_USAGE);
+            return;
+        }
+    }
+
+    if (!ip)       { printf("rfc2544: --ip is required\n%s",   RFC2544_USAGE); return; }
+    if (!has_port) { printf("rfc2544: --port is required\n%s", RFC2544_USAGE); return; }
+    if (p.trial_s == 0) { printf("rfc2544: --trial must be > 0\n"); return; }
+    if (p.loss_pct < 0 || p.loss_pct >= 100) {
+        printf("rfc2544: --loss must be 0 to <100\n");
+        return;
+    }
+    if (p.resolution_pct <= 0 || p.resolution_pct > 50) {
+        printf("rfc2544: --resolution must be >0 to 50\n");
+        return;
+    }
+    if (p.loss_step_pct == 0 || p.loss_step_pct > 100) {
+        printf("rfc2544: --step must be 1-100\n");
+        return;
+    }
+    if (p.dscp > 63 || p.vlan_id > 4094) {
+        printf("rfc2544: --dscp must be 0-63, --vlan 1-4094\n");
+        return;
+    }
+    /* Latency is measured at the throughput rate. */
+    if (p.tests & (1u << RFC2544_LATENCY))
+        p.tests |= 1u << RFC2544_THROUGHPUT;
+
+    /* Ethernet + IPv4 + UDP + FCS around the probe */
+    uint16_t min_frame = (uint16_t)(RTE_ETHER_HDR_LEN + sizeof(struct rte_ipv4_hdr) +
+                                    sizeof(struct rte_udp_hdr) +
+                                    RTE_ETHER_CRC_LEN + UDP_PROBE_LEN +
+                                    (p.vlan_id ? 4 : 0));
+    for (uint32_t i = 0; i < p.n_frames; i++) {
+        uint16_t f = p.frames[i] == RFC2544_IMIX ? 64 : p.frames[i];
+        if (f < min_frame) {
+            printf("rfc2544: frames must be >= %u bytes%s\n", min_frame,
+                   p.frames[i] == RFC2544_IMIX ? " (imix has 64)" : "");
+            return;
+        }
+    }
+
+    if (rfc2544_active()) {
+        printf("rfc2544: a run is already in progress\n");
+        return;
+    }
+    if (client_any_active()) {
+        printf("rfc2544: stop the running client flows first\n");
+        return;
+    }
+
+    if (tgen_parse_ipv4(ip, &p.dst_ip) < 0) {
+        printf("rfc2544: invalid IP '%s'\n", ip);
+        return;
+    }
+    if (resolve_dst("rfc2544", ip, p.dst_ip, &p.port_id, &p.dst_mac) < 0)
+        return;
+
+    metrics_reset(g_core_map.num_workers);
+    int rc = rfc2544_start(&p);
+    if (rc == -EINVAL) {
+        printf("rfc2544: port %u reports no link speed, pass --link <Mbps>\n",
+               p.port_id);
+        return;
+    }
+    if (rc < 0) {
+        printf("rfc2544: cannot start (%s)\n", strerror(-rc));
+        return;
+    }
+    printf("[rfc2544] %u frame sizes → %s:%u via port %u, %us trials"
+           " (use 'rfc2544 status', 'rfc2544 stop')\n",
+           p.n_frames, ip, p.dst_port, p.port_id, p.trial_s);
+}
+
 static void
 cmd_stop_client(int argc, char **argv)
 {
@@ -922,13 +2325,10 @@ cmd_reset(int argc, char **argv)
     /* Refuse if traffic generation is still active */
     uint32_t n_workers = g_core_map.num_workers;
     for (uint32_t w = 0; w < n_workers; w++) {
-        for (uint32_t s = 0; s < TGEN_MAX_CLIENT_FLOWS; s++) {
-            if (__atomic_load_n(&g_worker_ctx[w].tx_gen[s].active,
-                                __ATOMIC_ACQUIRE)) {
-                printf("reset: traffic generation is still active — "
-                       "run 'stop' first.\n");
-                return;
-            }
+        if (tx_sched_count(&g_worker_ctx[w].sched) > 0) {
+            printf("reset: traffic generation is still active — "
+                   "run 'stop' first.\n");
+            return;
         }
     }
 
@@ -951,34 +2351,145 @@ cmd_reset(int argc, char **argv)
 }
 
 /* ── Set runtime configuration ───────────────────────────────────────────── */
+#define SET_USAGE \
+    "Usage: set ip <port> <ip> <gateway> <netmask>\n" \
+    "       set rate <pps> [--flow N]   (change rate for running test)\n" \
+    "       set bps <rate>[k|m|g|t] [--layer l1|l2|l3] [--flow N]\n" \
+    "       set port-cap <port> [<rate>[k|m|g|t]|off]\n"
+
+/* set rate <pps> / set bps <rate> — dynamic rate change for running
+ * flows; without --flow every flow on every worker. */
+static void
+set_rate(int argc, char **argv, bool bps)
+{
+    tx_gen_rate_update_t ru = { .flow_idx = UINT32_MAX, .bps = bps,
+                                .layer = TX_GEN_LAYER_L1 };
+    if (argc < 3) {
+        printf("%s", SET_USAGE);
+        return;
+    }
+    if (!bps) {
+        ru.rate = strtoull(argv[2], NULL, 10);
+    } else if (tgen_parse_bps(argv[2], &ru.rate) < 0) {
+        printf("set bps: invalid rate '%s'\n", argv[2]);
+        return;
+    }
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--flow") == 0 && i + 1 < argc) {
+            ru.flow_idx = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (ru.flow_idx >= TGEN_MAX_CLIENT_FLOWS) {
+                printf("set: --flow must be 0-%u\n", TGEN_MAX_CLIENT_FLOWS - 1);
+                return;
+            }
+        } else if (bps && strcmp(argv[i], "--layer") == 0 && i + 1 < argc) {
+            int l = parse_layer(argv[++i]);
+            if (l < 0) {
+                printf("set bps: --layer must be l1, l2 or l3\n");
+                return;
+            }
+            ru.layer = (uint8_t)l;
+        } else {
+            printf("%s", SET_USAGE);
+            return;
+        }
+    }
+
+    config_update_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.cmd = CFG_CMD_SET_RATE;
+    memcpy(cmd.payload, &ru, sizeof(ru));
+    tgen_ipc_broadcast(&cmd);
+
+    /* Mirror what the workers apply, so the port's committed load
+     * follows the new rate. */
+    for (uint32_t i = 0; i < TGEN_MAX_CLIENT_FLOWS; i++) {
+        traffic_gen_state_t *f = &g_client_flows[i];
+        if (!f->active || (ru.flow_idx != UINT32_MAX && ru.flow_idx != i))
+            continue;
+        if (bps && !f->by_frame)
+            continue;       /* the workers ignore a bit rate there */
+        f->rate     = bps ? 0 : ru.rate;
+        f->rate_bps = bps ? ru.rate : 0;
+        /* A --reuse flow's packet rate counts segments of no set size */
+        f->l1_bps   = ru.rate && f->by_frame && (bps || !f->reuse)
+                    ? frames_l1_bps(f->frames, ru.rate, bps, ru.layer) : 0;
+    }
+
+    char flow[24] = "";
+    if (ru.flow_idx != UINT32_MAX)
+        snprintf(flow, sizeof(flow), " on flow #%u", ru.flow_idx);
+    if (bps) {
+        char tmp[32];
+        printf("Rate set to %s %s%s (udp, icmp and --reuse flows)\n",
+               tgen_bps_str(ru.rate, tmp, sizeof(tmp)),
+               k_layer_names[ru.layer], flow);
+    } else {
+        printf("Rate set to %lu pps%s\n", (unsigned long)ru.rate, flow);
+    }
+}
+
+/* set port-cap <port> [<rate>|off] — L1 ceiling over every flow on the
+ * port, read by the workers on their next burst. */
+static void
+set_port_cap(int argc, char **argv)
+{
+    if (argc < 3) {
+        printf("%s", SET_USAGE);
+        return;
+    }
+    uint16_t port_id = (uint16_t)strtoul(argv[2], NULL, 10);
+    if (port_id >= g_n_ports) {
+        printf("set port-cap: port %u does not exist (have %u port(s))\n",
+               port_id, g_n_ports);
+        return;
+    }
+    char tmp[32];
+    if (argc < 4) {
+        uint64_t cap = __atomic_load_n(&g_port_cap_bps[port_id],
+                                       __ATOMIC_RELAXED);
+        if (cap)
+            printf("Port %u capped at %s L1\n", port_id,
+                   tgen_bps_str(cap, tmp, sizeof(tmp)));
+        else
+            printf("Port %u: no cap\n", port_id);
+        return;
+    }
+    uint64_t cap = 0;
+    if (strcmp(argv[3], "off") != 0 && tgen_parse_bps(argv[3], &cap) < 0) {
+        printf("set port-cap: invalid rate '%s'\n", argv[3]);
+        return;
+    }
+    __atomic_store_n(&g_port_cap_bps[port_id], cap, __ATOMIC_RELAXED);
+    if (cap)
+        printf("Port %u capped at %s L1\n", port_id,
+               tgen_bps_str(cap, tmp, sizeof(tmp)));
+    else
+        printf("Port %u: cap removed\n", port_id);
+}
+
 static void
 cmd_set(int argc, char **argv)
 {
     if (argc < 2) {
-        printf("Usage: set ip <port> <ip> <gateway> <netmask>\n"
-               "       set rate <pps>   (change rate for running test)\n");
+        printf("%s", SET_USAGE);
         return;
     }
 
-    /* set rate <pps> — dynamic rate change for running test */
     if (strcmp(argv[1], "rate") == 0) {
-        if (argc < 3) {
-            printf("Usage: set rate <pps>\n");
-            return;
-        }
-        uint64_t new_rate = strtoull(argv[2], NULL, 10);
-        config_update_t cmd;
-        memset(&cmd, 0, sizeof(cmd));
-        cmd.cmd = CFG_CMD_SET_RATE;
-        memcpy(cmd.payload, &new_rate, sizeof(new_rate));
-        tgen_ipc_broadcast(&cmd);
-        printf("Rate set to %lu pps\n", (unsigned long)new_rate);
+        set_rate(argc, argv, false);
+        return;
+    }
+    if (strcmp(argv[1], "bps") == 0) {
+        set_rate(argc, argv, true);
+        return;
+    }
+    if (strcmp(argv[1], "port-cap") == 0) {
+        set_port_cap(argc, argv);
         return;
     }
 
     if (strcmp(argv[1], "ip") != 0) {
-        printf("Usage: set ip <port> <ip> <gateway> <netmask>\n"
-               "       set rate <pps>   (change rate for running test)\n");
+        printf("%s", SET_USAGE);
         return;
     }
 
@@ -1044,10 +2555,12 @@ cmd_show_clients(int argc, char **argv)
     uint64_t now = rte_rdtsc();
     uint64_t hz  = rte_get_tsc_hz();
 
-    printf("  #  %-8s %-16s %-6s %-10s %-8s %s\n",
-           "PROTO", "DESTINATION", "PORT", "DURATION", "ELAPSED", "STATE");
-    printf("  -  %-8s %-16s %-6s %-10s %-8s %s\n",
-           "-----", "-----------", "----", "--------", "-------", "-----");
+    printf("  #  %-8s %-16s %-6s %-10s %-8s %-12s %s\n",
+           "PROTO", "DESTINATION", "PORT", "DURATION", "ELAPSED", "SENT",
+           "STATE");
+    printf("  -  %-8s %-16s %-6s %-10s %-8s %-12s %s\n",
+           "-----", "-----------", "----", "--------", "-------", "----",
+           "-----");
 
     for (uint32_t i = 0; i < TGEN_MAX_CLIENT_FLOWS; i++) {
         traffic_gen_state_t *cs = &g_client_flows[i];
@@ -1066,10 +2579,14 @@ cmd_show_clients(int argc, char **argv)
                 ? (cs->stop_tsc - cs->start_tsc) / hz : 0;
         }
 
-        printf("  %u  %-8s %-16s %-6u %u/%us     %-8lu %s%s%s\n",
+        /* Packets, or connections initiated, over all generators */
+        uint64_t sent, dropped;
+        tgen_worker_flow_counters(i, &sent, &dropped);
+
+        printf("  %u  %-8s %-16s %-6u %u/%us     %-8lu %-12" PRIu64 " %s%s%s\n",
                i, cs->proto, cs->dst_ip_str, cs->dst_port,
                (unsigned)elapsed_s, cs->duration_s,
-               (unsigned long)(cs->rate ? cs->rate : 0),
+               (unsigned long)(cs->rate ? cs->rate : 0), sent,
                state,
                cs->tls ? " [TLS]" : "",
                cs->reuse ? " [reuse]" : "");
@@ -1219,6 +2736,8 @@ parse_listen_spec(const char *spec, srv_listen_spec_t *out)
             out->handler = SRV_HANDLER_DISCARD;
         else if (strcmp(hdl_s, "chargen") == 0)
             out->handler = SRV_HANDLER_CHARGEN;
+        else if (strcmp(hdl_s, "replay") == 0)
+            out->handler = SRV_HANDLER_REPLAY;
         else return -1;
     } else if (strcmp(proto_s, "http") == 0) {
         out->handler = SRV_HANDLER_HTTP;
@@ -1249,6 +2768,7 @@ cmd_serve(int argc, char **argv)
     const char *tls_cert    = NULL;
     const char *tls_key     = NULL;
     const char *tls_ciphers = NULL;
+    const char *pcap_path   = NULL;
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
@@ -1273,6 +2793,8 @@ cmd_serve(int argc, char **argv)
             tls_ciphers = argv[++i];
         } else if (strcmp(argv[i], "--http-body-size") == 0 && i + 1 < argc) {
             cfg.http_body_size = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pcap") == 0 && i + 1 < argc) {
+            pcap_path = argv[++i];
         } else {
             printf("serve: unknown option '%s'\n", argv[i]);
             return;
@@ -1302,6 +2824,30 @@ cmd_serve(int argc, char **argv)
         tls_ciphers = NULL;
     }
 
+    /* Replay listeners share one compiled capture */
+    bool needs_pcap = false;
+    for (uint32_t i = 0; i < cfg.count; i++)
+        if (cfg.specs[i].handler == SRV_HANDLER_REPLAY)
+            needs_pcap = true;
+    if (needs_pcap && !pcap_path) {
+        printf("serve: --pcap required for tcp:<port>:replay listeners\n");
+        return;
+    }
+    if (pcap_path && !needs_pcap) {
+        printf("serve: --pcap ignored (no replay listeners)\n");
+        pcap_path = NULL;
+    }
+    l7_prog_t *l7 = NULL;
+    if (pcap_path) {
+        int lrc = l7_replay_compile(pcap_path, &l7);
+        if (lrc < 0) {
+            printf("serve: cannot replay '%s': %s\n", pcap_path,
+                   lrc == -EINVAL ? "no usable TCP conversation (see log)"
+                                  : strerror(-lrc));
+            return;
+        }
+    }
+
     /* Store TLS cert/key paths globally */
     if (tls_cert)
         snprintf(g_srv_tls_cert_path, sizeof(g_srv_tls_cert_path), "%s", tls_cert);
@@ -1312,17 +2858,33 @@ cmd_serve(int argc, char **argv)
     if (needs_tls) {
         if (tls_server_ctx_load(tls_cert, tls_key) < 0) {
             printf("serve: failed to load TLS certificate/key\n");
+            l7_replay_install(&l7, NULL);
             return;
         }
         if (tls_ciphers) {
             if (tls_server_ctx_set_ciphers(tls_ciphers) < 0) {
                 printf("serve: invalid cipher list '%s'\n", tls_ciphers);
+                l7_replay_install(&l7, NULL);
                 return;
             }
             printf("TLS cipher list: %s\n", tls_ciphers);
         }
     }
 
+    /* Installed before the broadcast so workers see it on SERVE */
+    if (l7) {
+        l7_replay_install(&g_l7_srv_prog, l7);
+        const l7_replay_info_t *in = &l7->info;
+        printf("Replay: %s — %u of %u TCP conversations, %"PRIu64" messages, "
+               "%"PRIu64" B client / %"PRIu64" B server, %s first\n",
+               pcap_path, l7->n_convs, in->tcp_convs, in->msgs,
+               in->c2s_bytes, in->s2c_bytes,
+               l7->server_first ? "server" : "client");
+        if (in->incomplete || in->empty || in->dropped)
+            printf("  skipped: %u incomplete, %u without payload, %u dropped\n",
+                   in->incomplete, in->empty, in->dropped);
+    }
+
     /* Save mgmt-side shadow for listeners display */
     g_srv_active_cfg = cfg;
     g_srv_active = true;
@@ -1636,18 +3198,25 @@ cli_run(void)
         "With a command name, shows detailed usage for that command.\n",
         cmd_help);
 
-    cli_register("stat",     "Statistics: stat [cpu|mem|net|port] [--rate] [--core N]",
-        "Usage: stat [cpu|mem|net|port] [--rate] [--core N]\n"
+    cli_register("stat",     "Statistics: stat [cpu|mem|net|port|probe|pace|handshake|pool|target] [--rate] [--core N]",
+        "Usage: stat [cpu|mem|net|port|probe|pace|handshake|pool|target] [--rate] [--core N]\n"
         "\n"
         "Sub-commands:\n"
         "  cpu    Per-core CPU utilisation (RX%, TX%, Timer%, Idle%)\n"
         "  mem    Memory usage: mbufs, heap, connections, hugepages\n"
-        "  net    Network packet counters (same as 'stats')\n"
+        "  net    Network packet counters (same as 'stats') [--flow N]\n"
         "  port   Per-NIC hardware statistics from the DPDK driver\n"
+        "  probe  UDP probe loss, reorder, latency and jitter [--flow N]\n"
+        "  pace   Inter-packet gap of --pace flows [--flow N]\n"
+        "  handshake  SYN window, half-open handshakes, SYN→SYN-ACK time and\n"
+        "         SYN losses of tcp/http/l7 flows [--flow N]\n"
+        "  pool   Idle, borrowed and timed-out connections of --pool targets\n"
+        "  target Set point, measurement and hold score of a --target flow\n"
         "\n"
         "Flags:\n"
         "  --rate       1-second delta sample (pps, Mbps, %)\n"
         "  --core N     Filter output to worker N\n"
+        "  --flow N     net: counters and latency of client flow N only\n"
         "\n"
         "Without a sub-command, prints a brief summary of all domains.\n",
         cmd_stat);
@@ -1676,23 +3245,59 @@ cli_run(void)
 
     cli_register("start",    "Start traffic: start --ip <ip> --port <N> --duration <s> [flags]",
         "Usage: start --ip <addr> --port <N> --duration <secs>\n"
-        "             [--proto tcp|http|https|udp|icmp|tls]\n"
+        "             [--proto tcp|http|https|udp|icmp|tls|pcap|l7]\n"
+        "             [--pcap <file>] [--speed <x>|max] [--loops <N>]\n"
+        "             [--rewrite-mac] [--rewrite-ip <old>=<new>,...]\n"
         "             [--rate <pps>] [--cps <N>] [--ramp <secs>]\n"
-        "             [--size <bytes>] [--reuse] [--streams <N>]\n"
-        "             [--url <path>] [--host <name>] [--tls]\n"
+        "             [--bps <rate>[k|m|g]] [--layer l1|l2|l3]\n"
+        "             [--target cps|rps|tps|mbps|conc:<value>]\n"
+        "             [--profile <shape>] [--arrivals poisson|uniform]\n"
+        "             [--size <bytes>] [--sizes <dist>] [--reuse]\n"
+        "             [--streams <N>] [--url <path>] [--host <name>] [--tls]\n"
         "             [--one]\n"
         "\n"
         "Required:\n"
         "  --ip <addr>       Destination IPv4 address\n"
-        "  --port <N>        Destination TCP/UDP port\n"
+        "  --port <N>        Destination TCP/UDP port (not with --proto pcap;\n"
+        "                    with l7, every replayed connection goes to it)\n"
         "  --duration <s>    Test duration in seconds (not needed with --one)\n"
         "\n"
         "Optional:\n"
-        "  --proto <name>    Protocol: tcp, http, https, udp, icmp, tls (default: tcp)\n"
+        "  --proto <name>    Protocol: tcp, http, https, udp, icmp, tls, pcap, l7\n"
+        "                    (default: tcp)\n"
+        "  --pcap <file>     pcap: capture to replay (pcap or pcapng, Ethernet), preloaded\n"
+        "                    into memory; --ip picks the egress port and next hop\n"
+        "                    l7: capture whose TCP conversations each connection\n"
+        "                    replays in turn over the native stack, --cps opens\n"
+        "                    (see 'serve ...:replay' for the other side)\n"
+        "  --speed <x>|max   pcap: capture timing sped up x times (default 1), or max:\n"
+        "                    back to back; --rate/--bps replace the timing instead\n"
+        "  --loops <N>       pcap: passes over the capture, 0 = until --duration (default)\n"
+        "  --rewrite-mac     pcap: source MAC := port's, destination := --ip next hop\n"
+        "  --rewrite-ip <m>  pcap: <old>=<new>[,...] IPv4 address map (src and dst,\n"
+        "                    checksums fixed up), max 16 pairs\n"
         "  --rate <pps>      Rate limit in packets/sec (0 = unlimited)\n"
         "  --cps <N>         Connections per second (alias for --rate in TCP/HTTP)\n"
+        "  --bps <rate>      udp/icmp/pcap, --reuse: bit-rate target instead of --rate,\n"
+        "                    k/m/g suffixes (e.g. 9.5g)\n"
+        "  --layer <l>       Bytes --bps counts: l1 (default, frame + FCS + 20 B\n"
+        "                    preamble/IFG), l2 (frame + FCS), l3 (IP packet)\n"
+        "  --target <m>:<v>  Closed loop: adjust the rate every 100 ms to hold a\n"
+        "                    measured cps, rps, tps, mbps or conc (open connections)\n"
+        "                    at <v> within 1%; --ramp ramps the set point, --rate\n"
+        "                    caps the rate; the flow must run alone (see 'stat target')\n"
         "  --ramp <secs>     Gradual ramp-up from 0 to target rate\n"
+        "  --profile <shape> Shape the rate over time, levels in % of --rate/--bps:\n"
+        "                    steps:<dur>@<lvl>[-<lvl>],...  (then hold the last)\n"
+        "                    cycle:<dur>@<lvl>[-<lvl>],...  (repeating)\n"
+        "                    sine:<period>:<lo>-<hi>   onoff:<on>:<off>[@<lvl>]\n"
+        "                    durations in us, ms, s (default), m or h\n"
+        "  --arrivals <a>    uniform (default) or poisson: exponential gaps between\n"
+        "                    packets or connection opens at the --rate mean\n"
         "  --size <bytes>    Payload size in bytes (default: 56)\n"
+        "  --sizes <dist>    udp/icmp: frame-size mix, replaces --size (frames incl. FCS)\n"
+        "                    imix (64/570/1518 at 7:4:1), imix-tolly, or a list of\n"
+        "                    <size>[:<weight>] and <lo>-<hi>[:<weight>] entries\n"
         "  --streams <N>     Concurrent TCP connections for throughput, max 16 (default: 1)\n"
         "  --reuse           Enable connection reuse (throughput mode)\n"
         "  --url <path>      HTTP request path (default: /)\n"
@@ -1705,7 +3310,38 @@ cli_run(void)
         "  --vlan <id>       Insert 802.1Q VLAN tag (1-4094, default: none)\n"
         "  --cc <algo>       Congestion control: newreno (default), cubic\n"
         "  --src-ip-count <N>  Use N consecutive IPs from --ip as source pool\n"
+        "  --steer <mode>    Return-traffic steering: rss (default), flow (rte_flow)\n"
+        "  --syn-window <w>  tcp/http/l7: handshakes in flight (SYN_SENT) per worker;\n"
+        "                    <N> fixed (default 4096), or auto[:<N>] AIMD up to N\n"
+        "                    driven by SYN loss and SYN→SYN-ACK time (see\n"
+        "                    'stat handshake')\n"
+        "  --open-loop       http/https: issue --rate requests/s on a schedule of\n"
+        "                    intended send times, independent of responses, on\n"
+        "                    idle keep-alive connections; latency is measured from\n"
+        "                    the intended time (no coordinated omission)\n"
+        "  --conns <N>       --open-loop: connection pool size over all workers\n"
+        "                    (default 256 per worker, max 4096 per worker)\n"
+        "  --pool <spec>     http/https: <max>[:<min>[:<idle_ms>]] keep up to max\n"
+        "                    idle connections per worker and target (max 4096),\n"
+        "                    reused LIFO by later transactions of any --pool flow;\n"
+        "                    min opened ahead of demand; idle ones close after\n"
+        "                    idle_ms (default 60000) (see 'stat pool')\n"
+        "  --pipeline <N>    http/https: write N requests (2-16) back to back and\n"
+        "                    match the responses in order; the next batch goes\n"
+        "                    out when the last response is in. Responses need a\n"
+        "                    Content-Length\n"
+        "  --replay          udp/icmp: transmit a pre-built packet ring (no per-packet writes)\n"
         "  --header \"K: V\"   Add custom HTTP header (repeatable)\n"
+        "  --probe           udp: seq + TX timestamp payload for loss/reorder/latency/jitter\n"
+        "                    (see 'stat probe')\n"
+        "  --field <spec>    udp/icmp: vary a field per packet (repeatable, max 8)\n"
+        "                    <field>:<op>:<values>[:<step>]\n"
+        "                    field: src-ip dst-ip src-port dst-port src-mac dst-mac\n"
+        "                           vlan dscp payload@<off>/<1|2|4>\n"
+        "                    op: inc dec rand (values <min>-<max>), list (v,v,...)\n"
+        "  --pace [sw]       udp/icmp with --rate: schedule every packet's launch time\n"
+        "                    instead of 32-packet bursts; NIC scheduled send when\n"
+        "                    the port has it, 'sw' forces TSC pacing (see 'stat pace')\n"
         "\n"
         "Examples:\n"
         "  start --ip 10.0.0.2 --port 5000 --duration 10\n"
@@ -1713,6 +3349,29 @@ cli_run(void)
         "  start --ip 10.0.0.2 --port 80 --proto http --cps 5000 --ramp 5 --duration 30\n"
         "  start --ip 10.0.0.2 --port 80 --proto http --txn-per-conn 10 --think-time 100\n"
         "  start --ip 10.0.0.2 --port 443 --proto https --one --url /\n"
+        "  start --ip 10.0.0.2 --port 53 --proto udp --duration 30 \\\n"
+        "        --field src-ip:inc:10.1.0.0-10.1.255.255 --field src-port:inc:1024-65535\n"
+        "  start --ip 10.0.0.2 --port 9 --proto udp --duration 30 --sizes imix\n"
+        "  start --ip 10.0.0.2 --port 9 --proto udp --duration 30 --sizes 64:5,128-1518:1\n"
+        "  start --ip 10.0.0.2 --port 9 --proto udp --duration 30 --rate 100000 --pace\n"
+        "  start --ip 10.0.0.2 --port 9 --proto udp --duration 30 --sizes imix --bps 10g\n"
+        "  start --ip 10.0.0.2 --port 80 --proto http --duration 60 --ramp 10 \\\n"
+        "        --target rps:20000\n"
+        "  start --ip 10.0.0.2 --port 80 --proto tcp --duration 30 --syn-window auto\n"
+        "  start --ip 10.0.0.2 --port 80 --proto http --duration 60 --rate 50000 \\\n"
+        "        --open-loop --conns 2000 --arrivals poisson\n"
+        "  start --ip 10.0.0.2 --port 443 --proto https --duration 60 --cps 2000 \\\n"
+        "        --txn-per-conn 4 --pool 512:64:30000\n"
+        "  start --ip 10.0.0.2 --port 80 --proto http --duration 30 --cps 500 \\\n"
+        "        --txn-per-conn 1000 --pipeline 16\n"
+        "  start --ip 10.0.0.2 --port 80 --proto http --duration 120 --cps 20000 \\\n"
+        "        --profile steps:30s@25%,30s@50%,30s@100%,30s@50%\n"
+        "  start --ip 10.0.0.2 --port 9 --proto udp --duration 10 --bps 10g \\\n"
+        "        --profile onoff:20us:180us\n"
+        "  start --ip 10.0.0.2 --proto pcap --pcap trace.pcapng --duration 60 \\\n"
+        "        --speed 4 --loops 10 --rewrite-mac\n"
+        "  start --ip 10.0.0.2 --port 8080 --proto l7 --pcap web.pcap --duration 60 \\\n"
+        "        --cps 2000\n"
         "\n"
         "Multiple concurrent flows:\n"
         "  start can be called multiple times to run concurrent flows.\n"
@@ -1720,6 +3379,25 @@ cli_run(void)
         "  Use 'show flows' to see all flows, 'stop <N>' to stop one.\n",
         cmd_start_gated);
 
+    cli_register("rfc2544",  "RFC 2544 benchmark: rfc2544 --ip <ip> --port <N> [flags]",
+        RFC2544_USAGE
+        "\n"
+        "Runs the RFC 2544 tests with UDP probe flows, per frame size:\n"
+        "  throughput  binary search for the highest rate within --loss %\n"
+        "  latency     probe latency and jitter at the throughput rate\n"
+        "  loss        frame loss from 100% of line rate down in --step %\n"
+        "  b2b         longest burst at line rate without loss\n"
+        "\n"
+        "Frames must come back to vaigai (through the DUT or reflected).\n"
+        "Defaults: sizes 64,128,256,512,1024,1280,1518, all tests,\n"
+        "60 s trials, 0% loss, 0.1% resolution, 10% step, 2000 ms settle.\n"
+        "imix = 64/570/1518-byte frames at 7:4:1.\n"
+        "\n"
+        "Examples:\n"
+        "  rfc2544 --ip 10.0.1.1 --port 9 --trial 10\n"
+        "  rfc2544 --ip 10.0.1.1 --port 9 --sizes 64,1518,imix --tests throughput,latency\n",
+        cmd_rfc2544);
+
     cli_register("stop",     "Stop traffic/listeners: stop [#|all|spec]",
         "Usage: stop [<id>|all|<spec>]\n"
         "\n"
@@ -1776,7 +3454,7 @@ cli_run(void)
         "\n"
         "show flows:\n"
         "  Shows active client traffic flows with proto, destination,\n"
-        "  duration, elapsed time, and state.\n"
+        "  duration, elapsed time, packets (or connections) sent, and state.\n"
         "\n"
         "show listeners:\n"
         "  Shows active listeners with stats (SPEC is copy-pasteable for 'stop').\n"
@@ -1792,17 +3470,21 @@ cli_run(void)
         "  show connections\n",
         cmd_show);
 
-    cli_register("set",      "Set config: set ip ... | set rate <pps>",
-        "Usage: set ip <port> <ip> <gateway> <netmask>\n"
-        "       set rate <pps>\n"
+    cli_register("set",      "Set config: set ip ... | set rate <pps> | set bps <rate> | set port-cap",
+        SET_USAGE
         "\n"
         "Sub-commands:\n"
-        "  ip      Set IP address, gateway, and netmask for a port\n"
-        "  rate    Change rate limit for running test (broadcast to workers)\n"
+        "  ip        Set IP address, gateway, and netmask for a port\n"
+        "  rate      Change the pps limit of running flows (broadcast to workers)\n"
+        "  bps       Change running udp/icmp/--reuse flows to a bit-rate target;\n"
+        "            --layer counts L1 (default, incl. preamble/IFG), L2 or L3 bytes\n"
+        "  port-cap  L1 ceiling shared by all flows on a port; no rate shows it\n"
         "\n"
         "Examples:\n"
         "  set ip 0 10.88.33.65 10.88.32.1 255.255.252.0\n"
-        "  set rate 5000\n",
+        "  set rate 5000\n"
+        "  set bps 9.5g --layer l2 --flow 0\n"
+        "  set port-cap 0 25g\n",
         cmd_set);
 
     /* ── Server-mode commands ──────────────────────────────────────────── */
@@ -1810,7 +3492,7 @@ cli_run(void)
         "Usage: serve --listen <spec> [--listen <spec> ...]\n"
         "             [--tls-cert <path>] [--tls-key <path>]\n"
         "             [--ciphers <cipher-list>]\n"
-        "             [--http-body-size <bytes>]\n"
+        "             [--http-body-size <bytes>] [--pcap <file>]\n"
         "\n"
         "  <spec> = proto:port[:handler]\n"
         "\n"
@@ -1819,6 +3501,7 @@ cli_run(void)
         "  tcp       echo        Reflect received data\n"
         "  tcp       discard     ACK + drop payload\n"
         "  tcp       chargen     Send bulk data\n"
+        "  tcp       replay      Answer with a capture's server side (--pcap)\n"
         "  http      (implicit)  HTTP/1.1 response\n"
         "  https     (implicit)  TLS + HTTP response\n"
         "  tls       echo        TLS + echo\n"
@@ -1828,12 +3511,16 @@ cli_run(void)
         "                    priority order — #1 gets highest priority).\n"
         "                    Server preference is enforced. If omitted, the\n"
         "                    default ECDHE+AES-GCM suite list is used.\n"
+        "  --pcap <file>     Capture for replay listeners: each connection is\n"
+        "                    matched to a conversation by its first message and\n"
+        "                    answered with the server's recorded bytes\n"
         "\n"
         "Examples:\n"
         "  serve --listen tcp:5000:echo --listen http:80\n"
         "  serve --listen https:443 --tls-cert cert.pem --tls-key key.pem\n"
         "  serve --listen https:443 --tls-cert cert.pem --tls-key key.pem \\\n"
-        "        --ciphers ECDHE-RSA-AES256-GCM-SHA384:ECDHE-RSA-AES128-GCM-SHA256\n",
+        "        --ciphers ECDHE-RSA-AES256-GCM-SHA384:ECDHE-RSA-AES128-GCM-SHA256\n"
+        "  serve --listen tcp:8080:replay --pcap web.pcap\n",
         cmd_serve);
 
     /* Start CLI socket server for remote attach */
@@ -0,0 +1,422 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: closed-loop load controller.
+ *
+ * Velocity-form PI on the relative error e = (set point − measured) / set
+ * point, applied multiplicatively to the knob:
+ *
+ *     rate ← rate × (sp / sp_prev) × (1 + Kp·(e − e_prev) + Ki·e)
+ *
+ * The set-point ratio feeds the ramp forward; the PI term removes what
+ * the model gets wrong — failed handshakes, the SYN window,
+ * keep-alive transactions per connection, server latency.  Integral
+ * action on the plain (not log) error makes the mean over the hold
+ * phase converge on the target, not just the typical window.
+ *
+ * Open connections lag the knob by the connection lifetime, so for conc
+ * the integral gain is scaled by tick / lifetime, the lifetime estimated
+ * by Little's law from the open count and the open rate.
+ */
+#include "load_ctl.h"
+#include "mgmt_loop.h"
+#include "../core/ipc.h"
+#include "../core/tx_gen.h"
+#include "../telemetry/metrics.h"
+#include "../telemetry/output.h"
+#include "../common/util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+
+#define LC_KP          0.3
+#define LC_KI          0.3
+#define LC_STEP_MIN    0.5      /* knob change per tick, × current     */
+#define LC_STEP_MAX    2.0
+
+static const char *const k_metric_names[METRIC_MAX] = {
+    "cps", "rps", "tps", "mbps", "conc",
+};
+
+static const char *const k_phase_names[] = { "ramp", "hold", "done" };
+
+static struct {
+    bool              active;
+    bool              have;     /* r holds a run, current or last     */
+    load_ctl_params_t p;
+    uint64_t          rate;
+    uint64_t          rate_max;
+    uint64_t          hz;
+    uint64_t          t0;
+    uint64_t          t_last;
+    uint64_t          t_next;
+    double            c_last;   /* counter (or level) at t_last        */
+    double            opens_last;
+    double            sp_prev;
+    double            e_prev;
+    double            life_s;   /* conc: connection lifetime estimate  */
+
+    /* Scoring window */
+    uint32_t          w_ticks;
+    double            w_sum;
+    double            w_secs;
+    bool              w_hold;   /* window lies wholly in the hold phase */
+    bool              w_sat;
+
+    /* Hold phase */
+    double            hold_sum;
+    double            hold_secs;
+
+    load_ctl_report_t r;
+} g_lc;
+
+const char *
+load_metric_name(uint8_t metric)
+{
+    return metric < METRIC_MAX ? k_metric_names[metric] : "?";
+}
+
+int
+load_ctl_parse(const char *spec, uint8_t *metric, double *target)
+{
+    const char *colon = strchr(spec, ':');
+    if (!colon)
+        return -EINVAL;
+    size_t n = (size_t)(colon - spec);
+    for (uint8_t m = 0; m < METRIC_MAX; m++) {
+        if (strlen(k_metric_names[m]) != n ||
+            strncmp(spec, k_metric_names[m], n) != 0)
+            continue;
+        char *end;
+        double v = strtod(colon + 1, &end);
+        if (end == colon + 1 || *end != '\0' || !(v > 0) || isinf(v))
+            return -EINVAL;
+        *metric = m;
+        *target = v;
+        return 0;
+    }
+    return -EINVAL;
+}
+
+bool
+load_ctl_supports(uint8_t metric, uint8_t proto)
+{
+    switch (proto) {
+    case TX_GEN_PROTO_ICMP:
+    case TX_GEN_PROTO_UDP:
+        return metric == METRIC_TPS || metric == METRIC_MBPS;
+    case TX_GEN_PROTO_THROUGHPUT:
+        return metric == METRIC_MBPS;
+    case TX_GEN_PROTO_TCP_SYN:
+    case TX_GEN_PROTO_L7:
+        return metric != METRIC_RPS && metric < METRIC_MAX;
+    case TX_GEN_PROTO_HTTP:
+        return metric < METRIC_MAX;
+    default:
+        return false;
+    }
+}
+
+bool
+load_ctl_active(void)
+{
+    return g_lc.active;
+}
+
+/* ── Measurement ──────────────────────────────────────────────────────────── */
+
+/* The metric's counter: events, Mbit, or (conc) the current level. */
+static double
+counter(const worker_metrics_t *m)
+{
+    switch (g_lc.p.metric) {
+    case METRIC_CPS:
+        return (double)m->tcp_conn_open;
+    case METRIC_RPS:
+        return (double)m->http_rsp_rx;
+    case METRIC_TPS:
+        switch (g_lc.p.proto) {
+        case TX_GEN_PROTO_ICMP: return (double)m->icmp_echo_tx;
+        case TX_GEN_PROTO_UDP:  return (double)m->udp_tx;
+        case TX_GEN_PROTO_HTTP: return (double)m->http_rsp_rx;
+        case TX_GEN_PROTO_L7:   return (double)m->l7_conv_done;
+        default:                return (double)m->tcp_conn_open;
+        }
+    case METRIC_MBPS:
+        if (g_lc.p.proto == TX_GEN_PROTO_THROUGHPUT)
+            return (double)m->tcp_payload_tx * 8.0 / 1e6;
+        if (tx_gen_proto_stateless((tx_gen_proto_t)g_lc.p.proto))
+            return (double)m->tx_bytes * 8.0 / 1e6;
+        return (double)(m->tx_bytes + m->rx_bytes) * 8.0 / 1e6;
+    case METRIC_CONC:
+        return m->tcp_conn_open > m->tcp_conn_close
+             ? (double)(m->tcp_conn_open - m->tcp_conn_close) : 0.0;
+    default:
+        return 0.0;
+    }
+}
+
+static double
+setpoint(double t)
+{
+    double tick = LOAD_CTL_TICK_MS / 1000.0;
+    if (g_lc.p.ramp_s == 0)
+        return g_lc.p.target;
+    double f = (t < tick ? tick : t) / g_lc.p.ramp_s;
+    return g_lc.p.target * (f < 1.0 ? f : 1.0);
+}
+
+/* ── Control ──────────────────────────────────────────────────────────────── */
+
+static void
+send_rate(uint64_t rate)
+{
+    tx_gen_rate_update_t ru;
+    memset(&ru, 0, sizeof(ru));
+    ru.rate     = rate;
+    ru.flow_idx = g_lc.p.flow_idx;
+    ru.bps      = g_lc.r.bps;
+    ru.layer    = TX_GEN_LAYER_L1;
+
+    config_update_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.cmd = CFG_CMD_SET_RATE;
+    memcpy(cmd.payload, &ru, sizeof(ru));
+    tgen_ipc_broadcast(&cmd);
+}
+
+int
+load_ctl_start(const load_ctl_params_t *p, uint64_t *rate0)
+{
+    if (g_lc.active)
+        return -EBUSY;
+
+    memset(&g_lc, 0, sizeof(g_lc));
+    g_lc.p  = *p;
+    g_lc.hz = rte_get_tsc_hz();
+
+    double full = p->target / p->gain;
+    double u0   = setpoint(0) / p->gain;
+    g_lc.rate     = u0 < 1.0 ? 1 : (uint64_t)u0;
+    g_lc.rate_max = p->rate_max ? p->rate_max
+                  : (uint64_t)(full < 1.0 ? 1.0 : full) * LOAD_CTL_MAX_X;
+    if (g_lc.rate > g_lc.rate_max)
+        g_lc.rate = g_lc.rate_max;
+
+    g_lc.t0      = rte_rdtsc();
+    g_lc.t_last  = g_lc.t0;
+    g_lc.t_next  = g_lc.t0 + g_lc.hz * LOAD_CTL_TICK_MS / 1000;
+    g_lc.sp_prev = setpoint(0);
+    g_lc.life_s  = 0;
+
+    g_lc.r.flow_idx = p->flow_idx;
+    g_lc.r.metric   = p->metric;
+    g_lc.r.phase    = p->ramp_s ? LOAD_CTL_RAMP : LOAD_CTL_HOLD;
+    g_lc.r.bps      = p->proto == TX_GEN_PROTO_THROUGHPUT;
+    g_lc.r.target   = p->target;
+    g_lc.r.setpoint = g_lc.sp_prev;
+    g_lc.r.rate     = g_lc.rate;
+    g_lc.r.settle_s = -1;
+    g_lc.w_hold     = g_lc.r.phase == LOAD_CTL_HOLD;
+
+    g_lc.active = true;
+    g_lc.have   = true;
+    *rate0 = g_lc.rate;
+    return 0;
+}
+
+/* Close a scoring window: the measured value, and the band check when
+ * the window was all hold. */
+static void
+window_close(double now_s)
+{
+    double v = g_lc.w_secs > 0 ? g_lc.w_sum / g_lc.w_secs : 0;
+    g_lc.r.measured  = v;
+    g_lc.r.saturated = g_lc.w_sat;
+    if (g_lc.w_hold) {
+        double band = g_lc.p.target * LOAD_CTL_BAND_PCT / 100.0;
+        g_lc.r.windows++;
+        if (fabs(v - g_lc.p.target) <= band) {
+            g_lc.r.windows_in++;
+            if (g_lc.r.settle_s < 0)
+                g_lc.r.settle_s = now_s - g_lc.p.ramp_s;
+        }
+    }
+    g_lc.w_ticks = 0;
+    g_lc.w_sum   = 0;
+    g_lc.w_secs  = 0;
+    g_lc.w_sat   = false;
+    g_lc.w_hold  = g_lc.r.phase == LOAD_CTL_HOLD;
+}
+
+void
+load_ctl_tick(void)
+{
+    if (!g_lc.active)
+        return;
+    uint64_t now = rte_rdtsc();
+    if (now < g_lc.t_next)
+        return;
+    g_lc.t_next += g_lc.hz * LOAD_CTL_TICK_MS / 1000;
+    if (g_lc.t_next <= now)
+        g_lc.t_next = now + g_lc.hz * LOAD_CTL_TICK_MS / 1000;
+
+    const traffic_gen_state_t *ts = &g_client_flows[g_lc.p.flow_idx];
+    if (!ts->active)
+        return;
+
+    /* Other flows share the workers: steer by this flow's own slabs, and
+     * fall back to the worker totals only if they could not be allocated. */
+    metrics_snapshot_t snap;
+    if (flow_metrics_present(g_lc.p.flow_idx))
+        flow_metrics_snapshot(&snap, g_lc.p.flow_idx, g_lc.p.n_workers);
+    else
+        metrics_snapshot(&snap, g_lc.p.n_workers);
+    double dt    = (double)(now - g_lc.t_last) / (double)g_lc.hz;
+    double t     = (double)(now - g_lc.t0) / (double)g_lc.hz;
+    double c     = counter(&snap.total);
+    double opens = (double)snap.total.tcp_conn_open;
+    g_lc.t_last  = now;
+    if (dt <= 0)
+        return;
+
+    bool   conc = g_lc.p.metric == METRIC_CONC;
+    double inc  = conc ? c * dt : c - g_lc.c_last;
+    double m    = inc / dt;
+    if (conc && opens > g_lc.opens_last && c > 0) {
+        double life = c / ((opens - g_lc.opens_last) / dt);
+        g_lc.life_s = g_lc.life_s > 0 ? 0.8 * g_lc.life_s + 0.2 * life
+                                      : life;
+    }
+    g_lc.c_last     = c;
+    g_lc.opens_last = opens;
+
+    /* Hold totals, the scoring window, then the phase: a ramp ends by
+     * closing its partial window so hold windows start clean. */
+    if (g_lc.r.phase == LOAD_CTL_HOLD) {
+        g_lc.hold_sum  += inc;
+        g_lc.hold_secs += dt;
+        g_lc.r.hold_s    = g_lc.hold_secs;
+        g_lc.r.hold_mean = g_lc.hold_sum / g_lc.hold_secs;
+        g_lc.r.hold_err_pct = (g_lc.r.hold_mean - g_lc.p.target) /
+                              g_lc.p.target * 100.0;
+    }
+    g_lc.w_sum  += inc;
+    g_lc.w_secs += dt;
+    if (++g_lc.w_ticks == LOAD_CTL_WINDOW)
+        window_close(t);
+    if (g_lc.r.phase == LOAD_CTL_RAMP && t >= g_lc.p.ramp_s) {
+        g_lc.r.phase = LOAD_CTL_HOLD;
+        window_close(t);
+    }
+
+    /* PI step */
+    double sp = setpoint(t);
+    double e  = (sp - m) / sp;
+    double ki = LC_KI;
+    double tick = LOAD_CTL_TICK_MS / 1000.0;
+    if (conc && g_lc.life_s > tick)
+        ki *= tick / g_lc.life_s;
+    double step = (sp / g_lc.sp_prev) *
+                  (1.0 + LC_KP * (e - g_lc.e_prev) + ki * e);
+    if (step < LC_STEP_MIN) step = LC_STEP_MIN;
+    if (step > LC_STEP_MAX) step = LC_STEP_MAX;
+    g_lc.e_prev  = e;
+    g_lc.sp_prev = sp;
+    g_lc.r.setpoint = sp;
+
+    double u = (double)g_lc.rate * step;
+    uint64_t rate = u < 1.0 ? 1 : u >= (double)g_lc.rate_max
+                  ? g_lc.rate_max : (uint64_t)(u + 0.5);
+    if (rate == g_lc.rate_max && step > 1.0)
+        g_lc.w_sat = true;
+    if (rate != g_lc.rate) {
+        g_lc.rate   = rate;
+        g_lc.r.rate = rate;
+        send_rate(rate);
+    }
+}
+
+/* ── Reporting ────────────────────────────────────────────────────────────── */
+
+bool
+load_ctl_report(load_ctl_report_t *out)
+{
+    if (!g_lc.have)
+        return false;
+    *out = g_lc.r;
+    return true;
+}
+
+static const char *
+metric_unit(uint8_t metric)
+{
+    switch (metric) {
+    case METRIC_MBPS: return "Mbps";
+    case METRIC_CONC: return "open";
+    default:          return "/s";
+    }
+}
+
+void
+load_ctl_finish(uint32_t flow_idx)
+{
+    if (!g_lc.active || flow_idx != g_lc.p.flow_idx)
+        return;
+    g_lc.active  = false;
+    g_lc.r.phase = LOAD_CTL_DONE;
+
+    const load_ctl_report_t *r = &g_lc.r;
+    const char *unit = metric_unit(r->metric);
+    printf("Target: %s %.1f %s\n", load_metric_name(r->metric), r->target,
+           unit);
+    if (r->windows == 0) {
+        printf("  stopped before a full second of hold\n");
+    } else {
+        printf("  hold %.1f s: mean %.1f %s (%+.2f%%), "
+               "%u/%u windows within ±%.0f%%",
+               r->hold_s, r->hold_mean, unit, r->hold_err_pct,
+               r->windows_in, r->windows, LOAD_CTL_BAND_PCT);
+        if (r->settle_s >= 0)
+            printf(", settled after %.1f s\n", r->settle_s);
+        else
+            printf(", never settled\n");
+    }
+    if (r->saturated)
+        printf("  rate ceiling reached — the target is beyond what the "
+               "DUT or the flow can sustain\n");
+    output_target(r);
+}
+
+void
+load_ctl_status(void)
+{
+    load_ctl_report_t r;
+    if (!load_ctl_report(&r)) {
+        printf("No target flow has run.\n");
+        return;
+    }
+    const char *unit = metric_unit(r.metric);
+    char knob[32];
+    if (r.bps)
+        tgen_bps_str(r.rate, knob, sizeof(knob));
+    else
+        snprintf(knob, sizeof(knob), "%" PRIu64 "/s", r.rate);
+
+    printf("Target flow #%u: %s %.1f %s, %s\n", r.flow_idx,
+           load_metric_name(r.metric), r.target, unit,
+           k_phase_names[r.phase]);
+    printf("  set point  %14.1f %s\n", r.setpoint, unit);
+    printf("  measured   %14.1f %s (last second)\n", r.measured, unit);
+    printf("  rate       %14s%s\n", knob,
+           r.saturated ? "  (at ceiling)" : "");
+    if (r.windows > 0)
+        printf("  hold       %14.1f %s mean over %.1f s (%+.2f%%), "
+               "%u/%u windows within ±%.0f%%\n",
+               r.hold_mean, unit, r.hold_s, r.hold_err_pct,
+               r.windows_in, r.windows, LOAD_CTL_BAND_PCT);
+}
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: closed-loop load controller (management lcore).
+ *
+ * `start --target <metric>:<value>` holds a measured rate — connections,
+ * responses or transactions per second, Mbps, or open connections — at
+ * a set point instead of fixing the offered rate.  The flow's rate knob
+ * (rate_pps, or rate_bps for --reuse) is what workers already obey; the
+ * controller reads the aggregated counters every LOAD_CTL_TICK_MS and
+ * moves the knob with CFG_CMD_SET_RATE, which splits it across the
+ * port's generators as at START.
+ *
+ * The set point ramps linearly from zero over --ramp seconds, then holds
+ * the target for the rest of the duration.  The hold phase is scored in
+ * one-second windows against a ±LOAD_CTL_BAND_PCT band.
+ *
+ * The counters are global, so a target flow must run alone: `start`
+ * refuses a target flow next to other flows, and other flows next to it.
+ */
+#ifndef TGEN_LOAD_CTL_H
+#define TGEN_LOAD_CTL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAD_CTL_TICK_MS    100u
+#define LOAD_CTL_WINDOW     10u     /* ticks per scoring window (1 s)   */
+#define LOAD_CTL_BAND_PCT   1.0
+#define LOAD_CTL_MAX_X      64u     /* default knob ceiling, × initial  */
+
+typedef enum {
+    LOAD_CTL_RAMP = 0,
+    LOAD_CTL_HOLD,
+    LOAD_CTL_DONE,
+} load_ctl_phase_t;
+
+/** Controller parameters (filled by the CLI). */
+typedef struct {
+    uint8_t  metric;        /* load_metric_t                         */
+    uint8_t  proto;         /* tx_gen_proto_t of the flow            */
+    uint32_t flow_idx;
+    uint32_t n_workers;
+    double   target;        /* per second, Mbps, or connections      */
+    uint32_t ramp_s;        /* set point ramp, < duration_s          */
+    uint32_t duration_s;
+    double   gain;          /* expected metric per unit of the knob  */
+    uint64_t rate_max;      /* knob ceiling, 0 = LOAD_CTL_MAX_X × initial */
+} load_ctl_params_t;
+
+/** Progress or outcome of a controlled flow. */
+typedef struct {
+    uint32_t flow_idx;
+    uint8_t  metric;
+    uint8_t  phase;         /* load_ctl_phase_t                      */
+    bool     bps;           /* knob is a bit rate, else pps / cps    */
+    double   target;
+    double   setpoint;
+    double   measured;      /* last one-second window                */
+    uint64_t rate;          /* knob, flow-wide                       */
+    bool     saturated;     /* knob at its ceiling in the last window */
+    double   hold_s;        /* hold phase so far                     */
+    double   hold_mean;     /* mean over the hold phase              */
+    double   hold_err_pct;
+    uint32_t windows;       /* one-second windows held               */
+    uint32_t windows_in;    /* of which within the band              */
+    double   settle_s;      /* hold time to the first in-band window,
+                               < 0 if none                           */
+} load_ctl_report_t;
+
+/** Metric name ("cps", "rps", "tps", "mbps", "conc"). */
+const char *load_metric_name(uint8_t metric);
+
+/**
+ * Parse "<metric>:<value>", value in the metric's unit (mbps in Mbps).
+ * Returns 0 or -EINVAL.
+ */
+int load_ctl_parse(const char *spec, uint8_t *metric, double *target);
+
+/** @return true if `metric` can be targeted on a `proto` flow. */
+bool load_ctl_supports(uint8_t metric, uint8_t proto);
+
+/**
+ * Arm the controller for a flow about to start; *rate0 receives the
+ * initial flow-wide knob for the START config (≥ 1).
+ * @return 0, or -EBUSY when another target flow runs.
+ */
+int load_ctl_start(const load_ctl_params_t *p, uint64_t *rate0);
+
+/** Advance the controller (mgmt loop). */
+void load_ctl_tick(void);
+
+/** @return true while a target flow runs. */
+bool load_ctl_active(void);
+
+/** Fill `out` for the current or last target flow; false if none. */
+bool load_ctl_report(load_ctl_report_t *out);
+
+/** The target flow stopped: print and emit its result, disarm. */
+void load_ctl_finish(uint32_t flow_idx);
+
+/** Print the controller's state (stat target). */
+void load_ctl_status(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_LOAD_CTL_H */
@@ -13,15 +13,20 @@
 #include "../net/tcp_fsm.h"
 #include "../net/tcp_tcb.h"
 #include "../net/tcp_port_pool.h"
+#include "../net/rss_steer.h"
 #include "../core/ipc.h"
 #include "../core/core_assign.h"
 #include "../core/worker_loop.h"
+#include "../core/pcap_replay.h"
+#include "../app/l7_replay.h"
 #include "../telemetry/pktrace.h"
 #include "../telemetry/metrics.h"
 #include "../telemetry/export.h"
 #include "../telemetry/log.h"
 #include "../telemetry/output.h"
 #include "config_mgr.h"
+#include "rfc2544.h"
+#include "load_ctl.h"
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -80,7 +85,7 @@ ipc_ack_drain(void)
 static void
 traffic_gen_tick_flow(traffic_gen_state_t *ts)
 {
-    if (!ts->active)
+    if (!ts->active || ts->managed)
         return;
 
     uint64_t now = rte_rdtsc();
@@ -111,6 +116,12 @@ traffic_gen_tick_flow(traffic_gen_state_t *ts)
         }
     }
 
+    /* --proto pcap --loops: every generator sent its passes */
+    if (ts->pcap && pcap_replay_done(ts->flow_idx)) {
+        mgmt_traffic_stop_flow(ts->flow_idx);
+        return;
+    }
+
     /* Check duration */
     if (elapsed_s >= ts->duration_s) {
         mgmt_traffic_stop_flow(ts->flow_idx);
@@ -181,8 +192,15 @@ mgmt_traffic_stop_flow(uint32_t flow_idx)
     if (!ts->active)
         return;
 
+    /* An rfc2544 slot: stopping one stops the whole run */
+    if (ts->managed) {
+        rfc2544_abort();
+        return;
+    }
+
     ts->active = false;
     ts->stop_tsc = rte_rdtsc(); /* record actual stop time */
+    rss_steer_release(ts->steer_ctx);
 
     /* Broadcast STOP_FLOW to workers for this specific flow */
     config_update_t cmd;
@@ -195,6 +213,10 @@ mgmt_traffic_stop_flow(uint32_t flow_idx)
     delay_ms_flush(ts->reuse ? 1000 : 100);
     if (ts->is_tty && !ts->reuse)
         printf("\n");
+    if (ts->pcap)
+        pcap_replay_release(flow_idx);
+    /* Retired, not freed: the flow's connections may still be open */
+    l7_replay_install(&g_l7_progs[flow_idx], NULL);
 
     /* Snapshot results */
     metrics_snapshot_t snap;
@@ -226,7 +248,8 @@ mgmt_traffic_stop_flow(uint32_t flow_idx)
         printf("Protocol: %s, Duration: %s, Rate: %s\n"
                "%"PRIu64" packets transmitted\n",
                ts->proto, dur_str,
-               ts->rate ? "limited" : "unlimited",
+               ts->load == LOAD_TARGET   ? "target" :
+               ts->load == LOAD_CONSTANT ? "limited" : "unlimited",
                snap.total.tx_pkts);
         if (actual_s > 0.0 && snap.total.tx_pkts > 0) {
             double pps = (double)snap.total.tx_pkts / actual_s;
@@ -240,6 +263,30 @@ mgmt_traffic_stop_flow(uint32_t flow_idx)
                    summary, sizeof(summary));
     puts(summary);
 
+    if (ts->paced) {
+        tx_gen_pace_report_t pr;
+        tx_gen_pace_report(flow_idx, &pr);
+        export_pace_text(flow_idx, &pr, summary, sizeof(summary));
+        fputs(summary, stdout);
+        output_pacing(flow_idx, &pr);
+    }
+    if (ts->syn_window) {
+        tcp_hs_win_report_t hr;
+        tcp_hs_win_report(flow_idx, ts->n_workers, &hr);
+        export_handshake_text(flow_idx, &hr, summary, sizeof(summary));
+        fputs(summary, stdout);
+        output_handshake(flow_idx, &hr);
+    }
+    if (ts->open_loop) {
+        http_ol_report_t olr;
+        http_ol_report(flow_idx, ts->n_workers, &olr);
+        export_open_loop_text(flow_idx, &olr, summary, sizeof(summary));
+        fputs(summary, stdout);
+        output_open_loop(flow_idx, &olr);
+    }
+    if (ts->load == LOAD_TARGET)
+        load_ctl_finish(flow_idx);
+
     /* Structured output */
     output_result(flow_idx, ts->proto, actual_s, &snap);
 
@@ -290,6 +337,8 @@ mgmt_traffic_stop_flow(uint32_t flow_idx)
 void
 mgmt_traffic_stop_all(void)
 {
+    bool aborted = rfc2544_abort();
+
     /* Broadcast a blanket STOP_FLOW(all) first */
     config_update_t cmd;
     memset(&cmd, 0, sizeof(cmd));
@@ -310,6 +359,7 @@ mgmt_traffic_stop_all(void)
         any_was_active = true;
         ts->active = false;
         ts->stop_tsc = stop_tsc;
+        rss_steer_release(ts->steer_ctx);
         last_n_workers = ts->n_workers;
 
         uint64_t hz_s = rte_get_tsc_hz();
@@ -327,14 +377,24 @@ mgmt_traffic_stop_all(void)
 
         printf("  #%u  %s → %s:%u  %s\n",
                i, ts->proto, ts->dst_ip_str, ts->dst_port, dur_str);
+        if (ts->load == LOAD_TARGET)
+            load_ctl_finish(i);
     }
 
     if (!any_was_active) {
-        printf("No active client flows.\n");
+        if (!aborted)
+            printf("No active client flows.\n");
         return;
     }
 
     delay_ms_flush(100);
+    for (uint32_t i = 0; i < TGEN_MAX_CLIENT_FLOWS; i++) {
+        if (g_client_flows[i].active)
+            continue;
+        if (g_client_flows[i].pcap)
+            pcap_replay_release(i);
+        l7_replay_install(&g_l7_progs[i], NULL);
+    }
 
     /* Aggregate stats */
     metrics_snapshot_t snap;
@@ -493,6 +553,9 @@ mgmt_loop_run(mgmt_dispatch_fn_t dispatch)
         /* ── Priority 3: Background work ──────────────────────── */
         pktrace_flush();
         traffic_gen_tick();
+        rfc2544_tick();
+        load_ctl_tick();
+        rss_steer_tick();
 
         uint64_t t3 = rte_rdtsc();
 
@@ -34,11 +34,26 @@ typedef struct {
     char        proto[16];      /* protocol name for summary */
     uint32_t    streams;        /* TCP connection count (throughput mode) */
     uint64_t    rate;           /* rate limit (pps) */
+    uint64_t    rate_bps;       /* bit-rate target (--bps), 0 = none */
+    uint64_t    l1_bps;         /* L1 load committed on the port,
+                                   0 = not known up front */
+    bool        by_frame;       /* stateless or --reuse: l1_bps follows
+                                   set rate / set bps */
+    double      frames[3];      /* mean frame per TX_GEN_LAYER_* */
     uint16_t    size;           /* packet size */
     bool        tls;            /* TLS enabled */
     uint32_t    flow_idx;       /* slot index in g_client_flows[] */
     char        dst_ip_str[16]; /* destination IP for display */
     uint16_t    dst_port;       /* destination port for display */
+    uint8_t     steer_ctx;      /* RSS steering context (0 = none) */
+    bool        managed;        /* driven by the rfc2544 runner, not
+                                   by the duration tick */
+    bool        paced;          /* --pace: report inter-packet gaps */
+    load_mode_t load;           /* LOAD_TARGET: driven by load_ctl */
+    bool        pcap;           /* replays g_pcap_replays[flow_idx] */
+    bool        handshakes;     /* opens connections under a SYN window */
+    bool        syn_window;     /* --syn-window: report it at stop */
+    bool        open_loop;      /* --open-loop: report the schedule at stop */
 } traffic_gen_state_t;
 
 /* ── Client flow table (mirrors srv_table_t pattern) ───────────────── */
@@ -78,6 +78,27 @@ handle_request(void *cls,
                          n > 0 ? (size_t)n : 0);
     }
 
+    /* /api/v1/stats/flow/<N>: the same counters for one client flow */
+    static const char flow_pfx[] = "/api/v1/stats/flow/";
+    if (strncmp(url, flow_pfx, sizeof(flow_pfx) - 1) == 0 &&
+        strcmp(method, "GET") == 0) {
+        const char *arg = url + sizeof(flow_pfx) - 1;
+        char *end;
+        unsigned long f = strtoul(arg, &end, 10);
+        if (end == arg || *end != '\0' || f >= TGEN_MAX_CLIENT_FLOWS ||
+            !flow_metrics_present((uint32_t)f)) {
+            const char *err = "{\"error\":\"no such flow\"}";
+            return send_text(connection, MHD_HTTP_NOT_FOUND,
+                             "application/json", err, strlen(err));
+        }
+        metrics_snapshot_t snap;
+        uint32_t nw = g_core_map.num_workers ? g_core_map.num_workers : 1;
+        flow_metrics_snapshot(&snap, (uint32_t)f, nw);
+        n = export_json(&snap, buf, sizeof(buf));
+        return send_text(connection, MHD_HTTP_OK, "application/json", buf,
+                         n > 0 ? (size_t)n : 0);
+    }
+
     if (strcmp(url, "/api/v1/config") == 0 && strcmp(method, "GET") == 0) {
 #ifdef HAVE_JANSSON
         /* Quick-dump the current config as JSON */
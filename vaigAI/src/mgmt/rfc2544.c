@@ -0,0 +1,668 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: RFC 2544 benchmark runner.
+ *
+ * One trial = START of the run's UDP probe flows, trial_s of traffic (or
+ * one burst), STOP_FLOW, then settle_ms for late frames before the probe
+ * counters are read.  The per-test search decides the next trial.
+ */
+#include "rfc2544.h"
+#include "mgmt_loop.h"
+#include "../core/ipc.h"
+#include "../core/tx_gen.h"
+#include "../core/core_assign.h"
+#include "../core/worker_loop.h"
+#include "../net/arp.h"
+#include "../telemetry/log.h"
+#include "../telemetry/output.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+
+/* Frame bytes around the UDP payload: Ethernet, IPv4, UDP and FCS. */
+#define R_FRAME_OVERHEAD  (RTE_ETHER_HDR_LEN + 20u + 8u + RTE_ETHER_CRC_LEN)
+/* Wire bytes per frame beyond the frame: preamble + SFD and the IFG. */
+#define R_L1_OVERHEAD     20u
+/* Back-to-back bursts are searched up to this much line-rate traffic. */
+#define R_B2B_MAX_S       2u
+/* Frame-loss curve ends after this many consecutive clean trials. */
+#define R_LOSS_CLEAN_RUNS 2u
+
+/* Simple IMIX: 64, 570 and 1518-byte frames at 7:4:1. */
+static const struct {
+    uint16_t frame;
+    uint32_t weight;
+} k_imix[RFC2544_IMIX_LEGS] = {
+    {   64, 7 },
+    {  570, 4 },
+    { 1518, 1 },
+};
+
+static const char *const k_test_names[RFC2544_TEST_MAX] = {
+    "throughput", "latency", "loss", "b2b",
+};
+
+typedef enum {
+    R_TRIAL = 0,        /* traffic running                         */
+    R_SETTLE,           /* stopped, waiting for late frames        */
+} r_phase_t;
+
+/* A frame size of the run: one flow, or one per IMIX component. */
+typedef struct {
+    uint32_t flow_idx;
+    uint16_t frame;
+    uint32_t weight;
+} r_leg_t;
+
+static struct {
+    bool             active;
+    r_phase_t        phase;
+    rfc2544_params_t p;
+    uint32_t         slots[RFC2544_IMIX_LEGS];  /* claimed flow slots */
+    uint32_t         n_slots;
+
+    /* Position: frame size index and test */
+    uint32_t         size_i;
+    uint8_t          test;
+    r_leg_t          legs[RFC2544_IMIX_LEGS];
+    uint32_t         n_legs;
+    uint32_t         weight_sum;
+    double           mean_frame;
+    uint64_t         line_fps;
+
+    /* Current trial */
+    uint32_t         trial_n;
+    uint64_t         rate_fps;
+    uint64_t         burst;
+    uint64_t         t_start;
+    uint64_t         t_end;
+    uint64_t         t_settle;
+    double           secs;
+
+    /* Search state: fps (throughput, loss) or frames (b2b) */
+    uint64_t         lo;
+    uint64_t         hi;
+    uint64_t         step;
+    uint32_t         clean_runs;
+
+    rfc2544_result_t res[RFC2544_MAX_SIZES][RFC2544_TEST_MAX];
+    bool             have[RFC2544_MAX_SIZES][RFC2544_TEST_MAX];
+} g_r;
+
+const char *
+rfc2544_test_name(uint8_t test)
+{
+    return test < RFC2544_TEST_MAX ? k_test_names[test] : "?";
+}
+
+bool
+rfc2544_active(void)
+{
+    return g_r.active;
+}
+
+static const char *
+frame_label(uint16_t frame, char *buf, size_t len)
+{
+    if (frame == RFC2544_IMIX)
+        snprintf(buf, len, "imix");
+    else
+        snprintf(buf, len, "%u", frame);
+    return buf;
+}
+
+/* ── Flow control ─────────────────────────────────────────────────────────── */
+
+static void
+stop_legs(void)
+{
+    for (uint32_t i = 0; i < g_r.n_legs; i++) {
+        config_update_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.cmd = CFG_CMD_STOP_FLOW;
+        memcpy(cmd.payload, &g_r.legs[i].flow_idx, sizeof(uint32_t));
+        tgen_ipc_broadcast(&cmd);
+    }
+}
+
+/* Split `total` by the leg weights, remainder to the first leg; a leg
+ * never gets 0 out of a non-zero total. */
+static uint64_t
+leg_share(uint64_t total, uint32_t leg)
+{
+    if (total == 0 || g_r.n_legs == 1)
+        return total;
+    uint64_t s = total * g_r.legs[leg].weight / g_r.weight_sum;
+    if (leg == 0) {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < g_r.n_legs; i++)
+            sum += total * g_r.legs[i].weight / g_r.weight_sum;
+        s += total - sum;
+    }
+    return s ? s : 1;
+}
+
+/* A worker given max_initiations sends the whole count at the whole
+ * rate, so a burst goes to one worker only: the port's first. */
+static uint32_t
+burst_worker(uint16_t port_id)
+{
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++) {
+        const worker_ctx_t *ctx = &g_worker_ctx[w];
+        for (uint32_t pp = 0; pp < ctx->num_ports; pp++)
+            if (ctx->ports[pp] == port_id)
+                return w;
+    }
+    return 0;
+}
+
+static void
+trial_start(uint64_t rate_fps, uint64_t burst)
+{
+    const rfc2544_params_t *p = &g_r.p;
+    uint16_t l2_extra = p->vlan_id ? 4 : 0;
+
+    g_r.rate_fps = rate_fps;
+    g_r.burst    = burst;
+    g_r.trial_n++;
+
+    /* A burst may run past trial_s if the generator can't keep line rate. */
+    uint32_t limit_s = p->trial_s + (burst ? 2 * R_B2B_MAX_S : 0);
+
+    for (uint32_t i = 0; i < g_r.n_legs; i++) {
+        const r_leg_t *leg = &g_r.legs[i];
+        udp_probe_reset(leg->flow_idx);
+        flow_metrics_prepare(leg->flow_idx, g_core_map.num_workers);
+
+        tx_gen_config_t gcfg;
+        memset(&gcfg, 0, sizeof(gcfg));
+        gcfg.proto      = TX_GEN_PROTO_UDP;
+        gcfg.dst_ip     = p->dst_ip;
+        gcfg.src_ip     = g_arp[p->port_id].local_ip;
+        gcfg.dst_mac    = p->dst_mac;
+        gcfg.src_mac    = g_arp[p->port_id].local_mac;
+        gcfg.dst_port   = p->dst_port;
+        gcfg.src_port   = (uint16_t)(12345 + i);
+        gcfg.pkt_size   = (uint16_t)(leg->frame - R_FRAME_OVERHEAD - l2_extra);
+        gcfg.port_id    = p->port_id;
+        gcfg.rate_pps   = leg_share(rate_fps, i);
+        gcfg.max_initiations = (uint32_t)leg_share(burst, i);
+        /* Backstop only: the runner stops the trial itself. */
+        gcfg.duration_s = limit_s + 1;
+        gcfg.flow_idx   = leg->flow_idx;
+        gcfg.dscp       = p->dscp;
+        gcfg.vlan_id    = p->vlan_id;
+        gcfg.gen_flags  = TX_GEN_F_PROBE;
+
+        config_update_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.cmd = CFG_CMD_START;
+        cmd.seq = 1;
+        memcpy(cmd.payload, &gcfg, sizeof(gcfg));
+        if (burst)
+            tgen_ipc_send(burst_worker(p->port_id), &cmd);
+        else
+            tgen_ipc_broadcast(&cmd);
+    }
+
+    uint64_t hz = rte_get_tsc_hz();
+    g_r.t_start = rte_rdtsc();
+    g_r.t_end   = g_r.t_start + (uint64_t)limit_s * hz;
+    g_r.phase   = R_TRIAL;
+}
+
+/* Burst trials end when every leg has sent its frames. */
+static bool
+burst_done(void)
+{
+    for (uint32_t i = 0; i < g_r.n_legs; i++) {
+        uint64_t tx = 0;
+        for (uint32_t w = 0; w < g_core_map.num_workers; w++)
+            tx += g_udp_probe_tx[w][g_r.legs[i].flow_idx];
+        if (tx < leg_share(g_r.burst, i))
+            return false;
+    }
+    return true;
+}
+
+/* Sum the probe reports of the trial's flows. */
+static void
+trial_report(udp_probe_report_t *out)
+{
+    udp_probe_report(g_r.legs[0].flow_idx, out);
+    double jitter_w = out->jitter_ns * (double)out->rx;
+    double reorder_w = out->reorder_avg * (double)out->reordered;
+    for (uint32_t i = 1; i < g_r.n_legs; i++) {
+        udp_probe_report_t r;
+        udp_probe_report(g_r.legs[i].flow_idx, &r);
+        out->tx        += r.tx;
+        out->rx        += r.rx;
+        out->dup       += r.dup;
+        out->lost      += r.lost;
+        out->gaps      += r.gaps;
+        out->reordered += r.reordered;
+        if (r.reorder_max > out->reorder_max)
+            out->reorder_max = r.reorder_max;
+        jitter_w  += r.jitter_ns * (double)r.rx;
+        reorder_w += r.reorder_avg * (double)r.reordered;
+        hist_merge(&out->lat, &r.lat);
+    }
+    out->jitter_ns   = out->rx ? jitter_w / (double)out->rx : 0;
+    out->reorder_avg = out->reordered ? reorder_w / (double)out->reordered : 0;
+}
+
+/* ── Tests ────────────────────────────────────────────────────────────────── */
+
+static uint64_t
+resolution(uint64_t range)
+{
+    uint64_t r = (uint64_t)((double)range * g_r.p.resolution_pct / 100.0);
+    return r ? r : 1;
+}
+
+static void
+result_emit(uint64_t rate_fps, uint64_t burst, const udp_probe_report_t *rep)
+{
+    rfc2544_result_t *r = &g_r.res[g_r.size_i][g_r.test];
+    memset(r, 0, sizeof(*r));
+    r->test     = g_r.test;
+    r->frame    = g_r.p.frames[g_r.size_i];
+    r->line_fps = g_r.line_fps;
+    r->rate_fps = rate_fps;
+    r->burst    = burst;
+    r->mbps     = (double)rate_fps * (g_r.mean_frame + R_L1_OVERHEAD) * 8.0
+                  / 1e6;
+    r->pct_line = g_r.line_fps
+        ? (double)rate_fps * 100.0 / (double)g_r.line_fps : 0;
+    r->trials   = g_r.trial_n;
+    if (rep)
+        r->rep = *rep;
+    else
+        hist_reset(&r->rep.lat);
+    g_r.have[g_r.size_i][g_r.test] = true;
+
+    char fl[8];
+    frame_label(r->frame, fl, sizeof(fl));
+    switch (r->test) {
+    case RFC2544_THROUGHPUT:
+    case RFC2544_LOSS:
+        printf("[rfc2544] %s %s: %" PRIu64 " fps, %.1f Mbps, %.2f%% of line"
+               " (%u trials)\n", fl, rfc2544_test_name(r->test),
+               r->rate_fps, r->mbps, r->pct_line, r->trials);
+        break;
+    case RFC2544_LATENCY:
+        if (r->rep.lat.total_count > 0)
+            printf("[rfc2544] %s latency at %" PRIu64 " fps: min %" PRIu64
+                   " avg %" PRIu64 " p99 %" PRIu64 " max %" PRIu64
+                   " ns, jitter %.1f ns\n", fl, r->rate_fps,
+                   r->rep.lat.min_val,
+                   r->rep.lat.total_sum / r->rep.lat.total_count,
+                   hist_percentile(&r->rep.lat, 99.0), r->rep.lat.max_val,
+                   r->rep.jitter_ns);
+        else
+            printf("[rfc2544] %s latency: no probes received\n", fl);
+        break;
+    default:
+        printf("[rfc2544] %s b2b: %" PRIu64 " frames (%u trials)\n",
+               fl, r->burst, r->trials);
+        break;
+    }
+    fflush(stdout);
+    output_rfc2544_result(r);
+}
+
+/* Start the current test on the current frame size; false if it has
+ * nothing to run (latency without a throughput rate). */
+static bool
+test_begin(void)
+{
+    g_r.trial_n = 0;
+    switch (g_r.test) {
+    case RFC2544_THROUGHPUT:
+        g_r.lo = 0;
+        g_r.hi = g_r.line_fps;
+        trial_start(g_r.line_fps, 0);
+        return true;
+    case RFC2544_LATENCY: {
+        const rfc2544_result_t *t = &g_r.res[g_r.size_i][RFC2544_THROUGHPUT];
+        if (!g_r.have[g_r.size_i][RFC2544_THROUGHPUT] || t->rate_fps == 0) {
+            result_emit(0, 0, NULL);
+            return false;
+        }
+        trial_start(t->rate_fps, 0);
+        return true;
+    }
+    case RFC2544_LOSS:
+        g_r.step = g_r.line_fps * g_r.p.loss_step_pct / 100;
+        if (g_r.step == 0)
+            g_r.step = 1;
+        g_r.lo = 0;                     /* highest zero-loss rate */
+        g_r.clean_runs = 0;
+        trial_start(g_r.line_fps, 0);
+        return true;
+    default:
+        g_r.lo = 0;
+        g_r.hi = g_r.line_fps * R_B2B_MAX_S;
+        g_r.step = resolution(g_r.hi);
+        trial_start(0, g_r.hi);
+        return true;
+    }
+}
+
+/* Feed a trial's outcome to the search.  Returns true when the test is
+ * finished (result emitted), false after starting the next trial. */
+static bool
+test_step(const udp_probe_report_t *rep, double loss_pct)
+{
+    switch (g_r.test) {
+    case RFC2544_THROUGHPUT: {
+        bool pass = loss_pct <= g_r.p.loss_pct;
+        if (pass)
+            g_r.lo = g_r.rate_fps;
+        else
+            g_r.hi = g_r.rate_fps;
+        uint64_t next = g_r.lo + (g_r.hi - g_r.lo) / 2;
+        if ((pass && g_r.rate_fps == g_r.line_fps) ||
+            g_r.hi - g_r.lo <= resolution(g_r.line_fps) || next == g_r.lo) {
+            result_emit(g_r.lo, 0, NULL);
+            return true;
+        }
+        trial_start(next, 0);
+        return false;
+    }
+    case RFC2544_LATENCY:
+        result_emit(g_r.rate_fps, 0, rep);
+        return true;
+    case RFC2544_LOSS:
+        if (rep->lost == 0) {
+            g_r.clean_runs++;
+            if (g_r.rate_fps > g_r.lo)
+                g_r.lo = g_r.rate_fps;
+        } else {
+            g_r.clean_runs = 0;
+        }
+        if (g_r.clean_runs >= R_LOSS_CLEAN_RUNS || g_r.rate_fps <= g_r.step) {
+            result_emit(g_r.lo, 0, NULL);
+            return true;
+        }
+        trial_start(g_r.rate_fps - g_r.step, 0);
+        return false;
+    default: {
+        bool pass = rep->lost == 0;
+        if (pass)
+            g_r.lo = g_r.burst;
+        else
+            g_r.hi = g_r.burst;
+        uint64_t next = g_r.lo + (g_r.hi - g_r.lo) / 2;
+        if ((pass && g_r.burst == g_r.line_fps * R_B2B_MAX_S) ||
+            g_r.hi - g_r.lo <= g_r.step || next == g_r.lo) {
+            result_emit(0, g_r.lo, NULL);
+            return true;
+        }
+        trial_start(0, next);
+        return false;
+    }
+    }
+}
+
+/* Set up legs and line rate for frame size index i. */
+static void
+size_begin(uint32_t i)
+{
+    uint16_t frame = g_r.p.frames[i];
+    g_r.size_i = i;
+    if (frame == RFC2544_IMIX) {
+        g_r.n_legs = RFC2544_IMIX_LEGS;
+        for (uint32_t l = 0; l < RFC2544_IMIX_LEGS; l++) {
+            g_r.legs[l].frame  = k_imix[l].frame;
+            g_r.legs[l].weight = k_imix[l].weight;
+        }
+    } else {
+        g_r.n_legs = 1;
+        g_r.legs[0].frame  = frame;
+        g_r.legs[0].weight = 1;
+    }
+    uint64_t bytes = 0;
+    g_r.weight_sum = 0;
+    for (uint32_t l = 0; l < g_r.n_legs; l++) {
+        g_r.legs[l].flow_idx = g_r.slots[l];
+        bytes          += (uint64_t)g_r.legs[l].frame * g_r.legs[l].weight;
+        g_r.weight_sum += g_r.legs[l].weight;
+    }
+    g_r.mean_frame = (double)bytes / g_r.weight_sum;
+    g_r.line_fps = (uint64_t)((double)g_r.p.link_mbps * 1e6 /
+                              ((g_r.mean_frame + R_L1_OVERHEAD) * 8.0));
+}
+
+/* Move to the next selected test / frame size and start it; false when
+ * the run is complete. */
+static bool
+advance(void)
+{
+    for (;;) {
+        do {
+            g_r.test++;
+        } while (g_r.test < RFC2544_TEST_MAX &&
+                 !(g_r.p.tests & (1u << g_r.test)));
+        if (g_r.test >= RFC2544_TEST_MAX) {
+            if (g_r.size_i + 1 >= g_r.p.n_frames)
+                return false;
+            size_begin(g_r.size_i + 1);
+            g_r.test = 0;
+            if (!(g_r.p.tests & 1u))
+                continue;               /* find the first selected test */
+        }
+        if (test_begin())
+            return true;
+    }
+}
+
+static void
+release_slots(void)
+{
+    uint64_t now = rte_rdtsc();
+    for (uint32_t i = 0; i < g_r.n_slots; i++) {
+        traffic_gen_state_t *ts = &g_client_flows[g_r.slots[i]];
+        ts->active   = false;
+        ts->managed  = false;
+        ts->stop_tsc = now;
+    }
+    g_r.active = false;
+}
+
+static void
+finish(void)
+{
+    release_slots();
+    printf("[rfc2544] run complete\n");
+    rfc2544_status();
+}
+
+/* ── Public API ───────────────────────────────────────────────────────────── */
+
+int
+rfc2544_start(const rfc2544_params_t *p)
+{
+    if (g_r.active)
+        return -EBUSY;
+
+    uint64_t link_mbps = p->link_mbps;
+    if (link_mbps == 0) {
+        struct rte_eth_link link;
+        if (rte_eth_link_get_nowait(p->port_id, &link) == 0 &&
+            link.link_status && link.link_speed != RTE_ETH_SPEED_NUM_NONE &&
+            link.link_speed != RTE_ETH_SPEED_NUM_UNKNOWN)
+            link_mbps = link.link_speed;
+    }
+    if (link_mbps == 0)
+        return -EINVAL;
+
+    uint32_t need = 1;
+    for (uint32_t i = 0; i < p->n_frames; i++)
+        if (p->frames[i] == RFC2544_IMIX)
+            need = RFC2544_IMIX_LEGS;
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < UDP_PROBE_MAX_FLOWS && n < need; i++)
+        if (!g_client_flows[i].active)
+            g_r.slots[n++] = i;
+    if (n < need)
+        return -ENOSPC;
+
+    memset(g_r.have, 0, sizeof(g_r.have));
+    g_r.p = *p;
+    g_r.p.link_mbps = link_mbps;
+    g_r.n_slots = n;
+
+    char ip[16];
+    uint32_t hip = rte_be_to_cpu_32(p->dst_ip);
+    snprintf(ip, sizeof(ip), "%u.%u.%u.%u", (hip >> 24) & 0xFF,
+             (hip >> 16) & 0xFF, (hip >> 8) & 0xFF, hip & 0xFF);
+    for (uint32_t i = 0; i < n; i++) {
+        traffic_gen_state_t tgs;
+        memset(&tgs, 0, sizeof(tgs));
+        tgs.flow_idx  = g_r.slots[i];
+        tgs.managed   = true;
+        tgs.n_workers = g_core_map.num_workers;
+        tgs.port_id   = p->port_id;
+        tgs.dst_port  = p->dst_port;
+        strncpy(tgs.proto, "rfc2544", sizeof(tgs.proto) - 1);
+        strncpy(tgs.dst_ip_str, ip, sizeof(tgs.dst_ip_str) - 1);
+        mgmt_traffic_start(&tgs);
+    }
+    g_r.active = true;
+
+    size_begin(0);
+    g_r.test = RFC2544_THROUGHPUT;
+    if (!((p->tests & 1u) && test_begin()) && !advance())
+        finish();
+    return 0;
+}
+
+void
+rfc2544_tick(void)
+{
+    if (!g_r.active)
+        return;
+
+    /* `stop` on one of our slots ends the run. */
+    for (uint32_t i = 0; i < g_r.n_slots; i++) {
+        if (!g_client_flows[g_r.slots[i]].active) {
+            rfc2544_abort();
+            return;
+        }
+    }
+
+    uint64_t now = rte_rdtsc();
+    if (g_r.phase == R_TRIAL) {
+        bool over = now >= g_r.t_end;
+        if (!over && g_r.burst > 0)
+            over = burst_done();
+        if (!over)
+            return;
+        stop_legs();
+        g_r.secs     = (double)(now - g_r.t_start) / (double)rte_get_tsc_hz();
+        g_r.t_settle = now + (uint64_t)g_r.p.settle_ms *
+                             rte_get_tsc_hz() / 1000;
+        g_r.phase    = R_SETTLE;
+        return;
+    }
+    if (now < g_r.t_settle)
+        return;
+
+    rfc2544_trial_t t;
+    memset(&t, 0, sizeof(t));
+    trial_report(&t.rep);
+    t.test     = g_r.test;
+    t.frame    = g_r.p.frames[g_r.size_i];
+    t.trial    = g_r.trial_n;
+    t.rate_fps = g_r.rate_fps;
+    t.burst    = g_r.burst;
+    t.secs     = g_r.secs;
+    t.loss_pct = t.rep.tx ? (double)t.rep.lost * 100.0 / (double)t.rep.tx
+                          : 100.0;
+    t.pass     = g_r.test == RFC2544_THROUGHPUT
+                     ? t.loss_pct <= g_r.p.loss_pct : t.rep.lost == 0;
+    output_rfc2544_trial(&t);
+
+    if (t.rep.tx == 0) {
+        printf("[rfc2544] no frames sent on port %u — aborting\n",
+               g_r.p.port_id);
+        output_error("error", "rfc2544", "trial sent no frames");
+        rfc2544_abort();
+        return;
+    }
+
+    char fl[8];
+    frame_label(t.frame, fl, sizeof(fl));
+    if (t.burst)
+        printf("[rfc2544] %s %s #%u: burst %" PRIu64 "  lost %" PRIu64 "\n",
+               fl, rfc2544_test_name(t.test), t.trial, t.burst, t.rep.lost);
+    else
+        printf("[rfc2544] %s %s #%u: %" PRIu64 " fps (sent %.0f)  loss %.4f%%"
+               "\n", fl, rfc2544_test_name(t.test), t.trial, t.rate_fps,
+               t.secs > 0 ? (double)t.rep.tx / t.secs : 0, t.loss_pct);
+    fflush(stdout);
+
+    if (test_step(&t.rep, t.loss_pct) && !advance())
+        finish();
+}
+
+bool
+rfc2544_abort(void)
+{
+    if (!g_r.active)
+        return false;
+    for (uint32_t i = 0; i < g_r.n_slots; i++) {
+        config_update_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.cmd = CFG_CMD_STOP_FLOW;
+        memcpy(cmd.payload, &g_r.slots[i], sizeof(uint32_t));
+        tgen_ipc_broadcast(&cmd);
+    }
+    release_slots();
+    printf("[rfc2544] run aborted\n");
+    output_error("warn", "rfc2544", "run aborted");
+    return true;
+}
+
+void
+rfc2544_status(void)
+{
+    if (g_r.active) {
+        char fl[8];
+        printf("rfc2544: running %s on %s-byte frames, trial %u (%s)\n",
+               rfc2544_test_name(g_r.test),
+               frame_label(g_r.p.frames[g_r.size_i], fl, sizeof(fl)),
+               g_r.trial_n, g_r.phase == R_TRIAL ? "traffic" : "settling");
+    }
+
+    printf("  %-6s %-10s %14s %12s %8s %14s\n",
+           "FRAME", "TEST", "RATE (fps)", "Mbps (L1)", "% LINE", "DETAIL");
+    bool any = false;
+    for (uint32_t i = 0; i < RFC2544_MAX_SIZES; i++) {
+        for (uint8_t t = 0; t < RFC2544_TEST_MAX; t++) {
+            if (!g_r.have[i][t])
+                continue;
+            any = true;
+            const rfc2544_result_t *r = &g_r.res[i][t];
+            char fl[8], detail[48] = "";
+            if (t == RFC2544_LATENCY && r->rep.lat.total_count > 0)
+                snprintf(detail, sizeof(detail), "avg %" PRIu64 " ns",
+                         r->rep.lat.total_sum / r->rep.lat.total_count);
+            else if (t == RFC2544_B2B)
+                snprintf(detail, sizeof(detail), "%" PRIu64 " frames",
+                         r->burst);
+            printf("  %-6s %-10s %14" PRIu64 " %12.1f %7.2f%% %14s\n",
+                   frame_label(r->frame, fl, sizeof(fl)),
+                   rfc2544_test_name(t), r->rate_fps, r->mbps, r->pct_line,
+                   detail);
+        }
+    }
+    if (!any)
+        printf("  (no results yet)\n");
+}
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: RFC 2544 benchmark runner (management lcore).
+ *
+ * Drives the stateless UDP generator through the RFC 2544 tests for each
+ * requested frame size: throughput (binary search on the offered rate,
+ * with a loss tolerance), latency at the throughput rate, the frame-loss
+ * rate curve and back-to-back bursts (binary search on the burst length).
+ *
+ * Every trial is a UDP flow with probes (udp_probe.h), so loss is counted
+ * exactly per trial: probes transmitted versus unique probes received
+ * after a settle period.  Frames must come back to vaigAI — looped
+ * through the DUT to one of its ports, or reflected by the peer.
+ *
+ * The runner is a non-blocking state machine ticked by mgmt_loop_run().
+ * It claims its flow slots in g_client_flows[] as `managed` so the
+ * ordinary duration tick leaves them alone; `stop` aborts the run.
+ * Each trial and each test result is emitted to the NDJSON output.
+ */
+#ifndef TGEN_RFC2544_H
+#define TGEN_RFC2544_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rte_ether.h>
+#include "../net/udp_probe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RFC2544_MAX_SIZES   16u
+#define RFC2544_IMIX        0u      /* frame size entry meaning IMIX     */
+#define RFC2544_IMIX_LEGS   3u      /* 64:570:1518 at 7:4:1              */
+
+typedef enum {
+    RFC2544_THROUGHPUT = 0,
+    RFC2544_LATENCY,
+    RFC2544_LOSS,
+    RFC2544_B2B,
+    RFC2544_TEST_MAX,
+} rfc2544_test_t;
+
+#define RFC2544_T_ALL  ((1u << RFC2544_TEST_MAX) - 1)
+
+/** Run parameters (filled by the CLI). */
+typedef struct {
+    uint32_t              dst_ip;       /* network byte order            */
+    uint16_t              dst_port;
+    uint16_t              port_id;
+    struct rte_ether_addr dst_mac;
+    uint16_t              frames[RFC2544_MAX_SIZES]; /* incl. FCS; 0 = IMIX */
+    uint32_t              n_frames;
+    uint32_t              tests;        /* bitmask of 1 << rfc2544_test_t */
+    uint32_t              trial_s;      /* seconds per trial             */
+    uint32_t              settle_ms;    /* wait for late frames after a trial */
+    double                loss_pct;     /* throughput: accepted loss     */
+    double                resolution_pct; /* search stops at this % of line */
+    uint32_t              loss_step_pct;  /* frame-loss curve step       */
+    uint64_t              link_mbps;    /* 0 = from the port's link speed */
+    uint8_t               dscp;
+    uint16_t              vlan_id;
+} rfc2544_params_t;
+
+/** One trial, as emitted to the NDJSON stream. */
+typedef struct {
+    uint8_t            test;        /* rfc2544_test_t                    */
+    uint16_t           frame;       /* 0 = IMIX                          */
+    uint32_t           trial;       /* 1-based within the test           */
+    uint64_t           rate_fps;    /* offered rate, 0 = unpaced burst   */
+    uint64_t           burst;       /* back-to-back frames, else 0       */
+    double             secs;        /* trial length, traffic only        */
+    double             loss_pct;
+    bool               pass;
+    udp_probe_report_t rep;         /* summed over the trial's flows     */
+} rfc2544_trial_t;
+
+/** Outcome of one test for one frame size. */
+typedef struct {
+    uint8_t            test;
+    uint16_t           frame;
+    uint64_t           line_fps;    /* theoretical maximum for the frame */
+    uint64_t           rate_fps;    /* throughput: highest passing rate;
+                                       latency: rate measured at;
+                                       loss: highest zero-loss rate      */
+    uint64_t           burst;       /* back-to-back: longest clean burst */
+    double             mbps;        /* rate_fps in L1 Mbps               */
+    double             pct_line;
+    uint32_t           trials;
+    udp_probe_report_t rep;         /* latency: the measurement trial    */
+} rfc2544_result_t;
+
+/** Human-readable name of a test ("throughput", ...). */
+const char *rfc2544_test_name(uint8_t test);
+
+/**
+ * Start a run.  Claims flow slots and returns at once; the trials are
+ * driven by rfc2544_tick().
+ * @return 0, -EBUSY (a run is active), -ENOSPC (no free flow slots) or
+ *         -EINVAL (no link speed).
+ */
+int rfc2544_start(const rfc2544_params_t *p);
+
+/** Advance the running benchmark (mgmt loop). */
+void rfc2544_tick(void);
+
+/** @return true while a run is in progress. */
+bool rfc2544_active(void);
+
+/**
+ * Abort the run: stop its flows and release their slots.
+ * @return true if a run was active.
+ */
+bool rfc2544_abort(void);
+
+/** Print the run's progress and the results so far. */
+void rfc2544_status(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_RFC2544_H */
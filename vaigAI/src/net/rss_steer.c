@@ -0,0 +1,359 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: RSS-aware tuple steering for client source ranges.
+ *
+ * Contexts are built by the management thread before CFG_CMD_START is
+ * broadcast and are read-only for workers afterwards.  Released contexts
+ * keep their tables until the slot is rebuilt for a new target; slots
+ * are handed out round-robin so a just-released context is not rebuilt
+ * while its last connections are still draining.  Flow rules outlive the
+ * last release by RSS_STEER_DRAIN_MS, for those connections' FINs, and
+ * are then destroyed by rss_steer_tick().
+ */
+#include "rss_steer.h"
+#include "tcp_port_pool.h"
+#include "../core/core_assign.h"
+#include "../core/worker_loop.h"
+#include "../port/port_init.h"
+
+#include <string.h>
+#include <errno.h>
+#include <rte_byteorder.h>
+#include <rte_ethdev.h>
+#include <rte_thash.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+#include <rte_cycles.h>
+
+#define STEER_RETA_MAX      RTE_ETH_RSS_RETA_SIZE_512
+#define STEER_RETA_GROUPS   (STEER_RETA_MAX / RTE_ETH_RETA_GROUP_SIZE)
+#define STEER_SERVE_WORDS   ((TGEN_MAX_WORKERS + 63) / 64)
+
+/* Flow rules of a released context are kept this long: the stopped
+ * flows' connections close and sit out TIME_WAIT on their workers. */
+#define RSS_STEER_DRAIN_MS  (TGEN_TIMEWAIT_DEFAULT_MS + 1000u)
+
+typedef struct {
+    uint32_t  refcnt;               /* 0 → slot free for reuse */
+    bool      built;
+
+    /* Key */
+    uint16_t  port_id;
+    uint32_t  src_base;             /* host byte order */
+    uint32_t  src_count;
+    uint32_t  dst_ip;               /* network byte order */
+    uint16_t  dst_port;             /* host byte order */
+    uint16_t  vlan_id;              /* 0 = untagged */
+
+    /* Precomputed hash state */
+    uint8_t   mode;                 /* rss_steer_mode_t in use */
+    uint32_t  dst_hash;             /* partial Toeplitz of the dst word */
+    uint16_t  reta_mask;            /* reta_size - 1 */
+    uint8_t   q2w[STEER_RETA_MAX];  /* RETA index → worker idx */
+    uint64_t  serves[STEER_SERVE_WORDS]; /* workers present in q2w */
+    uint16_t *sport_hash;           /* [TGEN_EPHEM_CNT] partial of sport|dport */
+
+    /* Flow mode: one rule per dst-port class */
+    uint16_t  n_rules;
+    uint64_t  idle_tsc;             /* last release, rules still in */
+    struct rte_flow *rules[TGEN_FLOW_STEER_MAX_CLASSES];
+} steer_ctx_t;
+
+static steer_ctx_t g_steer[RSS_STEER_MAX_CTX + 1];  /* [0] unused */
+static uint32_t    g_steer_next = 1;                /* round-robin cursor */
+
+/* ── Helpers ─────────────────────────────────────────────────────────────── */
+
+/* Partial Toeplitz hash of a 3-word IPv4/L4 tuple with only one word set.
+ * rte_softrss() takes host byte order words; zero words contribute nothing. */
+static inline uint32_t
+partial_hash(uint32_t w0, uint32_t w1, uint32_t w2)
+{
+    uint32_t tuple[3] = { w0, w1, w2 };
+    return rte_softrss(tuple, 3, tgen_rss_key());
+}
+
+static inline uint32_t
+src_class(const steer_ctx_t *c, uint32_t src_ip)
+{
+    if (c->mode == RSS_STEER_MODE_FLOW)
+        return 0;   /* rules match the port only */
+    return partial_hash(rte_be_to_cpu_32(src_ip), 0, 0) ^ c->dst_hash;
+}
+
+/* The worker tgen_worker_ctx_init() gave RX queue q, as attached: a
+ * queue nobody polls owns no tuples. */
+static uint32_t
+queue_to_worker(uint16_t port_id, uint16_t q)
+{
+    uint32_t w = tgen_rx_queue_worker(port_id, q);
+    return w < g_core_map.num_workers ? w : RSS_STEER_NO_WORKER;
+}
+
+static void
+set_owner(steer_ctx_t *c, uint16_t idx, uint32_t w)
+{
+    c->q2w[idx] = (uint8_t)w;
+    if (w != RSS_STEER_NO_WORKER)
+        c->serves[w >> 6] |= (1ull << (w & 63));
+}
+
+/* Map every RETA index of the port to the worker that polls the queue. */
+static void
+build_q2w(steer_ctx_t *c)
+{
+    struct rte_eth_dev_info dev_info;
+    memset(&dev_info, 0, sizeof(dev_info));
+    int ri = rte_eth_dev_info_get(c->port_id, &dev_info); (void)ri;
+    uint16_t n_rxq = dev_info.nb_rx_queues ? dev_info.nb_rx_queues : 1;
+
+    uint16_t reta_size = 1;
+    bool have_reta = false;
+    struct rte_eth_rss_reta_entry64 reta_conf[STEER_RETA_GROUPS];
+    memset(reta_conf, 0, sizeof(reta_conf));
+
+    /* Software distributor: worker 0 hashes into a virtual RETA whose
+     * entry r goes to target (= port worker position) r % n. */
+    uint32_t n_dist = g_core_map.port_dist_targets[c->port_id];
+    if (n_dist) {
+        n_rxq     = (uint16_t)n_dist;
+        reta_size = TGEN_SW_DIST_RETA_SIZE;
+    } else if (n_rxq > 1) {
+        reta_size = dev_info.reta_size;
+        if (reta_size == 0 || reta_size > STEER_RETA_MAX ||
+            (reta_size & (reta_size - 1)) != 0)
+            reta_size = 128; /* fallback */
+        uint16_t n_groups = (uint16_t)((reta_size + RTE_ETH_RETA_GROUP_SIZE - 1) /
+                                       RTE_ETH_RETA_GROUP_SIZE);
+        for (uint16_t i = 0; i < n_groups; i++)
+            reta_conf[i].mask = UINT64_MAX;
+        have_reta = rte_eth_dev_rss_reta_query(c->port_id, reta_conf,
+                                               reta_size) == 0;
+    }
+
+    c->reta_mask = (uint16_t)(reta_size - 1);
+    memset(c->serves, 0, sizeof(c->serves));
+    for (uint16_t r = 0; r < reta_size; r++) {
+        uint16_t q = have_reta
+            ? reta_conf[r / RTE_ETH_RETA_GROUP_SIZE].reta[r % RTE_ETH_RETA_GROUP_SIZE]
+            : (uint16_t)(r % n_rxq);
+        set_owner(c, r, queue_to_worker(c->port_id, q));
+    }
+    c->mode = RSS_STEER_MODE_RSS;
+
+    RTE_LOG(INFO, TCP,
+            "RSS steer: port=%u n_rxq=%u reta_size=%u have_reta=%d\n",
+            c->port_id, n_rxq, reta_size, have_reta);
+}
+
+/* Install one rte_flow rule per dst-port class.  With a non power-of-two
+ * queue count, classes are quadrupled so the modulo spread stays even.
+ * Returns false (nothing installed) if the PMD rejects any rule. */
+static bool
+build_flow(steer_ctx_t *c)
+{
+    struct rte_eth_dev_info dev_info;
+    memset(&dev_info, 0, sizeof(dev_info));
+    int ri = rte_eth_dev_info_get(c->port_id, &dev_info); (void)ri;
+    uint16_t n_rxq = dev_info.nb_rx_queues ? dev_info.nb_rx_queues : 1;
+    if (n_rxq < 2 || g_core_map.port_dist_targets[c->port_id])
+        return false;   /* one queue: nothing for rules to split */
+
+    uint16_t n_classes = 1;
+    while (n_classes < n_rxq)
+        n_classes <<= 1;
+    if (n_classes != n_rxq)
+        n_classes <<= 2;
+    if (n_classes > TGEN_FLOW_STEER_MAX_CLASSES)
+        n_classes = TGEN_FLOW_STEER_MAX_CLASSES;
+
+    uint16_t class_queue[TGEN_FLOW_STEER_MAX_CLASSES];
+    for (uint16_t k = 0; k < n_classes; k++)
+        class_queue[k] = (uint16_t)(k % n_rxq);
+
+    if (tgen_port_flow_steer_install(c->port_id, c->vlan_id, c->dst_ip,
+                                     c->dst_port, n_classes, class_queue,
+                                     c->rules) < 0)
+        return false;
+    c->n_rules = n_classes;
+
+    c->reta_mask = (uint16_t)(n_classes - 1);
+    memset(c->serves, 0, sizeof(c->serves));
+    for (uint16_t k = 0; k < n_classes; k++)
+        set_owner(c, k, queue_to_worker(c->port_id, class_queue[k]));
+    c->mode = RSS_STEER_MODE_FLOW;
+    return true;
+}
+
+static bool
+ranges_overlap(uint32_t a, uint32_t na, uint32_t b, uint32_t nb)
+{
+    return a < b + nb && b < a + na;
+}
+
+/* ── Public API ──────────────────────────────────────────────────────────── */
+static void
+rules_remove(steer_ctx_t *c)
+{
+    if (c->n_rules) {
+        tgen_port_flow_steer_remove(c->port_id, c->n_rules, c->rules);
+        c->n_rules = 0;
+    }
+}
+
+int
+rss_steer_acquire(uint16_t port_id, uint16_t vlan_id,
+                  uint32_t src_ip, uint32_t src_count,
+                  uint32_t dst_ip, uint16_t dst_port,
+                  rss_steer_mode_t mode, bool *fresh)
+{
+    uint32_t base = rte_be_to_cpu_32(src_ip);
+    if (src_count == 0)
+        src_count = 1;
+    *fresh = false;
+
+    /* Share an identical target; refuse overlapping-but-different ranges
+     * (the two flows would hand out the same 4-tuples). */
+    for (uint32_t i = 1; i <= RSS_STEER_MAX_CTX; i++) {
+        steer_ctx_t *c = &g_steer[i];
+        if (c->refcnt == 0 || c->port_id != port_id ||
+            c->vlan_id != vlan_id ||
+            c->dst_ip != dst_ip || c->dst_port != dst_port)
+            continue;
+        if (c->src_base == base && c->src_count == src_count) {
+            c->refcnt++;
+            return (int)i;
+        }
+        if (ranges_overlap(c->src_base, c->src_count, base, src_count))
+            return -EEXIST;
+    }
+
+    /* Pick the next free slot round-robin */
+    uint32_t slot = 0;
+    for (uint32_t n = 0; n < RSS_STEER_MAX_CTX; n++) {
+        uint32_t i = (g_steer_next + n - 1) % RSS_STEER_MAX_CTX + 1;
+        if (g_steer[i].refcnt == 0) { slot = i; break; }
+    }
+    if (slot == 0)
+        return -ENOSPC;
+    g_steer_next = slot % RSS_STEER_MAX_CTX + 1;
+
+    steer_ctx_t *c = &g_steer[slot];
+    if (!c->sport_hash) {
+        c->sport_hash = rte_malloc("rss_steer",
+                                   TGEN_EPHEM_CNT * sizeof(uint16_t), 0);
+        if (!c->sport_hash) {
+            RTE_LOG(ERR, TCP, "RSS steer: OOM\n");
+            return -ENOMEM;
+        }
+    }
+
+    /* Rules of the target this slot served before, if not yet drained */
+    rules_remove(c);
+
+    c->port_id   = port_id;
+    c->vlan_id   = vlan_id;
+    c->src_base  = base;
+    c->src_count = src_count;
+    c->dst_ip    = dst_ip;
+    c->dst_port  = dst_port;
+    c->dst_hash  = partial_hash(0, rte_be_to_cpu_32(dst_ip), 0);
+    if (mode != RSS_STEER_MODE_FLOW || !build_flow(c)) {
+        if (mode == RSS_STEER_MODE_FLOW)
+            RTE_LOG(WARNING, TCP,
+                    "RSS steer: port %u rejected flow rules, using RSS\n",
+                    port_id);
+        build_q2w(c);
+    }
+    for (uint32_t bit = 0; bit < TGEN_EPHEM_CNT; bit++) {
+        uint32_t sport = TGEN_EPHEM_LO + bit;
+        c->sport_hash[bit] = c->mode == RSS_STEER_MODE_FLOW
+            ? (uint16_t)(sport & c->reta_mask)
+            : (uint16_t)(partial_hash(0, 0, (sport << 16) | dst_port) &
+                         c->reta_mask);
+    }
+    c->built  = true;
+    c->refcnt = 1;
+    *fresh = true;
+    return (int)slot;
+}
+
+void
+rss_steer_release(uint8_t ctx)
+{
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX)
+        return;
+    steer_ctx_t *c = &g_steer[ctx];
+    if (c->refcnt > 0 && --c->refcnt == 0)
+        c->idle_tsc = rte_rdtsc();
+}
+
+void
+rss_steer_tick(void)
+{
+    uint64_t now  = rte_rdtsc();
+    uint64_t hold = rte_get_tsc_hz() / 1000 * RSS_STEER_DRAIN_MS;
+    for (uint32_t i = 1; i <= RSS_STEER_MAX_CTX; i++) {
+        steer_ctx_t *c = &g_steer[i];
+        if (c->n_rules && c->refcnt == 0 && now - c->idle_tsc >= hold)
+            rules_remove(c);
+    }
+}
+
+void
+rss_steer_fini(void)
+{
+    for (uint32_t i = 1; i <= RSS_STEER_MAX_CTX; i++) {
+        rules_remove(&g_steer[i]);
+        rte_free(g_steer[i].sport_hash);
+    }
+    memset(g_steer, 0, sizeof(g_steer));
+}
+
+rss_steer_mode_t
+rss_steer_mode(uint8_t ctx)
+{
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX)
+        return RSS_STEER_MODE_RSS;
+    return (rss_steer_mode_t)g_steer[ctx].mode;
+}
+
+uint32_t
+rss_steer_owner(uint8_t ctx, uint32_t src_ip, uint16_t sport)
+{
+    const steer_ctx_t *c = &g_steer[ctx];
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX || !c->built)
+        return RSS_STEER_NO_WORKER;
+    uint32_t h = src_class(c, src_ip) ^ c->sport_hash[sport - TGEN_EPHEM_LO];
+    return c->q2w[h & c->reta_mask];
+}
+
+bool
+rss_steer_serves(uint8_t ctx, uint32_t worker_idx)
+{
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX ||
+        !g_steer[ctx].built || worker_idx >= TGEN_MAX_WORKERS)
+        return false;
+    return (g_steer[ctx].serves[worker_idx >> 6] >> (worker_idx & 63)) & 1u;
+}
+
+uint32_t
+rss_steer_fill_ports(uint8_t ctx, uint32_t worker_idx,
+                     uint32_t src_ip, uint64_t *leaf)
+{
+    const uint32_t n_words = (TGEN_EPHEM_CNT + 63) / 64;
+    memset(leaf, 0, n_words * sizeof(uint64_t));
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX ||
+        !g_steer[ctx].built)
+        return 0;
+
+    const steer_ctx_t *c = &g_steer[ctx];
+    uint32_t cls = src_class(c, src_ip);
+    uint32_t n   = 0;
+    for (uint32_t bit = 0; bit < TGEN_EPHEM_CNT; bit++) {
+        if (c->q2w[(cls ^ c->sport_hash[bit]) & c->reta_mask] == worker_idx) {
+            leaf[bit >> 6] |= (1ull << (bit & 63));
+            n++;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: RSS-aware tuple steering for client source ranges.
+ *
+ * A steering context describes one client target — (egress port, VLAN,
+ * source IP range, dst_ip, dst_port).  For it we precompute which
+ * worker's RX queue the NIC will deliver the return traffic of every
+ * (src_ip, src_port) tuple to, so that each worker only originates
+ * connections whose SYN-ACKs come back to itself.
+ *
+ * Toeplitz is linear over XOR, so the hash of a tuple is the XOR of the
+ * partial hashes of its 32-bit words.  A context keeps the partial hash
+ * of the destination word and of every (sport, dport) word of the
+ * ephemeral range; the partial of a source IP is computed on demand.
+ * Owner lookup is then two XORs and one RETA-index → worker table read.
+ *
+ * In flow mode the context instead installs rte_flow rules that send
+ * return traffic to the RX queue selected by the low bits of the
+ * local (src) port, so ownership depends on the port alone.  PMDs that
+ * reject the rules fall back to RSS mode.
+ */
+#ifndef TGEN_RSS_STEER_H
+#define TGEN_RSS_STEER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of steering contexts (ids 1..RSS_STEER_MAX_CTX).  Flows to
+ *  the same target share one, so this bounds distinct targets, not flows;
+ *  ids travel as uint8_t in the TCB. */
+#define RSS_STEER_MAX_CTX   64
+
+/** Context id meaning "no steering" (shared port pool, no RSS check). */
+#define RSS_STEER_NONE      0u
+
+/** Owner value for RETA entries whose queue no worker polls. */
+#define RSS_STEER_NO_WORKER 0xFFu
+
+/** How a context steers return traffic to the owning worker. */
+typedef enum {
+    RSS_STEER_MODE_RSS = 0,   /* pick tuples the NIC's RSS already routes */
+    RSS_STEER_MODE_FLOW,      /* rte_flow rules on dst-port low bits      */
+} rss_steer_mode_t;
+
+/**
+ * Find or build the steering context for a client target.
+ * A context with the identical key is shared (reference counted).
+ * src_ip/dst_ip are in network byte order, dst_port in host order;
+ * vlan_id 0 is untagged.
+ * *fresh is set when a new context was built (its port pools must be
+ * staged with tcp_port_pool_set_range()).  `mode` is the requested
+ * method for a new context; RSS_STEER_MODE_FLOW falls back to RSS when
+ * the PMD rejects the rules (see rss_steer_mode()).
+ * Management thread only.
+ * Returns the context id (≥1), -EEXIST if an active context targets the
+ * same port/dst/dport with an overlapping but different source range,
+ * -ENOSPC if all contexts are in use, or -ENOMEM.
+ */
+int rss_steer_acquire(uint16_t port_id, uint16_t vlan_id,
+                      uint32_t src_ip, uint32_t src_count,
+                      uint32_t dst_ip, uint16_t dst_port,
+                      rss_steer_mode_t mode, bool *fresh);
+
+/** Method actually in use by a context. */
+rss_steer_mode_t rss_steer_mode(uint8_t ctx);
+
+/** Drop one reference on a context acquired with rss_steer_acquire(). */
+void rss_steer_release(uint8_t ctx);
+
+/** Management loop: destroy the flow rules of contexts released more
+ *  than a TIME_WAIT ago. */
+void rss_steer_tick(void);
+
+/** Destroy every context's flow rules and tables.  Before the ports
+ *  are stopped or reconfigured. */
+void rss_steer_fini(void);
+
+/**
+ * Worker index whose RX queue receives the return traffic of
+ * (src_ip, sport) for this context, or RSS_STEER_NO_WORKER.
+ * src_ip in network byte order, sport in host order and inside the
+ * ephemeral range.
+ */
+uint32_t rss_steer_owner(uint8_t ctx, uint32_t src_ip, uint16_t sport);
+
+/** True if at least one RETA entry of the context maps to worker_idx. */
+bool rss_steer_serves(uint8_t ctx, uint32_t worker_idx);
+
+/**
+ * Fill `leaf` (one bit per ephemeral port, TGEN_EPHEM_CNT bits) with the
+ * ports of src_ip whose return traffic lands on worker_idx.
+ * Returns the number of bits set.
+ */
+uint32_t rss_steer_fill_ports(uint8_t ctx, uint32_t worker_idx,
+                              uint32_t src_ip, uint64_t *leaf);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_RSS_STEER_H */
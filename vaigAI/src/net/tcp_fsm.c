@@ -7,6 +7,8 @@
 #include "tcp_snd_buf.h"
 #include "tcp_options.h"
 #include "tcp_port_pool.h"
+#include "tcp_hs_win.h"
+#include "rss_steer.h"
 #include "tcp_checksum.h"
 #include "tcp_congestion.h"
 #include "../net/ipv4.h"
@@ -25,6 +27,9 @@
 #include "../core/tx_gen.h"
 #include "../telemetry/log.h"
 #include "../app/server.h"
+#include "../app/l7_replay.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 
 #include <string.h>
 #include <netinet/in.h>
@@ -36,90 +41,6 @@
 #include <rte_byteorder.h>
 #include <rte_log.h>
 
-/* ── HTTP response body tracking helpers ─────────────────────────────────── */
-
-/* Parse Content-Length from an HTTP response buffer.
- * Returns the value, or 0 if not found / not parseable.
- * buf must be at least buf_len bytes; does NOT require NUL termination. */
-static inline uint32_t
-http_parse_content_length(const uint8_t *buf, uint32_t buf_len)
-{
-    /* memmem is a glibc extension, available on Linux */
-    const uint8_t *p = memmem(buf, buf_len, "Content-Length: ", 16);
-    if (!p)
-        p = memmem(buf, buf_len, "content-length: ", 16);
-    if (!p)
-        return 0;
-    p += 16;
-    uint32_t rem = (uint32_t)(buf_len - (uint32_t)(p - buf));
-    uint32_t val = 0;
-    for (uint32_t i = 0; i < rem && p[i] >= '0' && p[i] <= '9'; i++)
-        val = val * 10 + (p[i] - '0');
-    return val;
-}
-
-/* Find the first byte of the HTTP response body (after \r\n\r\n).
- * Returns the offset into buf, or buf_len if header terminator not found. */
-static inline uint32_t
-http_body_offset(const uint8_t *buf, uint32_t buf_len)
-{
-    const uint8_t *p = memmem(buf, buf_len, "\r\n\r\n", 4);
-    if (!p)
-        return buf_len;
-    return (uint32_t)(p - buf) + 4;
-}
-
-/* After receiving the first HTTP response segment: set up body tracking and
- * decide what to do next.  Returns true if the connection was closed/reset
- * (caller must goto done). */
-static inline bool
-http_rsp_body_start(uint32_t worker_idx, tcb_t *tcb,
-                    const uint8_t *buf, uint32_t buf_len)
-{
-    tcb->http_content_length = http_parse_content_length(buf, buf_len);
-    if (tcb->http_content_length == 0) {
-        /* No Content-Length (chunked, connection-close, etc.) —
-         * fall back to passive close: server will send FIN when done. */
-        tcb->app_state = 0;
-        return false;
-    }
-
-    uint32_t body_off = http_body_offset(buf, buf_len);
-    tcb->http_body_rx = (buf_len > body_off) ? (buf_len - body_off) : 0;
-
-    if (tcb->http_body_rx >= tcb->http_content_length) {
-        /* Full body already arrived in this segment — active close now. */
-        tcb->app_state = 0;
-        if (tcb->graceful_close) {
-            tcp_fsm_close(worker_idx, tcb);
-            return true;
-        }
-        tcp_fsm_reset(worker_idx, tcb);
-        return true;
-    }
-
-    /* More body to come — wait in state 6. */
-    tcb->app_state = 6;
-    return false;
-}
-
-/* While in state 6 (accumulating body): add data_len bytes and close when
- * done.  Returns true if the connection was closed/reset. */
-static inline bool
-http_rsp_body_recv(uint32_t worker_idx, tcb_t *tcb, uint32_t data_len)
-{
-    tcb->http_body_rx += data_len;
-    if (tcb->http_body_rx >= tcb->http_content_length) {
-        tcb->app_state = 0;
-        if (tcb->graceful_close) {
-            tcp_fsm_close(worker_idx, tcb);
-            return true;
-        }
-        tcp_fsm_reset(worker_idx, tcb);
-        return true;
-    }
-    return false;
-}
 #define SEQ_LT(a,b)   ((int32_t)((a)-(b)) <  0)
 #define SEQ_LE(a,b)   ((int32_t)((a)-(b)) <= 0)
 #define SEQ_GT(a,b)   ((int32_t)((a)-(b)) >  0)
@@ -220,8 +141,7 @@ int tcp_send_segment(uint32_t worker_idx, tcb_t *tcb,
                      const uint8_t *payload, uint32_t payload_len,
                      uint32_t seq, uint32_t ack)
 {
-    struct rte_mempool *mp = g_worker_mempools[worker_idx];
-    struct rte_mbuf    *m  = rte_pktmbuf_alloc(mp);
+    struct rte_mbuf *m = tgen_mbuf_stash_get(worker_idx);
     if (!m) return -1;
 
     /* TCP options (SYN: up to 20 bytes; other: up to 12 bytes) */
@@ -369,6 +289,7 @@ int tcp_send_segment(uint32_t worker_idx, tcb_t *tcb,
         if (sent == 0) { rte_pktmbuf_free(m); return -1; }
     }
     worker_metrics_add_tx(worker_idx, 1, (uint32_t)seg_len);
+    flow_metrics_add_tx(worker_idx, tcb->flow_idx, 1, (uint32_t)seg_len);
     /* Piggybacking an ACK clears any pending delayed-ACK. */
     if ((flags & RTE_TCP_ACK_FLAG) && !(flags & RTE_TCP_SYN_FLAG))
         tcb->pending_ack = false;
@@ -410,8 +331,7 @@ static void tcp_send_rst_no_tcb(uint32_t worker_idx, struct rte_mbuf *m,
                                  uint32_t local_ip, uint32_t remote_ip)
 {
     uint16_t port_id = 0;
-    struct rte_mempool *mp = g_worker_mempools[worker_idx];
-    struct rte_mbuf *rst = rte_pktmbuf_alloc(mp);
+    struct rte_mbuf *rst = tgen_mbuf_stash_get(worker_idx);
     if (!rst) return;
 
     size_t tcp_hdr_sz = sizeof(struct rte_tcp_hdr);
@@ -506,6 +426,10 @@ http_next_txn(uint32_t worker_idx, tcb_t *tcb)
     if (hpb->txn_per_conn > 0 && tcb->http_txn_count >= hpb->txn_per_conn)
         return 0; /* limit reached → close */
 
+    /* Open loop: the next request comes from the flow's schedule */
+    if (tcb->http_ol != HTTP_OL_NONE)
+        return http_ol_next(worker_idx, tcb);
+
     /* Think-time delay before next request */
     if (hpb->think_time_us > 0) {
         tcb->think_deadline_tsc = rte_rdtsc() +
@@ -517,8 +441,56 @@ http_next_txn(uint32_t worker_idx, tcb_t *tcb)
     return 4; /* send next request immediately */
 }
 
+/* ── Client connection ready for its first request ────────────────────────
+ * A connection opened to warm the pool parks instead of sending.  An
+ * open-loop one takes a due request (app_state 4) or joins the flow's
+ * idle list.  Returns true when the request should be sent now; the
+ * connection is closed when it has nowhere to go. */
+static bool
+http_conn_ready(uint32_t worker_idx, tcb_t *tcb)
+{
+    if (tcb->pool_state == CONN_POOL_WARMING) {
+        if (!conn_pool_put(worker_idx, tcb))
+            tcp_fsm_close(worker_idx, tcb);
+        return false;
+    }
+    if (tcb->http_ol == HTTP_OL_NONE)
+        return true;
+
+    uint8_t nxt = http_ol_next(worker_idx, tcb);
+    if (nxt == 0) {
+        /* app_state stays ≥ 2 so the TLS session is detached at free */
+        tcp_fsm_close(worker_idx, tcb);
+        return false;
+    }
+    tcb->app_state = nxt;
+    return nxt == 4;
+}
+
+/* ── HTTP request→response latency ────────────────────────────────────────
+ * Closed loop: from the send, CO-corrected against the expected interval
+ * of the connection's own flow (its request, at its current rate).  Open
+ * loop: from the intended send time, which already includes any wait for
+ * a connection, so no correction applies. */
+static void
+http_rsp_latency(uint32_t worker_idx, tcb_t *tcb)
+{
+    if (!tcb->http_req_sent_tsc)
+        return;
+    bool ol = tcb->http_ol != HTTP_OL_NONE;
+    uint64_t t0 = (ol && tcb->http_intended_tsc) ? tcb->http_intended_tsc
+                                                 : tcb->http_req_sent_tsc;
+    uint64_t lat_us = (rte_rdtsc() - t0) * 1000000ULL / rte_get_tsc_hz();
+    const http_prebuilt_req_t *hp = (const http_prebuilt_req_t *)tcb->app_ctx;
+    uint64_t ei = (hp && !ol) ? hp->expected_interval_us : 0;
+    hist_record_corrected(&g_latency_hist[worker_idx], lat_us, ei);
+    flow_metrics_latency(worker_idx, tcb->flow_idx, lat_us, ei);
+}
+
 /* ── Send next HTTP request on a keep-alive connection ────────────────────
  * Handles both plain HTTP and HTTPS (encrypts if TLS session exists).
+ * With pipelining the next batch — up to pipe_depth requests, within the
+ * connection's transaction limit — goes out in one write.
  * Sets app_state = 5 (response pending) and records sent timestamp. */
 static void
 http_send_next_request(uint32_t worker_idx, tcb_t *tcb)
@@ -526,24 +498,115 @@ http_send_next_request(uint32_t worker_idx, tcb_t *tcb)
     http_prebuilt_req_t *hp = (http_prebuilt_req_t *)tcb->app_ctx;
     if (!hp || hp->hdr_len == 0) return;
 
+    const uint8_t *req = hp->hdr;
+    uint32_t req_len = hp->hdr_len, n_req = 1;
+    if (hp->pipe_depth > 1) {
+        n_req = hp->pipe_depth;
+        if (hp->txn_per_conn > 0)
+            n_req = TGEN_MIN(n_req, hp->txn_per_conn - tcb->http_txn_count);
+        req     = hp->pipe;
+        req_len = n_req * hp->hdr_len;
+    }
+    tcb->http_pipe_sent = (uint8_t)n_req;
+    tcb->http_pipe_out  = (uint8_t)n_req;
+    http11_rsp_scan_init(&tcb->http_rsp);
+
     uint32_t ci = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
     tls_session_t *ts = tls_session_get(worker_idx, ci);
     if (ts) {
         uint8_t ct_buf[4096];
-        int ct_len = tls_encrypt(ts, hp->hdr, hp->hdr_len,
+        int ct_len = tls_encrypt(ts, req, req_len,
                                   ct_buf, sizeof(ct_buf));
         if (ct_len > 0)
             tcp_fsm_send(worker_idx, tcb, ct_buf, (uint32_t)ct_len);
         worker_metrics_add_tls_tx(worker_idx);
     } else {
-        tcp_fsm_send(worker_idx, tcb, hp->hdr, hp->hdr_len);
+        tcp_fsm_send(worker_idx, tcb, req, req_len);
+    }
+    for (uint32_t i = 0; i < n_req; i++) {
+        worker_metrics_add_http_req(worker_idx);
+        flow_metrics_inc(worker_idx, tcb->flow_idx, http_req_tx);
     }
-    worker_metrics_add_http_req(worker_idx);
     tcb->http_req_sent_tsc = rte_rdtsc();
     tcb->app_state = 5; /* HTTP response pending */
     tcp_timer_resched(worker_idx, tcb);
 }
 
+/* ── A response is complete: count its status and latency ─────────────── */
+static inline void
+http_rsp_count(uint32_t worker_idx, tcb_t *tcb)
+{
+    worker_metrics_add_http_rsp(worker_idx, tcb->http_rsp.status);
+    flow_metrics_add_http_rsp(worker_idx, tcb->flow_idx,
+                              tcb->http_rsp.status);
+    http_rsp_latency(worker_idx, tcb);
+}
+
+/* ── Client response data ─────────────────────────────────────────────────
+ * Run a segment (or a decrypted TLS record) through the TCB's response
+ * parser.  Responses are split out in order, one per request of the batch
+ * in flight (one without pipelining), each with its own status and
+ * latency; a response is complete at its last byte — Content-Length or
+ * last chunk — however it is segmented.  While a body is still arriving
+ * the connection waits in app_state 6, which has no response timeout.
+ * After the last response the connection moves on to its next
+ * transaction, parks, or closes.  A 101 Switching Protocols is counted
+ * like any response, then the connection is reset: what follows is not
+ * HTTP, and the rest of a pipelined batch will not be answered.
+ * Returns true if it was closed or reset. */
+static bool
+http_rsp_rx(uint32_t worker_idx, tcb_t *tcb, const uint8_t *data,
+            uint32_t len)
+{
+    const http_prebuilt_req_t *hp = (const http_prebuilt_req_t *)tcb->app_ctx;
+
+    while (len > 0 && tcb->http_pipe_out > 0) {
+        uint32_t used;
+        int rc = http11_rsp_scan(&tcb->http_rsp, data, len, hp->head, &used);
+        if (rc < 0) {
+            worker_metrics_add_http_parse_err(worker_idx);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, http_parse_err);
+            tcp_fsm_reset(worker_idx, tcb);
+            return true;
+        }
+        if (rc == 0)
+            break;
+        data += used;
+        len  -= used;
+        http_rsp_count(worker_idx, tcb);
+        if (http11_rsp_scan_switched(&tcb->http_rsp)) {
+            tcb->http_pipe_out = 0;
+            tcp_fsm_reset(worker_idx, tcb);
+            return true;
+        }
+        tcb->http_pipe_out--;
+        http11_rsp_scan_init(&tcb->http_rsp);
+    }
+    if (tcb->http_pipe_out > 0) {
+        tcb->app_state = http11_rsp_scan_in_body(&tcb->http_rsp) ? 6 : 5;
+        return false;
+    }
+
+    /* Batch complete: count its requests as transactions */
+    tcb->http_txn_count += tcb->http_pipe_sent - 1u;
+    uint8_t nxt = http_next_txn(worker_idx, tcb);
+    if (nxt == 4) {
+        http_send_next_request(worker_idx, tcb);
+    } else if (nxt == 7 || nxt == HTTP_OL_APP_IDLE) {
+        tcb->app_state = nxt; /* think-time wait or open-loop idle */
+    } else if (conn_pool_put(worker_idx, tcb)) {
+        /* parked in the connection pool */
+    } else if (tcb->graceful_close) {
+        /* --one: the whole body is in, half-close like curl */
+        tcp_fsm_close(worker_idx, tcb);
+        return true;
+    } else {
+        tcp_fsm_reset(worker_idx, tcb);
+        return true;
+    }
+    return false;
+}
+
 /* ── Effective MSS helper ─────────────────────────────────────────────────── */
 static inline uint32_t
 tcb_effective_mss(const tcb_t *tcb)
@@ -579,6 +642,7 @@ snd_buf_drain(uint32_t worker_idx, tcb_t *tcb)
         tcb->snd_nxt += send_len;
         offset       += send_len;
         worker_metrics_add_tcp_payload_tx(worker_idx, send_len);
+        flow_metrics_add(worker_idx, tcb->flow_idx, tcp_payload_tx, send_len);
     }
 }
 
@@ -623,6 +687,9 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
             memcmp(tcb->dst_ip6, t_saved_src6, 16) != 0)
             tcb = NULL; /* 4-tuple mismatch */
     }
+    if (tcb)
+        flow_metrics_add_rx(worker_idx, tcb->flow_idx, 1,
+                            m->pkt_len + m->l2_len + m->l3_len);
 
 
     uint8_t flags = tcp->tcp_flags;
@@ -725,6 +792,14 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
             tcb->snd_wnd       = rte_be_to_cpu_16(tcp->rx_win);
             /* Traffic generator: allow full-window initial burst */
             tcb->cwnd          = rte_be_to_cpu_16(tcp->rx_win);
+            if (tcb->flow_idx != FLOW_METRICS_NONE) {
+                /* Handshake time from the SYN; retransmitted SYNs are
+                 * ambiguous (Karn) and only release the slot. */
+                uint64_t now = rte_rdtsc();
+                tcp_hs_win_established(worker_idx, tcb->flow_idx,
+                    (uint32_t)tgen_tsc_to_us(now - tcb->syn_tsc),
+                    tcb->retransmit_count == 0, now);
+            }
             tcb->state = TCP_ESTABLISHED;
             tcb->retransmit_count = 0;
             tcb->rto_deadline_tsc = 0;  /* disarm SYN RTO */
@@ -745,6 +820,7 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                 tcb->rto_us = TCP_INITIAL_RTO_US;
             }
             worker_metrics_add_tcp_conn_open(worker_idx);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_open);
             /* Send ACK */
             tcp_send_segment(worker_idx, tcb,
                               RTE_TCP_ACK_FLAG,
@@ -783,51 +859,45 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                         if (hr == 1) {
                             tcb->app_state = 3; /* TLS established */
                             worker_metrics_add_tls_ok(worker_idx);
+                            flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                             tls_handshake_ok);
                             uint64_t lat_us = (rte_rdtsc() - tcb->tls_hs_start_tsc)
                                               * 1000000ULL / rte_get_tsc_hz();
                             hist_record(&g_latency_hist[worker_idx], lat_us);
+                            flow_metrics_latency(worker_idx, tcb->flow_idx,
+                                                 lat_us, 0);
                             /* If HTTPS: encrypt & send HTTP request now that TLS is up.
                              * Throughput mode sets app_ctx=(void*)1 as marker — skip HTTP send. */
                             if (tcb->app_ctx && (uintptr_t)tcb->app_ctx > 0x1000) {
                                 http_prebuilt_req_t *hp_req =
                                     (http_prebuilt_req_t *)tcb->app_ctx;
-                                if (hp_req->hdr_len > 0) {
-                                    uint8_t ct_buf[4096];
-                                    int ct_len = tls_encrypt(sess,
-                                        hp_req->hdr, hp_req->hdr_len,
-                                        ct_buf, sizeof(ct_buf));
-                                    if (ct_len > 0)
-                                        tcp_fsm_send(worker_idx, tcb,
-                                                     ct_buf, (uint32_t)ct_len);
-                                    worker_metrics_add_http_req(worker_idx);
-                                    tcb->http_req_sent_tsc = rte_rdtsc();
-                                    tcb->app_state = 5;
-                                }
+                                if (hp_req->hdr_len > 0 &&
+                                    http_conn_ready(worker_idx, tcb))
+                                    http_send_next_request(worker_idx, tcb);
                             }
                         } else if (hr < 0) {
                             tcb->app_state = 0;
                             worker_metrics_add_tls_fail(worker_idx);
+                            flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                             tls_handshake_fail);
                         }
                     }
                 } else {
                     tcb->app_state = 0;
                     worker_metrics_add_tls_fail(worker_idx);
+                    flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                     tls_handshake_fail);
                     TGEN_ERR(TGEN_LOG_TLS, "tls_session_attach failed: %d\n", trc);
                 }
             }
 
             /* ── HTTP request initiation (plain HTTP only) ────────── */
-            if (tcb->app_state == 4) {
-                http_prebuilt_req_t *hp =
-                    (http_prebuilt_req_t *)tcb->app_ctx;
-                if (hp && hp->hdr_len > 0) {
-                    tcp_fsm_send(worker_idx, tcb,
-                                 hp->hdr, hp->hdr_len);
-                    worker_metrics_add_http_req(worker_idx);
-                    tcb->http_req_sent_tsc = rte_rdtsc();
-                    tcb->app_state = 5; /* HTTP response pending */
-                }
-            }
+            if (tcb->app_state == 4 && http_conn_ready(worker_idx, tcb))
+                http_send_next_request(worker_idx, tcb);
+
+            /* ── L7 replay: client speaks first, or waits ─────────── */
+            if (tcb->app_state == L7_REPLAY_APP_CLIENT)
+                l7_replay_pump(worker_idx, tcb);
         } else if ((flags & RTE_TCP_ACK_FLAG) && !(flags & RTE_TCP_RST_FLAG) &&
                    ack == tcb->snd_nxt) {
             /* RFC 5961 §4: challenge ACK — server already has a connection
@@ -897,6 +967,10 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                 /* Pump more chunked response data if streaming */
                 if (tcb->app_state == 12)
                     srv_stream_pump(worker_idx, tcb);
+                /* Queue more of a replayed message, or close at the end */
+                else if (tcb->app_state == L7_REPLAY_APP_CLIENT ||
+                         tcb->app_state == L7_REPLAY_APP_SERVER)
+                    l7_replay_pump(worker_idx, tcb);
             } else if (ack == tcb->snd_una) {
                 tcb->dup_ack_count++;
                 if (tcb->dup_ack_count == 3) {
@@ -911,6 +985,8 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                                          tcb->snd_buf->data, rtx_len,
                                          tcb->snd_una, tcb->rcv_nxt);
                         worker_metrics_add_tcp_retransmit(worker_idx);
+                        flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                         tcp_retransmit);
                     }
                 }
             }
@@ -932,6 +1008,8 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                     TCP_DELAYED_ACK_US * g_tsc_hz / 1000000ULL;
                 tcp_timer_dack_add(worker_idx, tcb);
                 worker_metrics_add_tcp_payload_rx(worker_idx, data_len);
+                flow_metrics_add(worker_idx, tcb->flow_idx, tcp_payload_rx,
+                                 data_len);
 
                 /* ── Server mode: dispatch to handler ────────────── */
                 if (tcb->app_state >= 10) {
@@ -940,10 +1018,17 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                     srv_on_data(worker_idx, tcb,
                                 payload_data, data_len,
                                 tcb->src_port);
+                    if (!tcb->in_use)
+                        goto done;  /* handler reset the connection */
                     /* Immediate ACK for server handlers */
                     tcp_send_segment(worker_idx, tcb, RTE_TCP_ACK_FLAG,
                                      NULL, 0, tcb->snd_nxt, tcb->rcv_nxt);
                     tcb->pending_ack = false;
+                } else if (tcb->app_state == L7_REPLAY_APP_CLIENT) {
+                    if (l7_replay_on_data(worker_idx, tcb,
+                                          (const uint8_t *)tcp + hdr_len,
+                                          data_len) < 0)
+                        goto done;
                 } else
                 /* ── L7: TLS handshake / decrypt ──────────────────── */
                 if (tcb->app_state == 2 || tcb->app_state == 3 ||
@@ -967,26 +1052,21 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                             if (hr == 1) {
                                 tcb->app_state = 3;
                                 worker_metrics_add_tls_ok(worker_idx);
+                                flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                                 tls_handshake_ok);
                                 uint64_t lat_us = (rte_rdtsc() - tcb->tls_hs_start_tsc)
                                                   * 1000000ULL / rte_get_tsc_hz();
                                 hist_record(&g_latency_hist[worker_idx], lat_us);
+                                flow_metrics_latency(worker_idx, tcb->flow_idx,
+                                                     lat_us, 0);
                                 /* If HTTPS: encrypt & send HTTP request now that TLS is up.
                                  * Throughput mode sets app_ctx=(void*)1 as marker — skip HTTP send. */
                                 if (tcb->app_ctx && (uintptr_t)tcb->app_ctx > 0x1000) {
                                     http_prebuilt_req_t *hp_req =
                                         (http_prebuilt_req_t *)tcb->app_ctx;
-                                    if (hp_req->hdr_len > 0) {
-                                        uint8_t ct_buf[4096];
-                                        int ct_len = tls_encrypt(ts,
-                                            hp_req->hdr, hp_req->hdr_len,
-                                            ct_buf, sizeof(ct_buf));
-                                        if (ct_len > 0)
-                                            tcp_fsm_send(worker_idx, tcb,
-                                                         ct_buf, (uint32_t)ct_len);
-                                        worker_metrics_add_http_req(worker_idx);
-                                        tcb->http_req_sent_tsc = rte_rdtsc();
-                                        tcb->app_state = 5; /* HTTP response pending */
-                                    }
+                                    if (hp_req->hdr_len > 0 &&
+                                        http_conn_ready(worker_idx, tcb))
+                                        http_send_next_request(worker_idx, tcb);
                                 } else if (!tcb->app_ctx) {
                                     /* TLS-only mode: send close_notify then FIN. */
                                     if (tcb->graceful_close) {
@@ -1010,6 +1090,8 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                             } else if (hr < 0) {
                                 tcb->app_state = 0;
                                 worker_metrics_add_tls_fail(worker_idx);
+                                flow_metrics_inc(worker_idx, tcb->flow_idx,
+                                                 tls_handshake_fail);
                             }
                         } else {
                             /* TLS established — decrypt incoming data */
@@ -1019,110 +1101,24 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                             if (n > 0) {
                                 worker_metrics_add_tls_rx(worker_idx);
                                 /* Parse decrypted HTTP response if waiting */
-                                if (tcb->app_state == 5 && n >= 12 &&
-                                    memcmp(plain, "HTTP/1.", 7) == 0) {
-                                    uint16_t status =
-                                        (uint16_t)atoi((const char *)plain + 9);
-                                    worker_metrics_add_http_rsp(worker_idx, status);
-                                    /* Record HTTPS request→response latency (CO-corrected) */
-                                    if (tcb->http_req_sent_tsc) {
-                                        uint64_t lat_us =
-                                            (rte_rdtsc() - tcb->http_req_sent_tsc)
-                                            * 1000000ULL / rte_get_tsc_hz();
-                                        http_prebuilt_req_t *hlat =
-                                            (http_prebuilt_req_t *)tcb->app_ctx;
-                                        uint64_t ei = hlat ? hlat->expected_interval_us : 0;
-                                        hist_record_corrected(&g_latency_hist[worker_idx],
-                                                              lat_us, ei);
-                                    }
-                                    uint8_t nxt = http_next_txn(worker_idx, tcb);
-                                    if (nxt == 4) {
-                                        http_send_next_request(worker_idx, tcb);
-                                    } else if (nxt == 7) {
-                                        tcb->app_state = 7; /* think-time wait */
-                                    } else if (!tcb->graceful_close) {
-                                        tcp_fsm_reset(worker_idx, tcb);
-                                        goto done;
-                                    } else {
-                                        /* graceful_close: parse Content-Length
-                                         * and close after full body received. */
-                                        if (http_rsp_body_start(worker_idx, tcb,
-                                                plain, (uint32_t)n))
-                                            goto done;
-                                    }
-                                } else if (tcb->app_state == 6) {
-                                    /* Accumulating response body in TLS stream */
-                                    if (http_rsp_body_recv(worker_idx, tcb,
-                                                           (uint32_t)n))
-                                        goto done;
-                                }
+                                if ((tcb->app_state == 5 ||
+                                     tcb->app_state == 6) &&
+                                    http_rsp_rx(worker_idx, tcb, plain,
+                                                (uint32_t)n))
+                                    goto done;
                             }
                         }
                     }
                 }
 
-                /* ── L7: HTTP response parsing + body accumulation (plain HTTP only) ── */
-                if (tcb->app_state == 5) {
+                /* ── L7: HTTP response parsing (plain HTTP only) ── */
+                if (tcb->app_state == 5 || tcb->app_state == 6) {
                     uint32_t ci2 = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
-                    tls_session_t *ts2 = tls_session_get(worker_idx, ci2);
-                    if (!ts2) {
-                        /* Plain HTTP — parse from raw TCP payload */
-                        const uint8_t *hp =
-                            (const uint8_t *)tcp + hdr_len;
-                        if (data_len >= 12 &&
-                            memcmp(hp, "HTTP/1.", 7) == 0) {
-                            uint16_t status =
-                                (uint16_t)atoi((const char *)hp + 9);
-                            worker_metrics_add_http_rsp(worker_idx,
-                                                        status);
-                            /* Record HTTP request→response latency (CO-corrected) */
-                            if (tcb->http_req_sent_tsc) {
-                                uint64_t lat_us =
-                                    (rte_rdtsc() - tcb->http_req_sent_tsc)
-                                    * 1000000ULL / rte_get_tsc_hz();
-                                http_prebuilt_req_t *hlat2 =
-                                    (http_prebuilt_req_t *)tcb->app_ctx;
-                                uint64_t ei2 = hlat2 ? hlat2->expected_interval_us : 0;
-                                hist_record_corrected(&g_latency_hist[worker_idx],
-                                                      lat_us, ei2);
-                            }
-                        } else {
-                            worker_metrics_add_http_parse_err(
-                                worker_idx);
-                        }
-                        uint8_t nxt2 = http_next_txn(worker_idx, tcb);
-                        if (nxt2 == 4) {
-                            http_send_next_request(worker_idx, tcb);
-                        } else if (nxt2 == 7) {
-                            tcb->app_state = 7; /* think-time wait */
-                        } else if (!tcb->graceful_close) {
-                            tcp_fsm_reset(worker_idx, tcb);
-                            goto done;
-                        } else {
-                            /* graceful_close: parse Content-Length and
-                             * send FIN only after the full body arrives.
-                             * Falls back to passive close if no
-                             * Content-Length header (chunked, etc.). */
-                            if (http_rsp_body_start(worker_idx, tcb,
-                                    (const uint8_t *)tcp + hdr_len,
-                                    data_len))
-                                goto done;
-                        }
-                    }
                     /* TLS HTTP responses handled above in decrypt path */
-                } else if (tcb->app_state == 6) {
-                    /* HTTP body accumulation — only for plain HTTP.
-                     * TLS body is accumulated in the decrypt path above.
-                     * Use else-if so this block does NOT fire on the same
-                     * segment that transitions state 5→6 (which would
-                     * double-count the body bytes already tallied by
-                     * http_rsp_body_start). */
-                    uint32_t ci3 = (uint32_t)(tcb - g_tcb_stores[worker_idx].tcbs);
-                    tls_session_t *ts3 = tls_session_get(worker_idx, ci3);
-                    if (!ts3) {
-                        if (http_rsp_body_recv(worker_idx, tcb, data_len))
-                            goto done;
-                    }
+                    if (!tls_session_get(worker_idx, ci2) &&
+                        http_rsp_rx(worker_idx, tcb,
+                                    (const uint8_t *)tcp + hdr_len, data_len))
+                        goto done;
                 }
             }
         }
@@ -1131,6 +1127,12 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
          * L7 handlers above (HTTP/TLS) may have already transitioned
          * via tcp_fsm_reset()/tcp_fsm_close(), freeing the TCB. */
         if ((flags & RTE_TCP_FIN_FLAG) && tcb->state == TCP_ESTABLISHED) {
+            /* A response with neither Content-Length nor chunked
+             * framing ends with the connection. */
+            if (tcb->app_state == 6 && http11_rsp_scan_eof(&tcb->http_rsp)) {
+                http_rsp_count(worker_idx, tcb);
+                tcb->http_pipe_out = 0;
+            }
             tcb->rcv_nxt++;
             tcb->state = TCP_CLOSE_WAIT;
             tcp_send_segment(worker_idx, tcb, RTE_TCP_ACK_FLAG,
@@ -1161,6 +1163,8 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
             if (seq == tcb->rcv_nxt) {
                 tcb->rcv_nxt += dlen;
                 worker_metrics_add_tcp_payload_rx(worker_idx, dlen);
+                flow_metrics_add(worker_idx, tcb->flow_idx, tcp_payload_rx,
+                                 dlen);
             }
         }
         if (flags & RTE_TCP_FIN_FLAG) {
@@ -1173,7 +1177,9 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                  * rapid port recycling is more important than guarding
                  * against duplicate segments from old connections. */
                 tls_detach_if_needed(worker_idx, tcb);
-                tcp_port_free_immediate(worker_idx, tcb->src_ip, tcb->src_port);
+                tcp_port_free_immediate(worker_idx, tcb->steer_ctx,
+                                        tcb->src_ip, tcb->src_port);
+                flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
                 tcb_free(&g_tcb_stores[worker_idx], tcb);
                 worker_metrics_add_tcp_conn_close(worker_idx);
             } else {
@@ -1210,6 +1216,8 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
             if (seq == tcb->rcv_nxt) {
                 tcb->rcv_nxt += dlen;
                 worker_metrics_add_tcp_payload_rx(worker_idx, dlen);
+                flow_metrics_add(worker_idx, tcb->flow_idx, tcp_payload_rx,
+                                 dlen);
             }
         }
         if (flags & RTE_TCP_FIN_FLAG) {
@@ -1218,7 +1226,9 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                               NULL, 0, tcb->snd_nxt, tcb->rcv_nxt);
             /* Skip TIME_WAIT — free immediately for fast port recycling */
             tls_detach_if_needed(worker_idx, tcb);
-            tcp_port_free_immediate(worker_idx, tcb->src_ip, tcb->src_port);
+            tcp_port_free_immediate(worker_idx, tcb->steer_ctx,
+                                    tcb->src_ip, tcb->src_port);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
             worker_metrics_add_tcp_conn_close(worker_idx);
         } else if (fw2_tlen > fw2_hlen) {
@@ -1234,7 +1244,9 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
         if ((flags & RTE_TCP_ACK_FLAG) && SEQ_GE(ack, tcb->snd_nxt)) {
             /* Skip TIME_WAIT — free immediately */
             tls_detach_if_needed(worker_idx, tcb);
-            tcp_port_free_immediate(worker_idx, tcb->src_ip, tcb->src_port);
+            tcp_port_free_immediate(worker_idx, tcb->steer_ctx,
+                                    tcb->src_ip, tcb->src_port);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
             worker_metrics_add_tcp_conn_close(worker_idx);
         }
@@ -1270,7 +1282,9 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
     case TCP_LAST_ACK:
         if (flags & RTE_TCP_ACK_FLAG) {
             tls_detach_if_needed(worker_idx, tcb);
-            tcp_port_free(worker_idx, tcb->src_ip, tcb->src_port);
+            tcp_port_free(worker_idx, tcb->steer_ctx,
+                          tcb->src_ip, tcb->src_port);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
             worker_metrics_add_tcp_conn_close(worker_idx);
         }
@@ -1297,8 +1311,13 @@ void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m)
                         SEQ_LT(seq, tcb->rcv_nxt + tcb->rcv_wnd);
         }
         if (rst_valid) {
+            if (tcb->state == TCP_SYN_SENT &&
+                tcb->flow_idx != FLOW_METRICS_NONE)
+                tcp_hs_win_failed(worker_idx, tcb->flow_idx);
             tls_detach_if_needed(worker_idx, tcb);
-            tcp_port_free_immediate(worker_idx, tcb->src_ip, tcb->src_port);
+            tcp_port_free_immediate(worker_idx, tcb->steer_ctx,
+                                    tcb->src_ip, tcb->src_port);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_reset_rx);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
             worker_metrics_add_tcp_reset_rx(worker_idx);
         }
@@ -1316,12 +1335,12 @@ bad:
 tcb_t *tcp_fsm_connect(uint32_t worker_idx,
                          uint32_t src_ip, uint16_t src_port,
                          uint32_t dst_ip, uint16_t dst_port,
-                         uint16_t port_id)
+                         uint16_t port_id, uint16_t flow_idx)
 {
 
     /* Auto-allocate ephemeral port if caller passes 0 */
     if (src_port == 0) {
-        if (tcp_port_alloc(worker_idx, src_ip, &src_port) < 0)
+        if (tcp_port_alloc(worker_idx, RSS_STEER_NONE, src_ip, &src_port) < 0)
             return NULL;
     }
 
@@ -1346,6 +1365,7 @@ tcb_t *tcp_fsm_connect(uint32_t worker_idx,
     tcb->port_id      = port_id;
     tcb->active_open  = true;
     tcb->ts_enabled   = true;
+    tcb->flow_idx     = flow_idx;
     /* Pre-resolve destination MAC so all segments use cached value */
     {
         struct rte_ether_addr mac;
@@ -1356,13 +1376,17 @@ tcb_t *tcp_fsm_connect(uint32_t worker_idx,
     }
     /* Store creation time for TLS handshake timeout.
      * Reuses timewait_deadline_tsc (only used in TIME_WAIT state). */
-    tcb->timewait_deadline_tsc = rte_rdtsc();
+    tcb->syn_tsc               = rte_rdtsc();
+    tcb->timewait_deadline_tsc = tcb->syn_tsc;
 
     tcp_send_segment(worker_idx, tcb, RTE_TCP_SYN_FLAG,
                       NULL, 0, tcb->snd_nxt, 0);
     tcb->snd_nxt++;
     arm_rto(worker_idx, tcb);
     worker_metrics_add_tcp_syn_sent(worker_idx);
+    flow_metrics_inc(worker_idx, flow_idx, tcp_syn_sent);
+    if (flow_idx != FLOW_METRICS_NONE)
+        tcp_hs_win_syn_sent(worker_idx, flow_idx);
     return tcb;
 }
 
@@ -1386,14 +1410,21 @@ int tcp_fsm_close(uint32_t worker_idx, tcb_t *tcb)
 void tcp_fsm_reset(uint32_t worker_idx, tcb_t *tcb)
 {
     /* Count connection close if handshake was complete (matches conn_open) */
-    if (tcb->state >= TCP_ESTABLISHED)
+    if (tcb->state >= TCP_ESTABLISHED) {
         worker_metrics_add_tcp_conn_close(worker_idx);
+        flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
+    } else if (tcb->state == TCP_SYN_SENT &&
+               tcb->flow_idx != FLOW_METRICS_NONE) {
+        tcp_hs_win_failed(worker_idx, tcb->flow_idx);
+    }
 
     tcp_send_segment(worker_idx, tcb, RTE_TCP_RST_FLAG | RTE_TCP_ACK_FLAG,
                       NULL, 0, tcb->snd_nxt, tcb->rcv_nxt);
     tls_detach_if_needed(worker_idx, tcb);
     /* RST teardown — no TIME_WAIT required (RFC 793 §3.4) */
-    tcp_port_free_immediate(worker_idx, tcb->src_ip, tcb->src_port);
+    tcp_port_free_immediate(worker_idx, tcb->steer_ctx,
+                            tcb->src_ip, tcb->src_port);
+    flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_reset_sent);
     tcb_free(&g_tcb_stores[worker_idx], tcb);
     worker_metrics_add_tcp_reset_sent(worker_idx);
 }
@@ -1414,6 +1445,30 @@ void tcp_fsm_reset_all(uint32_t worker_idx)
         }
     }
     tcb_store_reset(store);
+    tcp_hs_win_worker_reset(worker_idx);
+    http_ol_worker_reset(worker_idx);
+    conn_pool_worker_reset(worker_idx);
+}
+
+void tcp_fsm_reset_steer(uint32_t worker_idx, uint64_t mask)
+{
+    tcb_store_t *store = &g_tcb_stores[worker_idx];
+    for (uint32_t i = 0; i < store->capacity; i++) {
+        tcb_t *tcb = &store->tcbs[i];
+        if (tcb->in_use && tcb->steer_ctx != RSS_STEER_NONE &&
+            ((mask >> (tcb->steer_ctx - 1)) & 1))
+            tcp_fsm_reset(worker_idx, tcb);
+    }
+}
+
+void tcp_fsm_reset_flow(uint32_t worker_idx, uint16_t flow_idx)
+{
+    tcb_store_t *store = &g_tcb_stores[worker_idx];
+    for (uint32_t i = 0; i < store->capacity; i++) {
+        tcb_t *tcb = &store->tcbs[i];
+        if (tcb->in_use && tcb->flow_idx == flow_idx)
+            tcp_fsm_reset(worker_idx, tcb);
+    }
 }
 
 /* ── RTO expired ──────────────────────────────────────────────────────────── */
@@ -1433,6 +1488,8 @@ void tcp_fsm_rto_expired(uint32_t worker_idx, tcb_t *tcb)
     /* Retransmit based on FSM state */
     switch (tcb->state) {
     case TCP_SYN_SENT:
+        if (tcb->flow_idx != FLOW_METRICS_NONE)
+            tcp_hs_win_syn_retx(worker_idx, tcb->flow_idx, rte_rdtsc());
         tcp_send_segment(worker_idx, tcb, RTE_TCP_SYN_FLAG,
                           NULL, 0, tcb->snd_una, 0);
         break;
@@ -1462,6 +1519,7 @@ void tcp_fsm_rto_expired(uint32_t worker_idx, tcb_t *tcb)
     }
     arm_rto(worker_idx, tcb);
     worker_metrics_add_tcp_retransmit(worker_idx);
+    flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_retransmit);
 }
 
 /* tcp_fsm_flush_delayed_acks() removed — delayed ACK flushing is now
@@ -1504,6 +1562,8 @@ int tcp_fsm_send(uint32_t worker_idx, tcb_t *tcb,
             tcb->snd_nxt += send_len;
             total_sent += send_len;
             worker_metrics_add_tcp_payload_tx(worker_idx, send_len);
+            flow_metrics_add(worker_idx, tcb->flow_idx, tcp_payload_tx,
+                             send_len);
         }
         if (total_sent > 0 && tcb->rto_deadline_tsc == 0)
             arm_rto(worker_idx, tcb);
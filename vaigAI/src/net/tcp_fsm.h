@@ -24,11 +24,12 @@ extern "C" {
  *  m's data pointer should be at start of TCP header. */
 void tcp_fsm_input(uint32_t worker_idx, struct rte_mbuf *m);
 
-/** Worker: open an active connection (client side). */
+/** Worker: open an active connection (client side) for client flow
+ *  `flow_idx` (FLOW_METRICS_NONE: counted per worker only). */
 tcb_t *tcp_fsm_connect(uint32_t worker_idx,
                          uint32_t src_ip, uint16_t src_port,
                          uint32_t dst_ip, uint16_t dst_port,
-                         uint16_t port_id);
+                         uint16_t port_id, uint16_t flow_idx);
 
 /** Worker: initiate a passive-open listener on a port. */
 int tcp_fsm_listen(uint32_t worker_idx, uint16_t local_port);
@@ -46,6 +47,14 @@ void tcp_fsm_reset(uint32_t worker_idx, tcb_t *tcb);
 /** Worker: RST all active connections and reset the TCB store + port pool. */
 void tcp_fsm_reset_all(uint32_t worker_idx);
 
+/** Worker: RST the connections on the RSS steering contexts in `mask`
+ *  (bit ctx - 1), e.g. before their port pools are re-sized. */
+void tcp_fsm_reset_steer(uint32_t worker_idx, uint64_t mask);
+
+/** Worker: RST the connections of client flow `flow_idx`, e.g. those a
+ *  previous run in the slot left behind. */
+void tcp_fsm_reset_flow(uint32_t worker_idx, uint16_t flow_idx);
+
 /** Called from timer wheel to handle RTO expiry. */
 void tcp_fsm_rto_expired(uint32_t worker_idx, tcb_t *tcb);
 
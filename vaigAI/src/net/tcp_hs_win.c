@@ -0,0 +1,185 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-flow handshake window — AIMD on SYN loss and handshake time.
+ */
+#include "tcp_hs_win.h"
+#include "../core/core_assign.h"
+#include "../common/util.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_malloc.h>
+#include <rte_log.h>
+
+tcp_hs_win_t    *g_tcp_hs_win[TGEN_MAX_WORKERS];
+tcp_hs_worker_t  g_tcp_hs_worker[TGEN_MAX_WORKERS];
+
+/* A handshake of the flow left SYN_SENT */
+static inline void
+hs_done(uint32_t worker_idx, tcp_hs_win_t *h)
+{
+    if (h->half_open == 0)
+        return;
+    h->half_open--;
+    if (g_tcp_hs_worker[worker_idx].half_open > 0)
+        g_tcp_hs_worker[worker_idx].half_open--;
+}
+
+int tcp_hs_win_init(void)
+{
+    for (uint32_t w = 0; w < g_core_map.num_workers; w++) {
+        uint32_t lcore = g_core_map.worker_lcores[w];
+        g_tcp_hs_win[w] = rte_zmalloc_socket("tcp_hs_win",
+            (size_t)TGEN_MAX_CLIENT_FLOWS * sizeof(tcp_hs_win_t),
+            RTE_CACHE_LINE_SIZE, (int)g_core_map.socket_of_lcore[lcore]);
+        if (!g_tcp_hs_win[w]) {
+            RTE_LOG(ERR, TCP, "SYN window: no memory for worker %u\n", w);
+            tcp_hs_win_destroy();
+            return -ENOMEM;
+        }
+        for (uint32_t f = 0; f < TGEN_MAX_CLIENT_FLOWS; f++) {
+            g_tcp_hs_win[w][f].win    = TCP_HS_WIN_DEFAULT;
+            g_tcp_hs_win[w][f].capped = true;
+        }
+        g_tcp_hs_worker[w].half_open = 0;
+    }
+    return 0;
+}
+
+void tcp_hs_win_destroy(void)
+{
+    for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
+        rte_free(g_tcp_hs_win[w]);
+        g_tcp_hs_win[w] = NULL;
+    }
+}
+
+void tcp_hs_win_start(uint32_t worker_idx, uint32_t flow_idx,
+                      uint32_t win_max, bool adaptive)
+{
+    tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    uint32_t half_open = h->half_open;
+
+    memset(h, 0, sizeof(*h));
+    h->half_open      = half_open;
+    h->half_open_peak = half_open;
+    h->win_max        = win_max ? win_max : TCP_HS_WIN_DEFAULT;
+    h->capped         = win_max == 0;
+    h->adaptive       = adaptive;
+    if (adaptive) {
+        h->win      = TGEN_MIN(TCP_HS_WIN_INIT, h->win_max);
+        h->ssthresh = h->win_max;
+    } else {
+        h->win      = h->win_max;
+    }
+    h->win_peak = h->win;
+}
+
+/* Multiplicative decrease, once per smoothed handshake time.  Returns
+ * whether it was applied. */
+static bool
+hs_cut(tcp_hs_win_t *h, uint32_t num, uint32_t den, uint64_t now)
+{
+    uint64_t hold = (uint64_t)TGEN_MAX(h->srtt_us, 1000u) *
+                    (g_tsc_hz / 1000000);
+    if (h->last_cut_tsc && now - h->last_cut_tsc < hold)
+        return false;
+    h->last_cut_tsc = now;
+    h->win = TGEN_MAX((uint32_t)((uint64_t)h->win * num / den),
+                      TCP_HS_WIN_MIN);
+    h->ssthresh     = h->win;
+    h->acked_in_win = 0;
+    return true;
+}
+
+void tcp_hs_win_established(uint32_t worker_idx, uint32_t flow_idx,
+                            uint32_t lat_us, bool clean, uint64_t now)
+{
+    tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    hs_done(worker_idx, h);
+    h->syn_acked++;
+    if (!h->adaptive)
+        return;
+
+    if (clean) {
+        if (h->base_us == 0 || lat_us < h->base_us)
+            h->base_us = lat_us ? lat_us : 1;
+        h->srtt_us = h->srtt_us == 0 ? lat_us
+                   : h->srtt_us - (h->srtt_us >> 3) + (lat_us >> 3);
+        if (h->srtt_us > 2 * h->base_us + TCP_HS_WIN_SLACK_US) {
+            if (hs_cut(h, 7, 8, now))
+                h->cuts_delay++;
+            return;
+        }
+    }
+
+    if (h->win >= h->win_max)
+        return;
+    if (h->win < h->ssthresh) {
+        h->win++;
+    } else if (++h->acked_in_win >= h->win) {
+        h->acked_in_win = 0;
+        h->win++;
+    }
+    if (h->win > h->win_peak)
+        h->win_peak = h->win;
+}
+
+void tcp_hs_win_syn_retx(uint32_t worker_idx, uint32_t flow_idx,
+                         uint64_t now)
+{
+    tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    h->syn_lost++;
+    if (!h->adaptive)
+        return;
+    if (hs_cut(h, 1, 2, now))
+        h->cuts_loss++;
+}
+
+void tcp_hs_win_failed(uint32_t worker_idx, uint32_t flow_idx)
+{
+    tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    hs_done(worker_idx, h);
+    h->syn_failed++;
+}
+
+void tcp_hs_win_worker_reset(uint32_t worker_idx)
+{
+    if (!g_tcp_hs_win[worker_idx])
+        return;
+    for (uint32_t f = 0; f < TGEN_MAX_CLIENT_FLOWS; f++)
+        g_tcp_hs_win[worker_idx][f].half_open = 0;
+    g_tcp_hs_worker[worker_idx].half_open = 0;
+}
+
+void tcp_hs_win_report(uint32_t flow_idx, uint32_t n_workers,
+                       tcp_hs_win_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    uint64_t srtt_sum = 0;
+    uint32_t srtt_n   = 0;
+
+    for (uint32_t w = 0; w < n_workers; w++) {
+        if (!g_tcp_hs_win[w])
+            continue;
+        const tcp_hs_win_t *h = &g_tcp_hs_win[w][flow_idx];
+        out->adaptive       |= h->adaptive;
+        out->win_max         = TGEN_MAX(out->win_max, h->win_max);
+        out->win            += h->win;
+        out->win_peak       += h->win_peak;
+        out->half_open      += h->half_open;
+        out->half_open_peak += h->half_open_peak;
+        out->syn_acked      += h->syn_acked;
+        out->syn_lost       += h->syn_lost;
+        out->syn_failed     += h->syn_failed;
+        out->cuts_loss      += h->cuts_loss;
+        out->cuts_delay     += h->cuts_delay;
+        if (h->base_us && (out->base_us == 0 || h->base_us < out->base_us))
+            out->base_us = h->base_us;
+        if (h->srtt_us) {
+            srtt_sum += h->srtt_us;
+            srtt_n++;
+        }
+    }
+    out->srtt_us = srtt_n ? (uint32_t)(srtt_sum / srtt_n) : 0;
+}
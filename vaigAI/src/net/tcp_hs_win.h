@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: per-flow window on in-flight TCP handshakes.
+ *
+ * A TCP/HTTP/L7 client flow may only open a connection while the
+ * number of its handshakes still in SYN_SENT on this worker is below its
+ * window.  The half-open count is exact: it rises in tcp_fsm_connect()
+ * and falls when the TCB leaves SYN_SENT (SYN-ACK, RST, retry limit or
+ * store reset), so long-lived established connections no longer count
+ * against the opening rate.
+ *
+ * `start --syn-window N` fixes the window at N.  `--syn-window auto[:N]`
+ * runs AIMD on it, capped at N:
+ *
+ *   increase   slow start (+1 per SYN-ACK) up to ssthresh, then +1 per
+ *              window's worth of SYN-ACKs
+ *   loss       a SYN retransmit halves the window (≥ TCP_HS_WIN_MIN)
+ *   delay      a smoothed SYN→SYN-ACK time above twice the minimum seen
+ *              (+ TCP_HS_WIN_SLACK_US) takes 1/8 off
+ *
+ * Each decrease also sets ssthresh, and at most one is applied per
+ * smoothed handshake time, so a burst of losses from one queue overflow
+ * counts once.  The steady state is Little's law on the DUT: window ≈
+ * accept rate × handshake time, held just below the point where the
+ * handshake time starts to grow.  Latency is sampled only from SYNs that
+ * were not retransmitted (Karn).
+ *
+ * The window is per flow and per worker.  Flows without an explicit N
+ * (no --syn-window, or plain `auto`) are in addition held together under
+ * TCP_HS_WIN_WORKER_MAX half-open handshakes per worker, as all opens
+ * were before windows were per flow, so many default flows on one worker
+ * do not multiply the burst a DUT sees.
+ *
+ * State is per (worker, flow), written only by the owning worker;
+ * management aggregates it racily for telemetry.
+ */
+#ifndef TGEN_TCP_HS_WIN_H
+#define TGEN_TCP_HS_WIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rte_common.h>
+#include "../common/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TCP_HS_WIN_DEFAULT   4096u   /* fixed window without --syn-window */
+#define TCP_HS_WIN_WORKER_MAX 4096u  /* worker ceiling, default-window flows */
+#define TCP_HS_WIN_MIN       2u      /* adaptive floor                    */
+#define TCP_HS_WIN_INIT      16u     /* adaptive initial window/ssthresh  */
+#define TCP_HS_WIN_SLACK_US  100u    /* delay-signal allowance over 2×min */
+
+/** One flow's window on one worker; single writer. */
+typedef struct {
+    uint32_t half_open;        /* connections of this flow in SYN_SENT */
+    uint32_t win;              /* current window                       */
+    uint32_t win_max;
+    uint32_t ssthresh;
+    uint32_t acked_in_win;     /* SYN-ACKs since the last +1 (CA)      */
+    bool     adaptive;
+    bool     capped;           /* no explicit N: under the worker max  */
+    uint32_t base_us;          /* minimum SYN→SYN-ACK (0 = no sample)  */
+    uint32_t srtt_us;          /* EWMA, gain 1/8                       */
+    uint64_t last_cut_tsc;
+    /* Telemetry since START */
+    uint64_t syn_acked;        /* handshakes completed                 */
+    uint64_t syn_lost;         /* SYN retransmits                      */
+    uint64_t syn_failed;       /* RST or retries exhausted in SYN_SENT */
+    uint64_t cuts_loss;
+    uint64_t cuts_delay;
+    uint32_t win_peak;
+    uint32_t half_open_peak;
+} __rte_cache_aligned tcp_hs_win_t;
+
+/** Aggregated view of one flow over all workers (management thread). */
+typedef struct {
+    bool     adaptive;
+    uint32_t win_max;          /* per worker                           */
+    uint32_t win;              /* Σ current windows                    */
+    uint32_t win_peak;         /* Σ per-worker peaks                   */
+    uint32_t half_open;
+    uint32_t half_open_peak;
+    uint32_t base_us;          /* min over workers                     */
+    uint32_t srtt_us;          /* mean over workers with samples       */
+    uint64_t syn_acked;
+    uint64_t syn_lost;
+    uint64_t syn_failed;
+    uint64_t cuts_loss;
+    uint64_t cuts_delay;
+} tcp_hs_win_report_t;
+
+/** [worker] → TGEN_MAX_CLIENT_FLOWS entries, on the worker's socket. */
+extern tcp_hs_win_t *g_tcp_hs_win[TGEN_MAX_WORKERS];
+
+/** Half-open handshakes of all flows on one worker; single writer. */
+typedef struct {
+    uint32_t half_open;
+} __rte_cache_aligned tcp_hs_worker_t;
+
+extern tcp_hs_worker_t g_tcp_hs_worker[TGEN_MAX_WORKERS];
+
+/** Allocate the per-worker tables.  Returns 0 or -ENOMEM. */
+int  tcp_hs_win_init(void);
+void tcp_hs_win_destroy(void);
+
+/** Worker, on START: reset the flow's window and telemetry.  win_max 0
+ *  selects TCP_HS_WIN_DEFAULT and the TCP_HS_WIN_WORKER_MAX ceiling.
+ *  The half-open count carries over. */
+void tcp_hs_win_start(uint32_t worker_idx, uint32_t flow_idx,
+                      uint32_t win_max, bool adaptive);
+
+/** Worker: handshakes the flow may start now. */
+static inline uint32_t
+tcp_hs_win_room(uint32_t worker_idx, uint32_t flow_idx)
+{
+    const tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    uint32_t room = h->half_open < h->win ? h->win - h->half_open : 0;
+    if (h->capped) {
+        uint32_t all = g_tcp_hs_worker[worker_idx].half_open;
+        room = TGEN_MIN(room, all < TCP_HS_WIN_WORKER_MAX
+                              ? TCP_HS_WIN_WORKER_MAX - all : 0u);
+    }
+    return room;
+}
+
+/** Worker: a SYN of the flow went out for a new connection. */
+static inline void
+tcp_hs_win_syn_sent(uint32_t worker_idx, uint32_t flow_idx)
+{
+    tcp_hs_win_t *h = &g_tcp_hs_win[worker_idx][flow_idx];
+    if (++h->half_open > h->half_open_peak)
+        h->half_open_peak = h->half_open;
+    g_tcp_hs_worker[worker_idx].half_open++;
+}
+
+/** Worker: SYN_SENT → ESTABLISHED.  `lat_us` is valid when `clean`
+ *  (the SYN was never retransmitted). */
+void tcp_hs_win_established(uint32_t worker_idx, uint32_t flow_idx,
+                            uint32_t lat_us, bool clean, uint64_t now);
+
+/** Worker: the SYN timed out and is being resent. */
+void tcp_hs_win_syn_retx(uint32_t worker_idx, uint32_t flow_idx,
+                         uint64_t now);
+
+/** Worker: a connection left SYN_SENT without completing. */
+void tcp_hs_win_failed(uint32_t worker_idx, uint32_t flow_idx);
+
+/** Worker: every TCB was dropped (store reset) — no handshakes remain. */
+void tcp_hs_win_worker_reset(uint32_t worker_idx);
+
+/** Management: aggregate a flow over `n_workers`. */
+void tcp_hs_win_report(uint32_t flow_idx, uint32_t n_workers,
+                       tcp_hs_win_report_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_TCP_HS_WIN_H */
@@ -3,16 +3,36 @@
  *
  * Design
  * ------
- * Each worker has a flat bitmap of TGEN_EPHEM_CNT bits (one per port
- * in [10000, 60000)).  Allocation is a simple linear scan starting at
- * a per-worker cursor, so the amortised cost is O(1) under normal load.
+ * Each pool is a hierarchical bitmap over TGEN_EPHEM_CNT ports (one bit
+ * per port in [10000, 60000)):
+ *
+ *   root            1 word   bit s set → sum[s]  != 0
+ *   sum[SUM_WORDS]  13 words bit l set → leaf[l] != 0
+ *   leaf[LEAF_WORDS] 782 words bit b set → port available
+ *
+ * Finding the next free port at or after the cursor costs at most three
+ * tzcnt (__builtin_ctzll) probes — leaf word, summary word, root word —
+ * regardless of occupancy, so allocation stays O(1) even when 95% of the
+ * range is in use.  Set/clear keep the summary levels in sync.
  *
  * Per-IP independence (§3.3)
  * --------------------------
- * The spec calls for per-IP port pools. We implement this with a small
- * open-addressing hash table (64 slots per worker).  Each slot stores a
- * separate bitmap + cursor for one src_ip.  If the table is full we fall
- * back to the shared pool (harmless for correctness).
+ * For every RSS steering context (one client target, see rss_steer.h)
+ * each worker owns an array of per-IP pools indexed directly by the
+ * offset of src_ip within the context's source range (see
+ * tcp_port_pool_set_range(), up to TGEN_PP_MAX_SRC_IPS addresses).
+ * Management only stages the range; each worker sizes its own array in
+ * tcp_port_pool_apply() when it STARTs a flow on the context, so no
+ * array is ever freed under the worker using it.  A worker holds at most
+ * TGEN_PP_MAX_SRC_IPS per-IP pools over all contexts (~6.4 KB each);
+ * arrays of contexts it runs no flow on are reclaimed first.  A
+ * per-IP pool is seeded lazily the first time its IP is used after a
+ * reset (generation check) with exactly the ports whose return traffic
+ * the NIC delivers to this worker — by RSS, or by rte_flow rules on the
+ * port's low bits in flow mode, where every IP gets the same fixed
+ * stride of ports — so availability and queue affinity live in one
+ * bitmap.  Context 0 and IPs outside the range fall back to the
+ * unfiltered shared pool.
  *
  * TIME_WAIT hold-off
  * ------------------
@@ -21,10 +41,13 @@
  */
 
 #include "tcp_port_pool.h"
+#include "rss_steer.h"
 #include "../common/util.h"
+#include "../core/core_assign.h"
 #include <rte_malloc.h>
 #include <rte_log.h>
 #include <rte_atomic.h>
+#include <rte_byteorder.h>
 #include <string.h>
 
 #define RTE_LOGTYPE_TGEN_PP RTE_LOGTYPE_USER4
@@ -35,14 +58,19 @@
 #endif
 
 /* ------------------------------------------------------------------ */
-/* Per-IP slot                                                           */
+/* Per-IP pool (hierarchical bitmap)                                    */
 /* ------------------------------------------------------------------ */
-#define BITMAP_WORDS ((TGEN_EPHEM_CNT + 63) / 64)
+#define LEAF_WORDS ((TGEN_EPHEM_CNT + 63) / 64)
+#define SUM_WORDS  ((LEAF_WORDS + 63) / 64)
+
+_Static_assert(SUM_WORDS <= 64, "root summary must fit in one word");
 
 typedef struct {
-    uint32_t  src_ip;           /* 0 → slot free */
+    uint32_t  gen;              /* seeded when == pp_range_t.gen */
     uint32_t  cursor;           /* next scan position */
-    uint64_t  map[BITMAP_WORDS];/* 1 = available */
+    uint64_t  root;             /* 1 = sum word non-empty */
+    uint64_t  sum[SUM_WORDS];   /* 1 = leaf word non-empty */
+    uint64_t  leaf[LEAF_WORDS]; /* 1 = available */
 } ip_pool_t;
 
 /* ------------------------------------------------------------------ */
@@ -54,17 +82,36 @@ typedef struct {
 typedef struct {
     uint32_t  src_ip;
     uint16_t  port;             /* host byte order */
+    uint8_t   ctx;              /* steering context of the pool */
     uint64_t  release_tsc;      /* TSC at which to re-enable */
 } tw_entry_t;
 
 /* ------------------------------------------------------------------ */
 /* Per-worker state                                                     */
 /* ------------------------------------------------------------------ */
-#define N_IP_SLOTS 64u
+typedef struct {
+    ip_pool_t *ip_pools;            /* indexed by (src_ip - ip_base) */
+    uint32_t   ip_base;             /* host byte order */
+    uint32_t   ip_count;            /* IPs in ip_pools (the range, or
+                                     * fewer if the budget ran out) */
+    uint32_t   gen;                 /* bumped on reset → lazy re-seed */
+    uint32_t   epoch;               /* pp_stage_t.epoch applied */
+} pp_range_t;
+
+/* Source range of a context as management staged it, [ctx - 1].
+ * Workers copy it into their pp_range_t in tcp_port_pool_apply(). */
+typedef struct {
+    uint32_t   ip_base;             /* host byte order */
+    uint32_t   ip_count;
+    uint32_t   epoch;               /* bumped per set_range, 0 = never */
+} pp_stage_t;
 
 typedef struct {
-    ip_pool_t  ip_pools[N_IP_SLOTS];
-    ip_pool_t  shared;              /* fallback when ip_pools full */
+    uint32_t   worker_idx;
+    ip_pool_t  shared;              /* ctx 0 / IPs outside every range */
+
+    /* Per-IP pools of each steering context, [ctx - 1] */
+    pp_range_t ranges[RSS_STEER_MAX_CTX];
 
     /* TIME_WAIT ring (SPSC — same lcore writes & reads) */
     tw_entry_t tw_ring[TW_RING_SIZE];
@@ -72,6 +119,8 @@ typedef struct {
     uint32_t   tw_tail;
 
     uint64_t   tw_hold_tsc;         /* TGEN_TCP_TIMEWAIT_MS in TSC cycles */
+    uint32_t   ip_total;            /* per-IP pools allocated, all ctxs */
+    int        socket_id;
 
     /* stat */
     uint64_t   port_exhaustion_events;
@@ -81,98 +130,129 @@ typedef struct {
 /* Global array                                                         */
 /* ------------------------------------------------------------------ */
 static worker_pool_t *g_pools[TGEN_MAX_WORKERS];
+static pp_stage_t     g_stage[RSS_STEER_MAX_CTX];
 
 /* ------------------------------------------------------------------ */
-/* Helpers — bitmap                                                     */
+/* Helpers — hierarchical bitmap                                        */
 /* ------------------------------------------------------------------ */
 static inline void
-bm_set(uint64_t *map, uint32_t bit)
+pp_set(ip_pool_t *p, uint32_t bit)
 {
-    map[bit >> 6] |=  (1ull << (bit & 63));
+    uint32_t lw = bit >> 6;
+    uint32_t sw = lw >> 6;
+    p->leaf[lw] |= (1ull << (bit & 63));
+    p->sum[sw]  |= (1ull << (lw & 63));
+    p->root     |= (1ull << sw);
 }
 
 static inline void
-bm_clear(uint64_t *map, uint32_t bit)
+pp_clear(ip_pool_t *p, uint32_t bit)
 {
-    map[bit >> 6] &= ~(1ull << (bit & 63));
+    uint32_t lw = bit >> 6;
+    uint32_t sw = lw >> 6;
+    p->leaf[lw] &= ~(1ull << (bit & 63));
+    if (p->leaf[lw] == 0) {
+        p->sum[sw] &= ~(1ull << (lw & 63));
+        if (p->sum[sw] == 0)
+            p->root &= ~(1ull << sw);
+    }
 }
 
-static inline int
-bm_test(const uint64_t *map, uint32_t bit)
+/** Recompute both summary levels from the leaf words. */
+static void
+pp_rebuild(ip_pool_t *p)
 {
-    return (map[bit >> 6] >> (bit & 63)) & 1u;
+    memset(p->sum, 0, sizeof(p->sum));
+    p->root = 0;
+    for (uint32_t lw = 0; lw < LEAF_WORDS; lw++) {
+        if (p->leaf[lw]) {
+            p->sum[lw >> 6] |= (1ull << (lw & 63));
+            p->root         |= (1ull << (lw >> 6));
+        }
+    }
 }
 
-/** Find the next set bit at or after 'start', wrapping once.
- *  Uses __builtin_ctzll for word-granularity scanning (O(words) vs O(bits)). */
+/** Mark every port in the ephemeral range available. */
+static void
+pp_fill(ip_pool_t *p)
+{
+    memset(p->leaf, 0xff, sizeof(p->leaf));
+    /* Bits past TGEN_EPHEM_CNT in the last word must never be handed out */
+    if (TGEN_EPHEM_CNT & 63)
+        p->leaf[LEAF_WORDS - 1] = (1ull << (TGEN_EPHEM_CNT & 63)) - 1;
+    pp_rebuild(p);
+    p->cursor = 0;
+}
+
+/** Find the next available bit at or after 'start', wrapping once.
+ *  At most one probe per level: leaf word, summary word, root word. */
 static int
-bm_find_next(const uint64_t *map, uint32_t start, uint32_t *out)
+pp_find_next(const ip_pool_t *p, uint32_t start, uint32_t *out)
 {
-    uint32_t total_words = BITMAP_WORDS;
-
-    /* Start word and bit offset within that word */
-    uint32_t w = start >> 6;
-    uint32_t b = start & 63;
-
-    /* Phase 1: scan from 'start' to end of bitmap */
-    /* First partial word: mask off bits below 'b' */
-    uint64_t masked = map[w] & (~0ULL << b);
-    if (masked) {
-        uint32_t pos = (w << 6) + (uint32_t)__builtin_ctzll(masked);
-        if (pos < TGEN_EPHEM_CNT) { *out = pos; return 0; }
+    uint32_t lw = start >> 6;
+    uint64_t m  = p->leaf[lw] & (~0ull << (start & 63));
+    if (m) {
+        *out = (lw << 6) + (uint32_t)__builtin_ctzll(m);
+        return 0;
     }
-    for (uint32_t i = w + 1; i < total_words; i++) {
-        if (map[i]) {
-            uint32_t pos = (i << 6) + (uint32_t)__builtin_ctzll(map[i]);
-            if (pos < TGEN_EPHEM_CNT) { *out = pos; return 0; }
+
+    /* Next non-empty leaf word after lw within the same summary word */
+    uint32_t nlw = lw + 1;
+    if (nlw < LEAF_WORDS) {
+        uint32_t sw = nlw >> 6;
+        m = p->sum[sw] & (~0ull << (nlw & 63));
+        if (m) {
+            lw = (sw << 6) + (uint32_t)__builtin_ctzll(m);
+            goto found;
+        }
+        /* Next non-empty summary word */
+        if (sw + 1 < SUM_WORDS) {
+            m = p->root & (~0ull << (sw + 1));
+            if (m) {
+                sw = (uint32_t)__builtin_ctzll(m);
+                lw = (sw << 6) + (uint32_t)__builtin_ctzll(p->sum[sw]);
+                goto found;
+            }
         }
     }
 
-    /* Phase 2: wrap around from beginning to 'start' word */
-    for (uint32_t i = 0; i <= w; i++) {
-        uint64_t word = map[i];
-        if (i == w) word &= ~(~0ULL << b); /* mask off bits at/above 'b' */
-        if (word) {
-            uint32_t pos = (i << 6) + (uint32_t)__builtin_ctzll(word);
-            if (pos < TGEN_EPHEM_CNT) { *out = pos; return 0; }
-        }
+    /* Wrap: lowest available bit overall */
+    if (p->root == 0)
+        return -1; /* exhausted */
+    {
+        uint32_t sw = (uint32_t)__builtin_ctzll(p->root);
+        lw = (sw << 6) + (uint32_t)__builtin_ctzll(p->sum[sw]);
     }
 
-    return -1; /* exhausted */
+found:
+    *out = (lw << 6) + (uint32_t)__builtin_ctzll(p->leaf[lw]);
+    return 0;
 }
 
 /* ------------------------------------------------------------------ */
-/* Helpers — per-IP slot lookup                                         */
+/* Helpers — per-IP pool lookup                                         */
 /* ------------------------------------------------------------------ */
 static ip_pool_t *
-ip_pool_get(worker_pool_t *wp, uint32_t src_ip)
+ip_pool_get(worker_pool_t *wp, uint8_t ctx, uint32_t src_ip)
 {
-    if (src_ip == 0)
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX || src_ip == 0)
         return &wp->shared;
 
-    /* FNV-1a scramble → slot */
-    uint32_t h = src_ip ^ 0x811c9dc5u;
-    h = (h ^ (h >> 16)) * 0x45d9f3bu;
-    h ^= (h >> 16);
-    uint32_t start = h % N_IP_SLOTS;
-
-    for (uint32_t i = 0; i < N_IP_SLOTS; i++) {
-        uint32_t s = (start + i) % N_IP_SLOTS;
-        if (wp == NULL) break; /* safety */
-        ip_pool_t *p = &wp->ip_pools[s];
-        if (p->src_ip == src_ip)
-            return p;
-        if (p->src_ip == 0) {
-            /* Empty slot: claim it — inherit shared pool's bitmap
-             * so RSS queue affinity filtering is preserved. */
-            p->src_ip = src_ip;
-            memcpy(p->map, wp->shared.map, sizeof(p->map));
-            p->cursor = 0;
-            return p;
-        }
+    pp_range_t *r = &wp->ranges[ctx - 1];
+    uint32_t off = rte_be_to_cpu_32(src_ip) - r->ip_base;
+    if (off >= r->ip_count)
+        return &wp->shared;
+
+    ip_pool_t *p = &r->ip_pools[off];
+    if (p->gen != r->gen) {
+        /* First use since reset: only the ports whose return traffic
+         * RSS delivers to this worker are available. */
+        rss_steer_fill_ports(ctx, wp->worker_idx, src_ip, p->leaf);
+        pp_rebuild(p);
+        p->cursor = 0;
+        p->gen    = r->gen;
     }
-    /* Table full — use shared pool */
-    return &wp->shared;
+    return p;
 }
 
 /* ------------------------------------------------------------------ */
@@ -185,18 +265,26 @@ tcp_port_pool_init(uint32_t n_workers)
 
     if (n_workers == 0 || n_workers > TGEN_MAX_WORKERS)
         n_workers = TGEN_MAX_WORKERS;
+    memset(g_stage, 0, sizeof(g_stage));
 
     for (uint32_t w = 0; w < n_workers; w++) {
+        int socket = SOCKET_ID_ANY;
+        if (w < g_core_map.num_workers)
+            socket = (int)g_core_map.socket_of_lcore[
+                              g_core_map.worker_lcores[w]];
         worker_pool_t *wp = rte_zmalloc_socket("port_pool",
-                sizeof(worker_pool_t), RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+                sizeof(worker_pool_t), RTE_CACHE_LINE_SIZE, socket);
         if (!wp) {
             RTE_LOG(ERR, TGEN_PP, "OOM worker port pool %u\n", w);
             return -ENOMEM;
         }
-        /* Mark all ports available in each IP slot */
-        memset(wp->shared.map, 0xff, sizeof(wp->shared.map));
-        for (uint32_t s = 0; s < N_IP_SLOTS; s++)
-            memset(wp->ip_pools[s].map, 0xff, sizeof(wp->ip_pools[s].map));
+        /* Mark all ports available; per-IP pools are allocated by
+         * tcp_port_pool_set_range() and seeded lazily (gen 0 ≠ 1). */
+        wp->worker_idx = w;
+        wp->socket_id  = socket;
+        pp_fill(&wp->shared);
+        for (uint32_t c = 0; c < RSS_STEER_MAX_CTX; c++)
+            wp->ranges[c].gen = 1;
 
         wp->tw_hold_tsc = (uint64_t)TGEN_TCP_TIMEWAIT_MS * g_tsc_hz / 1000u;
         g_pools[w] = wp;
@@ -208,53 +296,196 @@ void
 tcp_port_pool_fini(void)
 {
     for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
+        if (g_pools[w])
+            for (uint32_t c = 0; c < RSS_STEER_MAX_CTX; c++)
+                rte_free(g_pools[w]->ranges[c].ip_pools);
         rte_free(g_pools[w]);
         g_pools[w] = NULL;
     }
 }
 
+int
+tcp_port_pool_set_range(uint8_t ctx, uint32_t base_ip, uint32_t count)
+{
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX)
+        return -EINVAL;
+    if (count == 0)
+        count = 1;
+    if (count > TGEN_PP_MAX_SRC_IPS) {
+        RTE_LOG(WARNING, TGEN_PP,
+                "src IP range %u clamped to %u per-IP pools\n",
+                count, TGEN_PP_MAX_SRC_IPS);
+        count = TGEN_PP_MAX_SRC_IPS;
+    }
+
+    pp_stage_t *sg = &g_stage[ctx - 1];
+    sg->ip_base  = rte_be_to_cpu_32(base_ip);
+    sg->ip_count = count;
+    uint32_t epoch = sg->epoch + 1;
+    __atomic_store_n(&sg->epoch, epoch ? epoch : 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+bool
+tcp_port_pool_stale(uint32_t worker_idx, uint8_t ctx)
+{
+    if (ctx == RSS_STEER_NONE || ctx > RSS_STEER_MAX_CTX ||
+        !g_pools[worker_idx])
+        return false;
+    return g_pools[worker_idx]->ranges[ctx - 1].epoch !=
+           __atomic_load_n(&g_stage[ctx - 1].epoch, __ATOMIC_ACQUIRE);
+}
+
+/* True if the entry's port came from a per-IP pool of its context's
+ * current (applied) range, rather than from the shared pool. */
+static bool
+tw_in_range(const worker_pool_t *wp, const tw_entry_t *e)
+{
+    if (e->ctx == RSS_STEER_NONE || e->ctx > RSS_STEER_MAX_CTX ||
+        e->src_ip == 0)
+        return false;
+    const pp_range_t *r = &wp->ranges[e->ctx - 1];
+    return rte_be_to_cpu_32(e->src_ip) - r->ip_base < r->ip_count;
+}
+
+/* Flush the TIME_WAIT entries of the contexts in `mask` (bit ctx - 1),
+ * whose ranges are about to be freed: ports of their per-IP pools are
+ * dropped with the pools, ports of the shared pool stay queued for it.
+ * Called before range_free(), while the old ranges are still known. */
+static void
+tw_drop(worker_pool_t *wp, uint64_t mask)
+{
+    uint32_t out = wp->tw_head;
+    for (uint32_t i = wp->tw_head; i != wp->tw_tail;
+         i = (i + 1) & TW_RING_MASK) {
+        tw_entry_t e = wp->tw_ring[i];
+        if (e.ctx != RSS_STEER_NONE && (mask >> (e.ctx - 1)) & 1) {
+            if (tw_in_range(wp, &e))
+                continue;
+            e.ctx = RSS_STEER_NONE;
+        }
+        wp->tw_ring[out] = e;
+        out = (out + 1) & TW_RING_MASK;
+    }
+    wp->tw_tail = out;
+}
+
+/* Pool a TIME_WAIT entry's port goes back to, or NULL if it belonged to
+ * a per-IP pool of a context since rebuilt for another target: that
+ * pool is dropped by the next tcp_port_pool_apply(), and the port may
+ * not even be this worker's under the new target. */
+static ip_pool_t *
+tw_pool(worker_pool_t *wp, const tw_entry_t *e)
+{
+    if (tw_in_range(wp, e) && tcp_port_pool_stale(wp->worker_idx, e->ctx))
+        return NULL;
+    return ip_pool_get(wp, e->ctx, e->src_ip);
+}
+
+static void
+range_free(worker_pool_t *wp, uint8_t ctx)
+{
+    pp_range_t *r = &wp->ranges[ctx - 1];
+    rte_free(r->ip_pools);
+    wp->ip_total -= r->ip_count;
+    r->ip_pools = NULL;
+    r->ip_count = 0;
+    r->epoch    = 0;
+}
+
+int
+tcp_port_pool_apply(uint32_t worker_idx, uint8_t ctx, uint64_t live)
+{
+    if (!tcp_port_pool_stale(worker_idx, ctx))
+        return 0;
+    worker_pool_t *wp = g_pools[worker_idx];
+    const pp_stage_t *sg = &g_stage[ctx - 1];
+    uint32_t epoch = __atomic_load_n(&sg->epoch, __ATOMIC_ACQUIRE);
+    uint32_t want  = sg->ip_count;
+
+    uint64_t dropped = 1ull << (ctx - 1);
+    uint32_t total   = wp->ip_total - wp->ranges[ctx - 1].ip_count;
+
+    /* Over budget: reclaim the contexts this worker runs no flow on */
+    for (uint8_t c = 1; c <= RSS_STEER_MAX_CTX &&
+                        total + want > TGEN_PP_MAX_SRC_IPS; c++) {
+        if (c == ctx || ((live >> (c - 1)) & 1) ||
+            !wp->ranges[c - 1].ip_pools)
+            continue;
+        total -= wp->ranges[c - 1].ip_count;
+        dropped |= 1ull << (c - 1);
+    }
+    tw_drop(wp, dropped);
+    for (uint8_t c = 1; c <= RSS_STEER_MAX_CTX; c++)
+        if ((dropped >> (c - 1)) & 1)
+            range_free(wp, c);
+
+    uint32_t count = TGEN_MIN(want, TGEN_PP_MAX_SRC_IPS - wp->ip_total);
+    if (count < want)
+        RTE_LOG(WARNING, TGEN_PP,
+                "worker %u: %u of %u source IPs get a per-IP port pool\n",
+                worker_idx, count, want);
+    pp_range_t *r = &wp->ranges[ctx - 1];
+    if (count) {
+        r->ip_pools = rte_zmalloc_socket("port_pool_ip",
+                (size_t)count * sizeof(ip_pool_t),
+                RTE_CACHE_LINE_SIZE, wp->socket_id);
+        if (!r->ip_pools) {
+            RTE_LOG(ERR, TGEN_PP,
+                    "OOM per-IP port pools worker=%u count=%u\n",
+                    worker_idx, count);
+            return -ENOMEM;
+        }
+    }
+    r->ip_base  = sg->ip_base;
+    r->ip_count = count;
+    r->gen++;  /* zeroed pools have gen 0: seed on first use */
+    if (r->gen == 0)
+        r->gen = 1;
+    r->epoch    = epoch;
+    wp->ip_total += count;
+    return 0;
+}
+
 void
 tcp_port_pool_reset(uint32_t worker_idx)
 {
     worker_pool_t *wp = g_pools[worker_idx];
     if (!wp) return;
     /* Mark all ports available */
-    memset(wp->shared.map, 0xff, sizeof(wp->shared.map));
-    wp->shared.cursor = 0;
-    /* Clear per-IP pools so they reinitialize from shared.map
-     * (which may have RSS filtering applied after this reset). */
-    for (uint32_t s = 0; s < N_IP_SLOTS; s++) {
-        wp->ip_pools[s].src_ip = 0;
-        memset(wp->ip_pools[s].map, 0, sizeof(wp->ip_pools[s].map));
-        wp->ip_pools[s].cursor = 0;
-    }
+    pp_fill(&wp->shared);
+    /* Invalidate per-IP pools so they re-seed on next use */
+    for (uint32_t c = 0; c < RSS_STEER_MAX_CTX; c++)
+        wp->ranges[c].gen++;
     /* Drain TIME_WAIT ring */
     wp->tw_head = 0;
     wp->tw_tail = 0;
 }
 
 int
-tcp_port_alloc(uint32_t worker_idx, uint32_t src_ip, uint16_t *port)
+tcp_port_alloc(uint32_t worker_idx, uint8_t ctx, uint32_t src_ip,
+               uint16_t *port)
 {
     worker_pool_t *wp = g_pools[worker_idx];
-    ip_pool_t     *ip = ip_pool_get(wp, src_ip);
+    ip_pool_t     *ip = ip_pool_get(wp, ctx, src_ip);
     uint32_t       bit;
 
-    if (bm_find_next(ip->map, ip->cursor, &bit) < 0) {
+    if (pp_find_next(ip, ip->cursor, &bit) < 0) {
         wp->port_exhaustion_events++;
         RTE_LOG(WARNING, TGEN_PP,
                 "Port exhaustion worker=%u src_ip=%u\n", worker_idx, src_ip);
         return -ENOBUFS;
     }
 
-    bm_clear(ip->map, bit);
+    pp_clear(ip, bit);
     ip->cursor = (bit + 1) % TGEN_EPHEM_CNT;
     *port = (uint16_t)(TGEN_EPHEM_LO + bit);
     return 0;
 }
 
 void
-tcp_port_free(uint32_t worker_idx, uint32_t src_ip, uint16_t port)
+tcp_port_free(uint32_t worker_idx, uint8_t ctx, uint32_t src_ip,
+              uint16_t port)
 {
     extern uint64_t g_tsc_hz;
     worker_pool_t *wp = g_pools[worker_idx];
@@ -266,26 +497,28 @@ tcp_port_free(uint32_t worker_idx, uint32_t src_ip, uint16_t port)
     uint32_t next_tail = (wp->tw_tail + 1) & TW_RING_MASK;
     if (next_tail == wp->tw_head) {
         /* Ring full — release immediately (unusual under normal load) */
-        ip_pool_t *ip = ip_pool_get(wp, src_ip);
-        bm_set(ip->map, port - TGEN_EPHEM_LO);
+        ip_pool_t *ip = ip_pool_get(wp, ctx, src_ip);
+        pp_set(ip, port - TGEN_EPHEM_LO);
         return;
     }
 
     tw_entry_t *e = &wp->tw_ring[wp->tw_tail];
     e->src_ip      = src_ip;
     e->port        = port;
+    e->ctx         = ctx;
     e->release_tsc = rte_rdtsc() + wp->tw_hold_tsc;
     wp->tw_tail    = next_tail;
 }
 
 void
-tcp_port_free_immediate(uint32_t worker_idx, uint32_t src_ip, uint16_t port)
+tcp_port_free_immediate(uint32_t worker_idx, uint8_t ctx, uint32_t src_ip,
+                        uint16_t port)
 {
     worker_pool_t *wp = g_pools[worker_idx];
     if (port < TGEN_EPHEM_LO || port >= TGEN_EPHEM_HI)
         return;
-    ip_pool_t *ip = ip_pool_get(wp, src_ip);
-    bm_set(ip->map, port - TGEN_EPHEM_LO);
+    ip_pool_t *ip = ip_pool_get(wp, ctx, src_ip);
+    pp_set(ip, port - TGEN_EPHEM_LO);
 }
 
 void
@@ -297,106 +530,9 @@ tcp_port_pool_tick(uint32_t worker_idx, uint64_t now_tsc)
         tw_entry_t *e = &wp->tw_ring[wp->tw_head];
         if (now_tsc < e->release_tsc)
             break; /* ring is FIFO — rest still in hold-off */
-        ip_pool_t *ip = ip_pool_get(wp, e->src_ip);
-        bm_set(ip->map, e->port - TGEN_EPHEM_LO);
+        ip_pool_t *ip = tw_pool(wp, e);
+        if (ip)
+            pp_set(ip, e->port - TGEN_EPHEM_LO);
         wp->tw_head = (wp->tw_head + 1) & TW_RING_MASK;
     }
 }
-
-/* ------------------------------------------------------------------ */
-/* RSS queue affinity filter                                            */
-/* ------------------------------------------------------------------ */
-#include <rte_thash.h>
-#include <rte_ethdev.h>
-
-void
-tcp_port_pool_apply_rss_filter(uint32_t n_workers,
-                               uint32_t src_ip, uint32_t dst_ip,
-                               uint16_t dst_port,
-                               const uint8_t *rss_key,
-                               uint8_t rss_key_len,
-                               uint16_t n_rxq)
-{
-    if (n_rxq <= 1 || n_workers <= 1)
-        return;  /* no filtering needed */
-
-    (void)rss_key_len;
-
-    /* Query the actual RETA from port 0 to match NIC behavior exactly */
-    uint16_t port_id = 0;
-    struct rte_eth_dev_info dev_info;
-    int ri = rte_eth_dev_info_get(port_id, &dev_info); (void)ri;
-    uint16_t reta_size = dev_info.reta_size;
-    if (reta_size == 0) reta_size = 128; /* fallback */
-
-    /* Read the RETA from device */
-    uint16_t n_reta_groups = (reta_size + RTE_ETH_RETA_GROUP_SIZE - 1) /
-                             RTE_ETH_RETA_GROUP_SIZE;
-    struct rte_eth_rss_reta_entry64 reta_conf[8]; /* max 512 entries */
-    memset(reta_conf, 0, sizeof(reta_conf));
-    for (uint16_t i = 0; i < n_reta_groups && i < 8; i++)
-        reta_conf[i].mask = UINT64_MAX;
-
-    int ret = rte_eth_dev_rss_reta_query(port_id, reta_conf, reta_size);
-    bool have_reta = (ret == 0);
-
-    RTE_LOG(INFO, TGEN_PP,
-            "RSS filter: reta_size=%u, n_rxq=%u, have_reta=%d\n",
-            reta_size, n_rxq, have_reta);
-
-    uint32_t ports_per_worker[TGEN_MAX_WORKERS];
-    memset(ports_per_worker, 0, sizeof(ports_per_worker));
-
-    for (uint32_t bit = 0; bit < TGEN_EPHEM_CNT; bit++) {
-        uint16_t sport = (uint16_t)(TGEN_EPHEM_LO + bit);
-
-        /* rte_softrss() takes host byte order values + original key.
-         * src_ip/dst_ip are stored as network byte order (from inet_pton),
-         * so convert to host byte order for the hash. */
-        uint32_t tuple[3];
-        tuple[0] = rte_be_to_cpu_32(src_ip);     /* host byte order */
-        tuple[1] = rte_be_to_cpu_32(dst_ip);     /* host byte order */
-        tuple[2] = ((uint32_t)sport << 16) | (uint32_t)dst_port;
-
-        uint32_t hash = rte_softrss(tuple, 3, rss_key);
-
-        /* Map hash to queue using RETA (matches NIC behavior) */
-        uint16_t reta_idx = hash & (reta_size - 1);
-        uint16_t target_q;
-        if (have_reta) {
-            uint16_t group = reta_idx / RTE_ETH_RETA_GROUP_SIZE;
-            uint16_t entry = reta_idx % RTE_ETH_RETA_GROUP_SIZE;
-            target_q = reta_conf[group].reta[entry];
-        } else {
-            target_q = reta_idx % n_rxq;
-        }
-
-        if (target_q >= n_workers)
-            target_q = target_q % n_workers;
-
-        /* Clear this port from every worker except the target */
-        for (uint32_t w = 0; w < n_workers; w++) {
-            worker_pool_t *wp = g_pools[w];
-            if (!wp) continue;
-            if (w == target_q) {
-                ports_per_worker[w]++;
-                bm_set(wp->shared.map, bit);
-            } else {
-                bm_clear(wp->shared.map, bit);
-            }
-            /* Also filter per-IP pools */
-            for (uint32_t s = 0; s < N_IP_SLOTS; s++) {
-                if (wp->ip_pools[s].src_ip == 0) continue;
-                if (w == target_q)
-                    bm_set(wp->ip_pools[s].map, bit);
-                else
-                    bm_clear(wp->ip_pools[s].map, bit);
-            }
-        }
-    }
-
-    for (uint32_t w = 0; w < n_workers; w++) {
-        RTE_LOG(INFO, TGEN_PP, "RSS filter: worker %u → %u ports\n",
-                w, ports_per_worker[w]);
-    }
-}
@@ -17,6 +17,10 @@ extern "C" {
 #define TGEN_EPHEM_HI  60000u
 #define TGEN_EPHEM_CNT (TGEN_EPHEM_HI - TGEN_EPHEM_LO)
 
+/** Maximum number of consecutive source IPs with a dedicated per-IP pool
+ *  (--src-ip-count upper bound). */
+#define TGEN_PP_MAX_SRC_IPS 4096u
+
 /**
  * Initialise port pools for `n_workers` workers.
  * Must be called from management thread before lcores start.
@@ -27,24 +31,56 @@ int tcp_port_pool_init(uint32_t n_workers);
 void tcp_port_pool_fini(void);
 
 /**
- * Allocate an ephemeral port for (worker_idx, src_ip).
+ * Stage the source IP range [base_ip, base_ip + count) of RSS steering
+ * context `ctx` (see rss_steer.h).  Every worker keeps a dedicated
+ * per-IP port pool for each IP of the range, indexed directly by offset
+ * and holding only the ports whose return traffic reaches that worker.
+ * IPs outside the range share a single fallback pool.
+ * base_ip is in network byte order; count is clamped to
+ * TGEN_PP_MAX_SRC_IPS.  Management thread only: workers pick the range
+ * up in tcp_port_pool_apply() when they START a flow on the context.
+ * Returns 0 on success, -EINVAL for ctx 0.
+ */
+int tcp_port_pool_set_range(uint8_t ctx, uint32_t base_ip, uint32_t count);
+
+/** True if `ctx` was staged since this worker last applied it. */
+bool tcp_port_pool_stale(uint32_t worker_idx, uint8_t ctx);
+
+/**
+ * Worker: apply the staged range of `ctx` to this worker's pools if it
+ * changed.  The old per-IP pools and the context's TIME_WAIT entries
+ * are dropped, so the caller must first reset the connections still
+ * holding ports of the context.  A worker holds at most
+ * TGEN_PP_MAX_SRC_IPS per-IP pools; when the new range does not fit,
+ * contexts not in `live` (bit ctx - 1) are reclaimed, then the range is
+ * truncated and its remaining IPs use the shared pool.
+ * Returns 0 on success, -ENOMEM.
+ */
+int tcp_port_pool_apply(uint32_t worker_idx, uint8_t ctx, uint64_t live);
+
+/**
+ * Allocate an ephemeral port for (worker_idx, ctx, src_ip).
+ * ctx is the RSS steering context (RSS_STEER_NONE = shared pool).
  * Returns 0 on success, negative on exhaustion.
  * *port is in host byte order.
  */
-int tcp_port_alloc(uint32_t worker_idx, uint32_t src_ip, uint16_t *port);
+int tcp_port_alloc(uint32_t worker_idx, uint8_t ctx, uint32_t src_ip,
+                   uint16_t *port);
 
 /**
  * Release a port previously allocated with tcp_port_alloc().
  * The port is not immediately reusable — it enters a TIME_WAIT
  * hold-off that expires after TGEN_TCP_TIMEWAIT_MS milliseconds.
  */
-void tcp_port_free(uint32_t worker_idx, uint32_t src_ip, uint16_t port);
+void tcp_port_free(uint32_t worker_idx, uint8_t ctx, uint32_t src_ip,
+                   uint16_t port);
 
 /**
  * Release a port immediately, bypassing the TIME_WAIT hold-off.
  * Use after RST-based teardown where TIME_WAIT is not required.
  */
-void tcp_port_free_immediate(uint32_t worker_idx, uint32_t src_ip, uint16_t port);
+void tcp_port_free_immediate(uint32_t worker_idx, uint8_t ctx,
+                             uint32_t src_ip, uint16_t port);
 
 /**
  * Per-worker tick: release ports whose TIME_WAIT hold-off has expired.
@@ -57,21 +93,6 @@ void tcp_port_pool_tick(uint32_t worker_idx, uint64_t now_tsc);
  */
 void tcp_port_pool_reset(uint32_t worker_idx);
 
-/**
- * Filter each worker's port pool to only contain ports whose RSS hash
- * maps to that worker's RX queue.  Required for multi-worker TCP so
- * that response packets (SYN-ACK etc.) arrive at the correct worker.
- *
- * Call from management thread after destination is known but before
- * traffic starts.  Only needed when n_rxq > 1.
- */
-void tcp_port_pool_apply_rss_filter(uint32_t n_workers,
-                                    uint32_t src_ip, uint32_t dst_ip,
-                                    uint16_t dst_port,
-                                    const uint8_t *rss_key,
-                                    uint8_t rss_key_len,
-                                    uint16_t n_rxq);
-
 #ifdef __cplusplus
 }
 #endif
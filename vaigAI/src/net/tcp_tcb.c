@@ -4,6 +4,8 @@
 #include "tcp_tcb.h"
 #include "tcp_timer.h"
 #include "tcp_snd_buf.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 #include "../core/core_assign.h"
 #include "../common/util.h"
 
@@ -93,6 +95,7 @@ tcb_t *tcb_alloc(tcb_store_t *store,
     tcb->tw_next  = UINT32_MAX;
     tcb->tw_prev  = UINT32_MAX;
     tcb->dack_next = UINT32_MAX;
+    tcb->flow_idx  = UINT16_MAX;
 
     /* Insert into hash table (linear probing).
      * Tombstone slots (-2) left by tcb_free are reused for insertion,
@@ -143,6 +146,11 @@ void tcb_free(tcb_store_t *store, tcb_t *tcb)
     /* Remove from timer wheel before zeroing */
     tcp_timer_cancel(store_to_worker(store), tcb);
 
+    if (tcb->http_ol != HTTP_OL_NONE)
+        http_ol_conn_gone(store_to_worker(store), tcb);
+    if (tcb->pool_key != 0)
+        conn_pool_conn_gone(store_to_worker(store), tcb);
+
     /* Free send buffer before zeroing the TCB */
     if (tcb->snd_buf) {
         tcp_snd_buf_free(tcb->snd_buf);
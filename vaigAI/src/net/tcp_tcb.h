@@ -9,6 +9,7 @@
 #include <rte_mbuf.h>
 #include <rte_ether.h>
 #include "../common/types.h"
+#include "../app/http11.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -114,9 +115,14 @@ typedef struct {
     bool        pending_ack;
     uint32_t    pending_ack_seq;
 
-    /* TIME_WAIT */
+    /* TIME_WAIT / FIN_WAIT_2 deadline.  Before that a client TCB keeps
+     * its creation time here, which the TLS handshake timeout counts
+     * from (app_state 1–2). */
     uint64_t    timewait_deadline_tsc;
 
+    /* TSC of the first SYN, for the SYN window's handshake time */
+    uint64_t    syn_tsc;
+
     /* L7 layer state (8 bytes for app-level opaque data) */
     uint64_t    app_state;
     void       *app_ctx;     /* pointer to L7 context (HTTP, TLS, etc.) */
@@ -127,14 +133,28 @@ typedef struct {
     /* HTTP request-response latency (TSC at request send) */
     uint64_t    http_req_sent_tsc;
 
-    /* HTTP response body tracking for proper active close.
-     * http_content_length is parsed from the Content-Length header.
-     * 0 means unknown (chunked / connection-close / not yet parsed).
-     * http_body_rx accumulates body bytes received across segments.
-     * app_state 6 = waiting for remaining body data after headers parsed.
+    /* Open-loop pool connection (HTTP_OL_*, app/http_ol.h) and the
+     * intended send time of its outstanding request, which latency is
+     * measured from (0 = closed loop: measured from the send).
+     * app_state 9 = idle in the pool. */
+    uint8_t     http_ol;
+    uint64_t    http_intended_tsc;
+
+    /* Connection pool membership (CONN_POOL_*, app/conn_pool.h): target
+     * key + 1 (0 = not pooled), state, and the idle-timeout deadline
+     * while parked (app_state 9). */
+    uint8_t     pool_key;
+    uint8_t     pool_state;
+    uint64_t    idle_deadline_tsc;
+
+    /* Client responses: requests in flight (a --pipeline batch, else 1),
+     * responses still due, and the incremental parser that splits them
+     * out of the stream (app/http11.h).
+     * app_state 5 = waiting for a response head, 6 = its body is arriving.
      * app_state 7 = think-time wait (timer transitions to 4). */
-    uint32_t    http_content_length;
-    uint32_t    http_body_rx;
+    uint8_t     http_pipe_sent;
+    uint8_t     http_pipe_out;
+    http_rsp_scan_t http_rsp;
     uint32_t    http_txn_count;       /* completed HTTP transactions */
     uint64_t    think_deadline_tsc;   /* TSC deadline for think-time wait */
 
@@ -143,6 +163,15 @@ typedef struct {
     uint32_t    srv_stream_total;     /* total body bytes to stream */
     uint32_t    srv_stream_sent;      /* body bytes sent so far */
 
+    /* L7 replay cursor (app_state 8 client / 13 server, app_ctx = program).
+     * l7_off counts bytes of message l7_msg; while the server has not yet
+     * identified the conversation (l7_conv = UINT16_MAX) it counts the
+     * opening bytes and l7_crc accumulates their CRC. */
+    uint16_t    l7_conv;
+    uint16_t    l7_msg;
+    uint32_t    l7_off;
+    uint32_t    l7_crc;
+
     /* When true, use graceful FIN close instead of RST at end of
      * transaction (--one flag).  Set by tx_gen when max_initiations > 0. */
     bool        graceful_close;
@@ -156,6 +185,14 @@ typedef struct {
     /* Congestion control algorithm: 0=NewReno, 1=CUBIC */
     uint8_t     cc_algo;
 
+    /* RSS steering context the source port was allocated from
+     * (RSS_STEER_NONE = shared pool). */
+    uint8_t     steer_ctx;
+
+    /* Client flow that opened the connection, for its per-flow metric
+     * slab (UINT16_MAX = FLOW_METRICS_NONE: passive open). */
+    uint16_t    flow_idx;
+
     /* CUBIC congestion control state (RFC 8312) */
     uint32_t    cubic_wmax;          /* W_max at last loss event (bytes) */
     uint64_t    cubic_epoch_start;   /* TSC when congestion epoch began  */
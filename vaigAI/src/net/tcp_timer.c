@@ -9,6 +9,8 @@
 #include "../telemetry/metrics.h"
 #include "../tls/tls_session.h"
 #include "../app/server.h"
+#include "../app/l7_replay.h"
+#include "../app/conn_pool.h"
 
 #include <rte_cycles.h>
 #include <rte_log.h>
@@ -90,6 +92,11 @@ static uint64_t tcb_earliest_deadline(const tcb_t *tcb)
     if (tcb->think_deadline_tsc && tcb->think_deadline_tsc < earliest)
         earliest = tcb->think_deadline_tsc;
 
+    /* Pooled connection idle timeout (only while it can be reused) */
+    if (tcb->state == TCP_ESTABLISHED &&
+        tcb->idle_deadline_tsc && tcb->idle_deadline_tsc < earliest)
+        earliest = tcb->idle_deadline_tsc;
+
     if (tcb->http_req_sent_tsc && tcb->http_req_sent_tsc < earliest) {
         /* HTTP response timeout: fire at req_sent + 5s */
         uint64_t http_dl = tcb->http_req_sent_tsc +
@@ -203,7 +210,8 @@ static void timer_fire(uint32_t worker_idx, tcb_t *tcb)
                 tls_session_detach(worker_idx, ci);
                 tcb->app_state = 0;
             }
-            tcp_port_free(worker_idx, tcb->src_ip, tcb->src_port);
+            tcp_port_free(worker_idx, tcb->steer_ctx,
+                          tcb->src_ip, tcb->src_port);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
         }
         break;
@@ -215,7 +223,9 @@ static void timer_fire(uint32_t worker_idx, tcb_t *tcb)
                 tcb->app_state = 0;
             }
             worker_metrics_add_tcp_conn_close(worker_idx);
-            tcp_port_free(worker_idx, tcb->src_ip, tcb->src_port);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, tcp_conn_close);
+            tcp_port_free(worker_idx, tcb->steer_ctx,
+                          tcb->src_ip, tcb->src_port);
             tcb_free(&g_tcb_stores[worker_idx], tcb);
         }
         break;
@@ -258,6 +268,15 @@ static void timer_fire(uint32_t worker_idx, tcb_t *tcb)
         if (!tcb->in_use)
             break;
 
+        /* Pooled connection idle timeout */
+        if (tcb->state == TCP_ESTABLISHED &&
+            tcb->app_state == CONN_POOL_APP_IDLE &&
+            tcb->idle_deadline_tsc != 0 &&
+            now >= tcb->idle_deadline_tsc)
+            conn_pool_idle_expired(worker_idx, tcb);
+        if (!tcb->in_use)
+            break;
+
         /* Streaming pump */
         if (tcb->state == TCP_ESTABLISHED && tcb->app_state == 12)
             srv_stream_pump(worker_idx, tcb);
@@ -275,6 +294,20 @@ static void timer_fire(uint32_t worker_idx, tcb_t *tcb)
             tcb->app_state = 0;
             tcp_fsm_reset(worker_idx, tcb);
         }
+        if (!tcb->in_use)
+            break;
+
+        /* L7 replay: the peer stopped short of the conversation */
+        if (tcb->state == TCP_ESTABLISHED &&
+            (tcb->app_state == L7_REPLAY_APP_CLIENT ||
+             tcb->app_state == L7_REPLAY_APP_SERVER) &&
+            tcb->http_req_sent_tsc != 0 &&
+            (now - tcb->http_req_sent_tsc) >=
+                TCP_HTTP_RSP_TIMEOUT_US * (rte_get_tsc_hz() / 1000000ULL)) {
+            worker_metrics_add_l7_fail(worker_idx);
+            flow_metrics_inc(worker_idx, tcb->flow_idx, l7_conv_fail);
+            tcp_fsm_reset(worker_idx, tcb);
+        }
         break;
 
     default:
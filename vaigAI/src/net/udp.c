@@ -2,10 +2,12 @@
  * vaigAI: UDP implementation (§2.5, RFC 768).
  *
  * Minimal RX path: worker forwards UDP datagrams to a per-port ring,
- * management thread validates checksum and accounts metrics.  TX path
+ * management thread validates checksum and accounts metrics.  Probe
+ * datagrams (udp_probe.h) are consumed on the worker instead.  TX path
  * is handled by the tx_gen builder in core/tx_gen.c.
  */
 #include "udp.h"
+#include "udp_probe.h"
 #include "arp.h"
 #include "../core/mempool.h"
 #include "../common/util.h"
@@ -36,11 +38,12 @@ int udp_init(void)
                               RING_F_SC_DEQ);
         if (!g_udp_rings[p]) return -1;
     }
-    return 0;
+    return udp_probe_init() < 0 ? -1 : 0;
 }
 
 void udp_destroy(void)
 {
+    udp_probe_destroy();
     for (uint32_t p = 0; p < TGEN_MAX_PORTS; p++) {
         if (g_udp_rings[p]) {
             rte_ring_free(g_udp_rings[p]);
@@ -60,6 +63,11 @@ void udp_input(uint32_t worker_idx, struct rte_mbuf *m)
     }
     /* Account RX */
     worker_metrics_add_udp_rx(worker_idx);
+    /* Probe datagrams are analysed here and never reach mgmt */
+    if (udp_probe_input(worker_idx, m)) {
+        rte_pktmbuf_free(m);
+        return;
+    }
     if (rte_ring_enqueue(g_udp_rings[port_id], m) != 0)
         rte_pktmbuf_free(m);
 }
@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: UDP probe RX analysis.
+ *
+ * Probes are stamped by the stateless generator (core/tx_gen.c) and
+ * analysed here on whichever worker receives them.  All state is
+ * per receiving worker; the management thread only reads it (racy reads
+ * are fine for reporting) and zeroes a flow's slice before it starts.
+ */
+#include "udp_probe.h"
+#include "udp.h"
+#include "../core/core_assign.h"
+#include "../telemetry/metrics.h"
+#include "../common/util.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+
+/* Sequence and jitter state of one (flow, generating worker) stream. */
+typedef struct {
+    uint64_t next_seq;      /* highest sequence seen + 1               */
+    uint64_t seen;          /* bit d: seq next_seq − 1 − d received    */
+    uint64_t last_transit;  /* rx_tsc − tx_tsc of the previous probe   */
+    uint64_t jitter16;      /* RFC 3550 J × 16, in TSC cycles          */
+    bool     started;
+    bool     has_transit;
+} probe_stream_t;
+
+uint64_t g_udp_probe_tx[TGEN_MAX_WORKERS][UDP_PROBE_MAX_FLOWS];
+
+static udp_probe_rx_t  g_probe_rx[TGEN_MAX_WORKERS][UDP_PROBE_MAX_FLOWS];
+/* [rx worker] → [flow][tx worker] */
+static probe_stream_t *g_probe_streams[TGEN_MAX_WORKERS];
+static uint32_t        g_probe_n_workers;
+
+static inline probe_stream_t *
+stream_of(uint32_t rx_worker, uint32_t flow, uint32_t tx_worker)
+{
+    return &g_probe_streams[rx_worker][flow * g_probe_n_workers + tx_worker];
+}
+
+int udp_probe_init(void)
+{
+    g_probe_n_workers = g_core_map.num_workers;
+    for (uint32_t w = 0; w < g_probe_n_workers; w++) {
+        uint32_t lcore = g_core_map.worker_lcores[w];
+        g_probe_streams[w] = rte_zmalloc_socket("udp_probe",
+            (size_t)UDP_PROBE_MAX_FLOWS * g_probe_n_workers *
+                sizeof(probe_stream_t),
+            RTE_CACHE_LINE_SIZE, (int)g_core_map.socket_of_lcore[lcore]);
+        if (!g_probe_streams[w]) {
+            RTE_LOG(ERR, NET, "UDP probe: no memory for worker %u\n", w);
+            udp_probe_destroy();
+            return -ENOMEM;
+        }
+        for (uint32_t f = 0; f < UDP_PROBE_MAX_FLOWS; f++)
+            hist_reset(&g_probe_rx[w][f].lat);
+    }
+    return 0;
+}
+
+void udp_probe_destroy(void)
+{
+    for (uint32_t w = 0; w < TGEN_MAX_WORKERS; w++) {
+        rte_free(g_probe_streams[w]);
+        g_probe_streams[w] = NULL;
+    }
+}
+
+bool udp_probe_input(uint32_t worker_idx, const struct rte_mbuf *m)
+{
+    if (m->data_len < UDP_HDR_LEN + UDP_PROBE_LEN)
+        return false;
+    udp_probe_hdr_t h;
+    memcpy(&h, rte_pktmbuf_mtod_offset(m, const uint8_t *, UDP_HDR_LEN),
+           sizeof(h));
+    if (h.magic != UDP_PROBE_MAGIC ||
+        h.flow_id >= UDP_PROBE_MAX_FLOWS ||
+        h.tx_worker >= g_probe_n_workers ||
+        !g_probe_streams[worker_idx])
+        return false;
+
+    uint64_t now = rte_rdtsc();
+    udp_probe_rx_t *rs = &g_probe_rx[worker_idx][h.flow_id];
+    probe_stream_t *st = stream_of(worker_idx, h.flow_id, h.tx_worker);
+
+    /* Widen the 32-bit sequence to the one nearest the stream's head. */
+    uint64_t seq = h.seq;
+    if (likely(st->started)) {
+        int64_t d = (int32_t)(h.seq - (uint32_t)st->next_seq);
+        if (unlikely(d < 0 && (uint64_t)-d > st->next_seq))
+            return true;                /* before the stream began */
+        seq = st->next_seq + (uint64_t)d;
+    }
+    rs->rx++;
+    /* Probe flows are numbered by their client flow slot */
+    flow_metrics_add_rx(worker_idx, h.flow_id, 1,
+                        m->pkt_len + m->l2_len + m->l3_len);
+    flow_metrics_inc(worker_idx, h.flow_id, udp_rx);
+
+    /* ── Sequence: in order, gap, late or duplicate ─────────────────── */
+    if (unlikely(!st->started)) {
+        st->started  = true;
+        st->next_seq = seq + 1;
+        st->seen     = 1;
+        rs->gaps    += seq;             /* generators count from 0 */
+    } else if (likely(seq >= st->next_seq)) {
+        uint64_t skip = seq - st->next_seq;
+        rs->gaps    += skip;
+        st->seen     = skip + 1 >= UDP_PROBE_WINDOW ? 1
+                     : (st->seen << (skip + 1)) | 1;
+        st->next_seq = seq + 1;
+    } else {
+        uint64_t dist = st->next_seq - 1 - seq;
+        if (dist < UDP_PROBE_WINDOW) {
+            if (st->seen & (1ull << dist)) {
+                rs->dup++;
+                return true;
+            }
+            st->seen |= 1ull << dist;
+        }
+        /* Beyond the window a duplicate can't be told apart; count it
+         * as late. */
+        rs->reordered++;
+        rs->reorder_sum += dist;
+        if (dist > rs->reorder_max)
+            rs->reorder_max = dist;
+        if (rs->gaps)
+            rs->gaps--;
+    }
+
+    /* ── Latency and RFC 3550 jitter ────────────────────────────────── */
+    uint64_t transit = (uint32_t)((uint32_t)now - h.tx_tsc);
+    hist_record(&rs->lat, tgen_tsc_to_ns(transit));
+    if (st->has_transit) {
+        uint64_t d = transit > st->last_transit ? transit - st->last_transit
+                                                : st->last_transit - transit;
+        /* J += (|D| − J) / 16, kept scaled by 16 */
+        st->jitter16 = st->jitter16 + d - (st->jitter16 >> 4);
+    }
+    st->last_transit = transit;
+    st->has_transit  = true;
+    return true;
+}
+
+void udp_probe_reset(uint32_t flow_idx)
+{
+    if (flow_idx >= UDP_PROBE_MAX_FLOWS)
+        return;
+    for (uint32_t w = 0; w < g_probe_n_workers; w++) {
+        memset(&g_probe_rx[w][flow_idx], 0, sizeof(udp_probe_rx_t));
+        hist_reset(&g_probe_rx[w][flow_idx].lat);
+        g_udp_probe_tx[w][flow_idx] = 0;
+        if (g_probe_streams[w])
+            memset(stream_of(w, flow_idx, 0), 0,
+                   g_probe_n_workers * sizeof(probe_stream_t));
+    }
+}
+
+void udp_probe_report(uint32_t flow_idx, udp_probe_report_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    hist_reset(&out->lat);
+    if (flow_idx >= UDP_PROBE_MAX_FLOWS)
+        return;
+
+    double   jitter_sum = 0;
+    uint32_t jitter_n   = 0;
+    uint64_t reorder_sum = 0;
+    for (uint32_t w = 0; w < g_probe_n_workers; w++) {
+        const udp_probe_rx_t *rs = &g_probe_rx[w][flow_idx];
+        out->tx        += g_udp_probe_tx[w][flow_idx];
+        out->rx        += rs->rx;
+        out->dup       += rs->dup;
+        out->gaps      += rs->gaps;
+        out->reordered += rs->reordered;
+        reorder_sum    += rs->reorder_sum;
+        if (rs->reorder_max > out->reorder_max)
+            out->reorder_max = rs->reorder_max;
+
+        hist_merge(&out->lat, &rs->lat);
+
+        if (!g_probe_streams[w])
+            continue;
+        for (uint32_t t = 0; t < g_probe_n_workers; t++) {
+            const probe_stream_t *st = stream_of(w, flow_idx, t);
+            if (!st->has_transit)
+                continue;
+            jitter_sum += (double)tgen_tsc_to_ns(st->jitter16 >> 4);
+            jitter_n++;
+        }
+    }
+
+    uint64_t unique = out->rx - out->dup;
+    out->lost        = out->tx > unique ? out->tx - unique : 0;
+    out->reorder_avg = out->reordered
+        ? (double)reorder_sum / (double)out->reordered : 0;
+    out->jitter_ns   = jitter_n ? jitter_sum / jitter_n : 0;
+}
@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: UDP probe payloads — loss, duplicates, reordering, latency and
+ * RFC 3550 jitter for stateless UDP flows.
+ *
+ * With `start --probe` every UDP datagram starts its payload with a
+ * udp_probe_hdr_t: a magic, the flow slot, the generating worker, a
+ * per-generator sequence number and the TX TSC.  The header is 16 bytes
+ * so it fits the 18-byte payload of a 64-byte frame.  Any worker that receives
+ * the datagram back (looped through a DUT, or reflected by the peer)
+ * parses it inline in udp_input() instead of handing it to the mgmt ring.
+ *
+ * Sequence analysis runs per stream = (flow, generating worker), in the
+ * receiving worker's state.  A 64-bit window behind the highest sequence
+ * seen tells a late arrival (reordered, undoes the tentative loss) from a
+ * duplicate.  Latency is rx_tsc − tx_tsc in ns: one-way through a DUT
+ * back to this host, RTT when the peer echoes the datagram.
+ *
+ * Sequence and TSC travel as their low 32 bits.  The receiver widens the
+ * sequence against the stream's highest one (serial-number arithmetic)
+ * and takes the transit time modulo 2^32 cycles, which bounds measurable
+ * latency to ~1 s at 4 GHz.
+ *
+ * Stream state is sized per (flow, tx worker, rx worker), so probes are
+ * limited to the first UDP_PROBE_MAX_FLOWS flow slots; the CLI places
+ * probe flows there.
+ */
+#ifndef TGEN_UDP_PROBE_H
+#define TGEN_UDP_PROBE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include "../common/types.h"
+#include "../telemetry/histogram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UDP_PROBE_MAGIC    0x76675062u  /* "vgPb" */
+#define UDP_PROBE_WINDOW   64u          /* duplicate-detection window */
+#define UDP_PROBE_MAX_FLOWS 64u         /* flow slots that may probe  */
+
+/** Probe header at the start of the UDP payload (host byte order —
+ *  only vaigAI reads it). */
+typedef struct {
+    uint32_t magic;
+    uint16_t flow_id;     /* client flow slot                        */
+    uint16_t tx_worker;   /* generating worker index                 */
+    uint32_t seq;         /* per (flow, tx_worker), from 0; low 32 b */
+    uint32_t tx_tsc;      /* low 32 bits of the TSC at build time    */
+} __rte_packed udp_probe_hdr_t;
+
+#define UDP_PROBE_LEN  ((uint16_t)sizeof(udp_probe_hdr_t))
+
+/** Per (receiving worker, flow) counters; single writer. */
+typedef struct {
+    uint64_t    rx;            /* probes received, duplicates included  */
+    uint64_t    dup;
+    uint64_t    reordered;     /* arrived after a higher sequence       */
+    uint64_t    reorder_sum;   /* Σ distance behind the highest seq     */
+    uint64_t    reorder_max;
+    uint64_t    gaps;          /* missing seqs not (yet) filled in      */
+    histogram_t lat;           /* latency in ns                         */
+} __rte_cache_aligned udp_probe_rx_t;
+
+/** Aggregated view of one flow (management thread). */
+typedef struct {
+    uint64_t    tx;
+    uint64_t    rx;
+    uint64_t    dup;
+    uint64_t    lost;          /* tx − unique rx (includes in-flight)   */
+    uint64_t    gaps;
+    uint64_t    reordered;
+    uint64_t    reorder_max;
+    double      reorder_avg;
+    double      jitter_ns;     /* mean RFC 3550 jitter over streams     */
+    histogram_t lat;
+} udp_probe_report_t;
+
+/** Probes sent, [tx worker][flow]; incremented by the generator. */
+extern uint64_t g_udp_probe_tx[TGEN_MAX_WORKERS][UDP_PROBE_MAX_FLOWS];
+
+/** Allocate per-worker stream state.  Returns 0 or -ENOMEM. */
+int udp_probe_init(void);
+void udp_probe_destroy(void);
+
+/**
+ * Worker: consume the datagram if it carries a probe (data at the UDP
+ * header).  Returns false for other datagrams, which are left untouched.
+ */
+bool udp_probe_input(uint32_t worker_idx, const struct rte_mbuf *m);
+
+/** Management: zero a flow's counters on every worker (before START). */
+void udp_probe_reset(uint32_t flow_idx);
+
+/** Management: aggregate a flow's counters over all workers. */
+void udp_probe_report(uint32_t flow_idx, udp_probe_report_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TGEN_UDP_PROBE_H */
@@ -10,13 +10,17 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
 
 #include <rte_ethdev.h>
 #include <rte_eth_ctrl.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
 #include <rte_flow.h>
+#include <rte_errno.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_cycles.h>
 
 /* ── AF_XDP mbuf fixup RX callback ────────────────────────────────────────── */
 /* On mlx5 ConnectX-4 with AF_XDP (zero-copy UMEM path), the kernel XDP
@@ -58,6 +62,8 @@ static const uint8_t g_rss_key_sym[52] = {
 /* ── Globals ─────────────────────────────────────────────────────────────── */
 port_caps_t g_port_caps[TGEN_MAX_PORTS];
 uint32_t    g_n_ports;
+int         g_tx_ts_offset = -1;
+uint64_t    g_tx_ts_flag;
 
 const uint8_t *tgen_rss_key(void) { return g_rss_key_sym; }
 uint8_t        tgen_rss_key_max_len(void) { return sizeof(g_rss_key_sym); }
@@ -86,6 +92,7 @@ static void probe_caps(uint16_t port_id, port_caps_t *caps)
     caps->rss_offloads           = info.flow_type_rss_offloads;
     caps->rss_key_size           = info.hash_key_size;
     caps->has_vlan_offload       = !!(tx_ol & RTE_ETH_TX_OFFLOAD_VLAN_INSERT);
+    caps->can_tx_timestamp       = !!(tx_ol & RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP);
 
     caps->max_rx_queues  = info.max_rx_queues;
     caps->max_tx_queues  = info.max_tx_queues;
@@ -102,7 +109,7 @@ static void probe_caps(uint16_t port_id, port_caps_t *caps)
 static int port_setup(uint16_t port_id,
                        uint32_t n_rxq, uint32_t n_txq,
                        uint32_t rx_desc, uint32_t tx_desc,
-                       struct rte_mempool *mp,
+                       struct rte_mempool *mp, bool tx_timestamp,
                        uint32_t *configured_txq)
 {
     port_caps_t *caps = &g_port_caps[port_id];
@@ -165,6 +172,22 @@ static int port_setup(uint16_t port_id,
         port_conf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_UDP_CKSUM;
     if (caps->has_multi_seg_tx)
         port_conf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_MULTI_SEGS;
+    /* Scheduled send (--tx-timestamp) needs the launch-time dynfield.
+     * The offload can change the PMD's TX burst path, so it stays off
+     * unless asked for. */
+    caps->has_tx_timestamp = tx_timestamp && caps->can_tx_timestamp;
+    if (caps->has_tx_timestamp && g_tx_ts_offset < 0 &&
+        rte_mbuf_dyn_tx_timestamp_register(&g_tx_ts_offset,
+                                           &g_tx_ts_flag) != 0) {
+        RTE_LOG(WARNING, PORT,
+                "Port %u: TX timestamp dynfield unavailable, no scheduled send\n",
+                port_id);
+        g_tx_ts_offset = -1;
+    }
+    if (g_tx_ts_offset < 0)
+        caps->has_tx_timestamp = false;
+    if (caps->has_tx_timestamp)
+        port_conf.txmode.offloads |= RTE_ETH_TX_OFFLOAD_SEND_ON_TIMESTAMP;
 
     int rc = rte_eth_dev_configure(port_id, (uint16_t)n_rxq, (uint16_t)n_txq,
                                     &port_conf);
@@ -237,6 +260,29 @@ static int port_setup(uint16_t port_id,
         return -1;
     }
 
+    /* Scheduled send takes launch times in NIC clock units: measure the
+     * clock against the TSC once here; tx_gen rebases while it runs. */
+    if (caps->has_tx_timestamp) {
+        uint64_t c0, c1;
+        uint64_t t0 = rte_rdtsc();
+        if (rte_eth_read_clock(port_id, &c0) == 0) {
+            rte_delay_ms(10);
+            uint64_t t1 = rte_rdtsc();
+            if (rte_eth_read_clock(port_id, &c1) == 0 && c1 > c0 && t1 > t0)
+                caps->tx_ts_hz = (uint64_t)((double)(c1 - c0) *
+                                 (double)rte_get_tsc_hz() / (double)(t1 - t0));
+        }
+        if (caps->tx_ts_hz == 0) {
+            RTE_LOG(WARNING, PORT,
+                    "Port %u: device clock unreadable, no scheduled send\n",
+                    port_id);
+            caps->has_tx_timestamp = false;
+        } else {
+            RTE_LOG(INFO, PORT, "Port %u: scheduled send, clock %.3f MHz\n",
+                    port_id, caps->tx_ts_hz / 1e6);
+        }
+    }
+
     /* Program a larger RETA for better RSS distribution.
      * Some drivers (mlx5) default to reta_size = n_rxq when n_rxq is a
      * power of 2, discarding almost all hash entropy.  Expand to 512
@@ -296,7 +342,8 @@ static int port_setup(uint16_t port_id,
 }
 
 /* ── Public API ───────────────────────────────────────────────────────────── */
-int tgen_ports_init(uint32_t num_rx_desc, uint32_t num_tx_desc)
+int tgen_ports_init(uint32_t num_rx_desc, uint32_t num_tx_desc,
+                    bool tx_timestamp)
 {
     g_n_ports = rte_eth_dev_count_avail();
     if (g_n_ports == 0) {
@@ -336,7 +383,8 @@ int tgen_ports_init(uint32_t num_rx_desc, uint32_t num_tx_desc)
         uint32_t n_txq = n_queues + 1;
         uint32_t actual_txq = 0;
         if (port_setup(port_id, n_queues, n_txq,
-                       num_rx_desc, num_tx_desc, mp, &actual_txq) < 0)
+                       num_rx_desc, num_tx_desc, mp, tx_timestamp,
+                       &actual_txq) < 0)
             return -1;
         /* If the actual configured TX queue count doesn't have room for
          * a dedicated mgmt queue, share worker queue 0. */
@@ -374,3 +422,92 @@ void tgen_ports_dump(void)
             c->has_rss, c->has_scatter_rx, c->has_multi_seg_tx);
     }
 }
+
+/* ── rte_flow return-traffic steering ─────────────────────────────────────── */
+int tgen_port_flow_steer_install(uint16_t port_id, uint16_t vlan_id,
+                                 uint32_t peer_ip, uint16_t peer_port,
+                                 uint16_t n_classes,
+                                 const uint16_t *class_queue,
+                                 struct rte_flow **rules)
+{
+    if (n_classes == 0 || n_classes > TGEN_FLOW_STEER_MAX_CLASSES ||
+        (n_classes & (n_classes - 1)) != 0)
+        return -EINVAL;
+
+    struct rte_flow_attr attr = { .ingress = 1 };
+
+    /* Tagged flows need a VLAN item: without one, some PMDs match only
+     * untagged frames and others the peer on every VLAN. */
+    struct rte_flow_item_vlan vlan_spec, vlan_mask;
+    memset(&vlan_spec, 0, sizeof(vlan_spec));
+    memset(&vlan_mask, 0, sizeof(vlan_mask));
+    vlan_spec.hdr.vlan_tci = rte_cpu_to_be_16(vlan_id & 0x0fff);
+    vlan_mask.hdr.vlan_tci = rte_cpu_to_be_16(0x0fff);
+
+    struct rte_flow_item_ipv4 ip_spec, ip_mask;
+    memset(&ip_spec, 0, sizeof(ip_spec));
+    memset(&ip_mask, 0, sizeof(ip_mask));
+    ip_spec.hdr.src_addr = peer_ip;
+    ip_mask.hdr.src_addr = UINT32_MAX;
+
+    struct rte_flow_item_tcp tcp_spec, tcp_mask;
+    memset(&tcp_spec, 0, sizeof(tcp_spec));
+    memset(&tcp_mask, 0, sizeof(tcp_mask));
+    tcp_spec.hdr.src_port = rte_cpu_to_be_16(peer_port);
+    tcp_mask.hdr.src_port = UINT16_MAX;
+    tcp_mask.hdr.dst_port = rte_cpu_to_be_16((uint16_t)(n_classes - 1));
+
+    struct rte_flow_item pattern[5];
+    uint32_t n_items = 0;
+    memset(pattern, 0, sizeof(pattern));
+    pattern[n_items++].type = RTE_FLOW_ITEM_TYPE_ETH;
+    if (vlan_id) {
+        pattern[n_items].type = RTE_FLOW_ITEM_TYPE_VLAN;
+        pattern[n_items].spec = &vlan_spec;
+        pattern[n_items++].mask = &vlan_mask;
+    }
+    pattern[n_items].type = RTE_FLOW_ITEM_TYPE_IPV4;
+    pattern[n_items].spec = &ip_spec;
+    pattern[n_items++].mask = &ip_mask;
+    pattern[n_items].type = RTE_FLOW_ITEM_TYPE_TCP;
+    pattern[n_items].spec = &tcp_spec;
+    pattern[n_items++].mask = &tcp_mask;
+    pattern[n_items].type = RTE_FLOW_ITEM_TYPE_END;
+    struct rte_flow_action_queue queue;
+    struct rte_flow_action actions[] = {
+        { .type = RTE_FLOW_ACTION_TYPE_QUEUE, .conf = &queue },
+        { .type = RTE_FLOW_ACTION_TYPE_END },
+    };
+
+    for (uint16_t c = 0; c < n_classes; c++) {
+        struct rte_flow_error err;
+        memset(&err, 0, sizeof(err));
+        tcp_spec.hdr.dst_port = rte_cpu_to_be_16(c);
+        queue.index = class_queue[c];
+        rules[c] = rte_flow_create(port_id, &attr, pattern, actions, &err);
+        if (!rules[c]) {
+            int rc = rte_errno ? -rte_errno : -ENOTSUP;
+            RTE_LOG(INFO, PORT,
+                    "Port %u: flow steering rule %u/%u rejected: %s\n",
+                    port_id, c, n_classes,
+                    err.message ? err.message : "unknown");
+            tgen_port_flow_steer_remove(port_id, c, rules);
+            return rc;
+        }
+    }
+    RTE_LOG(INFO, PORT, "Port %u: %u flow steering rules installed\n",
+            port_id, n_classes);
+    return 0;
+}
+
+void tgen_port_flow_steer_remove(uint16_t port_id, uint16_t n_rules,
+                                 struct rte_flow **rules)
+{
+    for (uint16_t i = 0; i < n_rules; i++) {
+        if (!rules[i])
+            continue;
+        struct rte_flow_error err;
+        rte_flow_destroy(port_id, rules[i], &err);
+        rules[i] = NULL;
+    }
+}
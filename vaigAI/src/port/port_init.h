@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <rte_ethdev.h>
 #include <rte_ether.h>
+#include <rte_flow.h>
 #include "../common/types.h"
 
 #ifdef __cplusplus
@@ -28,6 +29,9 @@ typedef struct {
     uint64_t      rss_offloads;    /* supported RSS hash functions */
     uint8_t       rss_key_size;   /* required RSS key length */
     bool          has_vlan_offload;
+    bool          can_tx_timestamp; /* SEND_ON_TIMESTAMP advertised   */
+    bool          has_tx_timestamp; /* SEND_ON_TIMESTAMP enabled      */
+    uint64_t      tx_ts_hz;       /* NIC clock rate, 0 = unusable     */
     uint32_t      max_rx_queues;
     uint32_t      max_tx_queues;
     uint32_t      rx_desc_lim_min;
@@ -43,6 +47,11 @@ typedef struct {
 extern port_caps_t g_port_caps[TGEN_MAX_PORTS];
 extern uint32_t    g_n_ports;
 
+/** Scheduled-send mbuf dynfield (launch time, NIC clock units) and its
+ *  ol_flags bit; offset -1 when no port has SEND_ON_TIMESTAMP. */
+extern int         g_tx_ts_offset;
+extern uint64_t    g_tx_ts_flag;
+
 /** RSS key used for all ports (Toeplitz symmetric). */
 const uint8_t *tgen_rss_key(void);
 uint8_t        tgen_rss_key_max_len(void);
@@ -51,8 +60,10 @@ uint8_t        tgen_rss_key_max_len(void);
  *  set RSS, enable promiscuous mode, start device.
  *  @param num_rx_desc  Desired RX descriptors per queue (clamped to driver max)
  *  @param num_tx_desc  Desired TX descriptors per queue
+ *  @param tx_timestamp Enable SEND_ON_TIMESTAMP where the port has it
  *  Returns 0 on success, -1 on error. */
-int tgen_ports_init(uint32_t num_rx_desc, uint32_t num_tx_desc);
+int tgen_ports_init(uint32_t num_rx_desc, uint32_t num_tx_desc,
+                    bool tx_timestamp);
 
 /** Stop and close all ports. */
 void tgen_ports_close(void);
@@ -60,6 +71,31 @@ void tgen_ports_close(void);
 /** Display per-port capability summary. */
 void tgen_ports_dump(void);
 
+/* ── rte_flow return-traffic steering ─────────────────────────────────────── */
+
+/** Max dst-port classes (and flow rules) per steering partition. */
+#define TGEN_FLOW_STEER_MAX_CLASSES 64u
+
+/**
+ * Install ingress rules steering TCP segments from (peer_ip, peer_port)
+ * to RX queue class_queue[c] when (tcp.dst_port & (n_classes-1)) == c.
+ * A non-zero vlan_id adds a VLAN item matching that VID.
+ * n_classes must be a power of two ≤ TGEN_FLOW_STEER_MAX_CLASSES.
+ * peer_ip is network byte order, peer_port host order.
+ * On success rules[0..n_classes-1] hold the created rules.  On failure
+ * any rule already created is destroyed and the PMD's errno is returned
+ * (negative); callers fall back to RSS.
+ */
+int tgen_port_flow_steer_install(uint16_t port_id, uint16_t vlan_id,
+                                 uint32_t peer_ip, uint16_t peer_port,
+                                 uint16_t n_classes,
+                                 const uint16_t *class_queue,
+                                 struct rte_flow **rules);
+
+/** Destroy rules created by tgen_port_flow_steer_install(). */
+void tgen_port_flow_steer_remove(uint16_t port_id, uint16_t n_rules,
+                                 struct rte_flow **rules);
+
 #ifdef __cplusplus
 }
 #endif
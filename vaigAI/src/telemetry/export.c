@@ -17,6 +17,7 @@
 #include <stdbool.h>
 #include <rte_ethdev.h>
 #include <rte_lcore.h>
+#include <rte_byteorder.h>
 
 /* ------------------------------------------------------------------ */
 /* JSON export (compact, for REST API / machine consumption)            */
@@ -50,6 +51,7 @@ export_json(const metrics_snapshot_t *snap, char *buf, size_t len)
         "  \"http_rsp_1xx\": %"PRIu64", \"http_rsp_2xx\": %"PRIu64",\n"
         "  \"http_rsp_3xx\": %"PRIu64", \"http_rsp_4xx\": %"PRIu64",\n"
         "  \"http_rsp_5xx\": %"PRIu64", \"http_parse_err\": %"PRIu64",\n"
+        "  \"l7_conv_done\": %"PRIu64", \"l7_conv_fail\": %"PRIu64",\n"
         "  \"tls_handshake_ok\": %"PRIu64", \"tls_handshake_fail\": %"PRIu64",\n"
         "  \"tls_records_tx\": %"PRIu64", \"tls_records_rx\": %"PRIu64",\n"
         "  \"p50\": %"PRIu64", \"p90\": %"PRIu64", \"p95\": %"PRIu64", \"p99\": %"PRIu64", \"p999\": %"PRIu64"\n"
@@ -77,6 +79,7 @@ export_json(const metrics_snapshot_t *snap, char *buf, size_t len)
         t->http_rsp_1xx,  t->http_rsp_2xx,
         t->http_rsp_3xx,  t->http_rsp_4xx,
         t->http_rsp_5xx,  t->http_parse_err,
+        t->l7_conv_done,  t->l7_conv_fail,
         t->tls_handshake_ok, t->tls_handshake_fail,
         t->tls_records_tx, t->tls_records_rx,
         hist_percentile(&snap->latency, 50.0),
@@ -207,9 +210,10 @@ export_summary(const metrics_snapshot_t *snap, double actual_s,
     p = append(buf, len, p, "  tx_pkts: %-12"PRIu64"  tx_bytes: %s",
                t->tx_pkts, fmt_bytes(t->tx_bytes, tmp1, sizeof(tmp1)));
     if (actual_s > 0.0)
-        p = append(buf, len, p, "  (%s, %.1f Mbps)",
+        p = append(buf, len, p, "  (%s, %.1f Mbps, %.1f Mbps L1)",
                    fmt_pps((double)t->tx_pkts / dur, tmp2, sizeof(tmp2)),
-                   (double)t->tx_bytes * 8.0 / dur / 1e6);
+                   (double)t->tx_bytes * 8.0 / dur / 1e6,
+                   metrics_tx_l1_bits(t) / dur / 1e6);
     p = append(buf, len, p, "\n");
     p = append(buf, len, p, "  rx_pkts: %-12"PRIu64"  rx_bytes: %s",
                t->rx_pkts, fmt_bytes(t->rx_bytes, tmp1, sizeof(tmp1)));
@@ -218,6 +222,22 @@ export_summary(const metrics_snapshot_t *snap, double actual_s,
                    fmt_pps((double)t->rx_pkts / dur, tmp2, sizeof(tmp2)));
     p = append(buf, len, p, "\n");
 
+    /* ── Stateless frame sizes (RFC 2819 bins, incl. FCS) ──────────── */
+    uint64_t sized = 0;
+    for (uint32_t b = 0; b < SIZE_BINS; b++)
+        sized += t->tx_size_bins[b];
+    if (sized > 0) {
+        p = append(buf, len, p, "  tx_sizes:");
+        for (uint32_t b = 0; b < SIZE_BINS; b++)
+            if (t->tx_size_bins[b])
+                p = append(buf, len, p, "  %s: %.1f%%",
+                           size_dist_bin_name(b),
+                           (double)t->tx_size_bins[b] * 100.0 / (double)sized);
+        p = append(buf, len, p, "  (avg %.0f B)\n",
+                   (double)t->tx_bytes / (double)t->tx_pkts +
+                   RTE_ETHER_CRC_LEN);
+    }
+
     /* ── Warnings ──────────────────────────────────────────────────── */
     if (t->rx_bytes == 0 && t->tcp_payload_rx > 0)
         p = append(buf, len, p,
@@ -288,6 +308,17 @@ export_summary(const metrics_snapshot_t *snap, double actual_s,
                        (double)t->http_rsp_rx / dur);
     }
 
+    /* ── L7 replay section (only if replay was used) ────────────────── */
+    if (t->l7_conv_done > 0 || t->l7_conv_fail > 0) {
+        p = append(buf, len, p, "\n--- l7 replay ---\n");
+        p = append(buf, len, p, "  conv_done:      %-8"PRIu64, t->l7_conv_done);
+        p = append(buf, len, p, "  conv_fail:      %"PRIu64"%s\n", t->l7_conv_fail,
+                   t->l7_conv_fail ? " ⚠" : "");
+        if (actual_s > 0.0)
+            p = append(buf, len, p, "  conv/s: %.1f\n",
+                       (double)t->l7_conv_done / dur);
+    }
+
     /* ── TLS section (only if TLS was used) ─────────────────────────── */
     if (t->tls_handshake_ok > 0 || t->tls_handshake_fail > 0) {
         p = append(buf, len, p, "\n--- tls ---\n");
@@ -340,11 +371,11 @@ export_summary(const metrics_snapshot_t *snap, double actual_s,
                    fmt_lat(p99, tmp4, sizeof(tmp4)),
                    fmt_lat(p999, tmp5, sizeof(tmp5)));
         if (snap->latency.total_count > 0) {
-            uint64_t avg = snap->latency.total_sum_us / snap->latency.total_count;
+            uint64_t avg = snap->latency.total_sum / snap->latency.total_count;
             p = append(buf, len, p, "  min: %s  avg: %s  max: %s  samples: %"PRIu64"\n",
-                       fmt_lat(snap->latency.min_us, tmp1, sizeof(tmp1)),
+                       fmt_lat(snap->latency.min_val, tmp1, sizeof(tmp1)),
                        fmt_lat(avg, tmp2, sizeof(tmp2)),
-                       fmt_lat(snap->latency.max_us, tmp3, sizeof(tmp3)),
+                       fmt_lat(snap->latency.max_val, tmp3, sizeof(tmp3)),
                        snap->latency.total_count);
         }
     }
@@ -517,6 +548,22 @@ export_mem_text(const mem_stats_snapshot_t *snap, int core,
             pool_total, pool_inuse, pool_total - pool_inuse, pct);
     }
 
+    /* ── Bulk allocation / mempool cache ───────────────────────────── */
+    p = append(buf, len, p,
+        "\n--- mbuf allocation ---\n"
+        "Pool         Bulk-Req     Hit%%    Fail       Stash-Get    Cache\n");
+    for (uint32_t i = 0; i < snap->n_pools; i++) {
+        if (core >= 0 && (int)i != core) continue;
+        const mempool_info_t *pi = &snap->pools[i];
+        double hit = pi->bulk_reqs > 0
+            ? (double)pi->cache_hits * 100.0 / (double)pi->bulk_reqs : 0;
+        p = append(buf, len, p,
+                   "%-12s %-12" PRIu64 " %5.1f%%  %-10" PRIu64
+                   " %-12" PRIu64 " %u/%u\n",
+                   pi->name, pi->bulk_reqs, hit, pi->bulk_fail,
+                   pi->stash_gets, pi->cache_len, pi->cache_size);
+    }
+
     /* ── DPDK heap (only in aggregate view) ────────────────────────── */
     if (core < 0 && snap->n_heaps > 0) {
         p = append(buf, len, p,
@@ -920,12 +967,12 @@ export_net_text(const metrics_snapshot_t *snap, char *buf, size_t len)
         fmt_lat(p95, tmp1, sizeof(tmp1)),
         fmt_lat(p999, tmp2, sizeof(tmp2)));
     if (snap->latency.total_count > 0) {
-        uint64_t avg = snap->latency.total_sum_us / snap->latency.total_count;
+        uint64_t avg = snap->latency.total_sum / snap->latency.total_count;
         p = append(buf, len, p,
             "│  min: %-12s  avg: %-12s  max: %-9s│\n",
-            fmt_lat(snap->latency.min_us, tmp1, sizeof(tmp1)),
+            fmt_lat(snap->latency.min_val, tmp1, sizeof(tmp1)),
             fmt_lat(avg, tmp2, sizeof(tmp2)),
-            fmt_lat(snap->latency.max_us, tmp3, sizeof(tmp3)));
+            fmt_lat(snap->latency.max_val, tmp3, sizeof(tmp3)));
         p = append(buf, len, p,
             "│  samples: %-47"PRIu64"│\n", snap->latency.total_count);
     }
@@ -935,4 +982,102 @@ export_net_text(const metrics_snapshot_t *snap, char *buf, size_t len)
     p = append(buf, len, p, "Workers: %u\n", snap->n_workers);
 
     return p;
-}
\ No newline at end of file
+}
+
+/* ================================================================== */
+/* Pacing — human-readable text                                       */
+/* ================================================================== */
+int
+export_pace_text(uint32_t flow_idx, const tx_gen_pace_report_t *r,
+                 char *buf, size_t len)
+{
+    int p = 0;
+    p = append(buf, len, p, "--- flow #%u pacing ---\n", flow_idx);
+    p = append(buf, len, p, "  generators: %u (%u scheduled send, %u software)\n",
+               r->generators, r->hw, r->generators - r->hw);
+    /* Scheduled-send gaps are the stamped launch times, not departures
+     * measured on the wire: say which the numbers are. */
+    p = append(buf, len, p, "  gap ns (%s): target %.0f",
+               r->hw == 0 ? "tx_burst calls"
+             : r->hw == r->generators ? "scheduled, not measured"
+             : "scheduled and tx_burst calls", r->target_ns);
+    if (r->gaps > 0)
+        p = append(buf, len, p,
+                   "  mean %.0f  stddev %.0f  min %"PRIu64"  max %"PRIu64,
+                   r->mean_ns, r->stddev_ns, r->min_ns, r->max_ns);
+    p = append(buf, len, p, "\n  worst lateness: %"PRIu64" ns  resyncs: %"PRIu64
+               "  gaps: %"PRIu64"\n",
+               r->late_max_ns, r->resyncs, r->gaps);
+    return p;
+}
+
+int
+export_handshake_text(uint32_t flow_idx, const tcp_hs_win_report_t *r,
+                      char *buf, size_t len)
+{
+    int p = 0;
+    p = append(buf, len, p, "--- flow #%u handshakes ---\n", flow_idx);
+    if (r->adaptive)
+        p = append(buf, len, p, "  SYN window: adaptive, max %u per worker\n",
+                   r->win_max);
+    else
+        p = append(buf, len, p, "  SYN window: fixed %u per worker\n",
+                   r->win_max);
+    p = append(buf, len, p, "  window: %u now, %u peak   half-open: %u now, "
+               "%u peak\n", r->win, r->win_peak, r->half_open,
+               r->half_open_peak);
+    if (r->srtt_us)
+        p = append(buf, len, p, "  SYN→SYN-ACK µs: min %u  smoothed %u\n",
+                   r->base_us, r->srtt_us);
+    p = append(buf, len, p, "  completed: %"PRIu64"  SYN retransmits: %"PRIu64
+               "  failed: %"PRIu64"\n",
+               r->syn_acked, r->syn_lost, r->syn_failed);
+    if (r->adaptive)
+        p = append(buf, len, p, "  window cuts: %"PRIu64" on loss, %"PRIu64
+                   " on delay\n", r->cuts_loss, r->cuts_delay);
+    return p;
+}
+
+int
+export_open_loop_text(uint32_t flow_idx, const http_ol_report_t *r,
+                      char *buf, size_t len)
+{
+    int p = 0;
+    p = append(buf, len, p, "--- flow #%u open loop ---\n", flow_idx);
+    p = append(buf, len, p, "  requests: %"PRIu64" sent, %"PRIu64
+               " behind schedule\n", r->sent, r->backlog);
+    p = append(buf, len, p, "  send lag µs: mean %.1f  max %.1f\n",
+               r->lag_mean_us, r->lag_max_us);
+    p = append(buf, len, p, "  connections: %u open, %u peak of %u, %"PRIu64
+               " opened\n", r->conns, r->conns_peak, r->max_conns,
+               r->conns_opened);
+    if (r->conns_peak >= r->max_conns && r->lag_max_us > 0)
+        p = append(buf, len, p, "  pool saturated: latency includes the "
+                   "wait for a connection\n");
+    return p;
+}
+
+int
+export_pool_text(const conn_pool_report_t *r, char *buf, size_t len)
+{
+    uint32_t ip = rte_be_to_cpu_32(r->dst_ip);
+    uint64_t txns = r->borrowed + r->opened;
+    int p = 0;
+    p = append(buf, len, p, "--- pool %u.%u.%u.%u:%u%s via port %u",
+               (ip >> 24) & 0xFF, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF,
+               ip & 0xFF, r->dst_port, r->tls ? " (tls)" : "", r->port_id);
+    if (r->vlan_id)
+        p = append(buf, len, p, " vlan %u", r->vlan_id);
+    p = append(buf, len, p, "%s ---\n", r->cc_algo ? " cubic" : "");
+    p = append(buf, len, p, "  per worker: min %u  max %u idle, timeout "
+               "%u ms\n", r->min_idle, r->max_idle, r->idle_ms);
+    p = append(buf, len, p, "  idle: %u now, %u peak   warming: %u\n",
+               r->idle, r->idle_peak, r->warming);
+    p = append(buf, len, p, "  borrowed: %"PRIu64"  opened: %"PRIu64
+               "  reuse: %.1f%%\n", r->borrowed, r->opened,
+               txns ? (double)r->borrowed * 100.0 / (double)txns : 0.0);
+    p = append(buf, len, p, "  returned: %"PRIu64"  timed out: %"PRIu64
+               "  closed (full): %"PRIu64"\n",
+               r->returned, r->evicted, r->overflow);
+    return p;
+}
@@ -7,6 +7,10 @@
 #include "metrics.h"
 #include "cpu_stats.h"
 #include "mem_stats.h"
+#include "../core/tx_gen.h"
+#include "../net/tcp_hs_win.h"
+#include "../app/http_ol.h"
+#include "../app/conn_pool.h"
 #include <stddef.h>
 
 #ifdef __cplusplus
@@ -66,6 +70,33 @@ int export_net_core_text(const metrics_snapshot_t *snap, uint32_t core,
  */
 int export_net_text(const metrics_snapshot_t *snap, char *buf, size_t len);
 
+/**
+ * Render a flow's pacing statistics (start --pace): target and measured
+ * inter-packet gap, its spread, worst lateness and schedule resyncs.
+ */
+int export_pace_text(uint32_t flow_idx, const tx_gen_pace_report_t *r,
+                     char *buf, size_t len);
+
+/**
+ * Render a flow's SYN window (start --syn-window): window and half-open
+ * handshakes now and at peak, handshake time, SYN losses and window cuts.
+ */
+int export_handshake_text(uint32_t flow_idx, const tcp_hs_win_report_t *r,
+                          char *buf, size_t len);
+
+/**
+ * Render a flow's open-loop schedule (start --open-loop): requests sent,
+ * backlog, send lag behind the intended times and the connection pool.
+ */
+int export_open_loop_text(uint32_t flow_idx, const http_ol_report_t *r,
+                          char *buf, size_t len);
+
+/**
+ * Render one connection-pool target (start --pool): limits, idle and
+ * warming connections, and how transactions found their connection.
+ */
+int export_pool_text(const conn_pool_report_t *r, char *buf, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,9 +13,9 @@ hist_percentile(const histogram_t *h, double p)
     for (uint32_t i = 0; i < HIST_BUCKETS; i++) {
         seen += h->counts[i];
         if (seen >= target) {
-            /* Upper bound of bucket i is 2^(i+1) µs */
+            /* Upper bound of bucket i is 2^(i+1) */
             return (1ull << (i + 1));
         }
     }
-    return h->max_us;
+    return h->max_val;
 }
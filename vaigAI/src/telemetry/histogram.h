@@ -1,7 +1,9 @@
 /* SPDX-License-Identifier: BSD-3-Clause
  * vaigAI: Latency histogram (§6.3) — HDR-style, power-of-2 buckets.
  *
- * Resolution: up to 64 buckets covering [1 µs, 1 s] in powers of 2.
+ * Resolution: 64 buckets in powers of 2 of the recorded unit.  The unit
+ * is the caller's: µs for the worker latency histograms, ns for UDP
+ * probes (udp_probe.h), so the fields carry no unit suffix.
  * Thread-safety: single writer (one worker), single reader (mgmt).
  * No atomics needed — snapshot copies are taken by management thread.
  */
@@ -20,9 +22,9 @@ extern "C" {
 typedef struct {
     uint64_t counts[HIST_BUCKETS];
     uint64_t total_count;
-    uint64_t total_sum_us;
-    uint64_t min_us;
-    uint64_t max_us;
+    uint64_t total_sum;
+    uint64_t min_val;
+    uint64_t max_val;
 } __rte_cache_aligned histogram_t;
 
 /** Reset histogram to zero. */
@@ -30,27 +32,27 @@ static inline void
 hist_reset(histogram_t *h)
 {
     __builtin_memset(h, 0, sizeof(*h));
-    h->min_us = UINT64_MAX;
+    h->min_val = UINT64_MAX;
 }
 
 /**
- * Record one latency sample (in microseconds).
- * Bucket index = 63 - __builtin_clzll(us | 1).
+ * Record one latency sample (in the histogram's unit).
+ * Bucket index = 63 - __builtin_clzll(v | 1).
  */
 static inline void
-hist_record(histogram_t *h, uint64_t us)
+hist_record(histogram_t *h, uint64_t v)
 {
-    uint32_t idx = 63u - (uint32_t)__builtin_clzll(us | 1ull);
+    uint32_t idx = 63u - (uint32_t)__builtin_clzll(v | 1ull);
     if (idx >= HIST_BUCKETS) idx = HIST_BUCKETS - 1;
     h->counts[idx]++;
     h->total_count++;
-    h->total_sum_us += us;
-    if (us < h->min_us) h->min_us = us;
-    if (us > h->max_us) h->max_us = us;
+    h->total_sum += v;
+    if (v < h->min_val) h->min_val = v;
+    if (v > h->max_val) h->max_val = v;
 }
 
 /**
- * Return the approximate p-th percentile (0–100) in microseconds.
+ * Return the approximate p-th percentile (0–100) in the histogram's unit.
  * Returns 0 if histogram is empty.
  */
 uint64_t hist_percentile(const histogram_t *h, double p);
@@ -75,6 +77,18 @@ hist_record_corrected(histogram_t *h, uint64_t us, uint64_t expected_interval_us
     }
 }
 
+/** Add src into dst (management thread, summing workers). */
+static inline void
+hist_merge(histogram_t *dst, const histogram_t *src)
+{
+    for (uint32_t b = 0; b < HIST_BUCKETS; b++)
+        dst->counts[b] += src->counts[b];
+    dst->total_count += src->total_count;
+    dst->total_sum   += src->total_sum;
+    if (src->min_val < dst->min_val) dst->min_val = src->min_val;
+    if (src->max_val > dst->max_val) dst->max_val = src->max_val;
+}
+
 /** Copy src → dst (used by management thread to take a snapshot). */
 static inline void
 hist_copy(histogram_t *dst, const histogram_t *src)
@@ -70,6 +70,20 @@ mem_stats_snapshot(mem_stats_snapshot_t *snap, uint32_t n_workers)
         pi->avail  = rte_mempool_avail_count(mp);
         pi->in_use = rte_mempool_in_use_count(mp);
         pi->total  = pi->avail + pi->in_use;
+
+        /* Cache and counters are owned by the worker; a racy read is
+         * fine for display. */
+        struct rte_mempool_cache *c =
+            rte_mempool_default_cache(mp, g_core_map.worker_lcores[w]);
+        if (c) {
+            pi->cache_size = c->size;
+            pi->cache_len  = c->len;
+        }
+        const tgen_mbuf_stats_t *ms = &g_mbuf_stats[w];
+        pi->bulk_reqs  = ms->bulk_reqs;
+        pi->cache_hits = ms->cache_hits;
+        pi->bulk_fail  = ms->bulk_fail;
+        pi->stash_gets = ms->stash_gets;
     }
 
     /* ── DPDK heap per NUMA socket ─────────────────────────────────── */
@@ -1,8 +1,8 @@
 /* SPDX-License-Identifier: BSD-3-Clause
  * vaigAI: Memory statistics — mempool, DPDK heap, TCB, hugepages.
  *
- * All queries are read-only against DPDK APIs and /sys; no new
- * per-worker instrumentation is needed.
+ * All queries are read-only against DPDK APIs and /sys, plus the
+ * per-worker bulk allocation counters kept in core/mempool.h.
  */
 #ifndef TGEN_MEM_STATS_H
 #define TGEN_MEM_STATS_H
@@ -20,6 +20,12 @@ typedef struct {
     uint32_t total;       /* total mbufs in pool */
     uint32_t in_use;      /* mbufs currently allocated */
     uint32_t avail;       /* mbufs available */
+    uint32_t cache_size;  /* owning worker's lcore cache capacity */
+    uint32_t cache_len;   /* mbufs currently in that cache */
+    uint64_t bulk_reqs;   /* bulk allocation calls */
+    uint64_t cache_hits;  /* bulk calls served from the lcore cache */
+    uint64_t bulk_fail;   /* bulk calls the pool could not satisfy */
+    uint64_t stash_gets;  /* TCP segments built from the mbuf stash */
 } mempool_info_t;
 
 /* ── Per-NUMA-socket DPDK heap info ───────────────────────────────── */
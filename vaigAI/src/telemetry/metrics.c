@@ -2,7 +2,11 @@
  * vaigAI: Per-worker metrics — global storage and snapshot.
  */
 #include "metrics.h"
+#include "../core/core_assign.h"
 #include <string.h>
+#include <errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
 
 /* Global array — one cache-line-aligned slab per worker. */
 worker_metrics_t g_metrics[TGEN_MAX_WORKERS];
@@ -10,62 +14,160 @@ worker_metrics_t g_metrics[TGEN_MAX_WORKERS];
 /* Per-worker latency histograms. */
 histogram_t g_latency_hist[TGEN_MAX_WORKERS];
 
+/* Per-flow slabs, allocated on demand by flow_metrics_prepare(), as is
+ * each worker's table of them. */
+flow_metrics_t **g_flow_metrics[TGEN_MAX_WORKERS];
+
+/* Add one worker's slab and histogram into the snapshot. */
+static void
+snap_add(metrics_snapshot_t *snap, uint32_t w,
+         const worker_metrics_t *src, const histogram_t *lat)
+{
+    /* Copy worker slab */
+    memcpy(&snap->per_worker[w], src, sizeof(worker_metrics_t));
+
+    /* Accumulate into total */
+    worker_metrics_t *t = &snap->total;
+    const worker_metrics_t *s = &snap->per_worker[w];
+
+#define ACC(field) t->field += s->field
+    ACC(tx_pkts);        ACC(tx_bytes);
+    ACC(rx_pkts);        ACC(rx_bytes);
+    ACC(ip_bad_cksum);   ACC(ip_frag_dropped); ACC(ip_not_for_us);
+    ACC(arp_reply_tx);   ACC(arp_request_tx);  ACC(arp_miss);
+    ACC(icmp_echo_tx);   ACC(icmp_bad_cksum);  ACC(icmp_unreachable_tx);
+    ACC(udp_tx);         ACC(udp_rx);           ACC(udp_bad_cksum);
+    ACC(tcp_conn_open);  ACC(tcp_conn_close);
+    ACC(tcp_syn_sent);   ACC(tcp_retransmit);
+    ACC(tcp_reset_rx);   ACC(tcp_reset_sent);
+    ACC(tcp_bad_cksum);  ACC(tcp_syn_queue_drops);
+    ACC(tcp_ooo_pkts);   ACC(tcp_duplicate_acks);
+    ACC(tcp_payload_tx); ACC(tcp_payload_rx);
+    ACC(tls_handshake_ok);   ACC(tls_handshake_fail);
+    ACC(tls_records_tx); ACC(tls_records_rx);
+    ACC(http_req_tx);    ACC(http_rsp_rx);
+    ACC(http_rsp_1xx);   ACC(http_rsp_2xx);
+    ACC(http_rsp_3xx);   ACC(http_rsp_4xx);   ACC(http_rsp_5xx);
+    ACC(http_parse_err);
+    ACC(l7_conv_done);
+    ACC(l7_conv_fail);
+#undef ACC
+    for (uint32_t b = 0; b < SIZE_BINS; b++)
+        t->tx_size_bins[b] += s->tx_size_bins[b];
+
+    /* Aggregate latency histograms across workers */
+    hist_merge(&snap->latency, lat);
+}
+
 void
 metrics_snapshot(metrics_snapshot_t *snap, uint32_t n_workers)
 {
     memset(snap, 0, sizeof(*snap));
     snap->n_workers = n_workers;
+    hist_reset(&snap->latency);
 
+    for (uint32_t w = 0; w < n_workers && w < TGEN_MAX_WORKERS; w++)
+        snap_add(snap, w, &g_metrics[w], &g_latency_hist[w]);
+}
+
+void
+metrics_reset(uint32_t n_workers)
+{
     for (uint32_t w = 0; w < n_workers && w < TGEN_MAX_WORKERS; w++) {
-        /* Copy worker slab */
-        memcpy(&snap->per_worker[w], &g_metrics[w], sizeof(worker_metrics_t));
+        memset(&g_metrics[w], 0, sizeof(worker_metrics_t));
+        hist_reset(&g_latency_hist[w]);
+        flow_metrics_t **tab = g_flow_metrics[w];
+        for (uint32_t f = 0; tab && f < TGEN_MAX_CLIENT_FLOWS; f++) {
+            flow_metrics_t *fm = tab[f];
+            if (fm) {
+                memset(&fm->m, 0, sizeof(fm->m));
+                hist_reset(&fm->latency);
+            }
+        }
+    }
+}
 
-        /* Accumulate into total */
-        worker_metrics_t *t = &snap->total;
-        const worker_metrics_t *s = &snap->per_worker[w];
+/* ------------------------------------------------------------------ */
+/* Per-flow slabs                                                       */
+/* ------------------------------------------------------------------ */
+int
+flow_metrics_prepare(uint32_t flow_idx, uint32_t n_workers)
+{
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS)
+        return -EINVAL;
 
-#define ACC(field) t->field += s->field
-        ACC(tx_pkts);        ACC(tx_bytes);
-        ACC(rx_pkts);        ACC(rx_bytes);
-        ACC(ip_bad_cksum);   ACC(ip_frag_dropped); ACC(ip_not_for_us);
-        ACC(arp_reply_tx);   ACC(arp_request_tx);  ACC(arp_miss);
-        ACC(icmp_echo_tx);   ACC(icmp_bad_cksum);  ACC(icmp_unreachable_tx);
-        ACC(udp_tx);         ACC(udp_rx);           ACC(udp_bad_cksum);
-        ACC(tcp_conn_open);  ACC(tcp_conn_close);
-        ACC(tcp_syn_sent);   ACC(tcp_retransmit);
-        ACC(tcp_reset_rx);   ACC(tcp_reset_sent);
-        ACC(tcp_bad_cksum);  ACC(tcp_syn_queue_drops);
-        ACC(tcp_ooo_pkts);   ACC(tcp_duplicate_acks);
-        ACC(tcp_payload_tx); ACC(tcp_payload_rx);
-        ACC(tls_handshake_ok);   ACC(tls_handshake_fail);
-        ACC(tls_records_tx); ACC(tls_records_rx);
-        ACC(http_req_tx);    ACC(http_rsp_rx);
-        ACC(http_rsp_1xx);   ACC(http_rsp_2xx);
-        ACC(http_rsp_3xx);   ACC(http_rsp_4xx);   ACC(http_rsp_5xx);
-        ACC(http_parse_err);
-#undef ACC
+    for (uint32_t w = 0; w < n_workers && w < TGEN_MAX_WORKERS; w++) {
+        int socket = (int)rte_lcore_to_socket_id(g_core_map.worker_lcores[w]);
+        flow_metrics_t **tab = g_flow_metrics[w];
+        if (!tab) {
+            tab = rte_zmalloc_socket("flow_metrics_tab",
+                                     TGEN_MAX_CLIENT_FLOWS * sizeof(*tab),
+                                     RTE_CACHE_LINE_SIZE, socket);
+            if (!tab)
+                return -ENOMEM;
+            __atomic_store_n(&g_flow_metrics[w], tab, __ATOMIC_RELEASE);
+        }
+        flow_metrics_t *fm = tab[flow_idx];
+        if (!fm) {
+            fm = rte_zmalloc_socket("flow_metrics", sizeof(*fm),
+                                    RTE_CACHE_LINE_SIZE, socket);
+            if (!fm)
+                return -ENOMEM;
+            hist_reset(&fm->latency);
+            /* Published ahead of the START that makes the worker use it */
+            __atomic_store_n(&tab[flow_idx], fm, __ATOMIC_RELEASE);
+        }
+        /* A slab kept from an earlier run is cleared by its worker at
+         * START (flow_metrics_clear()), not here: the worker may still
+         * be counting into it. */
     }
+    return 0;
+}
 
-    /* Aggregate latency histograms across workers */
-    hist_reset(&snap->latency);
+void
+flow_metrics_clear(uint32_t worker_idx, uint32_t flow_idx)
+{
+    flow_metrics_t *fm = flow_metrics_of(worker_idx, flow_idx);
+    if (!fm)
+        return;
+    memset(&fm->m, 0, sizeof(fm->m));
+    hist_reset(&fm->latency);
+}
+
+bool
+flow_metrics_present(uint32_t flow_idx)
+{
+    uint32_t n_workers = g_core_map.num_workers;
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS || n_workers == 0)
+        return false;
+
+    /* A prepare that ran out of memory part-way leaves some workers
+     * without the slab; their share would be missing from the flow. */
     for (uint32_t w = 0; w < n_workers && w < TGEN_MAX_WORKERS; w++) {
-        for (uint32_t b = 0; b < HIST_BUCKETS; b++) {
-            snap->latency.counts[b] += g_latency_hist[w].counts[b];
-            snap->latency.total_count += g_latency_hist[w].counts[b];
-        }
-        snap->latency.total_sum_us += g_latency_hist[w].total_sum_us;
-        if (g_latency_hist[w].min_us < snap->latency.min_us)
-            snap->latency.min_us = g_latency_hist[w].min_us;
-        if (g_latency_hist[w].max_us > snap->latency.max_us)
-            snap->latency.max_us = g_latency_hist[w].max_us;
+        flow_metrics_t **tab =
+            __atomic_load_n(&g_flow_metrics[w], __ATOMIC_ACQUIRE);
+        if (!tab || !__atomic_load_n(&tab[flow_idx], __ATOMIC_ACQUIRE))
+            return false;
     }
+    return true;
 }
 
 void
-metrics_reset(uint32_t n_workers)
+flow_metrics_snapshot(metrics_snapshot_t *snap, uint32_t flow_idx,
+                      uint32_t n_workers)
 {
+    memset(snap, 0, sizeof(*snap));
+    snap->n_workers = n_workers;
+    hist_reset(&snap->latency);
+    if (flow_idx >= TGEN_MAX_CLIENT_FLOWS)
+        return;
+
     for (uint32_t w = 0; w < n_workers && w < TGEN_MAX_WORKERS; w++) {
-        memset(&g_metrics[w], 0, sizeof(worker_metrics_t));
-        hist_reset(&g_latency_hist[w]);
+        flow_metrics_t **tab =
+            __atomic_load_n(&g_flow_metrics[w], __ATOMIC_ACQUIRE);
+        const flow_metrics_t *fm = tab
+            ? __atomic_load_n(&tab[flow_idx], __ATOMIC_ACQUIRE) : NULL;
+        if (fm)
+            snap_add(snap, w, &fm->m, &fm->latency);
     }
 }
@@ -8,9 +8,11 @@
 #define TGEN_METRICS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "../common/types.h"
 #include <rte_common.h>
 #include "histogram.h"
+#include "../core/size_dist.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,9 +79,16 @@ typedef struct {
     uint64_t http_rsp_5xx;
     uint64_t http_parse_err;
 
+    /* L7 replay (conversations replayed to the end / cut short) */
+    uint64_t l7_conv_done;
+    uint64_t l7_conv_fail;
+
+    /* Stateless generator frames by size incl. FCS (size_dist_bin()) */
+    uint64_t tx_size_bins[SIZE_BINS];
+
     /* Padding to a full cache line */
     uint8_t  _pad[RTE_CACHE_LINE_SIZE -
-                  (40 * sizeof(uint64_t)) % RTE_CACHE_LINE_SIZE];
+                  ((42 + SIZE_BINS) * sizeof(uint64_t)) % RTE_CACHE_LINE_SIZE];
 } __rte_cache_aligned worker_metrics_t;
 
 /* ------------------------------------------------------------------ */
@@ -103,6 +112,9 @@ extern histogram_t g_latency_hist[TGEN_MAX_WORKERS];
     do { g_metrics[(widx)].rx_pkts  += (pkts); \
          g_metrics[(widx)].rx_bytes += (bytes); } while (0)
 
+#define worker_metrics_add_tx_size(widx, bin, pkts) \
+    (g_metrics[(widx)].tx_size_bins[(bin)] += (pkts))
+
 #define worker_metrics_add_ip_bad_cksum(widx)    (g_metrics[(widx)].ip_bad_cksum++)
 #define worker_metrics_add_ip_frag_dropped(widx) (g_metrics[(widx)].ip_frag_dropped++)
 #define worker_metrics_add_ip_not_for_us(widx)   (g_metrics[(widx)].ip_not_for_us++)
@@ -137,15 +149,88 @@ extern histogram_t g_latency_hist[TGEN_MAX_WORKERS];
 #define worker_metrics_add_tls_rx(widx)           (g_metrics[(widx)].tls_records_rx++)
 
 #define worker_metrics_add_http_req(widx)         (g_metrics[(widx)].http_req_tx++)
+#define metrics_http_rsp(mp, code) \
+    do { (mp)->http_rsp_rx++;       \
+         if      ((code) < 200) (mp)->http_rsp_1xx++; \
+         else if ((code) < 300) (mp)->http_rsp_2xx++; \
+         else if ((code) < 400) (mp)->http_rsp_3xx++; \
+         else if ((code) < 500) (mp)->http_rsp_4xx++; \
+         else                   (mp)->http_rsp_5xx++; } while (0)
 #define worker_metrics_add_http_rsp(widx, code) \
-    do { g_metrics[(widx)].http_rsp_rx++;       \
-         if      ((code) < 200) g_metrics[(widx)].http_rsp_1xx++; \
-         else if ((code) < 300) g_metrics[(widx)].http_rsp_2xx++; \
-         else if ((code) < 400) g_metrics[(widx)].http_rsp_3xx++; \
-         else if ((code) < 500) g_metrics[(widx)].http_rsp_4xx++; \
-         else                   g_metrics[(widx)].http_rsp_5xx++; } while (0)
+    metrics_http_rsp(&g_metrics[(widx)], code)
 #define worker_metrics_add_http_parse_err(widx)   (g_metrics[(widx)].http_parse_err++)
 
+#define worker_metrics_add_l7_done(widx)          (g_metrics[(widx)].l7_conv_done++)
+#define worker_metrics_add_l7_fail(widx)          (g_metrics[(widx)].l7_conv_fail++)
+
+/* ------------------------------------------------------------------ */
+/* Per-flow slabs                                                       */
+/* ------------------------------------------------------------------ */
+/*
+ * Besides its worker slab, each client flow gets a slab of its own per
+ * worker, so concurrent flows can be told apart.  Slabs are allocated on
+ * the worker's socket by flow_metrics_prepare() before the flow starts
+ * and kept for reuse; the worker that owns a slab is its only writer, so
+ * the counting stays plain increments.  Traffic that cannot be tied to a
+ * flow (server side, ARP, stateless replies) is counted per worker only.
+ */
+#define FLOW_METRICS_NONE  UINT16_MAX   /* not a client flow */
+
+typedef struct {
+    worker_metrics_t m;         /* same counters as the worker slab */
+    histogram_t      latency;   /* TLS handshake / HTTP latency (µs) */
+} __rte_cache_aligned flow_metrics_t;
+
+/* Per worker, a table of TGEN_MAX_CLIENT_FLOWS slab pointers; NULL until
+ * the first flow_metrics_prepare(). */
+extern flow_metrics_t **g_flow_metrics[TGEN_MAX_WORKERS];
+
+/** Slab of `flow` on worker `widx`, or NULL (not a flow / not prepared). */
+static inline flow_metrics_t *
+flow_metrics_of(uint32_t widx, uint32_t flow)
+{
+    flow_metrics_t **tab = g_flow_metrics[widx];
+    return tab && flow < TGEN_MAX_CLIENT_FLOWS ? tab[flow] : NULL;
+}
+
+#define flow_metrics_add(widx, flow, field, n) \
+    do { flow_metrics_t *fm_ = flow_metrics_of((widx), (flow)); \
+         if (fm_) fm_->m.field += (n); } while (0)
+
+#define flow_metrics_inc(widx, flow, field) \
+    flow_metrics_add(widx, flow, field, 1)
+
+#define flow_metrics_add_tx(widx, flow, pkts, bytes) \
+    do { flow_metrics_t *fm_ = flow_metrics_of((widx), (flow)); \
+         if (fm_) { fm_->m.tx_pkts  += (pkts); \
+                    fm_->m.tx_bytes += (bytes); } } while (0)
+
+#define flow_metrics_add_rx(widx, flow, pkts, bytes) \
+    do { flow_metrics_t *fm_ = flow_metrics_of((widx), (flow)); \
+         if (fm_) { fm_->m.rx_pkts  += (pkts); \
+                    fm_->m.rx_bytes += (bytes); } } while (0)
+
+#define flow_metrics_add_http_rsp(widx, flow, code) \
+    do { flow_metrics_t *fm_ = flow_metrics_of((widx), (flow)); \
+         if (fm_) metrics_http_rsp(&fm_->m, code); } while (0)
+
+/** Record a latency sample (µs) on the flow's histogram; `interval_us`
+ *  as for hist_record_corrected() (0 = no correction). */
+#define flow_metrics_latency(widx, flow, us, interval_us) \
+    do { flow_metrics_t *fm_ = flow_metrics_of((widx), (flow)); \
+         if (fm_) hist_record_corrected(&fm_->latency, (us), \
+                                        (interval_us)); } while (0)
+
+/* Wire bytes per frame beyond tx_bytes (which excludes the FCS):
+ * FCS 4 + preamble/SFD 8 + inter-frame gap 12. */
+#define METRICS_L1_OVERHEAD  24u
+
+/** TX bits including L1 overhead (what the link carries). */
+static inline double metrics_tx_l1_bits(const worker_metrics_t *m)
+{
+    return (double)(m->tx_bytes + m->tx_pkts * METRICS_L1_OVERHEAD) * 8.0;
+}
+
 /* ------------------------------------------------------------------ */
 /* Aggregated snapshot (used by management/export thread)               */
 /* ------------------------------------------------------------------ */
@@ -163,11 +248,32 @@ typedef struct {
 void metrics_snapshot(metrics_snapshot_t *snap, uint32_t n_workers);
 
 /**
- * Reset all worker metrics to zero.
+ * Reset all worker metrics (and the per-flow slabs) to zero.
  * Call only from management thread when no workers are sending traffic.
  */
 void metrics_reset(uint32_t n_workers);
 
+/**
+ * Give `flow_idx` a slab on each of the first n_workers workers,
+ * allocating those it does not have yet (zeroed).  Management thread,
+ * before the flow's START; a reused slab is cleared by its worker.
+ * @return 0, or -ENOMEM (the flow then counts per worker only).
+ */
+int flow_metrics_prepare(uint32_t flow_idx, uint32_t n_workers);
+
+/** Worker: zero its slab of `flow_idx` on START, if it has one. */
+void flow_metrics_clear(uint32_t worker_idx, uint32_t flow_idx);
+
+/** True if every worker has a slab for `flow_idx`. */
+bool flow_metrics_present(uint32_t flow_idx);
+
+/**
+ * Snapshot one flow's slabs into 'snap' (per_worker, total and latency
+ * as for metrics_snapshot()).  A flow never prepared reads as zero.
+ */
+void flow_metrics_snapshot(metrics_snapshot_t *snap, uint32_t flow_idx,
+                           uint32_t n_workers);
+
 #ifdef __cplusplus
 }
 #endif
@@ -308,6 +308,8 @@ write_metrics(FILE *fp, const worker_metrics_t *t, const histogram_t *lat)
         ",\"http_rsp_4xx\":%"PRIu64
         ",\"http_rsp_5xx\":%"PRIu64
         ",\"http_parse_err\":%"PRIu64
+        ",\"l7_conv_done\":%"PRIu64
+        ",\"l7_conv_fail\":%"PRIu64
         ",\"tls_handshake_ok\":%"PRIu64
         ",\"tls_handshake_fail\":%"PRIu64
         ",\"tls_records_tx\":%"PRIu64
@@ -325,12 +327,13 @@ write_metrics(FILE *fp, const worker_metrics_t *t, const histogram_t *lat)
         t->http_req_tx, t->http_rsp_rx,
         t->http_rsp_2xx, t->http_rsp_4xx, t->http_rsp_5xx,
         t->http_parse_err,
+        t->l7_conv_done, t->l7_conv_fail,
         t->tls_handshake_ok, t->tls_handshake_fail,
         t->tls_records_tx, t->tls_records_rx);
 
     /* Latency as a separate nested object if histogram has data */
     if (lat && lat->total_count > 0) {
-        uint64_t avg = lat->total_sum_us / lat->total_count;
+        uint64_t avg = lat->total_sum / lat->total_count;
         /* caller already wrote the metrics object, so we need to
          * NOT close with } yet — but we already did. This helper writes
          * a standalone metrics object, latency is written separately. */
@@ -338,6 +341,35 @@ write_metrics(FILE *fp, const worker_metrics_t *t, const histogram_t *lat)
     }
 }
 
+/* ── Helper: write ,"latency":{...} (µs) ───────────────────────────── */
+static void
+write_latency(FILE *fp, const histogram_t *lat)
+{
+    uint64_t p50  = hist_percentile(lat, 50.0);
+    uint64_t p90  = hist_percentile(lat, 90.0);
+    uint64_t p95  = hist_percentile(lat, 95.0);
+    uint64_t p99  = hist_percentile(lat, 99.0);
+    uint64_t p999 = hist_percentile(lat, 99.9);
+    fprintf(fp,
+        ",\"latency\":{"
+        "\"p50\":%"PRIu64
+        ",\"p90\":%"PRIu64
+        ",\"p95\":%"PRIu64
+        ",\"p99\":%"PRIu64
+        ",\"p999\":%"PRIu64,
+        p50, p90, p95, p99, p999);
+    if (lat->total_count > 0) {
+        uint64_t avg = lat->total_sum / lat->total_count;
+        fprintf(fp,
+            ",\"min\":%"PRIu64
+            ",\"avg\":%"PRIu64
+            ",\"max\":%"PRIu64
+            ",\"samples\":%"PRIu64,
+            lat->min_val, avg, lat->max_val, lat->total_count);
+    }
+    fputc('}', fp);
+}
+
 /* ── progress ──────────────────────────────────────────────────────── */
 void
 output_progress(uint32_t flow_idx, uint64_t elapsed_s,
@@ -355,10 +387,23 @@ output_progress(uint32_t flow_idx, uint64_t elapsed_s,
         ",\"tx_pkts\":%"PRIu64
         ",\"rx_pkts\":%"PRIu64
         ",\"tcp_conn_open\":%"PRIu64
-        ",\"http_rsp_rx\":%"PRIu64
-        "}\n",
+        ",\"http_rsp_rx\":%"PRIu64,
         ts, flow_idx, elapsed_s,
         t->tx_pkts, t->rx_pkts, t->tcp_conn_open, t->http_rsp_rx);
+
+    /* The same counters of this flow alone */
+    if (flow_metrics_present(flow_idx)) {
+        static metrics_snapshot_t fs;
+        flow_metrics_snapshot(&fs, flow_idx, snap->n_workers);
+        const worker_metrics_t *f = &fs.total;
+        fprintf(g_output_fp,
+            ",\"flow\":{\"tx_pkts\":%"PRIu64
+            ",\"rx_pkts\":%"PRIu64
+            ",\"tcp_conn_open\":%"PRIu64
+            ",\"http_rsp_rx\":%"PRIu64"}",
+            f->tx_pkts, f->rx_pkts, f->tcp_conn_open, f->http_rsp_rx);
+    }
+    fputs("}\n", g_output_fp);
 }
 
 /* ── result ────────────────────────────────────────────────────────── */
@@ -391,30 +436,29 @@ output_result(uint32_t flow_idx, const char *proto,
     write_metrics(g_output_fp, t, &snap->latency);
 
     /* Latency */
-    uint64_t p50  = hist_percentile(&snap->latency, 50.0);
-    uint64_t p90  = hist_percentile(&snap->latency, 90.0);
-    uint64_t p95  = hist_percentile(&snap->latency, 95.0);
-    uint64_t p99  = hist_percentile(&snap->latency, 99.0);
-    uint64_t p999 = hist_percentile(&snap->latency, 99.9);
-    fprintf(g_output_fp,
-        ",\"latency\":{"
-        "\"p50\":%"PRIu64
-        ",\"p90\":%"PRIu64
-        ",\"p95\":%"PRIu64
-        ",\"p99\":%"PRIu64
-        ",\"p999\":%"PRIu64,
-        p50, p90, p95, p99, p999);
-    if (snap->latency.total_count > 0) {
-        uint64_t avg = snap->latency.total_sum_us / snap->latency.total_count;
-        fprintf(g_output_fp,
-            ",\"min\":%"PRIu64
-            ",\"avg\":%"PRIu64
-            ",\"max\":%"PRIu64
-            ",\"samples\":%"PRIu64,
-            snap->latency.min_us, avg, snap->latency.max_us,
-            snap->latency.total_count);
+    write_latency(g_output_fp, &snap->latency);
+
+    /* Achieved L1 rate; frame sizes of the stateless generator */
+    if (actual_s > 0.0)
+        fprintf(g_output_fp, ",\"tx_l1_bps\":%.0f",
+                metrics_tx_l1_bits(t) / actual_s);
+    if (t->udp_tx > 0 || t->icmp_echo_tx > 0) {
+        fputs(",\"tx_size_hist\":{", g_output_fp);
+        for (uint32_t b = 0; b < SIZE_BINS; b++)
+            fprintf(g_output_fp, "%s\"%s\":%"PRIu64, b ? "," : "",
+                    size_dist_bin_name(b), t->tx_size_bins[b]);
+        fputc('}', g_output_fp);
+    }
+
+    /* This flow's own slabs (the metrics above span every flow) */
+    if (flow_metrics_present(flow_idx)) {
+        static metrics_snapshot_t fs;
+        flow_metrics_snapshot(&fs, flow_idx, snap->n_workers);
+        fputs(",\"flow\":{\"metrics\":", g_output_fp);
+        write_metrics(g_output_fp, &fs.total, &fs.latency);
+        write_latency(g_output_fp, &fs.latency);
+        fputc('}', g_output_fp);
     }
-    fputc('}', g_output_fp);
 
     /* Per-worker summary */
     fprintf(g_output_fp, ",\"workers\":%u", snap->n_workers);
@@ -437,6 +481,206 @@ output_result(uint32_t flow_idx, const char *proto,
     fputs("}\n", g_output_fp);
 }
 
+/* ── Helper: write probe latency object (ns) ───────────────────────── */
+static void
+write_probe_latency(FILE *fp, const udp_probe_report_t *rep)
+{
+    const histogram_t *h = &rep->lat;
+    fputs(",\"latency_ns\":{", fp);
+    if (h->total_count > 0)
+        fprintf(fp,
+            "\"min\":%"PRIu64
+            ",\"avg\":%"PRIu64
+            ",\"p50\":%"PRIu64
+            ",\"p99\":%"PRIu64
+            ",\"p999\":%"PRIu64
+            ",\"max\":%"PRIu64
+            ",\"samples\":%"PRIu64
+            ",\"jitter\":%.1f",
+            h->min_val, h->total_sum / h->total_count,
+            hist_percentile(h, 50.0), hist_percentile(h, 99.0),
+            hist_percentile(h, 99.9), h->max_val, h->total_count,
+            rep->jitter_ns);
+    fputc('}', fp);
+}
+
+static void
+frame_str(uint16_t frame, char *buf, size_t len)
+{
+    if (frame == RFC2544_IMIX)
+        snprintf(buf, len, "\"imix\"");
+    else
+        snprintf(buf, len, "%u", frame);
+}
+
+/* ── rfc2544_trial ─────────────────────────────────────────────────── */
+void
+output_rfc2544_trial(const rfc2544_trial_t *t)
+{
+    if (!g_output_fp) return;
+    char ts[64], frame[16];
+    ts_now(ts, sizeof(ts));
+    frame_str(t->frame, frame, sizeof(frame));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"rfc2544_trial\""
+        ",\"test\":\"%s\""
+        ",\"frame\":%s"
+        ",\"trial\":%u"
+        ",\"rate_fps\":%"PRIu64
+        ",\"burst\":%"PRIu64
+        ",\"secs\":%.3f"
+        ",\"tx\":%"PRIu64
+        ",\"rx\":%"PRIu64
+        ",\"lost\":%"PRIu64
+        ",\"dup\":%"PRIu64
+        ",\"reordered\":%"PRIu64
+        ",\"loss_pct\":%.6f"
+        ",\"pass\":%s",
+        ts, rfc2544_test_name(t->test), frame, t->trial,
+        t->rate_fps, t->burst, t->secs,
+        t->rep.tx, t->rep.rx, t->rep.lost, t->rep.dup, t->rep.reordered,
+        t->loss_pct, t->pass ? "true" : "false");
+    write_probe_latency(g_output_fp, &t->rep);
+    fputs("}\n", g_output_fp);
+}
+
+/* ── rfc2544_result ────────────────────────────────────────────────── */
+void
+output_rfc2544_result(const rfc2544_result_t *r)
+{
+    if (!g_output_fp) return;
+    char ts[64], frame[16];
+    ts_now(ts, sizeof(ts));
+    frame_str(r->frame, frame, sizeof(frame));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"rfc2544_result\""
+        ",\"test\":\"%s\""
+        ",\"frame\":%s"
+        ",\"line_fps\":%"PRIu64
+        ",\"rate_fps\":%"PRIu64
+        ",\"mbps_l1\":%.3f"
+        ",\"pct_line\":%.3f"
+        ",\"burst\":%"PRIu64
+        ",\"trials\":%u",
+        ts, rfc2544_test_name(r->test), frame, r->line_fps,
+        r->rate_fps, r->mbps, r->pct_line, r->burst, r->trials);
+    if (r->test == RFC2544_LATENCY)
+        write_probe_latency(g_output_fp, &r->rep);
+    fputs("}\n", g_output_fp);
+}
+
+/* ── pacing ────────────────────────────────────────────────────────── */
+void
+output_pacing(uint32_t flow_idx, const tx_gen_pace_report_t *r)
+{
+    if (!g_output_fp) return;
+    char ts[64];
+    ts_now(ts, sizeof(ts));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"pacing\""
+        ",\"flow_idx\":%u"
+        ",\"generators\":%u"
+        ",\"scheduled_send\":%u"
+        ",\"gap_source\":\"%s\""
+        ",\"gaps\":%"PRIu64
+        ",\"target_ns\":%.1f"
+        ",\"mean_ns\":%.1f"
+        ",\"stddev_ns\":%.1f"
+        ",\"min_ns\":%"PRIu64
+        ",\"max_ns\":%"PRIu64
+        ",\"late_max_ns\":%"PRIu64
+        ",\"resyncs\":%"PRIu64"}\n",
+        ts, flow_idx, r->generators, r->hw,
+        r->hw == 0 ? "tx_burst" : r->hw == r->generators ? "scheduled" : "mixed",
+        r->gaps, r->target_ns,
+        r->mean_ns, r->stddev_ns, r->min_ns, r->max_ns, r->late_max_ns,
+        r->resyncs);
+}
+
+/* ── handshake ─────────────────────────────────────────────────────── */
+void
+output_handshake(uint32_t flow_idx, const tcp_hs_win_report_t *r)
+{
+    if (!g_output_fp) return;
+    char ts[64];
+    ts_now(ts, sizeof(ts));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"handshake\""
+        ",\"flow_idx\":%u"
+        ",\"adaptive\":%s"
+        ",\"win_max\":%u"
+        ",\"win\":%u"
+        ",\"win_peak\":%u"
+        ",\"half_open\":%u"
+        ",\"half_open_peak\":%u"
+        ",\"syn_ack_min_us\":%u"
+        ",\"syn_ack_srtt_us\":%u"
+        ",\"completed\":%"PRIu64
+        ",\"syn_retransmits\":%"PRIu64
+        ",\"failed\":%"PRIu64
+        ",\"cuts_loss\":%"PRIu64
+        ",\"cuts_delay\":%"PRIu64"}\n",
+        ts, flow_idx, r->adaptive ? "true" : "false", r->win_max, r->win,
+        r->win_peak, r->half_open, r->half_open_peak, r->base_us,
+        r->srtt_us, r->syn_acked, r->syn_lost, r->syn_failed,
+        r->cuts_loss, r->cuts_delay);
+}
+
+/* ── open_loop ─────────────────────────────────────────────────────── */
+void
+output_open_loop(uint32_t flow_idx, const http_ol_report_t *r)
+{
+    if (!g_output_fp) return;
+    char ts[64];
+    ts_now(ts, sizeof(ts));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"open_loop\""
+        ",\"flow_idx\":%u"
+        ",\"sent\":%"PRIu64
+        ",\"backlog\":%"PRIu64
+        ",\"lag_mean_us\":%.1f"
+        ",\"lag_max_us\":%.1f"
+        ",\"conns\":%u"
+        ",\"conns_peak\":%u"
+        ",\"conns_max\":%u"
+        ",\"conns_opened\":%"PRIu64"}\n",
+        ts, flow_idx, r->sent, r->backlog, r->lag_mean_us, r->lag_max_us,
+        r->conns, r->conns_peak, r->max_conns, r->conns_opened);
+}
+
+/* ── target ────────────────────────────────────────────────────────── */
+void
+output_target(const load_ctl_report_t *r)
+{
+    if (!g_output_fp) return;
+    char ts[64];
+    ts_now(ts, sizeof(ts));
+
+    fprintf(g_output_fp,
+        "{\"ts\":\"%s\",\"type\":\"target\""
+        ",\"flow_idx\":%u"
+        ",\"metric\":\"%s\""
+        ",\"target\":%.3f"
+        ",\"hold_s\":%.1f"
+        ",\"hold_mean\":%.3f"
+        ",\"hold_err_pct\":%.3f"
+        ",\"windows\":%u"
+        ",\"windows_in_band\":%u"
+        ",\"settle_s\":%.1f"
+        ",\"rate\":%"PRIu64
+        ",\"rate_unit\":\"%s\""
+        ",\"saturated\":%s}\n",
+        ts, r->flow_idx, load_metric_name(r->metric), r->target,
+        r->hold_s, r->hold_mean, r->hold_err_pct, r->windows,
+        r->windows_in, r->settle_s, r->rate, r->bps ? "bps" : "pps",
+        r->saturated ? "true" : "false");
+}
+
 /* ── error ─────────────────────────────────────────────────────────── */
 void
 output_error(const char *severity, const char *module,
@@ -10,6 +10,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "metrics.h"
+#include "../mgmt/rfc2544.h"
+#include "../mgmt/load_ctl.h"
+#include "../core/tx_gen.h"
+#include "../net/tcp_hs_win.h"
+#include "../app/http_ol.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,6 +63,24 @@ void output_progress(uint32_t flow_idx, uint64_t elapsed_s,
 void output_result(uint32_t flow_idx, const char *proto,
                    double actual_s, const metrics_snapshot_t *snap);
 
+/** Emit "pacing" event: inter-packet gap statistics of a --pace flow. */
+void output_pacing(uint32_t flow_idx, const tx_gen_pace_report_t *r);
+
+/** Emit "handshake" event: SYN window and handshake outcome of a flow. */
+void output_handshake(uint32_t flow_idx, const tcp_hs_win_report_t *r);
+
+/** Emit "open_loop" event: request schedule and pool of an open-loop flow. */
+void output_open_loop(uint32_t flow_idx, const http_ol_report_t *r);
+
+/** Emit "target" event: outcome of a --target (closed-loop) flow. */
+void output_target(const load_ctl_report_t *r);
+
+/** Emit "rfc2544_trial" event: one trial of an RFC 2544 run. */
+void output_rfc2544_trial(const rfc2544_trial_t *t);
+
+/** Emit "rfc2544_result" event: one test's outcome for one frame size. */
+void output_rfc2544_result(const rfc2544_result_t *r);
+
 /** Emit "error" event: structured error/warning. */
 void output_error(const char *severity, const char *module,
                   const char *message);
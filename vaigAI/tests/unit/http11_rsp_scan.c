@@ -0,0 +1,301 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * vaigAI: unit test for the incremental HTTP response parser,
+ * http11_rsp_scan() — framing by Content-Length and chunked coding,
+ * trailers, Transfer-Encoding over Content-Length, bodiless responses
+ * (HEAD, 1xx, 204, 304), close-delimited bodies, malformed input, and
+ * every way of splitting a stream across reads.
+ *
+ * Runs without EAL: only the parser is exercised.  meson test.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app/http11.h"
+#include "telemetry/metrics.h"
+
+/* http11.c counts parse errors of the server-side parser in the worker
+ * slabs; the test links it without metrics.c. */
+worker_metrics_t g_metrics[TGEN_MAX_WORKERS];
+
+#define MAX_RSP  64
+
+static int g_failed;
+
+#define CHECK(cond, ...)                                              \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("FAIL %s:%d: ", __func__, __LINE__);               \
+            printf(__VA_ARGS__);                                      \
+            printf("\n");                                             \
+            g_failed++;                                               \
+        }                                                             \
+    } while (0)
+
+/* Outcome of feeding a whole stream */
+typedef struct {
+    int      err;               /* -1 seen                             */
+    uint32_t n;                 /* responses completed                 */
+    uint32_t end[MAX_RSP];      /* stream offset just past each one    */
+    uint16_t status[MAX_RSP];
+    bool     eof;               /* left waiting for the close          */
+    bool     in_body;
+} scan_res_t;
+
+/* Feed `len` bytes in reads of `seg` bytes (0 = the rest after `cut`
+ * bytes: a two-read split at `cut`), as the FSM does: a read may end
+ * several responses, and the parser restarts after each. */
+static void
+feed(const char *stream, uint32_t len, uint32_t seg, uint32_t cut,
+     bool head, scan_res_t *r)
+{
+    http_rsp_scan_t s;
+    http11_rsp_scan_init(&s);
+    memset(r, 0, sizeof(*r));
+
+    uint32_t off = 0;
+    while (off < len && !r->err) {
+        uint32_t n = seg ? seg : (off < cut ? cut - off : len - off);
+        if (n > len - off)
+            n = len - off;
+        const uint8_t *d = (const uint8_t *)stream + off;
+        off += n;
+        while (n > 0) {
+            uint32_t used = 0;
+            int rc = http11_rsp_scan(&s, d, n, head, &used);
+            if (rc < 0) {
+                r->err = -1;
+                break;
+            }
+            if (rc == 0)
+                break;
+            if (r->n < MAX_RSP) {
+                r->end[r->n]    = off - n + used;
+                r->status[r->n] = s.status;
+            }
+            r->n++;
+            d += used;
+            n -= used;
+            if (http11_rsp_scan_switched(&s))
+                return;                 /* nothing after it is HTTP */
+            http11_rsp_scan_init(&s);
+        }
+    }
+    r->eof     = http11_rsp_scan_eof(&s);
+    r->in_body = http11_rsp_scan_in_body(&s);
+}
+
+/* One stream and what it must parse to, whatever the reads. */
+typedef struct {
+    const char *name;
+    const char *stream;
+    bool        head;
+    int         err;
+    uint32_t    n;
+    uint16_t    status[4];
+    uint32_t    end[4];         /* 0 = the end of the stream           */
+    bool        eof;
+} scan_case_t;
+
+static const scan_case_t k_cases[] = {
+    { "content-length",
+      "HTTP/1.1 200 OK\r\nServer: x\r\nContent-Length: 5\r\n\r\nhello",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "content-length, no space, trailing OWS",
+      "HTTP/1.1 404 Not Found\r\ncontent-length:3 \r\n\r\nabc",
+      false, 0, 1, { 404 }, { 0 }, false },
+    { "content-length zero",
+      "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "bare LF line ends",
+      "HTTP/1.1 200 OK\nX-A: 1\nContent-Length: 2\n\nok",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "look-alike header names",
+      "HTTP/1.1 200 OK\r\nContent-Lengthy: 99\r\n"
+      "Transfer-Encodings: chunked\r\nContent-Length: 1\r\n\r\nx",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "chunked",
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+      "5\r\nhello\r\n1a\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\n\r\n",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "chunked, extensions and trailers",
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n"
+      "3;name=\"a;b\"\r\nabc\r\n000;last\r\nTrailer-A: 1\r\nB: 2\r\n\r\n",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "transfer-encoding over content-length",
+      "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n"
+      "Transfer-Encoding: chunked\r\n\r\n2\r\nab\r\n0\r\n\r\n",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "HEAD: content-length but no body",
+      "HTTP/1.1 200 OK\r\nContent-Length: 1234\r\n\r\n",
+      true, 0, 1, { 200 }, { 0 }, false },
+    { "204 ignores its framing",
+      "HTTP/1.1 204 No Content\r\nContent-Length: 7\r\n\r\n",
+      false, 0, 1, { 204 }, { 0 }, false },
+    { "304 ignores its framing",
+      "HTTP/1.0 304 Not Modified\r\nTransfer-Encoding: chunked\r\n\r\n",
+      false, 0, 1, { 304 }, { 0 }, false },
+    { "100 and 103 are interim",
+      "HTTP/1.1 100 Continue\r\n\r\n"
+      "HTTP/1.1 103 Early Hints\r\nLink: </a.css>\r\n\r\n"
+      "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok",
+      false, 0, 1, { 200 }, { 0 }, false },
+    { "101 is final and ends HTTP",
+      "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+      "Connection: Upgrade\r\n\r\n\x81\x05hello",
+      false, 0, 1, { 101 }, { 77 }, false },
+    { "pipelined responses",
+      "HTTP/1.1 200 OK\r\nContent-Length: 1\r\n\r\na"
+      "HTTP/1.1 500 Oops\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n"
+      "HTTP/1.1 304 Not Modified\r\n\r\n"
+      "HTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nbc",
+      false, 0, 4, { 200, 500, 304, 201 }, { 39, 93, 122, 0 }, false },
+    { "no framing: ends at the close",
+      "HTTP/1.1 200 OK\r\n\r\nabc",
+      false, 0, 0, { 0 }, { 0 }, true },
+    { "unknown coding: ends at the close",
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip\r\n\r\nabc",
+      false, 0, 0, { 0 }, { 0 }, true },
+    { "bad protocol",
+      "HTTX/1.1 200 OK\r\n\r\n", false, -1, 0, { 0 }, { 0 }, false },
+    { "bad status",
+      "HTTP/1.1 2x0 OK\r\n\r\n", false, -1, 0, { 0 }, { 0 }, false },
+    { "two content-length numbers",
+      "HTTP/1.1 200 OK\r\nContent-Length: 1 2\r\n\r\n",
+      false, -1, 0, { 0 }, { 0 }, false },
+    { "negative content-length",
+      "HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n",
+      false, -1, 0, { 0 }, { 0 }, false },
+    { "empty content-length",
+      "HTTP/1.1 200 OK\r\nContent-Length:\r\n\r\n",
+      false, -1, 0, { 0 }, { 0 }, false },
+    { "bad chunk size",
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+      false, -1, 0, { 0 }, { 0 }, false },
+    { "chunk longer than its size",
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nabc",
+      false, -1, 0, { 0 }, { 0 }, false },
+};
+
+static void
+check_case(const scan_case_t *c, const scan_res_t *r, const char *how)
+{
+    uint32_t len = (uint32_t)strlen(c->stream);
+
+    CHECK(r->err == c->err, "%s (%s): error %d, want %d",
+          c->name, how, r->err, c->err);
+    if (c->err)
+        return;
+    CHECK(r->n == c->n, "%s (%s): %u responses, want %u",
+          c->name, how, r->n, c->n);
+    for (uint32_t i = 0; i < c->n && i < r->n; i++) {
+        uint32_t end = c->end[i] ? c->end[i] : len;
+        CHECK(r->status[i] == c->status[i], "%s (%s): #%u status %u, want %u",
+              c->name, how, i, r->status[i], c->status[i]);
+        CHECK(r->end[i] == end, "%s (%s): #%u ends at %u, want %u",
+              c->name, how, i, r->end[i], end);
+    }
+    CHECK(r->eof == c->eof, "%s (%s): eof %d, want %d",
+          c->name, how, r->eof, c->eof);
+    if (c->eof)
+        CHECK(r->in_body, "%s (%s): not in the body", c->name, how);
+}
+
+/* Every case in one read, byte by byte, and split in two at every
+ * offset. */
+static void
+test_cases(void)
+{
+    char how[32];
+    scan_res_t r;
+
+    for (size_t i = 0; i < sizeof(k_cases) / sizeof(k_cases[0]); i++) {
+        const scan_case_t *c = &k_cases[i];
+        uint32_t len = (uint32_t)strlen(c->stream);
+
+        feed(c->stream, len, len, 0, c->head, &r);
+        check_case(c, &r, "one read");
+        feed(c->stream, len, 1, 0, c->head, &r);
+        check_case(c, &r, "byte reads");
+        for (uint32_t cut = 1; cut < len; cut++) {
+            feed(c->stream, len, 0, cut, c->head, &r);
+            snprintf(how, sizeof(how), "split at %u", cut);
+            check_case(c, &r, how);
+        }
+    }
+}
+
+/* Header section over HTTP_SCAN_MAX_HDR, in one header line (the LF
+ * scan) and over many short ones (the name match). */
+static void
+test_header_limit(void)
+{
+    static char big[HTTP_SCAN_MAX_HDR + 256];
+    scan_res_t r;
+
+    strcpy(big, "HTTP/1.1 200 OK\r\nX: ");
+    memset(big + strlen(big), 'a', HTTP_SCAN_MAX_HDR);
+    feed(big, (uint32_t)strlen(big), 4096, 0, false, &r);
+    CHECK(r.err == -1, "long header line accepted");
+
+    strcpy(big, "HTTP/1.1 200 OK\r\n");
+    while (strlen(big) < HTTP_SCAN_MAX_HDR + 64)
+        strcat(big, "Content-Type: x\r\n");
+    feed(big, (uint32_t)strlen(big), 4096, 0, false, &r);
+    CHECK(r.err == -1, "long header section accepted");
+}
+
+/* Large bodies across vector-sized and odd reads: Content-Length past
+ * 32 bits and chunks with body bytes that look like framing. */
+static void
+test_large_bodies(void)
+{
+    static char stream[1 << 16];
+    scan_res_t r;
+    uint32_t n = 0;
+
+    n += (uint32_t)sprintf(stream + n, "HTTP/1.1 200 OK\r\n"
+                           "Transfer-Encoding: chunked\r\n\r\n");
+    for (uint32_t k = 1; k <= 4; k++) {
+        uint32_t sz = 1000 * k + 7;
+        n += (uint32_t)sprintf(stream + n, "%x\r\n", sz);
+        for (uint32_t i = 0; i < sz; i++)
+            stream[n++] = "\r\n0HTTP/1.1 200"[i % 15];
+        n += (uint32_t)sprintf(stream + n, "\r\n");
+    }
+    n += (uint32_t)sprintf(stream + n, "0\r\n\r\n");
+    uint32_t first = n;
+    n += (uint32_t)sprintf(stream + n, "HTTP/1.1 200 OK\r\n\r\n");
+
+    static const uint32_t segs[] = { 1, 3, 16, 31, 32, 33, 1460, 0 };
+    for (size_t i = 0; segs[i]; i++) {
+        feed(stream, n, segs[i], 0, false, &r);
+        CHECK(r.err == 0 && r.n == 1 && r.end[0] == first && r.eof,
+              "chunked body in %u-byte reads: err %d n %u end %u eof %d",
+              segs[i], r.err, r.n, r.end[0], r.eof);
+    }
+
+    /* Only the header section is fed: the body count must survive */
+    const char *hdr = "HTTP/1.1 200 OK\r\nContent-Length: 8589934592\r\n\r\n";
+    http_rsp_scan_t s;
+    uint32_t used;
+    http11_rsp_scan_init(&s);
+    CHECK(http11_rsp_scan(&s, (const uint8_t *)hdr, (uint32_t)strlen(hdr),
+                          false, &used) == 0 &&
+          http11_rsp_scan_in_body(&s) && s.body_left == 8589934592ULL,
+          "content-length past 32 bits");
+}
+
+int
+main(void)
+{
+    test_cases();
+    test_header_limit();
+    test_large_bodies();
+    if (g_failed) {
+        printf("http11_rsp_scan: %d check(s) failed\n", g_failed);
+        return 1;
+    }
+    printf("http11_rsp_scan: ok\n");
+    return 0;
+}